@@ -0,0 +1,33 @@
+// ==================================================
+// File: src/Backoff.h
+// ==================================================
+//
+// Exponential backoff with "equal jitter" (half fixed, half random) for
+// reconnect loops. nextDelay() doubles from minMs up to maxMs per failure.
+
+#pragma once
+#include <Arduino.h>
+
+struct Backoff
+{
+    unsigned long minMs;
+    unsigned long maxMs;
+    uint8_t failures;
+
+    void reset() { failures = 0; }
+
+    // Records a failure and returns how long to wait before the next attempt
+    unsigned long nextDelay()
+    {
+        if (failures < 255)
+            failures++;
+        unsigned long window = minMs;
+        for (uint8_t i = 1; i < failures && window < maxMs; i++)
+        {
+            window *= 2;
+        }
+        if (window > maxMs)
+            window = maxMs;
+        return window / 2 + random(window / 2 + 1);
+    }
+};
@@ -0,0 +1,42 @@
+// ==================================================
+// File: src/CalendarEvents.cpp
+// ==================================================
+
+#include "CalendarEvents.h"
+
+static CalendarHandler handlers[CAL_EVENT_COUNT][CALENDAR_MAX_HANDLERS];
+static uint8_t handlerCount[CAL_EVENT_COUNT];
+
+static CivilTime last;
+static bool haveLast = false;
+
+bool onCalendarEvent(CalendarEvent event, CalendarHandler handler)
+{
+    if (handlerCount[event] >= CALENDAR_MAX_HANDLERS)
+    {
+        Serial.println("❌ Calendar handler table full");
+        return false;
+    }
+    handlers[event][handlerCount[event]++] = handler;
+    return true;
+}
+
+void emitCalendarRollover(const CivilTime &local)
+{
+    // The coarsest unit that changed; every finer one changed with it
+    CalendarEvent top = CAL_MONTH;
+    if (haveLast && local.year == last.year && local.month == last.month)
+    {
+        top = CAL_DAY;
+        if (local.day == last.day)
+            top = local.hour == last.hour ? CAL_MINUTE : CAL_HOUR;
+    }
+    last = local;
+    haveLast = true;
+
+    for (uint8_t e = CAL_MINUTE; e <= top; e++)
+    {
+        for (uint8_t i = 0; i < handlerCount[e]; i++)
+            handlers[e][i](local);
+    }
+}
@@ -0,0 +1,38 @@
+// ==================================================
+// File: src/CalendarEvents.h
+// ==================================================
+//
+// Local-time rollover events from the clock service. Each time a new local
+// minute starts, the clock calls emitCalendarRollover() with the broken-down
+// time; which units changed is worked out once, and the handlers registered
+// for them run in order minute, hour, day, month (a new month is also a new
+// day, hour and minute).
+//
+// The first local time after boot counts as a rollover of every unit, since
+// nothing was known before it, so handlers must be idempotent for the
+// current period (compare against what they stored, not assume a change).
+//
+//   onCalendarEvent(CAL_DAY, storeDate);
+//
+// Handlers run in the "time" job and must not block.
+
+#pragma once
+#include <Arduino.h>
+#include "TimeZone.h"
+
+#define CALENDAR_MAX_HANDLERS 4 // per event
+
+enum CalendarEvent
+{
+    CAL_MINUTE,
+    CAL_HOUR,
+    CAL_DAY,
+    CAL_MONTH,
+    CAL_EVENT_COUNT
+};
+
+typedef void (*CalendarHandler)(const CivilTime &local);
+
+// Function declarations
+bool onCalendarEvent(CalendarEvent event, CalendarHandler handler); // false if the table is full
+void emitCalendarRollover(const CivilTime &local);
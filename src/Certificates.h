@@ -0,0 +1,11 @@
+// ==================================================
+// File: src/Certificates.h
+// ==================================================
+//
+// Root CAs pinned for the TLS connections. Only the roots that actually sign
+// our endpoints are trusted, instead of setInsecure().
+
+#pragma once
+
+extern const char ROOT_CA_ISRG_X1[]; // ISRG Root X1 (Let's Encrypt) - HiveMQ Cloud MQTT broker
+extern const char ROOT_CA_GTS_R1[];  // GTS Root R1 (Google Trust Services) - Firebase RTDB
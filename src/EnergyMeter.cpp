@@ -0,0 +1,200 @@
+// ==================================================
+// File: src/EnergyMeter.cpp
+// ==================================================
+
+#include "EnergyMeter.h"
+#include "config.h"
+#include "CalendarEvents.h"
+#include <Preferences.h>
+
+extern SystemStatus systemStatus;
+
+// NVS image
+struct EnergyBlob
+{
+    uint32_t version;
+    EnergyTotals totals;
+    uint32_t totalRemMilliWh; // below one Wh, not yet in totals.totalWh
+};
+
+static EnergyBlob blob;
+static uint32_t residualMilliJ = 0; // below one mWh
+static unsigned long lastTickMs = 0;
+static unsigned long lastSaveMs = 0;
+static bool dirty = false;
+static uint32_t saves = 0;
+
+static void rollPeriods(const CivilTime &local);
+
+// === Persistence ===
+
+void initEnergyMeter()
+{
+    Preferences prefs;
+    bool loaded = false;
+    if (prefs.begin("energy", true))
+    {
+        if (prefs.getBytesLength("meter") == sizeof(blob))
+        {
+            prefs.getBytes("meter", &blob, sizeof(blob));
+            loaded = blob.version == ENERGY_NVS_VERSION;
+        }
+        prefs.end();
+    }
+    if (!loaded)
+    {
+        memset(&blob, 0, sizeof(blob));
+        blob.version = ENERGY_NVS_VERSION;
+    }
+    lastTickMs = millis();
+    lastSaveMs = millis();
+    onCalendarEvent(CAL_HOUR, rollPeriods);
+
+    Serial.print("✅ Energy meter: ");
+    Serial.print(blob.totals.totalWh);
+    Serial.print(" Wh total, ");
+    Serial.print(getEnergyWh(blob.totals.day));
+    Serial.println(" Wh today");
+}
+
+void saveEnergyMeter()
+{
+    if (!dirty)
+        return;
+    Preferences prefs;
+    if (prefs.begin("energy", false))
+    {
+        prefs.putBytes("meter", &blob, sizeof(blob));
+        prefs.end();
+        saves++;
+    }
+    dirty = false;
+    lastSaveMs = millis();
+}
+
+// === Periods ===
+
+// Starts a new period when the clock moved past the current one.
+// Returns true when it did.
+static bool rollPeriod(EnergyPeriod &p, uint32_t key, uint32_t &completedWh)
+{
+    if (p.key == key)
+        return false;
+    if (p.key == 0)
+    {
+        p.key = key; // metered before the clock was set
+        return false;
+    }
+    completedWh = getEnergyWh(p);
+    memset(&p, 0, sizeof(p));
+    p.key = key;
+    return true;
+}
+
+// CAL_HOUR handler: closes the hour, and the day and month when they changed
+static void rollPeriods(const CivilTime &local)
+{
+    EnergyTotals &t = blob.totals;
+    uint32_t hourKey = (uint32_t)daysFromCivil(local.year, local.month, local.day) * 24 + local.hour;
+    uint32_t monthKey = local.year * 100UL + local.month;
+    uint32_t dayKey = monthKey * 100UL + local.day;
+
+    rollPeriod(t.hour, hourKey, t.lastHourWh);
+    bool newDay = rollPeriod(t.day, dayKey, t.lastDayWh);
+    bool newMonth = rollPeriod(t.month, monthKey, t.lastMonthWh);
+    if (newDay || newMonth)
+    {
+        Serial.print("⚡ Energy yesterday: ");
+        Serial.print(t.lastDayWh);
+        Serial.println(" Wh");
+        dirty = true;
+        saveEnergyMeter(); // period totals are what people look at
+    }
+}
+
+// === Metering ===
+
+static void addEnergy(EnergyPeriod &p, uint32_t milliWh, uint32_t onS, uint32_t meteredS)
+{
+    p.milliWh += milliWh;
+    p.onS += onS;
+    p.meteredS += meteredS;
+}
+
+void updateEnergyMeter()
+{
+    unsigned long nowMs = millis();
+    unsigned long dtMs = nowMs - lastTickMs;
+    lastTickMs = nowMs;
+    if (dtMs > ENERGY_MAX_STEP_MS)
+        dtMs = 0; // e.g. a long blocking call; don't guess
+
+    // Whole seconds for the time counters, the remainder carries over
+    static unsigned long msCarry = 0;
+    msCarry += dtMs;
+    uint32_t seconds = msCarry / 1000;
+    msCarry %= 1000;
+
+    bool on = systemStatus.heater == HEATER_ON;
+    uint32_t milliWh = 0;
+    if (on)
+    {
+        float watts = getHeaterCurrent() * MAINS_VOLTAGE;
+        residualMilliJ += (uint32_t)lroundf(watts * dtMs); // W x ms = mJ
+        milliWh = residualMilliJ / 3600;
+        residualMilliJ %= 3600;
+    }
+
+    if (milliWh == 0 && seconds == 0)
+        return;
+    uint32_t onS = on ? seconds : 0;
+    EnergyTotals &t = blob.totals;
+    addEnergy(t.hour, milliWh, onS, seconds);
+    addEnergy(t.day, milliWh, onS, seconds);
+    addEnergy(t.month, milliWh, onS, seconds);
+    t.totalOnS += onS;
+    blob.totalRemMilliWh += milliWh;
+    t.totalWh += blob.totalRemMilliWh / 1000;
+    blob.totalRemMilliWh %= 1000;
+
+    if (milliWh > 0 || onS > 0)
+        dirty = true;
+    if (dirty && millis() - lastSaveMs >= ENERGY_SAVE_INTERVAL_MS)
+        saveEnergyMeter();
+}
+
+// === Queries ===
+
+const EnergyTotals &getEnergyTotals()
+{
+    return blob.totals;
+}
+
+uint32_t getEnergyWh(const EnergyPeriod &p)
+{
+    return (p.milliWh + 500) / 1000;
+}
+
+uint16_t getDutyPermille(const EnergyPeriod &p)
+{
+    if (p.meteredS == 0)
+        return 0;
+    return (uint64_t)p.onS * 1000 / p.meteredS;
+}
+
+void printEnergyStats()
+{
+    const EnergyTotals &t = blob.totals;
+    Serial.print("Energy: hour ");
+    Serial.print(getEnergyWh(t.hour));
+    Serial.print(" Wh, today ");
+    Serial.print(getEnergyWh(t.day));
+    Serial.print(" Wh (duty ");
+    Serial.print(getDutyPermille(t.day) / 10.0f, 1);
+    Serial.print("%), month ");
+    Serial.print(getEnergyWh(t.month));
+    Serial.print(" Wh, total ");
+    Serial.print(t.totalWh);
+    Serial.print(" Wh, NVS saves ");
+    Serial.println(saves);
+}
@@ -0,0 +1,52 @@
+// ==================================================
+// File: src/EnergyMeter.h
+// ==================================================
+//
+// Heater energy and on-time. Every heater control tick integrates
+// Irms (SCT-013, see voltageSensor()) x MAINS_VOLTAGE over the time the relay
+// was on, into hour / day / month counters plus a lifetime total. Periods
+// follow local time once NTP has synced (closed by CAL_HOUR events); what is
+// metered before that counts towards the period the clock then reports.
+//
+// The counters are saved to NVS in one blob, at most every
+// ENERGY_SAVE_INTERVAL_MS while they change and right away when a day or
+// month ends - a few dozen small writes a day, which the NVS wear levelling
+// spreads easily. Up to one save interval of metering is lost on power-off.
+
+#pragma once
+#include <Arduino.h>
+
+#define ENERGY_SAVE_INTERVAL_MS 900000UL // 15 minutes
+#define ENERGY_MAX_STEP_MS 10000         // longer gaps between ticks are not metered
+#define ENERGY_NVS_VERSION 1
+#define ENERGY_MQTT_HEARTBEAT_MS 300000UL  // republish unchanged counters
+#define ENERGY_FIREBASE_INTERVAL_MS 60000UL // at most one /energy update per minute
+
+struct EnergyPeriod
+{
+    uint32_t key;       // local time: hour = hours since 1970, day = YYYYMMDD, month = YYYYMM; 0 = clock not set yet
+    uint32_t milliWh;
+    uint32_t onS;       // relay on
+    uint32_t meteredS;  // device running, for the duty cycle
+};
+
+struct EnergyTotals
+{
+    EnergyPeriod hour;
+    EnergyPeriod day;
+    EnergyPeriod month;
+    uint32_t lastHourWh; // completed periods
+    uint32_t lastDayWh;
+    uint32_t lastMonthWh;
+    uint32_t totalWh;
+    uint32_t totalOnS;
+};
+
+// Function declarations
+void initEnergyMeter();   // loads the counters from NVS
+void updateEnergyMeter(); // once per heater control tick
+void saveEnergyMeter();   // NVS write if anything changed
+const EnergyTotals &getEnergyTotals();
+uint32_t getEnergyWh(const EnergyPeriod &p);
+uint16_t getDutyPermille(const EnergyPeriod &p);
+void printEnergyStats();
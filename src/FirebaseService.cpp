@@ -5,9 +5,18 @@
 #include "FirebaseService.h"
 #include "config.h"
 #include <WiFi.h>
+#include "WiFiManagerCustom.h"
 #include <Firebase_ESP_Client.h>
 #include "TemperatureSensors.h"
 #include "GetShedual.h"
+#include "Scheduler.h"
+#include "Certificates.h"
+#include "NetClientPool.h"
+#include "Reporter.h"
+#include "History.h"
+#include "EnergyMeter.h"
+#include "ScheduleSync.h"
+#include "Presence.h"
 
 // External variable declarations for debugging
 extern ScheduleData currentSchedule;
@@ -20,61 +29,159 @@ static FirebaseConfig fbConfig;
 static FirebaseAuth fbAuth;
 static bool fbInitialized = false;
 static bool initialScheduleFetched = false; // Track initial schedule fetch
+static int initRetryJob = SCHED_INVALID_JOB; // One-shot retry of initFirebase()
 
-void setFirebaseOnlineStatus()
+enum FirebaseInitStage
 {
-    Serial.println("🤠🤠🤠🤠🤠🤠🤠🤠🤠🤠🤠 Line 26 void setFirebaseOnlineStatus()...");
-    Serial.println(" ");
-    if (!fbInitialized)
-        return;
-    FirebaseJson json;
-    json.set("status", "online");
-    json.set("last_seen", millis()); // You can use a real timestamp if available
-    Firebase.RTDB.setJSON(&fbData, "/system/device_status", &json);
+    FB_INIT_IDLE,
+    FB_INIT_SIGN_UP,
+    FB_INIT_WAIT_TOKEN,
+    FB_INIT_FETCH
+};
+
+static FirebaseInitStage initStage = FB_INIT_IDLE;
+static int initStepJob = SCHED_INVALID_JOB;
+static unsigned long initStartMs = 0;
+static unsigned long initStageMs = 0;
+static unsigned long readyMs = 0; // time-to-ready of the last initialization
+static bool tokenFailed = false; // set by the token status callback
+
+extern SystemStatus systemStatus;
+
+// Frees the TLS context held by fbData; the library reconnects on the next request
+static void closeFirebaseConnection()
+{
+    fbData.stopWiFiClient();
 }
 
-void setFirebaseOfflineStatus()
+static void retryFirebaseInit()
 {
-    Serial.println("😈😈😈😈😈😈😈😈😈😈😈😈😈😈 Line 37 void setFirebaseOfflineStatus()...");
-    Serial.println(" ");
-    if (!fbInitialized)
+    initRetryJob = SCHED_INVALID_JOB;
+    if (fbInitialized)
         return;
-    FirebaseJson json;
-    json.set("status", "offline");
-    json.set("last_seen", millis());
-    Firebase.RTDB.setJSON(&fbData, "/system/device_status", &json);
+    Serial.println("****Retrying Firebase initialization...");
+    initFirebase(systemStatus);
 }
 
-void updateFirebaseLastSeen()
+// Queue one retry of initFirebase() (no-op if one is already pending)
+static void scheduleFirebaseInitRetry()
 {
-    Serial.println("👹👹👹👹👹👹👹👹👹👹👹👹👹👹👹 Line 48 void updateFirebaseLastSeen()...");
-    Serial.println(" ");
-    if (!fbInitialized)
+    if (!isJobScheduled(initRetryJob))
+    {
+        initRetryJob = scheduleOnce("fb-retry", FIREBASE_INIT_RETRY_INTERVAL, retryFirebaseInit, JOB_PRIORITY_NORMAL);
+    }
+}
+
+// === Staged initialization ===
+//
+// initFirebase() configures the client and starts the "fb-init" job, which
+// advances one stage per run so heater control, MQTT and the LEDs keep
+// running in between:
+//   SIGN_UP       anonymous sign-up, then Firebase.begin()
+//   WAIT_TOKEN    Firebase.ready() drives token generation until it succeeds,
+//                 the token callback reports an error or FIREBASE_TOKEN_TIMEOUT_MS
+//   FETCH         Firebase is ready; the schedule merge
+// A failure anywhere drops back to idle and queues a retry.
+
+static void tokenStatusCallback(TokenInfo info)
+{
+    tokenFailed = info.status == token_status_error;
+}
+
+static void enterInitStage(FirebaseInitStage stage)
+{
+    initStage = stage;
+    initStageMs = millis();
+}
+
+static void finishInit()
+{
+    cancelJob(initStepJob);
+    initStepJob = SCHED_INVALID_JOB;
+    enterInitStage(FB_INIT_IDLE);
+}
+
+static void failInit(const char *reason)
+{
+    Serial.print("❌ Firebase initialization failed (");
+    Serial.print(reason);
+    Serial.println(") - will retry later");
+    finishInit();
+    systemStatus.firebase = FB_ERROR;
+    scheduleFirebaseInitRetry();
+}
+
+static void firebaseInitStep()
+{
+    if (!isWiFiConnected())
+    {
+        failInit("WiFi lost");
         return;
-    Firebase.RTDB.setInt(&fbData, "/system/device_status/last_seen", millis());
+    }
+    // Every stage may talk HTTPS; if the shared slot is busy try next run
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
+
+    switch (initStage)
+    {
+    case FB_INIT_SIGN_UP:
+        if (Firebase.signUp(&fbConfig, &fbAuth, "", ""))
+            Serial.println("Anonymous sign-up successful");
+        else
+            Serial.println("⚠️  Anonymous sign-up failed - check Firebase project settings for anonymous auth");
+        Firebase.begin(&fbConfig, &fbAuth);
+        Firebase.reconnectWiFi(true);
+        enterInitStage(FB_INIT_WAIT_TOKEN);
+        break;
+
+    case FB_INIT_WAIT_TOKEN:
+        if (Firebase.ready())
+        {
+            fbInitialized = true;
+            systemStatus.firebase = FB_CONNECTED;
+            readyMs = millis() - initStartMs;
+            Serial.print("✅ Firebase ready in ");
+            Serial.print(readyMs);
+            Serial.println(" ms");
+            enterInitStage(FB_INIT_FETCH);
+        }
+        else if (tokenFailed)
+            failInit("token error");
+        else if (millis() - initStageMs > FIREBASE_TOKEN_TIMEOUT_MS)
+            failInit("token timeout");
+        break;
+
+    case FB_INIT_FETCH:
+        resetPresence(); // written by the next sync
+        Serial.println("🚀 Fetching initial schedule data from Firebase...");
+        if (pullScheduleFromFirebase())
+            initialScheduleFetched = true; // otherwise the "fb-target" job merges it later
+        finishInit();
+        break;
+
+    default:
+        finishInit();
+        break;
+    }
 }
 
 void initFirebase(SystemStatus &status)
 {
-    Serial.println("👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺 Line 56 void initFirebase(SystemStatus &status)...");
-    Serial.println(" ");
     // Initialize only when WiFi connected
-    if (WiFi.status() != WL_CONNECTED)
+    if (!isWiFiConnected())
     {
         status.firebase = FB_CONNECTING;
         Serial.println("WiFi not connected, cannot initialize Firebase");
+        scheduleFirebaseInitRetry();
         return;
     }
+    if (initStage != FB_INIT_IDLE)
+        return; // already under way
 
+    registerNetClient(NET_CLIENT_FIREBASE, "firebase", false, closeFirebaseConnection);
     Serial.println("Initializing Firebase...");
 
-    // Debug print credentials (remove in production)
-    Serial.println("Firebase credentials:");
-    Serial.print("API Key: ");
-    Serial.println(FIREBASE_API_KEY);
-    Serial.print("Database URL: ");
-    Serial.println(FIREBASE_DATABASE_URL);
-
     // Clear any previous configuration
     fbConfig = FirebaseConfig();
     fbAuth = FirebaseAuth();
@@ -90,161 +197,57 @@ void initFirebase(SystemStatus &status)
     fbConfig.timeout.serverResponse = 15 * 1000;   // 15 seconds
     fbConfig.timeout.socketConnection = 15 * 1000; // 15 seconds
 
-    // For anonymous authentication, we need to sign in after initialization
-    Serial.println("Attempting anonymous authentication...");
-
-    // Initialize Firebase first
-    Firebase.begin(&fbConfig, &fbAuth);
-    Firebase.reconnectWiFi(true);
-
-    // Wait for initialization
-    delay(3000);
-
-    // Try anonymous authentication
-    Serial.println("Signing in anonymously...");
-    if (Firebase.signUp(&fbConfig, &fbAuth, "", ""))
-    {
-        Serial.println("Anonymous sign-up successful");
-    }
-    else
-    {
-        Serial.print("Anonymous sign-up failed: ");
-        Serial.println("Check Firebase project settings for anonymous auth");
-    }
-
-    // Wait longer for authentication
-    delay(2000);
+    // Verify the RTDB / identity toolkit endpoints (Google Trust Services)
+    fbConfig.cert.data = ROOT_CA_GTS_R1;
+    fbConfig.token_status_callback = tokenStatusCallback;
 
-    // Test the connection immediately
-    Serial.println("Testing Firebase connection...");
-
-    // Try to write a simple test value instead of just checking ready()
-    if (Firebase.RTDB.setString(&fbData, "/test/connection", "esp32_test"))
-    {
-        fbInitialized = true;
-        status.firebase = FB_CONNECTED;
-        Serial.println("Firebase initialized and connected successfully");
-        Serial.println("Test write successful");
-
-        // Set device online status in Firebase (LWT-like)
-        setFirebaseOnlineStatus();
+    tokenFailed = false;
+    initStartMs = millis();
+    status.firebase = FB_CONNECTING;
+    enterInitStage(FB_INIT_SIGN_UP);
+    initStepJob = scheduleEvery("fb-init", FIREBASE_INIT_STEP_MS, firebaseInitStep, JOB_PRIORITY_NORMAL);
+}
 
-        // Now try to read back the data we just wrote
-        Serial.println("Testing data retrieval...");
-        if (Firebase.RTDB.getString(&fbData, "/test/connection"))
-        {
-            String retrievedValue = fbData.stringData();
-            Serial.print("Retrieved value: ");
-            Serial.println(retrievedValue);
-
-            // Test reading a timestamp
-            if (Firebase.RTDB.setTimestamp(&fbData, "/test/last_connection"))
-            {
-                Serial.println("Timestamp written successfully");
-                if (Firebase.RTDB.getInt(&fbData, "/test/last_connection"))
-                {
-                    int timestamp = fbData.intData();
-                    Serial.print("Connection timestamp: ");
-                    Serial.println(timestamp);
-                }
-            }
-
-            // Immediately fetch schedule data from Firebase on startup
-            Serial.println("🚀 Fetching initial schedule data from Firebase...");
-            fetchScheduleDataFromFirebase();
-            initialScheduleFetched = true;
-            Serial.println("✅ Initial schedule fetch completed. Future updates will come via MQTT.");
-        }
-        else
-        {
-            Serial.println("Read test failed:");
-            Serial.print("Error: ");
-            Serial.println(fbData.errorReason());
-        }
-    }
-    else
-    {
-        // Try a different approach - check if we can read instead
-        Serial.println("Write failed, trying read test...");
-        if (Firebase.ready())
-        {
-            fbInitialized = true;
-            status.firebase = FB_CONNECTED;
-            Serial.println("Firebase ready - assuming connection is good");
-        }
-        else
-        {
-            // Don't set fbInitialized = false here - we'll try again later
-            status.firebase = FB_ERROR;
-            Serial.println("Firebase initialization failed - will retry later");
-            Serial.print("Error: ");
-            Serial.println(fbData.errorReason());
-            Serial.print("HTTP Code: ");
-            Serial.println(fbData.httpCode());
-        }
-    }
+unsigned long getFirebaseReadyMs()
+{
+    return readyMs;
 }
 
 /**
- * Main Firebase connection handler - manages Firebase initialization and connection monitoring
- * This function should be called regularly in the main loop to maintain Firebase connectivity
+ * Firebase connection monitor - called by the "fb-health" scheduler job
+ * every FIREBASE_HEALTH_INTERVAL ms
  *
  * @param status Reference to SystemStatus struct to update Firebase connection state
  *
  * Responsibilities:
- * 1. Attempts Firebase initialization when not yet initialized and WiFi is connected
+ * 1. Reports the waiting state while Firebase is not yet initialized
+ *    (initialization retries are queued by initFirebase() itself)
  * 2. Monitors ongoing Firebase connection health
  * 3. Updates system status flags for Firebase connectivity
- * 4. Implements rate limiting to prevent excessive initialization attempts
  */
 void handleFirebase(SystemStatus &status)
 {
-    Serial.println(" ");
-    Serial.println("Line 203 FirebaseService.cpp"); 
-    Serial.println("🤡🤡🤡🤡🤡🤡🤡🤡🤡🤡🤡🤡🤡🤡🤡🤡🤡🤡 Line 198 handleFirebase...");
-    Serial.println(" ");
     // === FIREBASE INITIALIZATION PHASE ===
-    // If Firebase hasn't been initialized yet, try to initialize it
     if (!fbInitialized)
     {
-        // Only attempt initialization if WiFi is connected
-        if (WiFi.status() == WL_CONNECTED)
-        {
-            // Rate limit initialization attempts to avoid spam (every 30 seconds)
-            static unsigned long lastInitAttempt = 0;
-            if (millis() - lastInitAttempt > 30000)
-            {
-                Serial.println("****WiFi connected, initializing Firebase...");
-                initFirebase(status); // Attempt Firebase initialization
-                lastInitAttempt = millis();
-            }
-        }
-        else
+        if (initStage != FB_INIT_IDLE)
+            return; // the "fb-init" job is working on it
+        if (!isWiFiConnected())
         {
             // WiFi not connected - set status and wait
             status.firebase = FB_CONNECTING;
-
-            // Only print this message occasionally to avoid spam (every 5 seconds)
-            static unsigned long lastWiFiMessage = 0;
-            if (millis() - lastWiFiMessage > 5000)
-            {
-                Serial.println("WiFi not connected, waiting for connection...");
-                lastWiFiMessage = millis();
-            }
+            Serial.println("WiFi not connected, waiting for connection...");
         }
+        scheduleFirebaseInitRetry();
         return; // Exit early if not initialized
     }
 
     // === CONNECTION MONITORING PHASE ===
-    // Firebase is initialized, now monitor its connection health
-
-    // Rate limit Firebase status checks to avoid excessive polling (every 10 seconds)
-    static unsigned long lastStatusCheck = 0;
-    if (millis() - lastStatusCheck < 10000)
-    {
-        return; // Skip this check cycle
-    }
-    lastStatusCheck = millis();
+    // Firebase.ready() may refresh the auth token over HTTPS; if the shared
+    // TLS slot is busy keep the last known status until the next check
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
 
     // Check current Firebase connection status
     if (Firebase.ready())
@@ -254,6 +257,7 @@ void handleFirebase(SystemStatus &status)
         {
             // Status changed from disconnected to connected - log the recovery
             Serial.println("Firebase connected successfully");
+            resetPresence();
         }
         status.firebase = FB_CONNECTED;
     }
@@ -265,408 +269,293 @@ void handleFirebase(SystemStatus &status)
     }
 }
 
+void addFirebaseUpdate(String &body, const String &path, const String &value)
+{
+    body += body.length() ? ",\"" : "\"";
+    body += path;
+    body += "\":";
+    body += value;
+}
+
+bool sendFirebaseUpdate(const char *node, const String &body)
+{
+    FirebaseJson json;
+    json.setJsonData("{" + body + "}");
+    return Firebase.RTDB.updateNodeSilent(&fbData, node, &json);
+}
+
+struct FirebaseSensorChannel
+{
+    ReportChannel channel;
+    uint8_t sensor;
+    const char *path; // relative to the root, for multi-path updates
+    const char *name;
+};
+
+static const FirebaseSensorChannel sensorChannels[] = {
+    {REPORT_TEMP_RED, 0, "sensors/temperature_red", "Red"},
+    {REPORT_TEMP_BLUE, 1, "sensors/temperature_blue", "Blue"},
+    {REPORT_TEMP_GREEN, 2, "sensors/temperature_green", "Green"},
+};
+#define SENSOR_CHANNEL_COUNT (sizeof(sensorChannels) / sizeof(sensorChannels[0]))
+
+// Pushes the sensor channels the Firebase reporter says are due (whole degrees)
 void pushSensorValuesToFirebase()
 {
-    Serial.println("💩💩💩💩💩💩💩💩💩💩💩💩💩💩💩💩 Line 263 pushSensorValuesToFirebase...");
-    Serial.println(" ");
     if (!fbInitialized)
     {
         Serial.println("Firebase not initialized, cannot push data");
         return;
     }
 
-    Serial.println("Pushing sensor data to Firebase...");
-
-    // Get real temperature readings from sensors
-    float temp0 = getTemperature(0); // Red sensor
-    float temp1 = getTemperature(1); // Blue sensor
-    float temp2 = getTemperature(2); // Green sensor
-
-    // Calculate average temperature from connected sensors
-    /*
-    // float avgTemp = 0;
-    // int validSensors = 0;
-
-    // if (!isnan(temp0))
-    // {
-    //     avgTemp += temp0;
-    //     validSensors++;
-    // }
-    // if (!isnan(temp1))
-    // {
-    //     avgTemp += temp1;
-    //     validSensors++;
-    // }
-    // if (!isnan(temp2))
-    // {
-    //     avgTemp += temp2;
-    //     validSensors++;
-    // }
-
-    // if (validSensors > 0)
-    // {
-    //     avgTemp /= validSensors;
-    // }
-    // else
-    // {
-    //     avgTemp = NAN; // No valid sensors
-    // }
-*/
-    // Push individual sensor temperatures
-    if (!isnan(temp0))
-    {
-        int roundedTemp0 = round(temp0);
-        if (Firebase.RTDB.setInt(&fbData, "/sensors/temperature_red", roundedTemp0))
-        {
-            Serial.print("Red temperature pushed: ");
-            Serial.print(roundedTemp0);
-            Serial.println("°C");
-        }
-    }
-
-    if (!isnan(temp1))
-    {
-        int roundedTemp1 = round(temp1);
-        if (Firebase.RTDB.setInt(&fbData, "/sensors/temperature_blue", roundedTemp1))
-        {
-            Serial.print("Blue temperature pushed: ");
-            Serial.print(roundedTemp1);
-            Serial.println("°C");
-        }
-    }
-
-    if (!isnan(temp2))
+    // Decide first, so a quiet round doesn't touch the network at all
+    Temp temps[SENSOR_CHANNEL_COUNT];
+    bool due[SENSOR_CHANNEL_COUNT];
+    bool anyDue = false;
+    for (uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++)
     {
-        int roundedTemp2 = round(temp2);
-        if (Firebase.RTDB.setInt(&fbData, "/sensors/temperature_green", roundedTemp2))
-        {
-            Serial.print("Green temperature pushed: ");
-            Serial.print(roundedTemp2);
-            Serial.println("°C");
-        }
+        temps[i] = getLastTemperature(sensorChannels[i].sensor); // cached, no bus I/O
+        due[i] = reportDue(sensorChannels[i].channel, REPORT_SINK_FIREBASE, temps[i]);
+        anyDue = anyDue || due[i];
     }
+    if (!anyDue)
+        return;
 
-    // Push current target temperature from schedule system (FORCE PUSH MODE)
-    static float lastTargetTemp = NAN;
-
-    // Check if schedule data has been loaded from Firebase
-    Serial.println("");
-    Serial.println("**===============================**");
-    Serial.println("🔍 Checking if schedule data is available...");
-    Serial.println("*===============================*");
-    Serial.println("");
-    bool scheduleDataLoaded = (!isnan(currentSchedule.amTemp) && !isnan(currentSchedule.pmTemp) &&
-                               currentSchedule.amTime.length() > 0 && currentSchedule.pmTime.length() > 0);
-
-    Serial.print("");
-    Serial.print("*===============================*");
-    Serial.print("📊 Schedule data loaded: ");
-    Serial.println(scheduleDataLoaded ? "YES" : "NO");
-    Serial.print("*===============================*");
-    Serial.println("");
-
-    // if (!scheduleDataLoaded)
-    // {
-    //     Serial.println("⚠️  Schedule data not yet loaded from Firebase - skipping target temperature push");
-    //     Serial.println("🔄 Attempting to fetch schedule data...");
-    //     fetchScheduleDataFromFirebase();
-    //     return; // Skip temperature push until data is loaded
-    // }
-
-    float currentTarget = getCurrentScheduledTemperature();
-
-    // Debug: Always show target temperature comparison
-    Serial.print("");
-    Serial.print("*===============================*");
-    Serial.print("🎯 Target temp check - Current: ");
-    Serial.print(currentTarget);
-    Serial.println("°C, ");
-    Serial.print("");
-    Serial.print("*===============================*");
-    Serial.print(" Last:");
-    Serial.println(isnan(lastTargetTemp) ? "NaN" : String(lastTargetTemp));
-    Serial.println("");
-    Serial.println("*===============================*");
-    Serial.println("");
-    Serial.println("*===============================*");
-    Serial.print("°C, Difference: ");
-    if (!isnan(lastTargetTemp) && !isnan(currentTarget))
-    {
-        Serial.print(abs(currentTarget - lastTargetTemp));
-    }
-    else
-    {
-        Serial.print("N/A");
-    }
-    Serial.println("°C");
+    // Skip this round if another HTTPS client holds the shared TLS slot
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
 
-    // SMART PUSH: Push when temperature changes OR periodically for sync
-    if (!isnan(currentTarget))
+    // All due channels and the presence record in one multi-path update
+    String body;
+    bool written[SENSOR_CHANNEL_COUNT] = {};
+    for (uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++)
     {
-        int roundedTarget = round(currentTarget);
-        static unsigned long lastPushTime = 0;
-        unsigned long currentTime = millis();
-        bool shouldPush = false;
-
-        // Push if temperature changed by more than 0.1°C
-        if (isnan(lastTargetTemp) || abs(currentTarget - lastTargetTemp) > 0.1)
+        if (!due[i])
+            continue;
+        const FirebaseSensorChannel &ch = sensorChannels[i];
+        if (!temps[i].isValid())
         {
-            shouldPush = true;
-            Serial.print("� Target temperature changed: ");
-            Serial.print(roundedTarget);
-            Serial.println("°C - pushing update");
-        }
-        // Or push periodically every 5 minutes to ensure Firebase stays in sync
-        else if (currentTime - lastPushTime > 300000) // 5 minutes
-        {
-            shouldPush = true;
-            Serial.print("🔄 Periodic sync: ");
-            Serial.print(roundedTarget);
-            Serial.println("°C - pushing for sync");
-        }
-
-        if (shouldPush)
-        {
-            Serial.print("🔗 Attempting Firebase push to /control/target_temperature with value: ");
-            Serial.println(roundedTarget);
-
-            if (Firebase.RTDB.setInt(&fbData, "/control/target_temperature", roundedTarget))
-            {
-                Serial.print("✅ Target temperature pushed successfully: ");
-                Serial.print(roundedTarget);
-                Serial.println("°C");
-                lastTargetTemp = currentTarget; // Remember this value
-                lastPushTime = currentTime;     // Remember when we pushed
-            }
-            else
-            {
-                Serial.println("❌ Failed to push target temperature to Firebase");
-                Serial.print("Firebase error: ");
-                Serial.println(fbData.errorReason());
-                Serial.print("HTTP Code: ");
-                Serial.println(fbData.httpCode());
-                Serial.print("Firebase ready: ");
-                Serial.println(Firebase.ready() ? "YES" : "NO");
-            }
-        }
-        else
-        {
-            Serial.print("⏭️  Target temperature unchanged (");
-            Serial.print(roundedTarget);
-            Serial.println("°C) - skipping push");
+            // Nothing to write; remember it so the sensor coming back counts as a change
+            markReported(ch.channel, REPORT_SINK_FIREBASE, temps[i]);
+            continue;
         }
+        addFirebaseUpdate(body, ch.path, String(temps[i].wholeDegrees()));
+        written[i] = true;
     }
-    else
-    {
-        Serial.println("⚠️  No valid target temperature to push - currentTarget is NaN");
-        Serial.println("🔍 Debugging schedule data availability...");
+    if (body.length() == 0)
+        return;
+    addPresenceFields(body);
 
-        // Debug schedule data
-        Serial.print("🕐 Current Hours: ");
-        Serial.println(Hours);
-        Serial.print("🌅 AmFlag: ");
-        Serial.println(AmFlag ? "true (AM period)" : "false (PM period)");
-        Serial.print("🌅 AM Temp: ");
-        Serial.println(isnan(currentSchedule.amTemp) ? "NaN" : String(currentSchedule.amTemp));
-        Serial.print("🌆🌆🌆🌆🌆🌆🌆🌆🌆🌆 PM Temp: ");
-        Serial.println(isnan(currentSchedule.pmTemp) ? "NaN" : String(currentSchedule.pmTemp));
-        Serial.print("🌅 AM Time: ");
-        Serial.println(currentSchedule.amTime.length() > 0 ? currentSchedule.amTime : "Empty");
-        Serial.print("🌆 PM Time: ");
-        Serial.println(currentSchedule.pmTime.length() > 0 ? currentSchedule.pmTime : "Empty");
-    } // Push system status
-    String statusPath = "/system/status";
-    if (Firebase.RTDB.setString(&fbData, statusPath.c_str(), "online"))
+    if (!sendFirebaseUpdate("/", body))
     {
-        Serial.println("System status pushed: online");
+        Serial.print("❌ Sensor push failed: ");
+        Serial.println(fbData.errorReason());
+        return;
     }
-
-    // Push timestamp
-    String timestampPath = "/system/last_update";
-    if (Firebase.RTDB.setTimestamp(&fbData, timestampPath.c_str()))
+    presenceWritten(true);
+    for (uint8_t i = 0; i < SENSOR_CHANNEL_COUNT; i++)
     {
-        Serial.println("Timestamp updated");
+        if (!written[i])
+            continue;
+        const FirebaseSensorChannel &ch = sensorChannels[i];
+        markReported(ch.channel, REPORT_SINK_FIREBASE, temps[i]);
+        Serial.print(ch.name);
+        Serial.print(" temperature pushed: ");
+        Serial.print(temps[i].wholeDegrees());
+        Serial.println("°C");
     }
 }
 
+// Pushes the scheduled target temperature when the Firebase reporter says it
+// is due (every change, plus a periodic resync)
 void checkAndPushTargetTemperature()
 {
-    Serial.println("👻👻👻👻👻👻👻👻👻👻👻👻👻👻👻👻 Line 469 checkAndPushTargetTemperature...");
-    Serial.println(" ");
     if (!fbInitialized)
     {
         Serial.println("Firebase not initialized, cannot push target temperature");
         return;
     }
 
-    // Static variables to track state
-    static float lastTargetTemp = NAN;
-    static unsigned long lastPushTime = 0;
-
-    // Check if schedule data has been loaded from Firebase
-    Serial.println("🔍 Checking if schedule data is available...");
-    bool scheduleDataLoaded = (!isnan(currentSchedule.amTemp) && !isnan(currentSchedule.pmTemp) &&
+    bool scheduleDataLoaded = (currentSchedule.amTemp.isValid() && currentSchedule.pmTemp.isValid() &&
                                currentSchedule.amTime.length() > 0 && currentSchedule.pmTime.length() > 0);
-
-    Serial.print("📊 Schedule data loaded: ");
-    Serial.println(scheduleDataLoaded ? "YES" : "NO");
-
     if (!scheduleDataLoaded)
     {
+        TlsLease lease(NET_CLIENT_FIREBASE);
+        if (!lease)
+            return;
         Serial.println("⚠️  Schedule data not yet loaded from Firebase - skipping target temperature push");
         Serial.println("🔄 Attempting to fetch schedule data...");
-        fetchScheduleDataFromFirebase();
+        pullScheduleFromFirebase();
         return; // Skip temperature push until data is loaded
     }
 
-    float currentTarget = getCurrentScheduledTemperature();
+    Temp currentTarget = getCurrentScheduledTemperature();
+    if (!currentTarget.isValid())
+    {
+        Serial.println("⚠️  No valid target temperature to push - currentTarget is invalid");
+        Serial.print("🕐 Current Hours: ");
+        Serial.print(Hours);
+        Serial.print(", AmFlag: ");
+        Serial.println(AmFlag ? "true (AM period)" : "false (PM period)");
+        return;
+    }
+    if (!reportDue(REPORT_TARGET_TEMP, REPORT_SINK_FIREBASE, currentTarget))
+        return;
+
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
 
-    // Debug: Always show target temperature comparison
-    Serial.print("🎯 Target temp check - Current: ");
-    Serial.print(currentTarget);
-    Serial.print("°C, Last: ");
-    Serial.print(isnan(lastTargetTemp) ? "NaN" : String(lastTargetTemp));
-    Serial.print("°C, Difference: ");
-    if (!isnan(lastTargetTemp) && !isnan(currentTarget))
+    int roundedTarget = currentTarget.wholeDegrees();
+    Serial.print("🎯 Target temperature ");
+    Serial.print(currentTarget.toString(2));
+    Serial.print("°C (last pushed ");
+    Serial.print(lastReported(REPORT_TARGET_TEMP, REPORT_SINK_FIREBASE).toString(2));
+    Serial.println("°C) - pushing");
+
+    if (Firebase.RTDB.setInt(&fbData, "/control/target_temperature", roundedTarget))
     {
-        Serial.print(abs(currentTarget - lastTargetTemp));
+        markReported(REPORT_TARGET_TEMP, REPORT_SINK_FIREBASE, currentTarget);
+        Serial.print("✅ Target temperature pushed successfully: ");
+        Serial.print(roundedTarget);
+        Serial.println("°C");
     }
     else
     {
-        Serial.print("N/A");
+        Serial.println("❌ Failed to push target temperature to Firebase");
+        Serial.print("Firebase error: ");
+        Serial.println(fbData.errorReason());
+        Serial.print("HTTP Code: ");
+        Serial.println(fbData.httpCode());
     }
-    Serial.println("°C");
+}
 
-    // SMART PUSH: Push when temperature changes OR periodically for sync
-    if (!isnan(currentTarget))
-    {
-        int roundedTarget = round(currentTarget);
-        unsigned long currentTime = millis();
-        bool shouldPush = false;
+// Uploads queued history points in one multi-path update:
+// /history/<sensor>/<epoch seconds> = centi-degrees ("gap" where readings stopped)
+void uploadHistoryToFirebase()
+{
+    static const char *const sensorKeys[HISTORY_SENSOR_COUNT] = {"red", "blue", "green"};
 
-        // Push if temperature changed by more than 0.1°C
-        if (isnan(lastTargetTemp) || abs(currentTarget - lastTargetTemp) > 0.1)
-        {
-            shouldPush = true;
-            Serial.print("🔄 Target temperature changed: ");
-            Serial.print(roundedTarget);
-            Serial.println("°C - pushing update");
-        }
-        // Or push periodically every 5 minutes to ensure Firebase stays in sync
-        else if (currentTime - lastPushTime > 300000) // 5 minutes
-        {
-            shouldPush = true;
-            Serial.print("🔄 Periodic sync: ");
-            Serial.print(roundedTarget);
-            Serial.println("°C - pushing for sync");
-        }
+    if (!fbInitialized || !historyUploadDue())
+        return;
 
-        if (shouldPush)
-        {
-            Serial.print("🔗 Attempting Firebase push to /control/target_temperature with value: ");
-            Serial.println(roundedTarget);
-
-            if (Firebase.RTDB.setInt(&fbData, "/control/target_temperature", roundedTarget))
-            {
-                Serial.print("✅ Target temperature pushed successfully: ");
-                Serial.print(roundedTarget);
-                Serial.println("°C");
-                lastTargetTemp = currentTarget; // Remember this value
-                lastPushTime = currentTime;     // Remember when we pushed
-            }
-            else
-            {
-                Serial.println("❌ Failed to push target temperature to Firebase");
-                Serial.print("Firebase error: ");
-                Serial.println(fbData.errorReason());
-                Serial.print("HTTP Code: ");
-                Serial.println(fbData.httpCode());
-                Serial.print("Firebase ready: ");
-                Serial.println(Firebase.ready() ? "YES" : "NO");
-            }
-        }
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
+
+    HistoryPoint points[HISTORY_UPLOAD_BATCH];
+    uint8_t count = peekHistory(points, HISTORY_UPLOAD_BATCH);
+    String body;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        String key = String(sensorKeys[points[i].sensor]) + "/" + String(points[i].point.t);
+        if (points[i].point.value.isValid())
+            addFirebaseUpdate(body, key, String((int)points[i].point.value.centi));
         else
-        {
-            Serial.print("⏭️  Target temperature unchanged (");
-            Serial.print(roundedTarget);
-            Serial.println("°C) - skipping push");
-        }
+            addFirebaseUpdate(body, key, "\"gap\"");
+    }
+
+    if (sendFirebaseUpdate("/history", body))
+    {
+        dropHistory(count);
+        Serial.print("📈 Uploaded ");
+        Serial.print(count);
+        Serial.println(" history points");
     }
     else
     {
-        Serial.println("⚠️  No valid target temperature to push - currentTarget is NaN");
-        Serial.println("🔍 Debugging schedule data availability...");
+        Serial.print("❌ History upload failed: ");
+        Serial.println(fbData.errorReason());
+    }
+}
 
-        // Debug schedule data
-        Serial.print("🕐 Current Hours: ");
-        Serial.println(Hours);
-        Serial.print("🌅 AmFlag: ");
-        Serial.println(AmFlag ? "true (AM period)" : "false (PM period)");
-        Serial.print("🌅 AM Temp: ");
-        Serial.println(isnan(currentSchedule.amTemp) ? "NaN" : String(currentSchedule.amTemp));
-        Serial.print("🌆 PM Temp: ");
-        Serial.println(isnan(currentSchedule.pmTemp) ? "NaN" : String(currentSchedule.pmTemp));
-        Serial.print("🌅 AM Time: ");
-        Serial.println(currentSchedule.amTime.length() > 0 ? currentSchedule.amTime : "Empty");
-        Serial.print("🌆 PM Time: ");
-        Serial.println(currentSchedule.pmTime.length() > 0 ? currentSchedule.pmTime : "Empty");
+// Current counters in /energy; each finished day also goes to
+// /energy/days/<YYYYMMDD> = Wh
+void pushEnergyToFirebase()
+{
+    static unsigned long lastPushMs = 0;
+    static uint32_t pushedDayMilliWh = UINT32_MAX;
+    static uint32_t pushedDayKey = 0;
+
+    if (!fbInitialized)
+        return;
+    const EnergyTotals &t = getEnergyTotals();
+    bool newDay = pushedDayKey != 0 && t.day.key != pushedDayKey;
+    if (!newDay && (t.day.milliWh == pushedDayMilliWh || millis() - lastPushMs < ENERGY_FIREBASE_INTERVAL_MS))
+        return;
+
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
+
+    String body;
+    addFirebaseUpdate(body, "hour_wh", String((int)getEnergyWh(t.hour)));
+    addFirebaseUpdate(body, "today_wh", String((int)getEnergyWh(t.day)));
+    addFirebaseUpdate(body, "month_wh", String((int)getEnergyWh(t.month)));
+    addFirebaseUpdate(body, "total_wh", String((int)t.totalWh));
+    addFirebaseUpdate(body, "yesterday_wh", String((int)t.lastDayWh));
+    addFirebaseUpdate(body, "last_month_wh", String((int)t.lastMonthWh));
+    addFirebaseUpdate(body, "today_on_s", String((int)t.day.onS));
+    addFirebaseUpdate(body, "today_duty_pct", String(getDutyPermille(t.day) / 10.0f, 1));
+    if (newDay)
+        addFirebaseUpdate(body, "days/" + String(pushedDayKey), String((int)t.lastDayWh));
+
+    if (sendFirebaseUpdate("/energy", body))
+    {
+        lastPushMs = millis();
+        pushedDayMilliWh = t.day.milliWh;
+        pushedDayKey = t.day.key;
+        Serial.print("⚡ Energy pushed to Firebase: ");
+        Serial.print(getEnergyWh(t.day));
+        Serial.println(" Wh today");
+    }
+    else
+    {
+        Serial.print("❌ Energy update failed: ");
+        Serial.println(fbData.errorReason());
     }
 }
 
+// Runs as the "fb-target" job every FIREBASE_TARGET_CHECK_INTERVAL: merges
+// external /schedule edits, then treats a /control/target_temperature that
+// differs from what the device last pushed as an edit of the active slot
 void checkFirebaseTargetTemperatureChanges()
 {
-    Serial.println("💀💀💀💀💀💀💀💀💀💀💀💀💀💀💀 Line 592 checkFirebaseTargetTemperatureChanges...");
-    Serial.println(" ");
     if (!fbInitialized)
     {
         return; // Skip if Firebase not ready
     }
 
-    // Rate limit checks to every 30 seconds to avoid excessive Firebase reads
-    static unsigned long lastCheck = 0;
-    unsigned long currentTime = millis();
-    if (currentTime - lastCheck < 30000) // 30 seconds
-    {
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
         return;
-    }
-    lastCheck = currentTime;
 
-    // Read current target temperature from Firebase
-    if (Firebase.RTDB.getInt(&fbData, "/control/target_temperature"))
-    {
-        int firebaseTarget = fbData.intData();
-        float currentScheduledTarget = getCurrentScheduledTemperature();
+    pullScheduleFromFirebase();
 
-        Serial.print("🔍 Firebase target check - Firebase: ");
-        Serial.print(firebaseTarget);
-        Serial.print("°C, Schedule: ");
-        Serial.print(isnan(currentScheduledTarget) ? "NaN" : String(currentScheduledTarget));
-        Serial.println("°C");
+    Temp pushed = lastReported(REPORT_TARGET_TEMP, REPORT_SINK_FIREBASE);
+    if (!pushed.isValid())
+        return; // nothing pushed yet, so an external change cannot be told apart
 
-        // Check if Firebase target differs from our scheduled target by more than 1°C
-        if (!isnan(currentScheduledTarget) && abs(firebaseTarget - currentScheduledTarget) > 1.0)
-        {
-            Serial.print("🚨 EXTERNAL CHANGE DETECTED! Firebase target (");
-            Serial.print(firebaseTarget);
-            Serial.print("°C) differs from schedule (");
-            Serial.print(currentScheduledTarget);
-            Serial.println("°C) - React app may have changed it");
-
-            // Note: In a full implementation, you might want to:
-            // 1. Temporarily override the schedule
-            // 2. Send an MQTT notification
-            // 3. Log the manual override
-            // For now, we'll just log it and let the schedule continue
-        }
-        else
-        {
-            Serial.println("✅ Firebase target matches schedule - no external changes");
-        }
-    }
-    else
+    if (!Firebase.RTDB.getInt(&fbData, "/control/target_temperature"))
     {
         Serial.println("⚠️  Could not read target temperature from Firebase");
+        return;
     }
+    int firebaseTarget = fbData.intData();
+    if (firebaseTarget == pushed.wholeDegrees())
+        return; // our own value
+
+    Serial.print("🚨 External target change in Firebase: ");
+    Serial.print(firebaseTarget);
+    Serial.print("°C (pushed ");
+    Serial.print(pushed.wholeDegrees());
+    Serial.println("°C)");
+
+    char value[8];
+    snprintf(value, sizeof(value), "%d", firebaseTarget);
+    setScheduleField(AmFlag ? SCHED_AM_TEMP : SCHED_PM_TEMP, value, SCHED_SOURCE_FIREBASE);
+    commitScheduleChanges();
 }
 
 void fetchControlValuesFromFirebase()
@@ -679,6 +568,10 @@ void fetchControlValuesFromFirebase()
         return;
     }
 
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
+
     Serial.println("Fetching sensor data from Firebase for verification...");
 
     // Read current sensor data back for verification only
@@ -691,7 +584,7 @@ void fetchControlValuesFromFirebase()
     }
 
     // Read individual sensor temperatures
-    if (Firebase.RTDB.getInt(&fbData, "/sensors/temperature_red"))
+    if (Firebase.RTDB.getInt(&fbData, "sensors/temperature_red"))
     {
         int redTemp = fbData.intData();
         Serial.print("Red sensor reading: ");
@@ -699,7 +592,7 @@ void fetchControlValuesFromFirebase()
         Serial.println("°C");
     }
 
-    if (Firebase.RTDB.getInt(&fbData, "/sensors/temperature_blue"))
+    if (Firebase.RTDB.getInt(&fbData, "sensors/temperature_blue"))
     {
         int blueTemp = fbData.intData();
         Serial.print("Blue sensor reading: ");
@@ -707,7 +600,7 @@ void fetchControlValuesFromFirebase()
         Serial.println("°C");
     }
 
-    if (Firebase.RTDB.getInt(&fbData, "/sensors/temperature_green"))
+    if (Firebase.RTDB.getInt(&fbData, "sensors/temperature_green"))
     {
         int greenTemp = fbData.intData();
         Serial.print("Green sensor reading: ");
@@ -751,6 +644,10 @@ void setControlValue(const char *path, float value)
         return;
     }
 
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
+
     if (Firebase.RTDB.setFloat(&fbData, path, value))
     {
         Serial.print("Control value set: ");
@@ -775,6 +672,10 @@ void setControlValue(const char *path, bool value)
         return;
     }
 
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
+
     if (Firebase.RTDB.setBool(&fbData, path, value))
     {
         Serial.print("Control value set: ");
@@ -799,6 +700,10 @@ void setControlValue(const char *path, const char *value)
         return;
     }
 
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
+
     if (Firebase.RTDB.setString(&fbData, path, value))
     {
         Serial.print("Control value set: ");
@@ -7,20 +7,32 @@
 #include "config.h"
 #include <Firebase_ESP_Client.h>
 
+#define FIREBASE_INIT_STEP_MS 200       // "fb-init" job period while initializing
+#define FIREBASE_TOKEN_TIMEOUT_MS 30000 // give up waiting for the auth token
+
 // External Firebase data object
 extern FirebaseData fbData;
 
 struct SystemStatus;
-void initFirebase(SystemStatus &status);
+void initFirebase(SystemStatus &status); // starts the staged, non-blocking initialization
+unsigned long getFirebaseReadyMs();      // WiFi-ready to token-ready of the last init, 0 until then
 void handleFirebase(SystemStatus &status);
 void pushSensorValuesToFirebase();
 void checkAndPushTargetTemperature();
+void uploadHistoryToFirebase();
+void pushEnergyToFirebase();
 void checkFirebaseTargetTemperatureChanges();
 void fetchControlValuesFromFirebase();
 void setControlValue(const char *path, float value);
 void setControlValue(const char *path, bool value);
 void setControlValue(const char *path, const char *value);
 
+// Multi-path updates. FirebaseJson::set() turns "a/b" into nested objects,
+// which an update applies by replacing "a" whole; these keep the slash in
+// the key, so only the listed paths change. The caller holds the TLS lease.
+void addFirebaseUpdate(String &body, const String &path, const String &value); // value is raw JSON
+bool sendFirebaseUpdate(const char *node, const String &body);
+
 // Schedule data management
 bool isInitialScheduleFetched();
 void markInitialScheduleAsFetched();
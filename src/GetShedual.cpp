@@ -3,395 +3,54 @@
 // ==================================================
 
 #include "GetShedual.h"
-#include "FirebaseService.h"
-#include "HeaterControl.h"
-#include <Firebase_ESP_Client.h>
+#include "ScheduleSync.h"
 
 // Global schedule data instance - no default values
 ScheduleData currentSchedule = {
-    NAN,   // amTemp
-    NAN,   // pmTemp
-    "",    // amTime
-    "",    // pmTime
-    false, // amEnabled
-    false  // pmEnabled
+    Temp::invalid(), // amTemp
+    Temp::invalid(), // pmTemp
+    "",              // amTime
+    "",              // pmTime
+    false,           // amEnabled
+    false            // pmEnabled
 };
 
-// Firebase data object (extern from FirebaseService.h)
-extern FirebaseData fbData;
-
-// void initScheduleManager()
-// {
-//     Serial.println("Schedule Manager initialized - waiting for Firebase data");
-//     Serial.println("⚠️  No default values set - schedule data must be retrieved from Firebase");
-//     printScheduleData();
-// }
-//=======================================================
-// I only want to fetch the schedule data once on startup
-//                        start     
-//=======================================================
-void fetchScheduleDataFromFirebase()
-{
-    Serial.println("=== Fetching Schedule Data from Firebase ===");
-
-    bool allDataRetrieved = true;
-
-    // Fetch AM scheduled time
-    if (Firebase.RTDB.getString(&fbData, "/schedule/amScheduledTime"))
-    {
-        String amTime = fbData.stringData();
-        if (isValidTime(amTime))
-        {
-            currentSchedule.amTime = amTime;
-            Serial.print("✅ AM Time retrieved: ");
-            Serial.println(amTime);
-        }
-        else
-        {
-            Serial.println("⚠️  Invalid AM time format - no fallback value");
-        }
-    }
-    else
-    {
-        Serial.println("❌ Failed to retrieve AM time from Firebase");
-        allDataRetrieved = false;
-    }
-
-    // Fetch PM scheduled time
-    if (Firebase.RTDB.getString(&fbData, "/schedule/pmScheduledTime"))
-    {
-        String pmTime = fbData.stringData();
-        if (isValidTime(pmTime))
-        {
-            currentSchedule.pmTime = pmTime;
-            Serial.print("✅ PM Time retrieved: ");
-            Serial.println(pmTime);
-        }
-        else
-        {
-            Serial.println("⚠️  Invalid PM time format - no fallback value");
-        }
-    }
-    else
-    {
-        Serial.println("❌ Failed to retrieve PM time from Firebase");
-        allDataRetrieved = false;
-    }
-
-    // Fetch AM temperature (try both string and float formats)
-    if (Firebase.RTDB.getString(&fbData, "/schedule/amTemperature"))
-    {
-        String amTempStr = fbData.stringData();
-        float amTemp = amTempStr.toFloat();
-        if (isValidTemperature(amTemp))
-        {
-            currentSchedule.amTemp = amTemp;
-            Serial.print("✅ AM Temperature retrieved: ");
-            Serial.print(amTemp);
-            Serial.println("°C");
-        }
-        else
-        {
-            Serial.println("⚠️  Invalid AM temperature - no fallback value");
-        }
-    }
-    else if (Firebase.RTDB.getFloat(&fbData, "/schedule/amTemperature"))
-    {
-        float amTemp = fbData.floatData();
-        if (isValidTemperature(amTemp))
-        {
-            currentSchedule.amTemp = amTemp;
-            Serial.print("✅ AM Temperature retrieved (float): ");
-            Serial.print(amTemp);
-            Serial.println("°C");
-        }
-        else
-        {
-            Serial.println("⚠️  Invalid AM temperature - no fallback value");
-        }
-    }
-    else
-    {
-        Serial.println("❌ Failed to retrieve AM temperature from Firebase");
-        allDataRetrieved = false;
-    }
-
-    // Fetch PM temperature (try both string and float formats)
-    if (Firebase.RTDB.getString(&fbData, "/schedule/pmTemperature"))
-    {
-        String pmTempStr = fbData.stringData();
-        float pmTemp = pmTempStr.toFloat();
-        if (isValidTemperature(pmTemp))
-        {
-            currentSchedule.pmTemp = pmTemp;
-            Serial.print("✅ PM Temperature retrieved: ");
-            Serial.print(pmTemp);
-            Serial.println("°C");
-        }
-        else
-        {
-            Serial.println("⚠️  Invalid PM temperature - no fallback value");
-        }
-    }
-    else if (Firebase.RTDB.getFloat(&fbData, "/schedule/pmTemperature"))
-    {
-        float pmTemp = fbData.floatData();
-        if (isValidTemperature(pmTemp))
-        {
-            currentSchedule.pmTemp = pmTemp;
-            Serial.print("✅ PM Temperature retrieved (float): ");
-            Serial.print(pmTemp);
-            Serial.println("°C");
-        }
-        else
-        {
-            Serial.println("⚠️  Invalid PM temperature - no fallback value");
-        }
-    }
-    else
-    {
-        Serial.println("❌ Failed to retrieve PM temperature from Firebase");
-        allDataRetrieved = false;
-    }
-
-    if (allDataRetrieved)
-    {
-        Serial.println("✅ All schedule data retrieved successfully from Firebase");
-        // Refresh the heater control cache with the new Firebase data
-        refreshScheduleCache();
-    }
-    else
-    {
-        Serial.println("⚠️  Some schedule data failed to retrieve - no default values available");
-    }
-
-    // Serial.println("=== Current Schedule Data ===");
-    // printScheduleData();
-    // Serial.println("==============================");
-}
-//=======================================================
-// I only want to fetch the schedule data once on startup
-//                        end     
-//=======================================================
-
+// MQTT schedule topics, each mapped to one field and applied through
+// ScheduleSync (validation, duplicate suppression, revision, Firebase push)
 void handleScheduleUpdate(const char *topic, const String &message)
 {
-    Serial.print("📡 MQTT Schedule Update received on topic: ");
-    Serial.println(topic);
-    Serial.print("📡 Message: ");
-    Serial.println(message);
+    static const struct
+    {
+        const char *suffix;
+        ScheduleField field;
+    } fieldTopics[] = {
+        {"/am/temperature", SCHED_AM_TEMP},
+        {"/pm/temperature", SCHED_PM_TEMP},
+        {"/am/time", SCHED_AM_TIME},
+        {"/pm/time", SCHED_PM_TIME},
+        {"/am/scheduledtime", SCHED_AM_TIME},
+        {"/pm/scheduledtime", SCHED_PM_TIME},
+        {"/am/enabled", SCHED_AM_ENABLED},
+        {"/pm/enabled", SCHED_PM_ENABLED},
+    };
 
-    // Parse topic to determine which schedule parameter to update
     String topicStr = String(topic);
     topicStr.trim();
     topicStr.toLowerCase();
-    Serial.print("🔍 Raw topic: '");
-    Serial.print(topic);
-    Serial.println("'");
-    Serial.print("🔍 Normalized topic string: '");
-    Serial.print(topicStr);
-    Serial.println("'");
-    Serial.print("🔍 Raw message: '");
-    Serial.print(message);
-    Serial.println("'");
-    bool updateSuccessful = false;
-    String firebasePath = "";
+    String value = message;
+    value.trim();
 
-     if (topicStr.endsWith("control/schedule"))
-     {
-        if (topicStr == "am/scheduledTime")
-        {
-            String amTime = message;
-            currentSchedule.amTime = amTime;
-            Serial.print("[DEBUG] Extracted amTime from MQTT: ");
-            Serial.println(amTime);
-            if (isValidTime(amTime))
-            {
-                Serial.print("*********************");
-                Serial.print("*********************");
-                Serial.print("*********************");
-                Serial.print(amTime);
-                
-                Serial.println("[DEBUG] setAMTime called from MQTT");
-                setAMTime(amTime);
-                updateFirebaseScheduleData("/schedule/amScheduledTime", amTime);
-            }
-            else
-            {
-                Serial.println("[DEBUG] amTime from MQTT is invalid");
-            }
-        }
-        else if (topicStr == "pm/scheduledTime")
-        {
-            String pmTime = message;
-            Serial.print("[DEBUG] Extracted pmTime from MQTT: ");
-            Serial.println(pmTime);
-            if (isValidTime(pmTime))
-            {
-                Serial.println("[DEBUG] setPMTime called from MQTT");
-                setPMTime(pmTime);
-                updateFirebaseScheduleData("/schedule/pmScheduledTime", pmTime);
-            }
-            else
-            {
-                Serial.println("[DEBUG] pmTime from MQTT is invalid");
-            }
-        }
-        else if (topicStr == "am/temperature")
-        {
-            float amTemp = message.toFloat();
-            Serial.print("[DEBUG] Extracted amTemp from MQTT: ");
-            Serial.println(amTemp);
-            if (isValidTemperature(amTemp))
-            {
-                Serial.println("[DEBUG] setAMTemperature called from MQTT");
-                setAMTemperature(amTemp);
-                updateFirebaseScheduleData("/schedule/amTemperature", String(amTemp));
-            }
-            else
-            {
-                Serial.println("[DEBUG] amTemp from MQTT is invalid");
-            }
-        }
-        else if (topicStr == "pm/temperature")
-        {
-            float pmTemp = message.toFloat();
-            Serial.print("[DEBUG] Extracted pmTemp from MQTT: ");
-            Serial.println(pmTemp);
-            if (isValidTemperature(pmTemp))
-            {
-                Serial.println("[DEBUG] setPMTemperature called from MQTT");
-                setPMTemperature(pmTemp);
-                updateFirebaseScheduleData("/schedule/pmTemperature", String(pmTemp));
-            }
-            else
-            {
-                Serial.println("[DEBUG] pmTemp from MQTT is invalid");
-            }
-        }
-        else
-        {
-            Serial.println("❌ Unrecognized schedule control topic");
-        }
-     }
-    // Individual topic handling (AM/PM temperature, time, enabled, scheduledTime)
-    if (topicStr.endsWith("/am/temperature"))
-    {
-        float temp = message.toFloat();
-        if (isValidTemperature(temp))
-        {
-            setAMTemperature(temp);
-            updateSuccessful = true;
-            firebasePath = "/schedule/amTemperature";
-            Serial.println("✅ AM Temperature updated via MQTT");
-        }
-        else
-        {
-            Serial.println("❌ Invalid AM temperature received via MQTT");
-        }
-    }
-    else if (topicStr.endsWith("/pm/temperature"))
-    {
-        float temp = message.toFloat();
-        if (isValidTemperature(temp))
-        {
-            setPMTemperature(temp);
-            updateSuccessful = true;
-            firebasePath = "/schedule/pmTemperature";
-            Serial.println("✅ PM Temperature updated via MQTT");
-        }
-        else
-        {
-            Serial.println("❌ Invalid PM temperature received via MQTT");
-        }
-    }
-    else if (topicStr.endsWith("/am/time"))
+    for (const auto &t : fieldTopics)
     {
-        if (isValidTime(message))
+        if (topicStr.endsWith(t.suffix))
         {
-            setAMTime(message);
-            updateSuccessful = true;
-            firebasePath = "/schedule/amScheduledTime";
-            Serial.println("✅ AM Time updated via MQTT");
-        }
-        else
-        {
-            Serial.println("❌ Invalid AM time format received via MQTT");
+            setScheduleField(t.field, value.c_str(), SCHED_SOURCE_MQTT);
+            commitScheduleChanges();
+            return;
         }
     }
-    else if (topicStr.endsWith("/pm/time"))
-    {
-        if (isValidTime(message))
-        {
-            setPMTime(message);
-            updateSuccessful = true;
-            firebasePath = "/schedule/pmScheduledTime";
-            Serial.println("✅ PM Time updated via MQTT");
-        }
-        else
-        {
-            Serial.println("❌ Invalid PM time format received via MQTT");
-        }
-    }
-    else if (topicStr.endsWith("/am/enabled"))
-    {
-        bool enabled = (message == "true");
-        currentSchedule.amEnabled = enabled;
-        updateSuccessful = true;
-        firebasePath = "/schedule/amEnabled";
-        Serial.print("✅ AM Enabled updated via MQTT: ");
-        Serial.println(enabled ? "true" : "false");
-    }
-    else if (topicStr.endsWith("/pm/enabled"))
-    {
-        bool enabled = (message == "true");
-        currentSchedule.pmEnabled = enabled;
-        updateSuccessful = true;
-        firebasePath = "/schedule/pmEnabled";
-        Serial.print("✅ PM Enabled updated via MQTT: ");
-        Serial.println(enabled ? "true" : "false");
-    }
-    else if (topicStr.endsWith("/am/scheduledtime"))
-    {
-        if (isValidTime(message))
-        {
-            setAMTime(message);
-            updateSuccessful = true;
-            firebasePath = "/schedule/amScheduledTime";
-            Serial.println("✅ AM ScheduledTime updated via MQTT");
-        }
-        else
-        {
-            Serial.println("❌ Invalid AM scheduledTime format received via MQTT");
-        }
-    }
-    else if (topicStr.endsWith("/pm/scheduledtime"))
-    {
-        if (isValidTime(message))
-        {
-            setPMTime(message);
-            updateSuccessful = true;
-            firebasePath = "/schedule/pmScheduledTime";
-            Serial.println("✅ PM ScheduledTime updated via MQTT");
-        }
-        else
-        {
-            Serial.println("❌ Invalid PM scheduledTime format received via MQTT");
-        }
-    }
-    else
-    {
-        Serial.println("⚠️  Unknown schedule topic received");
-    }
-
-    // Update Firebase if MQTT update was successful
-    if (updateSuccessful && firebasePath.length() > 0)
-    {
-        updateFirebaseScheduleData(firebasePath, message);
-    }
-
-    // Print updated schedule
-    // printScheduleData();
+    Serial.print("⚠️  Unknown schedule topic received: ");
+    Serial.println(topic);
 }
 
 // void printScheduleData()
@@ -399,7 +58,7 @@ void handleScheduleUpdate(const char *topic, const String &message)
 //     Serial.println("📅 Current Schedule:");
 
 //     // Check AM data
-//     if (currentSchedule.amTime.length() > 0 && !isnan(currentSchedule.amTemp))
+//     if (currentSchedule.amTime.length() > 0 && currentSchedule.amTemp.isValid())
 //     {
 //         Serial.print("   🌅 AM: ");
 //         Serial.print(currentSchedule.amTime);
@@ -413,7 +72,7 @@ void handleScheduleUpdate(const char *topic, const String &message)
 //     }
 
 //     // Check PM data
-//     if (currentSchedule.pmTime.length() > 0 && !isnan(currentSchedule.pmTemp))
+//     if (currentSchedule.pmTime.length() > 0 && currentSchedule.pmTemp.isValid())
 //     {
 //         Serial.print("   🌆 PM: ");
 //         Serial.print(currentSchedule.pmTime);
@@ -443,27 +102,27 @@ bool isValidTime(const String &timeStr)
     return (hours >= 0 && hours <= 23 && minutes >= 0 && minutes <= 59);
 }
 
-bool isValidTemperature(float temp)
+bool isValidTemperature(Temp temp)
 {
     // Allow reasonable temperature range (0-50°C)
-    return (temp >= 0.0 && temp <= 50.0 && !isnan(temp));
+    return temp.isValid() && temp.centi >= 0 && temp.centi <= 5000;
 }
 
 // Getter functions
-float getAMTemperature()
+Temp getAMTemperature()
 {
-    if (isnan(currentSchedule.amTemp))
+    if (!currentSchedule.amTemp.isValid())
     {
-        Serial.println("⚠️  Warning: AM Temperature not set - returning NaN");
+        Serial.println("⚠️  Warning: AM Temperature not set - returning invalid");
     }
     return currentSchedule.amTemp;
 }
 
-float getPMTemperature()
+Temp getPMTemperature()
 {
-    if (isnan(currentSchedule.pmTemp))
+    if (!currentSchedule.pmTemp.isValid())
     {
-        Serial.println("⚠️  Warning: PM Temperature not set - returning NaN");
+        Serial.println("⚠️  Warning: PM Temperature not set - returning invalid");
     }
     return currentSchedule.pmTemp;
 }
@@ -487,15 +146,15 @@ String getPMTime()
 }
 
 // Setter functions
-void setAMTemperature(float temp)
+void setAMTemperature(Temp temp)
 {
     Serial.print("[DEBUG] setAMTemperature called with value: ");
-    Serial.println(temp);
+    Serial.println(temp.toString(2));
     if (isValidTemperature(temp))
     {
         currentSchedule.amTemp = temp;
         Serial.print("🔄 AM Temperature set to: ");
-        Serial.print(temp);
+        Serial.print(temp.toString(2));
         Serial.println("°C");
     }
     else
@@ -504,15 +163,15 @@ void setAMTemperature(float temp)
     }
 }
 
-void setPMTemperature(float temp)
+void setPMTemperature(Temp temp)
 {
     Serial.print("[DEBUG] setPMTemperature called with value: ");
-    Serial.println(temp);
+    Serial.println(temp.toString(2));
     if (isValidTemperature(temp))
     {
         currentSchedule.pmTemp = temp;
         Serial.print("🔄 PM Temperature set to: ");
-        Serial.print(temp);
+        Serial.print(temp.toString(2));
         Serial.println("°C");
     }
     else
@@ -553,7 +212,7 @@ void setPMTime(const String &time)
     }
 }
 
-float getCurrentScheduledTemperature()
+Temp getCurrentScheduledTemperature()
 {
     // Get current time to determine if we should use AM or PM temperature
     extern int Hours;   // From TimeManager
@@ -563,26 +222,26 @@ float getCurrentScheduledTemperature()
     // If AmFlag is true, use AM temperature, otherwise use PM temperature
     if (AmFlag)
     {
-        if (!isnan(currentSchedule.amTemp))
+        if (currentSchedule.amTemp.isValid())
         {
             return currentSchedule.amTemp;
         }
         else
         {
             Serial.println("⚠️  Warning: AM temperature not available");
-            return NAN;
+            return Temp::invalid();
         }
     }
     else
     {
-        if (!isnan(currentSchedule.pmTemp))
+        if (currentSchedule.pmTemp.isValid())
         {
             return currentSchedule.pmTemp;
         }
         else
         {
             Serial.println("⚠️  Warning: PM temperature not available");
-            return NAN;
+            return Temp::invalid();
         }
     }
 }
@@ -599,27 +258,3 @@ String formatTime(int hours, int minutes)
     timeStr += String(minutes);
     return timeStr;
 }
-
-// Function to update Firebase schedule data
-void updateFirebaseScheduleData(const String &path, const String &value)
-{
-    // This function updates Firebase with schedule changes received via MQTT
-    // Use the existing Firebase data object from FirebaseService
-    extern FirebaseData fbData;
-
-    // Try to update Firebase - if it fails, it will handle the error gracefully
-    if (Firebase.RTDB.setString(&fbData, path.c_str(), value))
-    {
-        Serial.print("✅ Firebase schedule updated: ");
-        Serial.print(path);
-        Serial.print(" = ");
-        Serial.println(value);
-    }
-    else
-    {
-        Serial.print("❌ Failed to update Firebase schedule: ");
-        Serial.print(path);
-        Serial.print(" - Error: ");
-        Serial.println(fbData.errorReason());
-    }
-}
\ No newline at end of file
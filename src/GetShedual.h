@@ -6,12 +6,13 @@
 #define GETSHEDUAL_H
 
 #include <Arduino.h>
+#include "Temp.h"
 
 // Schedule structure to hold AM and PM values
 struct ScheduleData
 {
-    float amTemp;   // Default AM temperature
-    float pmTemp;   // Default PM temperature
+    Temp amTemp;    // Default AM temperature
+    Temp pmTemp;    // Default PM temperature
     String amTime;  // Default AM time
     String pmTime;  // Default PM time
     bool amEnabled; // AM schedule enabled
@@ -26,24 +27,22 @@ void initScheduleManager();
 void handleScheduleUpdate(const char *topic, const String &message);
 void printScheduleData();
 bool isValidTime(const String &timeStr);
-bool isValidTemperature(float temp);
+bool isValidTemperature(Temp temp);
 
 // Getter functions
-float getAMTemperature();
-float getPMTemperature();
+Temp getAMTemperature();
+Temp getPMTemperature();
 String getAMTime();
 String getPMTime();
 
 // Setter functions (for manual updates or defaults)
-void setAMTemperature(float temp);
-void setPMTemperature(float temp);
+void setAMTemperature(Temp temp);
+void setPMTemperature(Temp temp);
 void setAMTime(const String &time);
 void setPMTime(const String &time);
 
-// Firebase integration
-void fetchScheduleDataFromFirebase();
-void updateFirebaseScheduleData(const String &path, const String &value);
-float getCurrentScheduledTemperature();
+// Helpers; MQTT, LAN and Firebase writes go through ScheduleSync.h
+Temp getCurrentScheduledTemperature();
 String formatTime(int hours, int minutes);
 
 #endif // GETSHEDUAL_H
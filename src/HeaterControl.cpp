@@ -9,6 +9,7 @@
 #include "TimeManager.h"
 #include "TemperatureSensors.h"
 #include "StatusLEDs.h"
+#include "CalendarEvents.h"
 
 // External declarations
 extern bool AmFlag;
@@ -16,27 +17,48 @@ extern SystemStatus systemStatus;
 
 // Global flag to force schedule cache refresh
 static bool forceScheduleRefresh = false;
+// Set when the active slot's scheduled time starts (CAL_MINUTE)
+static bool scheduledTimeReached = false;
+
+// Day profile: AM slot before noon, PM after; checked once per local minute
+static void onScheduleMinute(const CivilTime &local)
+{
+    AmFlag = local.hour < 12;
+    String scheduledTime = AmFlag ? currentSchedule.amTime : currentSchedule.pmTime;
+    if (scheduledTime == getFormattedTime())
+        scheduledTimeReached = true;
+}
+
+// The same AM/PM split, straight from the clock: a forced refresh can come
+// before the first minute event (the NVS schedule at cold start), when
+// AmFlag still holds its boot default. False while the clock is not set.
+static bool syncAmFlagWithClock()
+{
+    uint32_t now = getEpochTime();
+    if (now == 0)
+        return false;
+    AmFlag = toLocalTime(now) % 86400 < 12 * 3600UL;
+    return true;
+}
+
+void initHeaterControl()
+{
+    onCalendarEvent(CAL_MINUTE, onScheduleMinute);
+}
+
 // Heater control function
 void updateHeaterControl()
 {
-    static float targetTemp = 0; // persistent across calls
+    static Temp targetTemp = Temp::fromCenti(0); // persistent across calls
     Serial.println("******************Updating Heater Control...**************");
-    // getTime();
     String currentTime = getFormattedTime();
-    if (currentTime < "12:00")
-    {
-        AmFlag = true;
-    }
-    else
-    {
-        AmFlag = false;
-    }
     readAllSensors();
-    float tempRed = getTemperature(0); // Before the if statement
+    Temp tempRed = getLastTemperature(0); // Before the if statement
 
-     
+    // A forced refresh waits for the clock, so it never applies the wrong slot
+    bool refreshNow = forceScheduleRefresh && syncAmFlagWithClock();
 
-    float newTargetTemp = AmFlag ? currentSchedule.amTemp : currentSchedule.pmTemp;
+    Temp newTargetTemp = AmFlag ? currentSchedule.amTemp : currentSchedule.pmTemp;
 
  String scheduledTime = AmFlag ? currentSchedule.amTime : currentSchedule.pmTime;
       Serial.println("😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈");
@@ -44,19 +66,22 @@ void updateHeaterControl()
       Serial.println("Scheduled Time: " + scheduledTime);
       Serial.println("================================================");
       Serial.print("New Target Temp: ");
-      Serial.println(newTargetTemp);
+      Serial.println(newTargetTemp.toString(2));
       Serial.print("Current Target Temp: ");
-      Serial.println(targetTemp);
+      Serial.println(targetTemp.toString(2));
       Serial.println("😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈😈");
-    // Only update targetTemp at the scheduled time
-    if (scheduledTime == currentTime)
+    // Only update targetTemp at the scheduled time, or right away when the
+    // schedule was changed (refreshScheduleCache) and the clock is set
+    if (scheduledTimeReached || refreshNow)
     {
+        scheduledTimeReached = false;
+        forceScheduleRefresh = false;
         targetTemp = newTargetTemp;
         Serial.println("👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺👺");
         Serial.println("==================================================");
         Serial.println("Debug output for target temperature update");
         Serial.print("Target temperature updated to: ");        
-        Serial.println(targetTemp);
+        Serial.println(targetTemp.toString(2));
          Serial.println("==================================================");
     }
     // // Display current values BEFORE control logic
@@ -76,6 +101,7 @@ void updateHeaterControl()
     // Serial.println("*******************************");
 
     // Check if the current target temperature is valid
+    // (an invalid target or sensor reading compares neither < nor >, so the relay is left alone)
     if (targetTemp < tempRed)
     {
         digitalWrite(RELAY_PIN, LOW);
@@ -100,5 +126,5 @@ void updateHeaterControl()
 void refreshScheduleCache()
 {
     forceScheduleRefresh = true;
-    Serial.println("🔄 Schedule cache refresh requested - will update on next heater control cycle");
+    Serial.println("🔄 Schedule cache refresh requested - will update on the next heater control cycle once the clock is set");
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 
 // Function declarations
+void initHeaterControl(); // subscribes the AM/PM day profile to minute events
 void updateHeaterControl();
 void refreshScheduleCache(); // Force refresh of cached schedule values
 void getTime();
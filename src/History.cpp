@@ -0,0 +1,112 @@
+// ==================================================
+// File: src/History.cpp
+// ==================================================
+
+#include "History.h"
+#include "TemperatureSensors.h"
+#include "TimeManager.h"
+
+static SwingingDoor doors[HISTORY_SENSOR_COUNT];
+static bool doorsReady = false;
+
+static HistoryPoint pending[HISTORY_PENDING_POINTS];
+static uint8_t pendingHead = 0; // oldest
+static uint8_t pendingCount = 0;
+
+static HistoryStats stats;
+
+static void queuePoint(uint8_t sensor, const SdtPoint &point)
+{
+    stats.points++;
+    if (pendingCount == HISTORY_PENDING_POINTS)
+    {
+        pendingHead = (pendingHead + 1) % HISTORY_PENDING_POINTS;
+        pendingCount--;
+        stats.dropped++;
+    }
+    pending[(pendingHead + pendingCount) % HISTORY_PENDING_POINTS] = {sensor, point};
+    pendingCount++;
+}
+
+void recordHistorySamples()
+{
+    uint32_t now = getEpochTime();
+    if (now == 0)
+        return; // points need wall-clock timestamps
+
+    if (!doorsReady)
+    {
+        for (uint8_t i = 0; i < HISTORY_SENSOR_COUNT; i++)
+        {
+            doors[i] = {HISTORY_DEVIATION_CENTI, HISTORY_MAX_GAP_S};
+            doors[i].reset();
+        }
+        doorsReady = true;
+    }
+
+    for (uint8_t i = 0; i < HISTORY_SENSOR_COUNT; i++)
+    {
+        SdtPoint out[2];
+        uint8_t n = doors[i].add(now, getLastTemperature(i), out);
+        for (uint8_t k = 0; k < n; k++)
+        {
+            queuePoint(i, out[k]);
+        }
+        stats.samples++;
+    }
+}
+
+bool historyUploadDue()
+{
+    if (pendingCount >= HISTORY_UPLOAD_BATCH)
+        return true;
+    if (pendingCount == 0)
+        return false;
+    uint32_t now = getEpochTime();
+    return now != 0 && now - pending[pendingHead].point.t >= HISTORY_UPLOAD_MAX_AGE_S;
+}
+
+uint8_t peekHistory(HistoryPoint *out, uint8_t max)
+{
+    uint8_t n = pendingCount < max ? pendingCount : max;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        out[i] = pending[(pendingHead + i) % HISTORY_PENDING_POINTS];
+    }
+    return n;
+}
+
+void dropHistory(uint8_t count)
+{
+    if (count > pendingCount)
+        count = pendingCount;
+    pendingHead = (pendingHead + count) % HISTORY_PENDING_POINTS;
+    pendingCount -= count;
+    stats.uploaded += count;
+}
+
+HistoryStats getHistoryStats()
+{
+    return stats;
+}
+
+void printHistoryStats()
+{
+    Serial.print("History: ");
+    Serial.print(stats.samples);
+    Serial.print(" samples -> ");
+    Serial.print(stats.points);
+    Serial.print(" points");
+    if (stats.points > 0)
+    {
+        Serial.print(" (");
+        Serial.print(stats.samples / stats.points);
+        Serial.print(":1)");
+    }
+    Serial.print(", ");
+    Serial.print(pendingCount);
+    Serial.print(" waiting, uploaded ");
+    Serial.print(stats.uploaded);
+    Serial.print(", dropped ");
+    Serial.println(stats.dropped);
+}
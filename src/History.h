@@ -0,0 +1,42 @@
+// ==================================================
+// File: src/History.h
+// ==================================================
+//
+// Temperature history for upload. Every sensor reading goes through a
+// swinging-door compressor (SwingingDoor.h); only the archived points -
+// enough to redraw each curve within HISTORY_DEVIATION_CENTI - are queued
+// for the uploader. Slow enclosure temperatures sampled once a second
+// compress by two orders of magnitude or more.
+
+#pragma once
+#include <Arduino.h>
+#include "SwingingDoor.h"
+
+#define HISTORY_SENSOR_COUNT 3
+#define HISTORY_DEVIATION_CENTI 10   // reconstruction error bound, 0.1 °C
+#define HISTORY_MAX_GAP_S 3600       // at least one point per sensor per hour
+#define HISTORY_PENDING_POINTS 64    // RAM queue waiting for upload
+#define HISTORY_UPLOAD_BATCH 16      // upload once this many points wait...
+#define HISTORY_UPLOAD_MAX_AGE_S 900 // ...or the oldest has waited this long
+
+struct HistoryPoint
+{
+    uint8_t sensor;
+    SdtPoint point;
+};
+
+struct HistoryStats
+{
+    uint32_t samples;  // readings fed to the compressors
+    uint32_t points;   // archived points
+    uint32_t uploaded; // points acknowledged by the uploader
+    uint32_t dropped;  // queue overflow (oldest dropped)
+};
+
+// Function declarations
+void recordHistorySamples(); // the readings cached by readAllSensors(); no-op until the clock is set
+bool historyUploadDue();
+uint8_t peekHistory(HistoryPoint *out, uint8_t max); // oldest first
+void dropHistory(uint8_t count);                      // after a successful upload
+HistoryStats getHistoryStats();
+void printHistoryStats();
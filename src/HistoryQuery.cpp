@@ -0,0 +1,226 @@
+// ==================================================
+// File: src/HistoryQuery.cpp
+// ==================================================
+
+#include "HistoryQuery.h"
+#include "Rollups.h"
+#include "MQTTManager.h"
+#include "Scheduler.h"
+#include "TimeManager.h"
+
+struct HistoryQuery
+{
+    bool active;
+    char id[HISTORY_QUERY_ID_LEN];
+    RollupCursor cursor;
+    uint16_t seq;
+    uint16_t buckets;
+    bool haveCarry; // bucket that did not fit the previous message
+    RollupBucket carry;
+};
+
+static HistoryQuery query;
+static int queryJob = SCHED_INVALID_JOB;
+
+static void sendNextMessage();
+
+// === Request parsing ===
+
+static bool parseLevel(const char *value, uint8_t &level)
+{
+    if (strcmp(value, "1m") == 0 || strcmp(value, "60") == 0)
+        level = ROLLUP_1MIN;
+    else if (strcmp(value, "15m") == 0 || strcmp(value, "900") == 0)
+        level = ROLLUP_15MIN;
+    else if (strcmp(value, "1h") == 0 || strcmp(value, "3600") == 0)
+        level = ROLLUP_1H;
+    else
+        return false;
+    return true;
+}
+
+// Absolute epoch seconds, or relative to now when negative
+static bool parseTime(const char *value, uint32_t now, uint32_t &out)
+{
+    char *end;
+    long v = strtol(value, &end, 10);
+    if (end == value || *end != '\0')
+        return false;
+    if (v < 0)
+        out = (uint32_t)-v > now ? 0 : now + v;
+    else
+        out = (uint32_t)v;
+    return true;
+}
+
+static void sendError(const char *id, const char *error)
+{
+    char payload[80];
+    snprintf(payload, sizeof(payload), "{\"id\":\"%s\",\"error\":\"%s\"}", id, error);
+    publishDirect(TOPIC_HISTORY_RESPONSE, payload);
+}
+
+void handleHistoryQuery(const char *topic, const String &message)
+{
+    char request[128];
+    strncpy(request, message.c_str(), sizeof(request) - 1);
+    request[sizeof(request) - 1] = '\0';
+
+    uint32_t now = getEpochTime();
+    char id[HISTORY_QUERY_ID_LEN] = "";
+    uint8_t level = ROLLUP_15MIN;
+    uint32_t from = now > 86400 ? now - 86400 : 0;
+    uint32_t to = now + 1;
+    bool ok = now != 0;
+
+    char *save;
+    for (char *token = strtok_r(request, " &", &save); token && ok; token = strtok_r(nullptr, " &", &save))
+    {
+        char *value = strchr(token, '=');
+        if (!value)
+        {
+            ok = false;
+            break;
+        }
+        *value++ = '\0';
+        if (strcmp(token, "id") == 0 && strlen(value) < sizeof(id) && !strpbrk(value, "\"\\"))
+            strcpy(id, value);
+        else if (strcmp(token, "res") == 0)
+            ok = parseLevel(value, level);
+        else if (strcmp(token, "from") == 0)
+            ok = parseTime(value, now, from);
+        else if (strcmp(token, "to") == 0)
+            ok = parseTime(value, now, to);
+        else
+            ok = false;
+    }
+
+    if (!ok || from >= to)
+    {
+        Serial.print("❌ Bad history query: ");
+        Serial.println(message);
+        sendError(id, now == 0 ? "clock not set" : "bad request");
+        return;
+    }
+
+    if (query.active)
+    {
+        Serial.print("⚠️  History query ");
+        Serial.print(query.id);
+        Serial.println(" replaced by a new one");
+    }
+    query.active = true;
+    strcpy(query.id, id);
+    beginRollupRead(query.cursor, level, from, to);
+    query.seq = 0;
+    query.buckets = 0;
+    query.haveCarry = false;
+
+    Serial.print("📈 History query ");
+    Serial.print(id);
+    Serial.print(": ");
+    Serial.print(getRollupPeriod(level));
+    Serial.print(" s buckets over ");
+    Serial.print((to - from) / 3600);
+    Serial.println(" h");
+
+    if (!isJobScheduled(queryJob))
+        queryJob = scheduleOnce("hist-query", 0, sendNextMessage, JOB_PRIORITY_LOW);
+}
+
+bool isHistoryQueryActive()
+{
+    return query.active;
+}
+
+// === Response ===
+
+static int appendTemp(char *buf, size_t size, Temp t)
+{
+    if (!t.isValid())
+        return snprintf(buf, size, ",null");
+    return snprintf(buf, size, ",%d", t.centi);
+}
+
+static int formatRow(char *buf, size_t size, const RollupBucket &b)
+{
+    int len = snprintf(buf, size, "[%lu", (unsigned long)b.t);
+    for (uint8_t i = 0; i < ROLLUP_SENSOR_COUNT; i++)
+    {
+        len += appendTemp(buf + len, size - len, b.min[i]);
+        len += appendTemp(buf + len, size - len, b.max[i]);
+        len += appendTemp(buf + len, size - len, b.mean[i]);
+    }
+    uint32_t duty = b.coveredS ? (uint32_t)b.heaterOnS * 1000 / b.coveredS : 0;
+    len += snprintf(buf + len, size - len, ",%lu,%lu]", (unsigned long)duty, (unsigned long)b.energyJ);
+    return len;
+}
+
+// One message of rows per run; reschedules itself until the range is done
+static void sendNextMessage()
+{
+    if (!query.active)
+        return;
+
+    static char payload[HISTORY_QUERY_PAYLOAD_MAX];
+    char row[160];
+    int len = snprintf(payload, sizeof(payload), "{\"id\":\"%s\",\"res\":%lu,\"seq\":%u,\"rows\":[",
+                       query.id, (unsigned long)getRollupPeriod(query.cursor.level), query.seq);
+    bool first = true;
+    bool done = false;
+
+    while (true)
+    {
+        RollupBucket b;
+        if (query.haveCarry)
+        {
+            b = query.carry;
+            query.haveCarry = false;
+        }
+        else if (query.buckets >= HISTORY_QUERY_MAX_BUCKETS || !nextRollupBucket(query.cursor, b))
+        {
+            done = true;
+            break;
+        }
+        else
+        {
+            query.buckets++;
+        }
+
+        int rowLen = formatRow(row, sizeof(row), b);
+        // room for the separator and the closing `],"done":false}`
+        if (len + rowLen + 20 >= (int)sizeof(payload))
+        {
+            query.carry = b;
+            query.haveCarry = true;
+            break;
+        }
+        len += snprintf(payload + len, sizeof(payload) - len, "%s%s", first ? "" : ",", row);
+        first = false;
+    }
+    snprintf(payload + len, sizeof(payload) - len, "],\"done\":%s}", done ? "true" : "false");
+
+    if (!publishDirect(TOPIC_HISTORY_RESPONSE, payload))
+    {
+        Serial.print("❌ History query ");
+        Serial.print(query.id);
+        Serial.println(" aborted: MQTT not connected");
+        query.active = false;
+        return;
+    }
+    query.seq++;
+
+    if (done)
+    {
+        Serial.print("📈 History query ");
+        Serial.print(query.id);
+        Serial.print(" done: ");
+        Serial.print(query.buckets);
+        Serial.print(" buckets in ");
+        Serial.print(query.seq);
+        Serial.println(" messages");
+        query.active = false;
+        return;
+    }
+    queryJob = scheduleOnce("hist-query", HISTORY_QUERY_MESSAGE_GAP_MS, sendNextMessage, JOB_PRIORITY_LOW);
+}
@@ -0,0 +1,32 @@
+// ==================================================
+// File: src/HistoryQuery.h
+// ==================================================
+//
+// MQTT request/response access to the rollups (Rollups.h). A client
+// publishes to TOPIC_HISTORY_QUERY, e.g.
+//
+//   id=dash1 res=15m from=-86400
+//
+// (space or '&' separated; res is 1m, 15m or 1h; from/to are epoch seconds,
+// negative = relative to now, to defaults to now) and receives the buckets
+// on TOPIC_HISTORY_RESPONSE as a series of JSON messages:
+//
+//   {"id":"dash1","res":900,"seq":0,"rows":[[t,
+//     redMin,redMax,redMean, blueMin,blueMax,blueMean,
+//     greenMin,greenMax,greenMean, dutyPermille, energyJ], ...],"done":false}
+//
+// Temperatures are centi-degrees (null = no reading); empty buckets are
+// left out. The response is sent a message at a time from a scheduler job
+// so a long range never blocks the loop.
+
+#pragma once
+#include <Arduino.h>
+
+#define HISTORY_QUERY_ID_LEN 16
+#define HISTORY_QUERY_MAX_BUCKETS 2000   // per query
+#define HISTORY_QUERY_PAYLOAD_MAX 900    // per response message (MQTT buffer is 1024)
+#define HISTORY_QUERY_MESSAGE_GAP_MS 20
+
+// Function declarations
+void handleHistoryQuery(const char *topic, const String &message); // TopicRouter handler
+bool isHistoryQueryActive();
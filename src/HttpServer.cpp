@@ -0,0 +1,480 @@
+// ==================================================
+// File: src/HttpServer.cpp
+// ==================================================
+
+#include "HttpServer.h"
+#include <WiFi.h>
+#include <stdarg.h>
+
+struct HttpClientSlot
+{
+    WiFiClient client;
+    bool active;
+    unsigned long since;
+    size_t len;
+    char buf[HTTP_REQUEST_MAX + 1];
+};
+
+struct HttpRoute
+{
+    const char *method;
+    const char *path;
+    HttpHandler handler;
+};
+
+static WiFiServer server(HTTP_PORT);
+static bool listening = false;
+static HttpClientSlot slots[HTTP_MAX_CLIENTS];
+static HttpRoute routes[HTTP_MAX_ROUTES];
+static uint8_t routeCount = 0;
+static char responseBuf[HTTP_RESPONSE_MAX];
+static WiFiClient streams[HTTP_MAX_STREAMS];
+static uint32_t requestCount = 0;
+
+// === Response buffer ===
+
+void HttpResponse::print(const char *s)
+{
+    size_t n = strlen(s);
+    if (len + n >= cap)
+    {
+        overflow = true;
+        n = cap - 1 - len;
+    }
+    memcpy(buf + len, s, n);
+    len += n;
+    buf[len] = '\0';
+}
+
+void HttpResponse::printf(const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + len, cap - len, fmt, args);
+    va_end(args);
+    if (n < 0)
+        return;
+    if (len + n >= cap)
+    {
+        overflow = true;
+        len = cap - 1;
+    }
+    else
+    {
+        len += n;
+    }
+}
+
+void HttpResponse::clear()
+{
+    len = 0;
+    overflow = false;
+    buf[0] = '\0';
+}
+
+// === Routes ===
+
+bool addHttpRoute(const char *method, const char *path, HttpHandler handler)
+{
+    if (routeCount >= HTTP_MAX_ROUTES)
+    {
+        Serial.print("❌ HTTP route table full, cannot add ");
+        Serial.println(path);
+        return false;
+    }
+    routes[routeCount++] = {method, path, handler};
+    return true;
+}
+
+const char *getHttpHeader(const HttpRequest &req, const char *name)
+{
+    for (uint8_t i = 0; i < req.headerCount; i++)
+    {
+        if (strcasecmp(req.headers[i].name, name) == 0)
+            return req.headers[i].value;
+    }
+    return nullptr;
+}
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+// Finds name=value in a urlencoded parameter list and decodes the value into out
+static bool findParam(const char *p, const char *name, char *out, size_t outLen)
+{
+    size_t nameLen = strlen(name);
+    while (*p)
+    {
+        const char *end = strchr(p, '&');
+        if (!end)
+            end = p + strlen(p);
+        if (strncmp(p, name, nameLen) == 0 && p[nameLen] == '=')
+        {
+            size_t n = 0;
+            for (const char *v = p + nameLen + 1; v < end && n + 1 < outLen; v++)
+            {
+                if (*v == '+')
+                    out[n++] = ' ';
+                else if (*v == '%' && v + 2 < end && hexValue(v[1]) >= 0 && hexValue(v[2]) >= 0)
+                {
+                    out[n++] = (char)(hexValue(v[1]) * 16 + hexValue(v[2]));
+                    v += 2;
+                }
+                else
+                    out[n++] = *v;
+            }
+            out[n] = '\0';
+            return true;
+        }
+        p = *end ? end + 1 : end;
+    }
+    return false;
+}
+
+bool getHttpQueryParam(const HttpRequest &req, const char *name, char *out, size_t outLen)
+{
+    return findParam(req.query, name, out, outLen);
+}
+
+bool getHttpFormParam(const HttpRequest &req, const char *name, char *out, size_t outLen)
+{
+    return req.bodyLen > 0 && findParam(req.body, name, out, outLen);
+}
+
+// === Request parsing ===
+
+static const char *statusText(int status)
+{
+    switch (status)
+    {
+    case 200:
+        return "OK";
+    case 204:
+        return "No Content";
+    case 403:
+        return "Forbidden";
+    case 400:
+        return "Bad Request";
+    case 401:
+        return "Unauthorized";
+    case 404:
+        return "Not Found";
+    case 405:
+        return "Method Not Allowed";
+    case 413:
+        return "Payload Too Large";
+    case 503:
+        return "Service Unavailable";
+    default:
+        return "Internal Server Error";
+    }
+}
+
+// Length of the head including the blank line, 0 while incomplete
+static size_t headLength(const char *buf)
+{
+    const char *end = strstr(buf, "\r\n\r\n");
+    return end ? (size_t)(end - buf) + 4 : 0;
+}
+
+// Content-Length from the (still unparsed) head; -1 if malformed
+static long contentLength(const char *buf, size_t head)
+{
+    const char *line = strstr(buf, "\r\n");
+    while (line && (size_t)(line - buf) + 2 < head)
+    {
+        line += 2;
+        if (strncasecmp(line, "Content-Length:", 15) == 0)
+        {
+            char *end;
+            long n = strtol(line + 15, &end, 10);
+            return n < 0 ? -1 : n;
+        }
+        line = strstr(line, "\r\n");
+    }
+    return 0;
+}
+
+// Splits the head in place
+static bool parseRequest(char *buf, size_t head, size_t bodyLen, HttpRequest &req)
+{
+    buf[head - 2] = '\0'; // ends the last header line
+    char *save;
+    char *line = strtok_r(buf, "\r\n", &save);
+    if (!line)
+        return false;
+
+    char *target;
+    req.method = strtok_r(line, " ", &target);
+    char *path = strtok_r(nullptr, " ", &target);
+    if (!req.method || !path || *path != '/')
+        return false;
+    char *query = strchr(path, '?');
+    if (query)
+        *query++ = '\0';
+    req.path = path;
+    req.query = query ? query : "";
+
+    req.headerCount = 0;
+    while ((line = strtok_r(nullptr, "\r\n", &save)) != nullptr)
+    {
+        char *colon = strchr(line, ':');
+        if (!colon || req.headerCount >= HTTP_MAX_HEADERS)
+            continue;
+        *colon++ = '\0';
+        while (*colon == ' ')
+            colon++;
+        req.headers[req.headerCount++] = {line, colon};
+    }
+
+    req.body = buf + head;
+    req.bodyLen = bodyLen;
+    buf[head + bodyLen] = '\0';
+    return true;
+}
+
+// === Connection handling ===
+
+static void sendResponse(WiFiClient &client, const HttpResponse &res)
+{
+    char head[224];
+    int n = snprintf(head, sizeof(head),
+                     "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %u\r\n"
+                     "Cache-Control: no-store\r\nAccess-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n",
+                     res.status, statusText(res.status), res.contentType, (unsigned)res.length());
+    client.write((const uint8_t *)head, n);
+    if (res.length() > 0)
+        client.write((const uint8_t *)res.data(), res.length());
+}
+
+static void sendPreflight(WiFiClient &client)
+{
+    static const char head[] =
+        "HTTP/1.1 204 No Content\r\nAccess-Control-Allow-Origin: *\r\n"
+        "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
+        "Access-Control-Allow-Headers: Authorization, Content-Type\r\n"
+        "Access-Control-Max-Age: 86400\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    client.write((const uint8_t *)head, sizeof(head) - 1);
+}
+
+// Hands the client over to a stream slot; false if all are taken
+static bool openStream(WiFiClient &client, const HttpResponse &res)
+{
+    WiFiClient *stream = nullptr;
+    for (uint8_t i = 0; i < HTTP_MAX_STREAMS && stream == nullptr; i++)
+    {
+        if (!streams[i] || !streams[i].connected())
+            stream = &streams[i];
+    }
+    if (!stream)
+        return false;
+
+    static const char head[] =
+        "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-store\r\n"
+        "Access-Control-Allow-Origin: *\r\nConnection: keep-alive\r\n\r\n";
+    client.write((const uint8_t *)head, sizeof(head) - 1);
+    if (res.length() > 0)
+        client.write((const uint8_t *)res.data(), res.length());
+
+    stream->stop();
+    *stream = client;
+    client = WiFiClient(); // the slot must not close it
+    return true;
+}
+
+static void sendError(WiFiClient &client, int status)
+{
+    HttpResponse res(responseBuf, sizeof(responseBuf));
+    res.status = status;
+    res.printf("%d %s\n", status, statusText(status));
+    sendResponse(client, res);
+}
+
+static void closeSlot(HttpClientSlot &slot)
+{
+    slot.client.stop();
+    slot.active = false;
+    slot.len = 0;
+}
+
+static void dispatch(HttpClientSlot &slot, size_t head, size_t bodyLen)
+{
+    HttpRequest req;
+    if (!parseRequest(slot.buf, head, bodyLen, req))
+    {
+        sendError(slot.client, 400);
+        return;
+    }
+    requestCount++;
+
+    bool pathKnown = false;
+    if (strcmp(req.method, "OPTIONS") == 0)
+    {
+        for (uint8_t i = 0; i < routeCount && !pathKnown; i++)
+            pathKnown = strcmp(routes[i].path, req.path) == 0;
+        if (pathKnown)
+            sendPreflight(slot.client);
+        else
+            sendError(slot.client, 404);
+        return;
+    }
+
+    for (uint8_t i = 0; i < routeCount; i++)
+    {
+        if (strcmp(routes[i].path, req.path) != 0)
+            continue;
+        pathKnown = true;
+        if (strcmp(routes[i].method, req.method) != 0)
+            continue;
+
+        HttpResponse res(responseBuf, sizeof(responseBuf));
+        routes[i].handler(req, res);
+        if (res.overflowed())
+        {
+            Serial.print("❌ HTTP response too large: ");
+            Serial.println(req.path);
+            sendError(slot.client, 500);
+            return;
+        }
+        if (res.stream)
+        {
+            if (!openStream(slot.client, res))
+                sendError(slot.client, 503);
+            return;
+        }
+        sendResponse(slot.client, res);
+        return;
+    }
+    sendError(slot.client, pathKnown ? 405 : 404);
+}
+
+// Reads what has arrived; dispatches once the request is complete
+static void serviceSlot(HttpClientSlot &slot)
+{
+    while (slot.client.available() && slot.len < HTTP_REQUEST_MAX)
+    {
+        int n = slot.client.read((uint8_t *)slot.buf + slot.len, HTTP_REQUEST_MAX - slot.len);
+        if (n <= 0)
+            break;
+        slot.len += n;
+    }
+    slot.buf[slot.len] = '\0';
+
+    size_t head = headLength(slot.buf);
+    if (head == 0)
+    {
+        if (slot.len >= HTTP_REQUEST_MAX)
+        {
+            sendError(slot.client, 413);
+            closeSlot(slot);
+        }
+        else if (!slot.client.connected() || millis() - slot.since > HTTP_CLIENT_TIMEOUT_MS)
+        {
+            closeSlot(slot);
+        }
+        return;
+    }
+
+    long bodyLen = contentLength(slot.buf, head);
+    if (bodyLen < 0 || head + bodyLen > HTTP_REQUEST_MAX)
+    {
+        sendError(slot.client, bodyLen < 0 ? 400 : 413);
+        closeSlot(slot);
+        return;
+    }
+    if (slot.len < head + bodyLen)
+    {
+        if (millis() - slot.since > HTTP_CLIENT_TIMEOUT_MS)
+            closeSlot(slot);
+        return; // body still arriving
+    }
+
+    dispatch(slot, head, bodyLen);
+    closeSlot(slot);
+}
+
+void initHttpServer()
+{
+    if (listening)
+        return;
+    server.begin();
+    server.setNoDelay(true);
+    listening = true;
+    Serial.print("✅ HTTP server listening on port ");
+    Serial.println(HTTP_PORT);
+}
+
+void handleHttpServer()
+{
+    if (!listening)
+        return;
+
+    WiFiClient incoming = server.available();
+    if (incoming)
+    {
+        HttpClientSlot *slot = nullptr;
+        for (uint8_t i = 0; i < HTTP_MAX_CLIENTS && slot == nullptr; i++)
+        {
+            if (!slots[i].active)
+                slot = &slots[i];
+        }
+        if (slot)
+        {
+            slot->client = incoming;
+            slot->active = true;
+            slot->since = millis();
+            slot->len = 0;
+        }
+        else
+        {
+            sendError(incoming, 503);
+            incoming.stop();
+        }
+    }
+
+    for (uint8_t i = 0; i < HTTP_MAX_CLIENTS; i++)
+    {
+        if (slots[i].active)
+            serviceSlot(slots[i]);
+    }
+}
+
+uint8_t writeHttpStreams(const char *data, size_t len)
+{
+    uint8_t written = 0;
+    for (uint8_t i = 0; i < HTTP_MAX_STREAMS; i++)
+    {
+        if (streams[i].connected() && streams[i].write((const uint8_t *)data, len) == len)
+        {
+            written++;
+            continue;
+        }
+        // Empty, or the peer went away (a WiFiClient is false once it is
+        // disconnected, so `!streams[i]` cannot tell these apart)
+        streams[i].stop();
+    }
+    return written;
+}
+
+uint8_t getHttpStreamCount()
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < HTTP_MAX_STREAMS; i++)
+    {
+        if (streams[i] && streams[i].connected())
+            count++;
+    }
+    return count;
+}
+
+uint32_t getHttpRequestCount()
+{
+    return requestCount;
+}
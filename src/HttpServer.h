@@ -0,0 +1,84 @@
+// ==================================================
+// File: src/HttpServer.h
+// ==================================================
+//
+// Small HTTP/1.1 server for the LAN, polled by a scheduler job instead of
+// running its own task. A few client slots read the request into a fixed
+// buffer without blocking; once the head (and any Content-Length body) is
+// in, the matching route handler writes its body into one preallocated
+// response buffer, and the reply goes out with "Connection: close".
+// No String or heap allocation anywhere on the request path.
+//
+// A handler can instead set `res.stream`: the client then moves to one of
+// HTTP_MAX_STREAMS long-lived slots and receives a Server-Sent Events
+// stream (text/event-stream). Its response body is sent as the first chunk,
+// and writeHttpStreams() pushes later events to every open stream.
+//
+// Responses carry "Access-Control-Allow-Origin: *" and OPTIONS preflights
+// are answered for every registered path, so a dashboard served from
+// elsewhere can call the device directly.
+
+#pragma once
+#include <Arduino.h>
+
+#define HTTP_PORT 80
+#define HTTP_MAX_CLIENTS 2
+#define HTTP_REQUEST_MAX 768   // request line + headers + body
+#define HTTP_RESPONSE_MAX 4096 // body
+#define HTTP_MAX_HEADERS 12
+#define HTTP_MAX_ROUTES 12
+#define HTTP_CLIENT_TIMEOUT_MS 3000
+#define HTTP_MAX_STREAMS 2
+
+struct HttpHeader
+{
+    const char *name; // as received; compare case-insensitively
+    const char *value;
+};
+
+struct HttpRequest
+{
+    const char *method;
+    const char *path;  // without the query string
+    const char *query; // after '?', "" if none
+    const char *body;
+    size_t bodyLen;
+    HttpHeader headers[HTTP_MAX_HEADERS];
+    uint8_t headerCount;
+};
+
+class HttpResponse
+{
+public:
+    HttpResponse(char *buf, size_t cap) : status(200), contentType("text/plain"), stream(false), buf(buf), cap(cap), len(0), overflow(false) { buf[0] = '\0'; }
+
+    void print(const char *s);
+    void printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+    void clear();
+    const char *data() const { return buf; }
+    size_t length() const { return len; }
+    bool overflowed() const { return overflow; }
+
+    int status;
+    const char *contentType;
+    bool stream; // keep the connection open as an event stream
+
+private:
+    char *buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+};
+
+typedef void (*HttpHandler)(const HttpRequest &req, HttpResponse &res);
+
+// Function declarations
+void initHttpServer(); // starts listening; safe to call again
+bool addHttpRoute(const char *method, const char *path, HttpHandler handler);
+void handleHttpServer(); // scheduler job
+const char *getHttpHeader(const HttpRequest &req, const char *name); // nullptr if absent
+bool getHttpQueryParam(const HttpRequest &req, const char *name, char *out, size_t outLen);
+bool getHttpFormParam(const HttpRequest &req, const char *name, char *out, size_t outLen); // urlencoded body
+uint8_t writeHttpStreams(const char *data, size_t len); // returns streams written; drops dead ones
+uint8_t getHttpStreamCount();
+uint32_t getHttpRequestCount();
@@ -0,0 +1,254 @@
+// ==================================================
+// File: src/LocalControl.cpp
+// ==================================================
+
+#include "LocalControl.h"
+#include "HttpServer.h"
+#include "config.h"
+#include "GetShedual.h"
+#include "ScheduleSync.h"
+#include "TemperatureSensors.h"
+#include "TimeManager.h"
+
+extern SystemStatus systemStatus;
+extern bool AmFlag;
+
+static uint32_t broadcastGeneration = 0; // schedule changes already sent to the streams
+static char eventBuf[LAN_EVENT_MAX];
+static const char *const sensorNames[] = {"red", "blue", "green"};
+
+// === Formatting ===
+
+static void printTemp(HttpResponse &res, Temp t)
+{
+    if (!t.isValid())
+    {
+        res.print("null");
+        return;
+    }
+    int c = t.centi;
+    res.printf("%s%d.%02d", c < 0 ? "-" : "", abs(c) / 100, abs(c) % 100);
+}
+
+static void printSchedule(HttpResponse &res)
+{
+    res.print("{\"am\":{\"temp\":");
+    printTemp(res, currentSchedule.amTemp);
+    res.printf(",\"time\":\"%s\",\"enabled\":%s},\"pm\":{\"temp\":", currentSchedule.amTime.c_str(),
+               currentSchedule.amEnabled ? "true" : "false");
+    printTemp(res, currentSchedule.pmTemp);
+    res.printf(",\"time\":\"%s\",\"enabled\":%s},\"period\":\"%s\",\"target\":", currentSchedule.pmTime.c_str(),
+               currentSchedule.pmEnabled ? "true" : "false", AmFlag ? "am" : "pm");
+    printTemp(res, AmFlag ? currentSchedule.amTemp : currentSchedule.pmTemp);
+    res.print("}");
+}
+
+static void printLive(HttpResponse &res)
+{
+    res.printf("{\"t\":%lu,\"uptime_s\":%lu,\"temperatures\":{", (unsigned long)getEpochTime(), millis() / 1000);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        res.printf("%s\"%s\":", i ? "," : "", sensorNames[i]);
+        printTemp(res, getLastTemperature(i));
+    }
+    res.printf("},\"heater\":\"%s\",\"current_a\":%.2f,\"target\":", systemStatus.heater == HEATER_ON ? "on" : "off",
+               getHeaterCurrent());
+    printTemp(res, AmFlag ? currentSchedule.amTemp : currentSchedule.pmTemp);
+    res.print("}");
+}
+
+// Formats one SSE event into eventBuf and sends it to every open stream
+static void broadcastEvent(const char *name, void (*printData)(HttpResponse &))
+{
+    if (getHttpStreamCount() == 0)
+        return;
+    HttpResponse event(eventBuf, sizeof(eventBuf));
+    event.printf("event: %s\ndata: ", name);
+    printData(event);
+    event.print("\n\n");
+    if (event.overflowed())
+        return;
+    writeHttpStreams(event.data(), event.length());
+}
+
+// === Authentication ===
+
+// Compares without an early exit so the time taken does not reveal the prefix
+static bool tokenMatches(const char *given)
+{
+    const char *expected = LAN_API_TOKEN;
+    size_t n = strlen(expected);
+    if (strlen(given) != n)
+        return false;
+    uint8_t diff = 0;
+    for (size_t i = 0; i < n; i++)
+        diff |= (uint8_t)(given[i] ^ expected[i]);
+    return diff == 0;
+}
+
+// Sends 401/403 itself when the request may not proceed
+static bool authorize(const HttpRequest &req, HttpResponse &res)
+{
+    if (LAN_API_TOKEN[0] == '\0')
+    {
+        res.status = 403;
+        res.print("{\"error\":\"LAN API disabled\"}");
+        return false;
+    }
+    const char *header = getHttpHeader(req, "Authorization");
+    if (header && strncmp(header, "Bearer ", 7) == 0 && tokenMatches(header + 7))
+        return true;
+    char token[64];
+    if (getHttpQueryParam(req, "token", token, sizeof(token)) && tokenMatches(token))
+        return true;
+
+    res.status = 401;
+    res.print("{\"error\":\"unauthorized\"}");
+    return false;
+}
+
+// === Handlers ===
+
+// Form body first, then the query string
+static bool param(const HttpRequest &req, const char *name, char *out, size_t outLen)
+{
+    return getHttpFormParam(req, name, out, outLen) || getHttpQueryParam(req, name, out, outLen);
+}
+
+static void rejectField(HttpResponse &res, const char *field)
+{
+    res.status = 400;
+    res.printf("{\"error\":\"invalid %s\"}", field);
+}
+
+// Commits through ScheduleSync (heater refresh, NVS cache; Firebase follows
+// with the next sync) and tells the event streams right away
+static void scheduleChanged()
+{
+    commitScheduleChanges();
+    broadcastGeneration = getScheduleSyncStats().applied;
+    broadcastEvent("schedule", printSchedule);
+}
+
+static void handleGetSchedule(const HttpRequest &req, HttpResponse &res)
+{
+    res.contentType = "application/json";
+    if (!authorize(req, res))
+        return;
+    printSchedule(res);
+}
+
+// All given fields are validated before any is applied
+static void handlePostSchedule(const HttpRequest &req, HttpResponse &res)
+{
+    static const struct
+    {
+        const char *name;
+        ScheduleField field;
+    } postFields[] = {
+        {"am_temp", SCHED_AM_TEMP},
+        {"pm_temp", SCHED_PM_TEMP},
+        {"am_time", SCHED_AM_TIME},
+        {"pm_time", SCHED_PM_TIME},
+        {"am_enabled", SCHED_AM_ENABLED},
+        {"pm_enabled", SCHED_PM_ENABLED},
+    };
+    const uint8_t count = sizeof(postFields) / sizeof(postFields[0]);
+
+    res.contentType = "application/json";
+    if (!authorize(req, res))
+        return;
+
+    char values[count][16];
+    bool present[count];
+    bool any = false;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        present[i] = param(req, postFields[i].name, values[i], sizeof(values[i]));
+        if (present[i] && !isValidScheduleValue(postFields[i].field, values[i]))
+        {
+            rejectField(res, postFields[i].name);
+            return;
+        }
+        any |= present[i];
+    }
+    if (!any)
+    {
+        res.status = 400;
+        res.print("{\"error\":\"no schedule fields\"}");
+        return;
+    }
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (present[i])
+            setScheduleField(postFields[i].field, values[i], SCHED_SOURCE_LAN);
+    }
+    scheduleChanged();
+    printSchedule(res);
+}
+
+static void handlePostTarget(const HttpRequest &req, HttpResponse &res)
+{
+    res.contentType = "application/json";
+    if (!authorize(req, res))
+        return;
+
+    ScheduleField field = AmFlag ? SCHED_AM_TEMP : SCHED_PM_TEMP;
+    char value[16];
+    if (!param(req, "value", value, sizeof(value)) || !isValidScheduleValue(field, value))
+    {
+        rejectField(res, "value");
+        return;
+    }
+    setScheduleField(field, value, SCHED_SOURCE_LAN);
+    scheduleChanged();
+    printSchedule(res);
+}
+
+static void handleGetLive(const HttpRequest &req, HttpResponse &res)
+{
+    res.contentType = "application/json";
+    if (!authorize(req, res))
+        return;
+    printLive(res);
+}
+
+// The opening chunk carries the current schedule and readings, so a new
+// dashboard does not wait for the next tick
+static void handleEvents(const HttpRequest &req, HttpResponse &res)
+{
+    res.contentType = "application/json";
+    if (!authorize(req, res))
+        return;
+    res.stream = true;
+    res.printf("retry: %d\n\nevent: schedule\ndata: ", LAN_STREAM_RETRY_MS);
+    printSchedule(res);
+    res.print("\n\nevent: live\ndata: ");
+    printLive(res);
+    res.print("\n\n");
+}
+
+void initLocalControl()
+{
+    addHttpRoute("GET", "/api/schedule", handleGetSchedule);
+    addHttpRoute("POST", "/api/schedule", handlePostSchedule);
+    addHttpRoute("POST", "/api/target", handlePostTarget);
+    addHttpRoute("GET", "/api/live", handleGetLive);
+    addHttpRoute("GET", "/api/events", handleEvents);
+
+    if (LAN_API_TOKEN[0] == '\0')
+        Serial.println("⚠️  LAN_API_TOKEN is empty - LAN control API disabled");
+}
+
+// Also forwards schedule changes that arrived over MQTT or from Firebase
+void localControlJob()
+{
+    uint32_t generation = getScheduleSyncStats().applied;
+    if (generation != broadcastGeneration)
+    {
+        broadcastGeneration = generation;
+        broadcastEvent("schedule", printSchedule);
+    }
+    broadcastEvent("live", printLive);
+}
@@ -0,0 +1,29 @@
+// ==================================================
+// File: src/LocalControl.h
+// ==================================================
+//
+// Control API for a dashboard on the LAN, on the HTTP server (HttpServer.h),
+// so the enclosure stays controllable without HiveMQ or Firebase:
+//   GET  /api/schedule  current AM/PM slots, active period and target
+//   POST /api/schedule  any of am_temp, am_time, am_enabled, pm_temp,
+//                       pm_time, pm_enabled (urlencoded body or query)
+//   POST /api/target    value=<°C> for the active period's slot
+//   GET  /api/live      one snapshot of the readings
+//   GET  /api/events    Server-Sent Events: "schedule" on every change,
+//                       "live" every LAN_LIVE_INTERVAL
+//
+// Every endpoint needs LAN_API_TOKEN, as "Authorization: Bearer <token>" or
+// ?token=<token> (EventSource cannot set headers). A POST is validated as a
+// whole and then applied through ScheduleSync - the path MQTT and Firebase
+// use, ending in setAMTemperature, setAMTime, ... The heater picks the
+// change up on its next tick, and it reaches Firebase once that is reachable.
+
+#pragma once
+#include <Arduino.h>
+
+#define LAN_EVENT_MAX 512    // one formatted SSE event
+#define LAN_STREAM_RETRY_MS 3000
+
+// Function declarations
+void initLocalControl(); // registers the routes
+void localControlJob();  // live readings and schedule changes to open event streams
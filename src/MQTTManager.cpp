@@ -11,11 +11,58 @@
 #include "GetShedual.h"
 #include "HeaterControl.h"
 #include <WiFi.h>
-#include <ArduinoJson.h>
+#include "WiFiManagerCustom.h"
+#include "Backoff.h"
+#include "TopicRouter.h"
+#include "TlsClient.h"
+#include "Certificates.h"
+#include "NetClientPool.h"
+#include "MQTTOutbox.h"
+#include "SystemState.h"
+#include "Reporter.h"
+#include "HistoryQuery.h"
+#include "EnergyMeter.h"
 
 // MQTT Client setup
-WiFiClientSecure wifiClientSecure;
-PubSubClient mqttClient(wifiClientSecure);
+struct BrokerConfig
+{
+    const char *name;
+    const char *host;
+    uint16_t port;
+    bool tls;
+    const char *user; // "" = anonymous
+    const char *password;
+};
+
+// Indexed by MQTTBroker
+static const BrokerConfig brokers[] = {
+    {"LAN", MQTT_LAN_SERVER, MQTT_LAN_PORT, false, MQTT_LAN_USER, MQTT_LAN_PASSWORD},
+    {"cloud", MQTT_SERVER, MQTT_PORT, MQTT_USE_TLS, MQTT_USER, MQTT_PASSWORD},
+};
+
+static TlsClient tlsClient;
+static WiFiClient plainClient;
+PubSubClient mqttClient;
+
+static MQTTBroker activeBroker = MQTT_LAN_ENABLED ? MQTT_BROKER_LAN : MQTT_BROKER_CLOUD;
+static IPAddress brokerIP; // from the RESOLVE stage
+static uint8_t lanFailures = 0;
+static unsigned long lanProbeAt = 0;
+
+// Transport of the broker currently in use
+static Client &mqttTransport()
+{
+    return brokers[activeBroker].tls ? (Client &)tlsClient : (Client &)plainClient;
+}
+
+// To the address the RESOLVE stage found
+static bool brokerConnect()
+{
+    const BrokerConfig &b = brokers[activeBroker];
+    if (b.tls)
+        return tlsClient.connect(brokerIP, b.port, b.host);
+    return plainClient.connect(brokerIP, b.port);
+}
 
 // Global MQTT status
 MQTTState mqttStatus = MQTT_STATE_DISCONNECTED;
@@ -23,66 +70,94 @@ MQTTState mqttStatus = MQTT_STATE_DISCONNECTED;
 // Client ID for MQTT connection
 String clientId = "ESP32-TemperatureController-";
 
-// Previous temperature values for change detection
-static float prevTempRed = NAN;
-static float prevTempBlue = NAN;
-static float prevTempGreen = NAN;
-static bool firstReading = true;
+// === Connection state machine ===
+enum SubscriptionState
+{
+    SUB_PENDING,
+    SUB_SENT,
+    SUB_CONFIRMED
+};
 
+struct Subscription
+{
+    const char *topic;
+    SubscriptionState state;
+};
+
+// One wildcard covers every control topic (and the sync barrier below it);
+// individual topics are dispatched on-device by the topic router
+static Subscription subscriptions[] = {
+    {TOPIC_CONTROL_ALL, SUB_PENDING},
+};
+#define SUBSCRIPTION_COUNT (sizeof(subscriptions) / sizeof(subscriptions[0]))
+
+static MQTTConnState connState = MQTT_CONN_IDLE;
+static Backoff connBackoff = {MQTT_BACKOFF_MIN_MS, MQTT_BACKOFF_MAX_MS, 0};
+static unsigned long nextAttemptAt = 0;
+static unsigned long attemptStartedAt = 0;
+static unsigned long stageStartedAt = 0;
+static unsigned long lastConnectMs = 0;
+static uint32_t connectCount = 0;
+static String syncTopic = "";
+static uint32_t syncNonce = 0;
+static bool subscriptionsConfirmed = false;
+
+static void setConnState(MQTTConnState next);
+static void useBroker(MQTTBroker broker);
+static void registerTopicRoutes();
+static void handleSyncMessage(const char *topic, const String &message);
+
+// All publishes go through the outbox: latest value per topic, delivered
+// (and retransmitted after a reconnect) once the session is up
 void publishSingleValue(const char *topic, float value)
 {
-    if (mqttStatus != MQTT_STATE_CONNECTED)
-        return;
     String payload = String(value, 2); // 2 decimal places
-    if (mqttClient.publish(topic, payload.c_str()))
-    {
-        Serial.print("Published to ");
-        Serial.print(topic);
-        Serial.print(": ");
-        Serial.println(payload);
-    }
-    else
-    {
-        Serial.print("Failed to publish to ");
-        Serial.println(topic);
-    }
+    publishSingleValue(topic, payload.c_str());
 }
 
 void publishSingleValue(const char *topic, int value)
 {
-    if (mqttStatus != MQTT_STATE_CONNECTED)
-        return;
-    String payload = String(value);
-    if (mqttClient.publish(topic, payload.c_str()))
-    {
-        Serial.print("Published to ");
-        Serial.print(topic);
-        Serial.print(": ");
-        Serial.println(payload);
-    }
-    else
-    {
-        Serial.print("Failed to publish to ");
-        Serial.println(topic);
-    }
+    char payload[12];
+    snprintf(payload, sizeof(payload), "%d", value);
+    publishSingleValue(topic, payload);
 }
 
 void publishSingleValue(const char *topic, const char *value)
 {
-    if (mqttStatus != MQTT_STATE_CONNECTED)
-        return;
-    if (mqttClient.publish(topic, value))
+    outboxEnqueue(topic, value);
+}
+
+bool publishDirect(const char *topic, const char *payload)
+{
+    if (connState != MQTT_CONN_READY)
+        return false;
+    return mqttClient.publish(topic, payload, false);
+}
+
+// Outbox transport: one PUBLISH on the live session
+static bool sendQueuedMessage(const char *topic, const char *payload, bool retained)
+{
+    if (!mqttClient.publish(topic, payload, retained))
+    {
+        Serial.print("Failed to publish to ");
+        Serial.println(topic);
+        return false;
+    }
+    if (strcmp(topic, syncTopic.c_str()) != 0)
     {
         Serial.print("Published to ");
         Serial.print(topic);
         Serial.print(": ");
-        Serial.println(value);
-    }
-    else
-    {
-        Serial.print("Failed to publish to ");
-        Serial.println(topic);
+        Serial.println(payload);
     }
+    return true;
+}
+
+void publishSingleValue(const char *topic, Temp value)
+{
+    char payload[12];
+    value.format(payload, sizeof(payload), 1);
+    publishSingleValue(topic, payload);
 }
 
 void publishTimeData()
@@ -104,21 +179,6 @@ MQTTState getMQTTStatus()
     return mqttStatus;
 }
 
-bool checkTemperatureChanges()
-{
-    float tempRed = getTemperature(0);   // Red sensor
-    float tempBlue = getTemperature(1);  // Blue sensor
-    float tempGreen = getTemperature(2); // Green sensor
-    bool hasChanged = firstReading ||
-                      (abs(tempRed - prevTempRed) > 1.0 && !isnan(tempRed)) ||
-                      (abs(tempBlue - prevTempBlue) > 1.0 && !isnan(tempBlue)) ||
-                      (abs(tempGreen - prevTempGreen) > 1.0 && !isnan(tempGreen)) ||
-                      (isnan(tempRed) != isnan(prevTempRed)) ||
-                      (isnan(tempBlue) != isnan(prevTempBlue)) ||
-                      (isnan(tempGreen) != isnan(prevTempGreen));
-    return hasChanged;
-}
-
 void onMQTTMessage(char *topic, unsigned char *payload, unsigned int length)
 {
     Serial.println("===================================");
@@ -140,25 +200,17 @@ void onMQTTMessage(char *topic, unsigned char *payload, unsigned int length)
     Serial.println(topic);
     Serial.print("*****************Message: ");
     Serial.println(message);
-    // Route schedule topics to handleScheduleUpdate
-    String topicStr = String(topic);
-    topicStr.trim();
-    topicStr.toLowerCase();
-    if (topicStr.endsWith("control/schedule") ||
-        topicStr.endsWith("control/schedule/am/temperature") ||
-        topicStr.endsWith("control/schedule/pm/temperature") ||
-        topicStr.endsWith("control/schedule/am/time") ||
-        topicStr.endsWith("control/schedule/pm/time") ||
-        topicStr.endsWith("control/schedule/am/enabled") ||
-        topicStr.endsWith("control/schedule/pm/enabled") ||
-        topicStr.endsWith("control/schedule/pm/scheduledtime"))
-    {
-        Serial.println("[DEBUG] Routing to handleScheduleUpdate...");
-        handleScheduleUpdate(topic, message);
-    }
-    else
+    // Dispatch through the topic trie (see registerTopicRoutes())
+    switch (routeTopic(topic, message))
     {
-        Serial.println("[DEBUG] Topic not routed to handleScheduleUpdate.");
+    case ROUTE_DISPATCHED:
+        break;
+    case ROUTE_DUPLICATE:
+        Serial.println("[DEBUG] Duplicate message suppressed");
+        break;
+    case ROUTE_UNMATCHED:
+        Serial.println("[DEBUG] No route for topic");
+        break;
     }
     Serial.println("===================================");
     Serial.println("");
@@ -168,348 +220,461 @@ void initMQTT()
 {
     Serial.println("Initializing MQTT Manager...");
 
-    // Check WiFi connection
-    if (WiFi.status() != WL_CONNECTED)
-    {
-        Serial.println("WiFi not connected, cannot initialize MQTT");
-        mqttStatus = MQTT_STATE_DISCONNECTED;
-        return;
-    }
-
     // Generate unique client ID to avoid conflicts with React app
     clientId = "ESP32_TempController_";
     clientId += String(WiFi.macAddress());
     clientId.replace(":", "");
     clientId += "_" + String(millis()); // Add timestamp for absolute uniqueness
+    syncTopic = String(TOPIC_CONTROL_SYNC_PREFIX) + clientId;
 
     Serial.print("🆔 MQTT Client ID: ");
     Serial.println(clientId);
 
-    // Configure secure WiFi client for TLS connection
-    wifiClientSecure.setInsecure(); // For testing - in production, use proper certificates
+    // Publish windows are acknowledged through the same sync topic
+    initOutbox(sendQueuedMessage, syncTopic.c_str());
 
-    // CRITICAL FIX: Set MQTT server and callback with enhanced registration
-    mqttClient.setServer(MQTT_SERVER, MQTT_PORT_TLS);
+    // HiveMQ Cloud chains to ISRG Root X1; the session is reused on reconnect
+    tlsClient.setPinnedCA(ROOT_CA_ISRG_X1);
+    registerNetClient(NET_CLIENT_MQTT, "mqtt", true, nullptr);
+#if MQTT_TLS_PERSIST_SESSION
+    tlsClient.setSessionStore("mqtt");
+#endif
 
-    // Set callback MULTIPLE times to ensure it sticks
+    useBroker(activeBroker);
     mqttClient.setCallback(onMQTTMessage);
-    delay(50);
-    mqttClient.setCallback(onMQTTMessage); // Double registration for safety
-
-    Serial.println("✅ MQTT callback registered (double-confirmed)");
+    registerTopicRoutes();
 
     // Set buffer size for larger messages and keepalive
-    mqttClient.setBufferSize(512);
-    mqttClient.setKeepAlive(60); // 60 second keepalive
+    mqttClient.setBufferSize(1024); // history query responses
+    mqttClient.setKeepAlive(60);      // 60 second keepalive
+    mqttClient.setSocketTimeout(5);   // bound the CONNACK wait
 
-    // Test callback registration immediately
-    Serial.println("✅ MQTT callback registered");
+    connBackoff.reset();
+    setConnState(isWiFiConnected() ? MQTT_CONN_RESOLVE : MQTT_CONN_IDLE);
+    nextAttemptAt = millis();
 
     Serial.println("MQTT Manager initialized");
 }
 
-void handleMQTT()
+static void setConnState(MQTTConnState next)
 {
-    // Add debug to verify this function is being called
-    static unsigned long lastDebugHandleMQTT = 0;
-    if (millis() - lastDebugHandleMQTT > 60000) // Debug every 60 seconds
+    connState = next;
+    stageStartedAt = millis();
+
+    switch (next)
     {
-        Serial.println("🔧 handleMQTT() function called");
-        lastDebugHandleMQTT = millis();
+    case MQTT_CONN_IDLE:
+        mqttStatus = connBackoff.failures > 0 ? MQTT_STATE_ERROR : MQTT_STATE_DISCONNECTED;
+        break;
+    case MQTT_CONN_READY:
+        mqttStatus = MQTT_STATE_CONNECTED;
+        break;
+    default:
+        mqttStatus = MQTT_STATE_CONNECTING;
+        break;
     }
+}
 
-    // Don't proceed if WiFi is not connected
-    if (WiFi.status() != WL_CONNECTED)
+// Close the MQTT session and its transport, returning the TLS budget
+static void closeTransport()
+{
+    mqttClient.disconnect();
+    mqttTransport().stop();
+    tlsClosed(NET_CLIENT_MQTT);
+    outboxConnectionLost(); // unacknowledged window goes out again on reconnect
+}
+
+static void useBroker(MQTTBroker broker)
+{
+    activeBroker = broker;
+    const BrokerConfig &b = brokers[broker];
+    mqttClient.setClient(mqttTransport());
+    mqttClient.setServer(b.host, b.port);
+    lanProbeAt = millis() + MQTT_LAN_PROBE_INTERVAL;
+    Serial.print("📡 MQTT broker: ");
+    Serial.print(b.name);
+    Serial.print(" (");
+    Serial.print(b.host);
+    Serial.print(":");
+    Serial.print(b.port);
+    Serial.println(")");
+}
+
+// Drop the session and wait out the backoff before the next attempt
+static void connectFailed(const char *stage)
+{
+    int clientState = mqttClient.state(); // disconnect() resets it
+    closeTransport();
+
+    if (MQTT_LAN_ENABLED && activeBroker == MQTT_BROKER_LAN && ++lanFailures >= MQTT_LAN_FAILOVER_ATTEMPTS)
     {
-        mqttStatus = MQTT_STATE_DISCONNECTED;
+        Serial.print("❌ MQTT ");
+        Serial.print(stage);
+        Serial.println(" failed on LAN broker - failing over to cloud");
+        lanFailures = 0;
+        connBackoff.reset();
+        useBroker(MQTT_BROKER_CLOUD);
+        nextAttemptAt = millis();
+        setConnState(MQTT_CONN_IDLE);
         return;
     }
+    if (MQTT_LAN_ENABLED && activeBroker == MQTT_BROKER_CLOUD)
+    {
+        useBroker(MQTT_BROKER_LAN); // cloud down too - try LAN again after the backoff
+    }
+
+    unsigned long wait = connBackoff.nextDelay();
+    nextAttemptAt = millis() + wait;
+    setConnState(MQTT_CONN_IDLE);
+
+    Serial.print("❌ MQTT ");
+    Serial.print(stage);
+    Serial.print(" failed (state ");
+    Serial.print(clientState);
+    Serial.print("), retry ");
+    Serial.print(connBackoff.failures);
+    Serial.print(" in ");
+    Serial.print(wait);
+    Serial.println(" ms");
+}
 
-    // Try to connect if not connected
-    if (!mqttClient.connected())
+// Queue every SUBSCRIBE back to back; the broker answers them in order
+static bool sendSubscriptions()
+{
+    for (uint8_t i = 0; i < SUBSCRIPTION_COUNT; i++)
     {
-        mqttStatus = MQTT_STATE_CONNECTING;
-        if (connectToMQTT())
-        {
-            mqttStatus = MQTT_STATE_CONNECTED;
-        }
-        else
+        subscriptions[i].state = SUB_PENDING;
+    }
+    for (uint8_t i = 0; i < SUBSCRIPTION_COUNT; i++)
+    {
+        if (!mqttClient.subscribe(subscriptions[i].topic, 1))
         {
-            mqttStatus = MQTT_STATE_ERROR;
-            // Rate limit connection attempts
-            static unsigned long lastConnectAttempt = 0;
-            if (millis() - lastConnectAttempt > 30000) // Try every 30 seconds
-            {
-                Serial.println("MQTT connection failed, will retry in 30 seconds");
-                lastConnectAttempt = millis();
-            }
+            Serial.print("❌ Failed to send SUBSCRIBE for ");
+            Serial.println(subscriptions[i].topic);
+            return false;
         }
+        subscriptions[i].state = SUB_SENT;
     }
-    else
-    {
-        mqttStatus = MQTT_STATE_CONNECTED;
-        // Keep the connection alive and process incoming messages
-        // Call loop() more frequently for better message processing
-        mqttClient.loop();
 
-        static unsigned long lastLoopDebug = 0;
-        if (millis() - lastLoopDebug > 30000) // Debug every 30 seconds
+    // PubSubClient does not surface SUBACKs, so close the batch with a barrier:
+    // publish a nonce to our private sync topic (covered by the control
+    // wildcard). The broker handles packets in order, so the echo only comes
+    // back after every SUBSCRIBE above has been processed.
+    syncNonce = (uint32_t)random(1, 0x7FFFFFFF);
+    char nonce[12];
+    snprintf(nonce, sizeof(nonce), "%lu", (unsigned long)syncNonce);
+    return mqttClient.publish(syncTopic.c_str(), nonce, false);
+}
+
+// Subscription / publish window barrier echo; other devices' sync topics are ignored
+static void handleSyncMessage(const char *topic, const String &message)
+{
+    if (strcmp(topic, syncTopic.c_str()) != 0)
+        return;
+    if (outboxHandleBarrier(message))
+        return;
+    if (connState == MQTT_CONN_WAIT_SUBACK && (uint32_t)message.toInt() == syncNonce)
+    {
+        for (uint8_t i = 0; i < SUBSCRIPTION_COUNT; i++)
         {
-            Serial.println("🔄 MQTT client loop() running, waiting for messages...");
-            lastLoopDebug = millis();
+            subscriptions[i].state = SUB_CONFIRMED;
         }
+        subscriptionsConfirmed = true;
     }
 }
 
-bool connectToMQTT()
-{
-    Serial.print("Connecting to MQTT broker: ");
-    Serial.println(MQTT_SERVER);
-    const char *lwtTopic = "esp32/system/status";
-    const char *lwtMessage = "offline";
-    int lwtQos = 1;
-    bool lwtRetain = true;
-
-    // Attempt to connect with credentials
-    if (mqttClient.connect(
-            clientId.c_str(),
-            MQTT_USER,
-            MQTT_PASSWORD,
-            lwtTopic,  // LWT topic
-            lwtQos,    // LWT QoS
-            lwtRetain, // LWT retain
-            lwtMessage // LWT message
-            ))
-    {
-        Serial.println("MQTT connected successfully!");
+// Control topics handled on this device
+static void registerTopicRoutes()
+{
+    static bool registered = false;
+    if (registered)
+        return;
 
-        // CRITICAL: Re-register callback after connection
-        mqttClient.setCallback(onMQTTMessage);
-        Serial.println("🔄 Callback re-registered after connection");
+    addTopicRoute(TOPIC_CONTROL_SCHEDULE, handleScheduleUpdate); // JSON schedule
+    addTopicRoute(TOPIC_CONTROL_AM_TEMP, handleScheduleUpdate);
+    addTopicRoute(TOPIC_CONTROL_PM_TEMP, handleScheduleUpdate);
+    addTopicRoute(TOPIC_CONTROL_AM_TIME, handleScheduleUpdate);
+    addTopicRoute(TOPIC_CONTROL_PM_TIME, handleScheduleUpdate);
+    addTopicRoute(TOPIC_CONTROL_AM_ENABLED, handleScheduleUpdate);
+    addTopicRoute(TOPIC_CONTROL_PM_ENABLED, handleScheduleUpdate);
+    addTopicRoute("esp32/control/schedule/+/scheduledTime", handleScheduleUpdate);
+    addTopicRoute(TOPIC_HISTORY_QUERY, handleHistoryQuery);
+    addTopicRoute(TOPIC_CONTROL_SYNC_PREFIX "+", handleSyncMessage);
+    registered = true;
+}
+
+static void connectionReady()
+{
+    connBackoff.reset();
+    lastConnectMs = millis() - attemptStartedAt;
+    connectCount++;
+    setConnState(MQTT_CONN_READY);
+
+    // Overwrite the retained LWT "offline"
+    mqttClient.publish(TOPIC_STATUS, "online", true);
+    markSystemStateDirty(); // a fresh session gets the full state
+
+    Serial.print("✅ MQTT ready in ");
+    Serial.print(lastConnectMs);
+    Serial.print(" ms (");
+    Serial.print(SUBSCRIPTION_COUNT);
+    Serial.println(" subscriptions confirmed)");
+
+    if (activeBroker == MQTT_BROKER_LAN)
+        lanFailures = 0;
+    if (!brokers[activeBroker].tls)
+        return;
 
-        // Subscribe to control topics (for receiving commands) with QoS 1 for guaranteed delivery
-        Serial.println("📡 Subscribing to MQTT topics with QoS 1...");
-        if (mqttClient.subscribe("esp32/control/+", 1))
+    const TlsHandshakeStats &tls = tlsClient.getStats();
+    Serial.print("🔐 TLS handshake: ");
+    Serial.print(tls.lastType == TLS_HANDSHAKE_RESUMED ? "resumed" : "full");
+    Serial.print(" in ");
+    Serial.print(tls.lastHandshakeMs);
+    Serial.print(" ms (full ");
+    Serial.print(tls.fullHandshakes);
+    Serial.print(", resumed ");
+    Serial.print(tls.resumedHandshakes);
+    Serial.println(")");
+}
+
+// While on the cloud broker, check whether the LAN broker accepts TCP again
+static bool lanBrokerReachable()
+{
+    WiFiClient probe;
+    bool reachable = probe.connect(MQTT_LAN_SERVER, MQTT_LAN_PORT, MQTT_LAN_PROBE_TIMEOUT_MS);
+    probe.stop();
+    return reachable;
+}
+
+/**
+ * MQTT connection state machine, one stage per call (called by the "mqtt"
+ * scheduler job every MQTT_LOOP_INTERVAL ms):
+ *
+ *   IDLE -> RESOLVE -> TLS -> CONNECT -> SUBSCRIBE -> WAIT_SUBACK -> READY
+ *
+ * Nothing waits with delay(), but three stages block inside the network
+ * stack, each bounded by its own timeout: RESOLVE (DNS lookup), TLS (TCP
+ * connect + handshake, to the resolved address) and CONNECT (CONNACK wait,
+ * setSocketTimeout). Each call runs at most one of them.
+ *
+ * Any failure drops back to IDLE and waits out an exponential backoff. With
+ * MQTT_LAN_ENABLED the LAN broker is tried first; after
+ * MQTT_LAN_FAILOVER_ATTEMPTS failures the cloud broker takes over until a
+ * periodic probe finds the LAN broker reachable again.
+ */
+void handleMQTT()
+{
+    // Don't proceed if WiFi is not connected
+    if (!isWiFiConnected())
+    {
+        if (connState != MQTT_CONN_IDLE)
         {
-            Serial.println("✅ Subscribed to esp32/control/+ (QoS 1)");
+            closeTransport();
+            connBackoff.reset();
+            setConnState(MQTT_CONN_IDLE);
         }
-        else
+        mqttStatus = MQTT_STATE_DISCONNECTED;
+        nextAttemptAt = millis();
+        return;
+    }
+
+    switch (connState)
+    {
+    case MQTT_CONN_IDLE:
+        if ((long)(millis() - nextAttemptAt) >= 0)
         {
-            Serial.println("❌ Failed to subscribe to esp32/control/+");
+            attemptStartedAt = millis();
+            setConnState(MQTT_CONN_RESOLVE);
         }
+        break;
 
-        if (mqttClient.subscribe("esp32/commands/+", 1))
+    case MQTT_CONN_RESOLVE:
+        // Blocks for the lookup (lwIP DNS timeout at worst); the address is
+        // kept so the TLS stage does not resolve again
+        if (WiFi.hostByName(brokers[activeBroker].host, brokerIP) == 1)
         {
-            Serial.println("✅ Subscribed to esp32/commands/+ (QoS 1)");
+            setConnState(MQTT_CONN_TLS);
         }
         else
         {
-            Serial.println("❌ Failed to subscribe to esp32/commands/+");
+            connectFailed("DNS lookup");
         }
+        break;
 
-        // Subscribe to schedule topics to match React app format with QoS 1
-        if (mqttClient.subscribe(TOPIC_CONTROL_AM_TEMP, 1))
-        {
-            Serial.println("✅ Subscribed to " TOPIC_CONTROL_AM_TEMP " (QoS 1)");
-        }
-        else
+    case MQTT_CONN_TLS:
+        // MQTT keeps its context resident; this only fails when even closing
+        // idle HTTPS connections leaves too little heap for a handshake
+        if (brokers[activeBroker].tls && !acquireTls(NET_CLIENT_MQTT))
         {
-            Serial.println("❌ Failed to subscribe to " TOPIC_CONTROL_AM_TEMP);
+            connectFailed("TLS budget");
+            break;
         }
-
-        if (mqttClient.subscribe(TOPIC_CONTROL_PM_TEMP, 1))
+        // Blocks for the TCP connect and handshake (TLS_CONNECT_TIMEOUT_MS and
+        // the handshake timeout at worst). The name still goes into SNI and
+        // the certificate check.
+        if (brokerConnect())
         {
-            Serial.println("✅ Subscribed to " TOPIC_CONTROL_PM_TEMP " (QoS 1)");
+            setConnState(MQTT_CONN_CONNECT);
         }
         else
         {
-            Serial.println("❌ Failed to subscribe to " TOPIC_CONTROL_PM_TEMP);
+            connectFailed(brokers[activeBroker].tls ? "TLS handshake" : "TCP connect");
         }
+        break;
 
-        if (mqttClient.subscribe(TOPIC_CONTROL_AM_TIME, 1))
+    case MQTT_CONN_CONNECT:
+    {
+        // The transport is already up, so PubSubClient only sends CONNECT and
+        // waits for CONNACK (bounded by setSocketTimeout)
+        const BrokerConfig &b = brokers[activeBroker];
+        bool anonymous = b.user[0] == '\0';
+        if (mqttClient.connect(clientId.c_str(), anonymous ? nullptr : b.user, anonymous ? nullptr : b.password,
+                               TOPIC_STATUS, 1, true, "offline"))
         {
-            Serial.println("✅ Subscribed to " TOPIC_CONTROL_AM_TIME " (QoS 1)");
+            setConnState(MQTT_CONN_SUBSCRIBE);
         }
         else
         {
-            Serial.println("❌ Failed to subscribe to " TOPIC_CONTROL_AM_TIME);
+            connectFailed("CONNECT");
         }
+        break;
+    }
 
-        if (mqttClient.subscribe(TOPIC_CONTROL_PM_TIME, 1))
+    case MQTT_CONN_SUBSCRIBE:
+        subscriptionsConfirmed = false;
+        if (sendSubscriptions())
         {
-            Serial.println("✅ Subscribed to " TOPIC_CONTROL_PM_TIME " (QoS 1)");
+            setConnState(MQTT_CONN_WAIT_SUBACK);
         }
         else
         {
-            Serial.println("❌ Failed to subscribe to " TOPIC_CONTROL_PM_TIME);
+            connectFailed("SUBSCRIBE");
         }
+        break;
 
-        // Subscribe to JSON schedule updates with QoS 1
-        if (mqttClient.subscribe(TOPIC_CONTROL_SCHEDULE, 1))
+    case MQTT_CONN_WAIT_SUBACK:
+        if (!mqttClient.loop())
         {
-            Serial.println("✅ Subscribed to " TOPIC_CONTROL_SCHEDULE " (QoS 1)");
+            connectFailed("SUBACK wait");
         }
-        else
+        else if (subscriptionsConfirmed)
         {
-            Serial.println("❌ Failed to subscribe to " TOPIC_CONTROL_SCHEDULE);
+            connectionReady();
         }
-
-        // Subscribe to additional React app topics with QoS 1
-        if (mqttClient.subscribe(TOPIC_CONTROL_AM_ENABLED, 1))
+        else if (millis() - stageStartedAt > MQTT_SUBACK_TIMEOUT_MS)
         {
-            Serial.println("✅ Subscribed to " TOPIC_CONTROL_AM_ENABLED " (QoS 1)");
+            connectFailed("SUBACK timeout");
         }
-        if (mqttClient.subscribe(TOPIC_CONTROL_PM_ENABLED, 1))
+        break;
+
+    case MQTT_CONN_READY:
+        // Keep the connection alive and process incoming messages
+        if (!mqttClient.loop())
         {
-            Serial.println("✅ Subscribed to " TOPIC_CONTROL_PM_ENABLED " (QoS 1)");
+            Serial.println("⚠️  MQTT connection lost");
+            connBackoff.reset();
+            connectFailed("session");
+            break;
         }
-        if (mqttClient.subscribe(TOPIC_CONTROL_PM_SCHEDULED_TIME, 1))
+        serviceOutbox();
+        if (MQTT_LAN_ENABLED && activeBroker == MQTT_BROKER_CLOUD && (long)(millis() - lanProbeAt) >= 0)
         {
-            Serial.println("✅ Subscribed to " TOPIC_CONTROL_PM_SCHEDULED_TIME " (QoS 1)");
+            lanProbeAt = millis() + MQTT_LAN_PROBE_INTERVAL;
+            if (lanBrokerReachable())
+            {
+                Serial.println("🏠 LAN broker reachable again - switching back from cloud");
+                closeTransport();
+                useBroker(MQTT_BROKER_LAN);
+                connBackoff.reset();
+                nextAttemptAt = millis();
+                setConnState(MQTT_CONN_IDLE);
+            }
         }
+        break;
+    }
+}
 
-        // Publish connection status
-        publishSingleValue(TOPIC_STATUS, "online");
-
-        // Add debug info about connection
-        Serial.print("✅ MQTT Client State: ");
-        Serial.println(mqttClient.state());
-        Serial.println("📡 All subscriptions complete");
+MQTTBroker getMQTTBroker()
+{
+    return activeBroker;
+}
 
-        // CRITICAL TEST: Send a self-test message to trigger callback with QoS 1
-        Serial.println("🧪 Sending self-test message to verify callback...");
-        delay(1000); // Give subscriptions time to settle
+const char *getMQTTBrokerName()
+{
+    return brokers[activeBroker].name;
+}
 
-        // Call loop() multiple times to ensure message processing
-        for (int i = 0; i < 5; i++)
-        {
-            mqttClient.loop();
-            delay(100);
-        }
+MQTTConnState getMQTTConnState()
+{
+    return connState;
+}
 
-        mqttClient.publish("esp32/commands/status", "SELF_TEST_CALLBACK", true); // Retained message with QoS
-        Serial.println("📤 Self-test message sent with QoS, callback should trigger...");
+unsigned long getMQTTLastConnectMs()
+{
+    return lastConnectMs;
+}
 
-        // Process the message immediately
-        for (int i = 0; i < 10; i++)
-        {
-            mqttClient.loop();
-            delay(50);
-        }
+uint32_t getMQTTConnectCount()
+{
+    return connectCount;
+}
 
-        return true;
-    }
-    else
-    {
-        Serial.print("MQTT connection failed, rc=");
-        Serial.print(mqttClient.state());
-        Serial.println(" retrying...");
+// Publishes one channel if the MQTT reporter says it is due
+static bool reportTemperature(ReportChannel channel, const char *topic, Temp value)
+{
+    if (!reportDue(channel, REPORT_SINK_MQTT, value))
         return false;
-    }
+    publishSingleValue(topic, value); // 1 decimal place, "ERROR" if invalid
+    markReported(channel, REPORT_SINK_MQTT, value); // the outbox guarantees delivery
+    return true;
 }
 
 void publishSensorData()
 {
     if (mqttStatus != MQTT_STATE_CONNECTED)
-    {
-        Serial.println("MQTT not connected, cannot publish sensor data");
         return;
-    }
 
-    // Get temperature readings
-    float tempRed = getTemperature(0);   // Red sensor
-    float tempBlue = getTemperature(1);  // Blue sensor
-    float tempGreen = getTemperature(2); // Green sensor
-
-    // Check if any temperature has changed (or this is the first reading)
-    // Using 0.1°C as the minimum change threshold to avoid noise
-    bool hasChanged = firstReading ||
-                      (abs(tempRed - prevTempRed) > 0.1 && !isnan(tempRed)) ||
-                      (abs(tempBlue - prevTempBlue) > 0.1 && !isnan(tempBlue)) ||
-                      (abs(tempGreen - prevTempGreen) > 0.1 && !isnan(tempGreen)) ||
-                      (isnan(tempRed) != isnan(prevTempRed)) ||
-                      (isnan(tempBlue) != isnan(prevTempBlue)) ||
-                      (isnan(tempGreen) != isnan(prevTempGreen));
-
-    if (!hasChanged)
-    {
-        // Only print this message every 30 seconds to avoid spam
-        static unsigned long lastNoChangeMessage = 0;
-        if (millis() - lastNoChangeMessage > 30000)
-        {
-            Serial.println("📊 No significant temperature changes detected");
-            lastNoChangeMessage = millis();
-        }
-        return;
-    }
+    // Readings cached by readAllSensors(); no bus conversion here
+    Temp tempRed = getLastTemperature(0);   // Red sensor
+    Temp tempBlue = getLastTemperature(1);  // Blue sensor
+    Temp tempGreen = getLastTemperature(2); // Green sensor
 
-    Serial.println("🌡️  Temperature change detected, publishing sensor data to MQTT...");
-
-    // Update previous values
-    prevTempRed = tempRed;
-    prevTempBlue = tempBlue;
-    prevTempGreen = tempGreen;
-    firstReading = false;
-
-    // Calculate average temperature
-    float avgTemp = 0;
+    // Average over the connected sensors (sum in centi-degrees)
+    int32_t avgCenti = 0;
     int validSensors = 0;
-
-    if (!isnan(tempRed))
+    Temp readings[] = {tempRed, tempBlue, tempGreen};
+    for (Temp t : readings)
     {
-        publishSingleValue(TOPIC_TEMP_RED, (float)(round(tempRed * 10) / 10.0)); // Round to 1 decimal place
-        avgTemp += tempRed;
-        validSensors++;
-    }
-    else
-    {
-        publishSingleValue(TOPIC_TEMP_RED, "ERROR");
+        if (t.isValid())
+        {
+            avgCenti += t.centi;
+            validSensors++;
+        }
     }
+    Temp avgTemp = validSensors > 0 ? Temp::fromCenti(avgCenti / validSensors) : Temp::invalid();
 
-    if (!isnan(tempBlue))
-    {
-        publishSingleValue(TOPIC_TEMP_BLUE, (float)(round(tempBlue * 10) / 10.0)); // Round to 1 decimal place
-        avgTemp += tempBlue;
-        validSensors++;
-    }
-    else
-    {
-        publishSingleValue(TOPIC_TEMP_BLUE, "ERROR");
-    }
+    // Each channel has its own deadband / rate limit / heartbeat state
+    uint8_t published = 0;
+    published += reportTemperature(REPORT_TEMP_RED, TOPIC_TEMP_RED, tempRed);
+    published += reportTemperature(REPORT_TEMP_BLUE, TOPIC_TEMP_BLUE, tempBlue);
+    published += reportTemperature(REPORT_TEMP_GREEN, TOPIC_TEMP_GREEN, tempGreen);
+    published += reportTemperature(REPORT_TEMP_AVG, TOPIC_TEMP_AVG, avgTemp);
 
-    if (!isnan(tempGreen))
-    {
-        publishSingleValue(TOPIC_TEMP_GREEN, (float)(round(tempGreen * 10) / 10.0)); // Round to 1 decimal place
-        avgTemp += tempGreen;
-        validSensors++;
-    }
-    else
-    {
-        publishSingleValue(TOPIC_TEMP_GREEN, "ERROR");
-    }
+    if (published == 0)
+        return;
 
-    // Publish average temperature
-    if (validSensors > 0)
-    {
-        avgTemp /= validSensors;
-        publishSingleValue(TOPIC_TEMP_AVG, (float)(round(avgTemp * 10) / 10.0)); // Round to 1 decimal place
-        Serial.print("📊 Average temperature: ");
-        Serial.print(avgTemp);
-        Serial.print("°C (from ");
-        Serial.print(validSensors);
-        Serial.println(" sensors)");
-    }
-    else
-    {
-        publishSingleValue(TOPIC_TEMP_AVG, "ERROR");
-        Serial.println("⚠️  No valid temperature sensors available");
-    }
+    Serial.print("🌡️  Published ");
+    Serial.print(published);
+    Serial.print(" temperature channel(s), average ");
+    Serial.print(avgTemp.toString(2));
+    Serial.print("°C (from ");
+    Serial.print(validSensors);
+    Serial.println(" sensors)");
 
-    // Publish dummy current data (until current sensor is implemented)
-    float dummyCurrent = random(0, 100) / 10.0; // Random current 0-10A
-    publishSingleValue(TOPIC_CURRENT, dummyCurrent);
+    // Heater current measured on the last heater tick
+    publishSingleValue(TOPIC_CURRENT, getHeaterCurrent());
 
-    // Also publish time and system data when temperature changes
+    // Time-stamp the readings and catch up on any system state changes
     publishTimeData();
     publishSystemData();
 }
@@ -517,27 +682,65 @@ void publishSensorData()
 // Ensure systemStatus is available for publishing heater status
 extern SystemStatus systemStatus;
 
-void publishSystemData()
+// Energy counters whose rounded value changed; everything on the heartbeat
+void publishEnergyData()
 {
+    static uint32_t last[5];
+    static unsigned long lastFullMs = 0;
+    static bool published = false;
+
     if (mqttStatus != MQTT_STATE_CONNECTED)
-    {
-        Serial.println("MQTT not connected, cannot publish system data");
         return;
-    }
-
-    //Serial.println("Publishing system data to MQTT...");
 
-    // Publish WiFi signal strength
-    int rssi = WiFi.RSSI();
-    publishSingleValue(TOPIC_WIFI_RSSI, rssi);
+    const EnergyTotals &t = getEnergyTotals();
+    bool full = !published || millis() - lastFullMs >= ENERGY_MQTT_HEARTBEAT_MS;
+    const char *topics[5] = {TOPIC_ENERGY_HOUR, TOPIC_ENERGY_TODAY, TOPIC_ENERGY_MONTH, TOPIC_ENERGY_TOTAL, TOPIC_ENERGY_YESTERDAY};
+    uint32_t values[5] = {getEnergyWh(t.hour), getEnergyWh(t.day), getEnergyWh(t.month), t.totalWh, t.lastDayWh};
+    bool changed = false;
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        if (full || values[i] != last[i])
+        {
+            publishSingleValue(topics[i], (int)values[i]);
+            last[i] = values[i];
+            changed = true;
+        }
+    }
+    // Duty follows the energy; on its own it creeps every tick
+    if (changed)
+        publishSingleValue(TOPIC_ENERGY_DUTY, getDutyPermille(t.day) / 10.0f);
+    if (full)
+    {
+        lastFullMs = millis();
+        published = true;
+    }
+}
 
-    // Publish uptime in seconds
-    unsigned long uptime = millis() / 1000;
-    publishSingleValue(TOPIC_UPTIME, (int)uptime);
+// Publishes only the system fields that changed since the last call, plus
+// the full state as a periodic heartbeat (see SystemState.h)
+void publishSystemData()
+{
+    updateSystemState(systemStatus, getWiFiRSSI(), millis() / 1000);
+    if (mqttStatus != MQTT_STATE_CONNECTED)
+        return; // changes stay dirty until the session is back
 
-    // Publish system status
-    publishSingleValue(TOPIC_STATUS, "online");
+    uint8_t fields = takeSystemStateChanges();
+    if (fields == 0)
+        return;
 
-    // Publish heater status as "ON" or "OFF"
-    publishSingleValue("esp32/system/heater", systemStatus.heater ? "ON" : "OFF");
+    const SystemStateModel &state = getSystemState();
+    if (fields & STATE_FIELD_BIT(STATE_FIELD_HEATER))
+        publishSingleValue(TOPIC_HEATER, state.heater == HEATER_ON ? "ON" : "OFF");
+    if (fields & STATE_FIELD_BIT(STATE_FIELD_WIFI))
+        publishSingleValue(TOPIC_WIFI_STATE, wifiStateName(state.wifi));
+    if (fields & STATE_FIELD_BIT(STATE_FIELD_MQTT))
+        publishSingleValue(TOPIC_MQTT_STATE, mqttStateName(state.mqtt));
+    if (fields & STATE_FIELD_BIT(STATE_FIELD_FIREBASE))
+        publishSingleValue(TOPIC_FIREBASE_STATE, firebaseStateName(state.firebase));
+    if (fields & STATE_FIELD_BIT(STATE_FIELD_RSSI))
+        publishSingleValue(TOPIC_WIFI_RSSI, (int)state.rssi);
+    if (fields & STATE_FIELD_BIT(STATE_FIELD_UPTIME))
+        publishSingleValue(TOPIC_UPTIME, (int)(millis() / 1000));
+    if (fields == STATE_ALL_FIELDS)
+        publishSingleValue(TOPIC_STATUS, "online");
 }
@@ -5,13 +5,51 @@
 #ifndef MQTTMANAGER_H
 #define MQTTMANAGER_H
 
-#include <WiFiClientSecure.h>
+#include <WiFiClient.h>
 #include <PubSubClient.h>
 #include "config.h"
+#include "Temp.h"
 
 // MQTT Configuration
 #define MQTT_SERVER "ea53fbd1c1a54682b81526905851077b.s1.eu.hivemq.cloud"
 #define MQTT_PORT_TLS 8883
+#define MQTT_PORT_PLAIN 1883
+
+// Set MQTT_USE_TLS to false to talk plain MQTT to MQTT_SERVER
+#ifndef MQTT_USE_TLS
+#define MQTT_USE_TLS true
+#endif
+#if MQTT_USE_TLS
+#define MQTT_PORT MQTT_PORT_TLS
+#else
+#define MQTT_PORT MQTT_PORT_PLAIN
+#endif
+
+// LAN broker, e.g. a Mosquitto container bridged to the cloud broker. When
+// enabled it is preferred (plain MQTT, no cloud round trip or TLS cost); the
+// cloud broker becomes the failover target and the LAN broker is probed
+// periodically so the device switches back once it is reachable again.
+#ifndef MQTT_LAN_ENABLED
+#define MQTT_LAN_ENABLED false
+#endif
+#define MQTT_LAN_SERVER "192.168.1.50"
+#define MQTT_LAN_PORT 1883
+#define MQTT_LAN_USER "" // empty = anonymous
+#define MQTT_LAN_PASSWORD ""
+#define MQTT_LAN_FAILOVER_ATTEMPTS 2  // consecutive LAN failures before using the cloud
+#define MQTT_LAN_PROBE_INTERVAL 60000 // while on the cloud broker
+#define MQTT_LAN_PROBE_TIMEOUT_MS 300
+
+// Reconnect timing
+#define MQTT_BACKOFF_MIN_MS 1000
+#define MQTT_BACKOFF_MAX_MS 120000
+#define MQTT_SUBACK_TIMEOUT_MS 5000
+
+// Keep the TLS session in NVS so even the first connect after a reboot can
+// resume instead of doing a full handshake
+#ifndef MQTT_TLS_PERSIST_SESSION
+#define MQTT_TLS_PERSIST_SESSION true
+#endif
 #define MQTT_USER "ESP32FireBaseTortoise"
 #define MQTT_PASSWORD "ESP32FireBaseHea1951Ter"
 
@@ -27,8 +65,21 @@
 #define TOPIC_STATUS "esp32/system/status"
 #define TOPIC_WIFI_RSSI "esp32/system/wifi_rssi"
 #define TOPIC_UPTIME "esp32/system/uptime"
+#define TOPIC_HEATER "esp32/system/heater"
+#define TOPIC_WIFI_STATE "esp32/system/wifi"
+#define TOPIC_MQTT_STATE "esp32/system/mqtt"
+#define TOPIC_FIREBASE_STATE "esp32/system/firebase"
+#define TOPIC_ENERGY_HOUR "esp32/energy/hour_wh"
+#define TOPIC_ENERGY_TODAY "esp32/energy/today_wh"
+#define TOPIC_ENERGY_MONTH "esp32/energy/month_wh"
+#define TOPIC_ENERGY_TOTAL "esp32/energy/total_wh"
+#define TOPIC_ENERGY_YESTERDAY "esp32/energy/yesterday_wh"
+#define TOPIC_ENERGY_DUTY "esp32/energy/duty_today" // percent of metered time
+#define TOPIC_HISTORY_RESPONSE "esp32/history/response" // see HistoryQuery.h
 
-// Control Topics (ESP32 subscribes to these)
+// Control Topics (ESP32 subscribes to TOPIC_CONTROL_ALL and routes these locally)
+#define TOPIC_CONTROL_ALL "esp32/control/#"
+#define TOPIC_CONTROL_SYNC_PREFIX "esp32/control/_sync/" // + client ID, subscription barrier
 #define TOPIC_CONTROL_SCHEDULE "esp32/control/schedule"
 #define TOPIC_CONTROL_AM_TEMP "esp32/control/schedule/am/temperature"
 #define TOPIC_CONTROL_PM_TEMP "esp32/control/schedule/pm/temperature"
@@ -37,22 +88,49 @@
 #define TOPIC_CONTROL_AM_ENABLED "esp32/control/schedule/am/enabled"
 #define TOPIC_CONTROL_PM_ENABLED "esp32/control/schedule/pm/enabled"
 #define TOPIC_CONTROL_PM_SCHEDULED_TIME "esp32/control/schedule/pm/scheduledTime"
+#define TOPIC_HISTORY_QUERY "esp32/control/history/query"
 #define TOPIC_COMMANDS_STATUS "esp32/commands/status"
 
+// Connection stages (see handleMQTT())
+enum MQTTConnState
+{
+    MQTT_CONN_IDLE,
+    MQTT_CONN_RESOLVE,
+    MQTT_CONN_TLS,
+    MQTT_CONN_CONNECT,
+    MQTT_CONN_SUBSCRIBE,
+    MQTT_CONN_WAIT_SUBACK,
+    MQTT_CONN_READY
+};
+
+enum MQTTBroker
+{
+    MQTT_BROKER_LAN,
+    MQTT_BROKER_CLOUD
+};
+
 // Function declarations
 void initMQTT();
 void handleMQTT();
-void publishSensorData();
+void publishSensorData(); // channels that are due per the MQTT reporter
 void publishSystemData();
+void publishEnergyData(); // counters that changed (plus a heartbeat)
 void publishTimeData();
-bool connectToMQTT();
+MQTTConnState getMQTTConnState();
+unsigned long getMQTTLastConnectMs(); // duration of the last successful connect
+uint32_t getMQTTConnectCount();
+MQTTBroker getMQTTBroker();
+const char *getMQTTBrokerName();
 void onMQTTMessage(char *topic, byte *payload, unsigned int length);
 void parseAndUpdateScheduleJson(const String &jsonMessage);
 MQTTState getMQTTStatus();
+// Queued in the MQTT outbox (see MQTTOutbox.h); safe to call while disconnected
 void publishSingleValue(const char *topic, float value);
 void publishSingleValue(const char *topic, int value);
 void publishSingleValue(const char *topic, const char *value);
-bool checkTemperatureChanges(); // Check if any temperature sensor values have changed
+void publishSingleValue(const char *topic, Temp value); // 1 decimal place, "ERROR" when invalid
+// Bypasses the outbox (no coalescing, no retransmit); for bulk responses
+bool publishDirect(const char *topic, const char *payload);
 
 // Global MQTT status
 extern MQTTState mqttStatus;
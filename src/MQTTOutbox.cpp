@@ -0,0 +1,229 @@
+// ==================================================
+// File: src/MQTTOutbox.cpp
+// ==================================================
+
+#include "MQTTOutbox.h"
+
+enum OutboxSlotState
+{
+    SLOT_FREE,
+    SLOT_QUEUED,
+    SLOT_INFLIGHT
+};
+
+struct OutboxSlot
+{
+    char topic[MQTT_OUTBOX_TOPIC_LEN];
+    char payload[MQTT_OUTBOX_PAYLOAD_LEN];
+    bool retained;
+    OutboxSlotState state;
+    bool newer;     // replaced while in flight - send again after the ack
+    uint32_t order; // first-queued order, oldest goes first
+};
+
+static OutboxSlot slots[MQTT_OUTBOX_SLOTS];
+static OutboxPublishFn publishFn = nullptr;
+static const char *barrierTopic = nullptr;
+static uint32_t nextOrder = 0;
+
+static bool windowOpen = false;
+static uint32_t windowId = 0;
+static unsigned long windowSentAt = 0;
+
+static OutboxStats stats;
+
+// === Helpers ===
+
+static OutboxSlot *findSlot(const char *topic)
+{
+    for (uint8_t i = 0; i < MQTT_OUTBOX_SLOTS; i++)
+    {
+        if (slots[i].state != SLOT_FREE && strcmp(slots[i].topic, topic) == 0)
+            return &slots[i];
+    }
+    return nullptr;
+}
+
+static OutboxSlot *oldestQueued()
+{
+    OutboxSlot *oldest = nullptr;
+    for (uint8_t i = 0; i < MQTT_OUTBOX_SLOTS; i++)
+    {
+        if (slots[i].state == SLOT_QUEUED && (oldest == nullptr || (int32_t)(slots[i].order - oldest->order) < 0))
+            oldest = &slots[i];
+    }
+    return oldest;
+}
+
+// Puts the open window back in the queue
+static uint8_t requeueInflight()
+{
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < MQTT_OUTBOX_SLOTS; i++)
+    {
+        if (slots[i].state == SLOT_INFLIGHT)
+        {
+            slots[i].state = SLOT_QUEUED;
+            slots[i].newer = false;
+            count++;
+        }
+    }
+    windowOpen = false;
+    return count;
+}
+
+// === Public API ===
+
+void initOutbox(OutboxPublishFn publish, const char *topic)
+{
+    publishFn = publish;
+    barrierTopic = topic;
+}
+
+bool outboxEnqueue(const char *topic, const char *payload, bool retained)
+{
+    if (strlen(topic) >= MQTT_OUTBOX_TOPIC_LEN || strlen(payload) >= MQTT_OUTBOX_PAYLOAD_LEN)
+    {
+        stats.dropped++;
+        Serial.print("❌ Outbox: message too long for ");
+        Serial.println(topic);
+        return false;
+    }
+
+    OutboxSlot *slot = findSlot(topic);
+    if (slot)
+    {
+        if (slot->state == SLOT_QUEUED)
+            stats.coalesced++;
+        else if (strcmp(slot->payload, payload) != 0)
+            slot->newer = true;
+    }
+    else
+    {
+        for (uint8_t i = 0; i < MQTT_OUTBOX_SLOTS && slot == nullptr; i++)
+        {
+            if (slots[i].state == SLOT_FREE)
+                slot = &slots[i];
+        }
+        if (slot == nullptr)
+        {
+            stats.dropped++;
+            Serial.print("❌ Outbox full, dropping ");
+            Serial.println(topic);
+            return false;
+        }
+        strcpy(slot->topic, topic);
+        slot->state = SLOT_QUEUED;
+        slot->newer = false;
+        slot->order = nextOrder++;
+    }
+    strcpy(slot->payload, payload);
+    slot->retained = retained;
+    stats.queued++;
+    return true;
+}
+
+void serviceOutbox()
+{
+    if (publishFn == nullptr || barrierTopic == nullptr)
+        return;
+
+    if (windowOpen)
+    {
+        if (millis() - windowSentAt < MQTT_OUTBOX_ACK_TIMEOUT_MS)
+            return;
+        uint8_t count = requeueInflight();
+        stats.retransmits += count;
+        Serial.print("⚠️  Outbox: window not acknowledged, resending ");
+        Serial.print(count);
+        Serial.println(" messages");
+    }
+
+    uint8_t count = 0;
+    OutboxSlot *slot;
+    while (count < MQTT_OUTBOX_WINDOW && (slot = oldestQueued()) != nullptr)
+    {
+        if (!publishFn(slot->topic, slot->payload, slot->retained))
+            break; // stays queued; try again next call
+        slot->state = SLOT_INFLIGHT;
+        slot->newer = false;
+        stats.sent++;
+        count++;
+    }
+    if (count == 0)
+        return;
+
+    char barrier[12];
+    snprintf(barrier, sizeof(barrier), "%c%lu", MQTT_OUTBOX_BARRIER_PREFIX, (unsigned long)++windowId);
+    if (!publishFn(barrierTopic, barrier, false))
+    {
+        requeueInflight();
+        return;
+    }
+    windowOpen = true;
+    windowSentAt = millis();
+}
+
+bool outboxHandleBarrier(const String &message)
+{
+    if (message.length() < 2 || message[0] != MQTT_OUTBOX_BARRIER_PREFIX)
+        return false;
+    if (!windowOpen || (uint32_t)message.substring(1).toInt() != windowId)
+        return true; // stale window, already resent
+
+    for (uint8_t i = 0; i < MQTT_OUTBOX_SLOTS; i++)
+    {
+        OutboxSlot &slot = slots[i];
+        if (slot.state != SLOT_INFLIGHT)
+            continue;
+        stats.delivered++;
+        if (slot.newer)
+        {
+            slot.state = SLOT_QUEUED; // a newer value arrived meanwhile
+            slot.newer = false;
+        }
+        else
+        {
+            slot.state = SLOT_FREE;
+        }
+    }
+    windowOpen = false;
+    return true;
+}
+
+void outboxConnectionLost()
+{
+    stats.retransmits += requeueInflight();
+}
+
+uint8_t getOutboxDepth()
+{
+    uint8_t depth = 0;
+    for (uint8_t i = 0; i < MQTT_OUTBOX_SLOTS; i++)
+    {
+        if (slots[i].state != SLOT_FREE)
+            depth++;
+    }
+    return depth;
+}
+
+OutboxStats getOutboxStats()
+{
+    return stats;
+}
+
+void printOutboxStats()
+{
+    Serial.print("MQTT outbox: ");
+    Serial.print(getOutboxDepth());
+    Serial.print(" waiting, sent ");
+    Serial.print(stats.sent);
+    Serial.print(", delivered ");
+    Serial.print(stats.delivered);
+    Serial.print(", coalesced ");
+    Serial.print(stats.coalesced);
+    Serial.print(", retransmitted ");
+    Serial.print(stats.retransmits);
+    Serial.print(", dropped ");
+    Serial.println(stats.dropped);
+}
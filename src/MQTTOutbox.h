@@ -0,0 +1,47 @@
+// ==================================================
+// File: src/MQTTOutbox.h
+// ==================================================
+//
+// Outbound MQTT publish queue with at-least-once delivery to the broker.
+//
+// Only the latest value per topic is kept: queuing a topic that is already
+// waiting overwrites its payload, so a flapping value costs one publish, not
+// one per change. Queued messages are sent in windows of at most
+// MQTT_OUTBOX_WINDOW; each window is closed by a barrier message on the
+// device's private sync topic. The broker processes a client's packets in
+// order, so when the barrier comes back every message of the window has been
+// accepted - an acknowledgement for the whole window. Windows that are not
+// acknowledged in time, or that were in flight when the connection dropped,
+// are sent again.
+
+#pragma once
+#include <Arduino.h>
+
+#define MQTT_OUTBOX_SLOTS 24
+#define MQTT_OUTBOX_TOPIC_LEN 48
+#define MQTT_OUTBOX_PAYLOAD_LEN 32
+#define MQTT_OUTBOX_WINDOW 8            // messages in flight per barrier
+#define MQTT_OUTBOX_ACK_TIMEOUT_MS 5000 // resend the window after this
+#define MQTT_OUTBOX_BARRIER_PREFIX 'p'  // tells window barriers from the SUBACK barrier
+
+typedef bool (*OutboxPublishFn)(const char *topic, const char *payload, bool retained);
+
+struct OutboxStats
+{
+    uint32_t queued;     // outboxEnqueue() calls accepted
+    uint32_t coalesced;  // ... that replaced a value still waiting
+    uint32_t sent;       // PUBLISH packets written, including retransmits
+    uint32_t delivered;  // acknowledged by a barrier
+    uint32_t retransmits;
+    uint32_t dropped;    // queue full or oversized
+};
+
+// Function declarations
+void initOutbox(OutboxPublishFn publish, const char *barrierTopic);
+bool outboxEnqueue(const char *topic, const char *payload, bool retained = false);
+void serviceOutbox();                           // call while the session is up
+bool outboxHandleBarrier(const String &message); // true if it was ours
+void outboxConnectionLost();
+uint8_t getOutboxDepth();
+OutboxStats getOutboxStats();
+void printOutboxStats();
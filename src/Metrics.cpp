@@ -0,0 +1,182 @@
+// ==================================================
+// File: src/Metrics.cpp
+// ==================================================
+
+#include "Metrics.h"
+#include "HttpServer.h"
+#include "config.h"
+#include "TemperatureSensors.h"
+#include "WiFiManagerCustom.h"
+#include "MQTTManager.h"
+#include "MQTTOutbox.h"
+#include "NetClientPool.h"
+#include "TopicRouter.h"
+#include "Scheduler.h"
+#include "PowerManager.h"
+#include "EnergyMeter.h"
+#include "FirebaseService.h"
+#include "Presence.h"
+#include "SystemState.h"
+#include "TimeManager.h"
+
+extern SystemStatus systemStatus;
+
+static const char *const sensorNames[] = {"red", "blue", "green"};
+
+// === Formatting helpers ===
+
+// "21.50", or `invalid` when there is no reading
+static void printTemp(HttpResponse &res, Temp t, const char *invalid)
+{
+    if (!t.isValid())
+    {
+        res.print(invalid);
+        return;
+    }
+    int c = t.centi;
+    res.printf("%s%d.%02d", c < 0 ? "-" : "", abs(c) / 100, abs(c) % 100);
+}
+
+static void metricHeader(HttpResponse &res, const char *name, const char *type, const char *help)
+{
+    res.printf("# HELP " METRICS_PREFIX "%s %s\n# TYPE " METRICS_PREFIX "%s %s\n", name, help, name, type);
+}
+
+static void metric(HttpResponse &res, const char *name, const char *type, const char *help, unsigned long value)
+{
+    metricHeader(res, name, type, help);
+    res.printf(METRICS_PREFIX "%s %lu\n", name, value);
+}
+
+// === /metrics ===
+
+static void handleMetrics(const HttpRequest &req, HttpResponse &res)
+{
+    res.contentType = "text/plain; version=0.0.4";
+
+    metricHeader(res, "temperature_celsius", "gauge", "Enclosure temperature per sensor");
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        res.printf(METRICS_PREFIX "temperature_celsius{sensor=\"%s\"} ", sensorNames[i]);
+        printTemp(res, getLastTemperature(i), "NaN");
+        res.print("\n");
+    }
+
+    metricHeader(res, "heater_current_amps", "gauge", "Heater Irms at the last measurement");
+    res.printf(METRICS_PREFIX "heater_current_amps %.3f\n", getHeaterCurrent());
+    metric(res, "heater_on", "gauge", "Relay state (1 = on)", systemStatus.heater == HEATER_ON);
+
+    const EnergyTotals &energy = getEnergyTotals();
+    metric(res, "energy_wh_total", "counter", "Heater energy since the meter was reset", energy.totalWh);
+    metric(res, "heater_on_seconds_total", "counter", "Relay on-time since the meter was reset", energy.totalOnS);
+    metric(res, "energy_today_wh", "gauge", "Heater energy today", getEnergyWh(energy.day));
+    metricHeader(res, "duty_today_ratio", "gauge", "Relay on-time today over metered time");
+    res.printf(METRICS_PREFIX "duty_today_ratio %.3f\n", getDutyPermille(energy.day) / 1000.0f);
+
+    // Per-job timing; the jobs are the phases of the main loop
+    metricHeader(res, "job_runs_total", "counter", "Scheduler job runs");
+    for (int id = 0; id < SCHED_MAX_JOBS; id++)
+    {
+        const JobStats *s = getJobStats(id);
+        if (s)
+            res.printf(METRICS_PREFIX "job_runs_total{job=\"%s\"} %lu\n", getJobName(id), (unsigned long)s->runs);
+    }
+    metricHeader(res, "job_run_seconds_total", "counter", "Time spent inside each job");
+    for (int id = 0; id < SCHED_MAX_JOBS; id++)
+    {
+        const JobStats *s = getJobStats(id);
+        if (s)
+            res.printf(METRICS_PREFIX "job_run_seconds_total{job=\"%s\"} %lu.%03lu\n", getJobName(id),
+                       (unsigned long)(s->totalRunMs / 1000), (unsigned long)(s->totalRunMs % 1000));
+    }
+    metricHeader(res, "job_max_run_seconds", "gauge", "Longest single run of each job");
+    for (int id = 0; id < SCHED_MAX_JOBS; id++)
+    {
+        const JobStats *s = getJobStats(id);
+        if (s)
+            res.printf(METRICS_PREFIX "job_max_run_seconds{job=\"%s\"} %lu.%03lu\n", getJobName(id),
+                       (unsigned long)(s->maxRunMs / 1000), (unsigned long)(s->maxRunMs % 1000));
+    }
+    metricHeader(res, "job_late_seconds_total", "counter", "Sum of start delays past each deadline");
+    for (int id = 0; id < SCHED_MAX_JOBS; id++)
+    {
+        const JobStats *s = getJobStats(id);
+        if (s)
+            res.printf(METRICS_PREFIX "job_late_seconds_total{job=\"%s\"} %lu.%03lu\n", getJobName(id),
+                       (unsigned long)(s->totalLateMs / 1000), (unsigned long)(s->totalLateMs % 1000));
+    }
+
+    metric(res, "heap_free_bytes", "gauge", "Free heap", ESP.getFreeHeap());
+    metric(res, "heap_min_free_bytes", "gauge", "Lowest free heap since boot", ESP.getMinFreeHeap());
+    metric(res, "heap_max_alloc_bytes", "gauge", "Largest free heap block", ESP.getMaxAllocHeap());
+    metric(res, "uptime_seconds", "counter", "Seconds since boot", millis() / 1000);
+
+    ClockStats clock = getClockStats();
+    metric(res, "clock_synced", "gauge", "Clock disciplined by NTP", clock.synced);
+    metricHeader(res, "clock_drift_ppm", "gauge", "Oscillator rate correction");
+    res.printf(METRICS_PREFIX "clock_drift_ppm %.3f\n", clock.driftPpb / 1000.0f);
+    metricHeader(res, "clock_offset_ms", "gauge", "NTP minus clock at the last sample");
+    res.printf(METRICS_PREFIX "clock_offset_ms %ld\n", (long)clock.lastOffsetMs);
+    metric(res, "clock_ntp_samples_total", "counter", "NTP samples applied", clock.samples);
+    metric(res, "clock_steps_total", "counter", "NTP samples that stepped the clock", clock.steps);
+    metric(res, "clock_sample_age_seconds", "gauge", "Time since the last NTP sample", clock.lastSampleAgeS);
+    metric(res, "awake_percent", "gauge", "CPU awake share since boot", getAwakePercent());
+
+    metric(res, "wifi_connected", "gauge", "WiFi station connected", isWiFiConnected());
+    metricHeader(res, "wifi_rssi_dbm", "gauge", "WiFi signal strength");
+    res.printf(METRICS_PREFIX "wifi_rssi_dbm %ld\n", getWiFiRSSI());
+    metric(res, "wifi_reconnects_total", "counter", "WiFi reconnects", getWiFiReconnectCount());
+    metric(res, "mqtt_connected", "gauge", "MQTT session ready", getMQTTConnState() == MQTT_CONN_READY);
+    metric(res, "mqtt_connects_total", "counter", "MQTT sessions established", getMQTTConnectCount());
+    metric(res, "mqtt_last_connect_seconds", "gauge", "Duration of the last MQTT connect", getMQTTLastConnectMs() / 1000);
+    metric(res, "mqtt_duplicates_total", "counter", "Duplicate MQTT messages suppressed", getDuplicateMessageCount());
+    metric(res, "firebase_connected", "gauge", "Firebase ready", systemStatus.firebase == FB_CONNECTED);
+    unsigned long fbReadyMs = getFirebaseReadyMs();
+    metricHeader(res, "firebase_ready_seconds", "gauge", "WiFi-ready to Firebase-ready of the last initialization");
+    res.printf(METRICS_PREFIX "firebase_ready_seconds %lu.%03lu\n", fbReadyMs / 1000, fbReadyMs % 1000);
+    const PresenceStats &presence = getPresenceStats();
+    metric(res, "presence_heartbeats_total", "counter", "Firebase presence updates of their own", presence.heartbeats);
+    metric(res, "presence_piggybacked_total", "counter", "Presence carried by sensor pushes", presence.piggybacked);
+
+    OutboxStats outbox = getOutboxStats();
+    metric(res, "outbox_depth", "gauge", "MQTT messages waiting", getOutboxDepth());
+    metric(res, "outbox_sent_total", "counter", "MQTT publishes written", outbox.sent);
+    metric(res, "outbox_dropped_total", "counter", "MQTT messages dropped", outbox.dropped);
+    metric(res, "tls_contexts_open", "gauge", "Open TLS connections", getOpenTlsContexts());
+    metric(res, "http_requests_total", "counter", "HTTP requests served", getHttpRequestCount());
+    metric(res, "http_streams_open", "gauge", "Open /api/events streams", getHttpStreamCount());
+}
+
+// === /status ===
+
+static void handleStatus(const HttpRequest &req, HttpResponse &res)
+{
+    res.contentType = "application/json";
+    const EnergyTotals &energy = getEnergyTotals();
+
+    res.printf("{\"uptime_s\":%lu,\"time\":%lu,\"heater\":\"%s\",\"current_a\":%.2f,\"temperatures\":{",
+               millis() / 1000, (unsigned long)getEpochTime(),
+               systemStatus.heater == HEATER_ON ? "on" : "off", getHeaterCurrent());
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        res.printf("%s\"%s\":", i ? "," : "", sensorNames[i]);
+        printTemp(res, getLastTemperature(i), "null");
+    }
+    res.printf("},\"energy\":{\"today_wh\":%lu,\"month_wh\":%lu,\"total_wh\":%lu,\"duty_today_pct\":%.1f}",
+               (unsigned long)getEnergyWh(energy.day), (unsigned long)getEnergyWh(energy.month),
+               (unsigned long)energy.totalWh, getDutyPermille(energy.day) / 10.0f);
+    res.printf(",\"wifi\":{\"state\":\"%s\",\"rssi\":%ld,\"reconnects\":%lu}",
+               wifiStateName(systemStatus.wifi), getWiFiRSSI(), (unsigned long)getWiFiReconnectCount());
+    res.printf(",\"mqtt\":{\"state\":\"%s\",\"broker\":\"%s\",\"connects\":%lu,\"outbox\":%u}",
+               mqttStateName(systemStatus.mqtt), getMQTTBrokerName(), (unsigned long)getMQTTConnectCount(),
+               getOutboxDepth());
+    res.printf(",\"firebase\":\"%s\",\"heap\":{\"free\":%lu,\"min_free\":%lu,\"largest\":%lu}}\n",
+               firebaseStateName(systemStatus.firebase), (unsigned long)ESP.getFreeHeap(),
+               (unsigned long)ESP.getMinFreeHeap(), (unsigned long)ESP.getMaxAllocHeap());
+}
+
+void initMetrics()
+{
+    addHttpRoute("GET", "/metrics", handleMetrics);
+    addHttpRoute("GET", "/status", handleStatus);
+}
@@ -0,0 +1,18 @@
+// ==================================================
+// File: src/Metrics.h
+// ==================================================
+//
+// Device endpoints on the HTTP server (HttpServer.h):
+//   GET /metrics  Prometheus text format - temperatures, heater current and
+//                 relay state, energy, scheduler job timings, heap, RSSI,
+//                 reconnect counters, queue depths
+//   GET /status   the same at a glance, as JSON
+// Both are formatted straight into the server's response buffer.
+
+#pragma once
+#include <Arduino.h>
+
+#define METRICS_PREFIX "heater_"
+
+// Function declarations
+void initMetrics(); // registers the routes
@@ -0,0 +1,199 @@
+// ==================================================
+// File: src/NetClientPool.cpp
+// ==================================================
+
+#include "NetClientPool.h"
+
+enum TlsSlotState
+{
+    TLS_CLOSED,
+    TLS_IDLE,  // connection open, nobody using it
+    TLS_ACTIVE // inside acquireTls()/releaseTls()
+};
+
+struct NetClient
+{
+    const char *name;
+    bool resident;
+    TlsCloseFn close;
+    TlsSlotState state;
+    uint8_t depth; // nested leases by the same client
+    unsigned long idleSince;
+    NetClientStats stats;
+};
+
+static NetClient clients[NET_CLIENT_COUNT];
+
+// === Helpers ===
+
+static void closeClient(NetClient &c)
+{
+    if (c.state == TLS_CLOSED)
+        return;
+    if (c.close)
+        c.close();
+    c.state = TLS_CLOSED;
+    c.depth = 0;
+}
+
+static bool heapAllowsNewContext()
+{
+    return ESP.getFreeHeap() >= TLS_CONTEXT_HEAP_COST + NET_HEAP_RESERVE &&
+           ESP.getMaxAllocHeap() >= NET_MIN_CONTIGUOUS;
+}
+
+// Closes idle contexts (shared ones first) until a new one fits
+static bool makeRoom(NetClientId requester)
+{
+    for (int pass = 0; pass < 2 && !heapAllowsNewContext(); pass++)
+    {
+        for (int i = 0; i < NET_CLIENT_COUNT && !heapAllowsNewContext(); i++)
+        {
+            NetClient &c = clients[i];
+            if (i == requester || c.state != TLS_IDLE || (pass == 0 && c.resident))
+                continue;
+            Serial.print("♻️  Closing idle TLS connection: ");
+            Serial.println(c.name);
+            closeClient(c);
+            c.stats.evictions++;
+        }
+    }
+    return heapAllowsNewContext();
+}
+
+// === Public API ===
+
+void registerNetClient(NetClientId id, const char *name, bool resident, TlsCloseFn close)
+{
+    NetClient &c = clients[id];
+    c.name = name;
+    c.resident = resident;
+    c.close = close; // state is kept, so re-registering is harmless
+}
+
+bool acquireTls(NetClientId id)
+{
+    NetClient &c = clients[id];
+    if (c.state == TLS_ACTIVE)
+    {
+        c.depth++;
+        return true;
+    }
+    if (c.state == TLS_IDLE)
+    {
+        c.state = TLS_ACTIVE; // reuse the open connection
+        c.depth = 1;
+        return true;
+    }
+
+    // Shared clients take turns on one slot
+    if (!c.resident)
+    {
+        for (int i = 0; i < NET_CLIENT_COUNT; i++)
+        {
+            NetClient &other = clients[i];
+            if (i == id || other.resident || other.state == TLS_CLOSED)
+                continue;
+            if (other.state == TLS_ACTIVE)
+            {
+                c.stats.denials++;
+                return false;
+            }
+            closeClient(other);
+            other.stats.evictions++;
+        }
+    }
+
+    if (!makeRoom(id))
+    {
+        c.stats.denials++;
+        Serial.print("⚠️  TLS budget: not enough heap for ");
+        Serial.print(c.name);
+        Serial.print(" (free ");
+        Serial.print(ESP.getFreeHeap());
+        Serial.print(", largest block ");
+        Serial.print(ESP.getMaxAllocHeap());
+        Serial.println(")");
+        return false;
+    }
+
+    c.state = TLS_ACTIVE;
+    c.depth = 1;
+    c.stats.grants++;
+    return true;
+}
+
+void releaseTls(NetClientId id)
+{
+    NetClient &c = clients[id];
+    if (c.state != TLS_ACTIVE)
+        return;
+    if (--c.depth > 0)
+        return;
+    c.state = TLS_IDLE;
+    c.idleSince = millis();
+}
+
+void tlsClosed(NetClientId id)
+{
+    clients[id].state = TLS_CLOSED;
+    clients[id].depth = 0;
+}
+
+// Closes shared connections that have been idle too long; runs as a job
+void handleNetClientPool()
+{
+    bool lowHeap = ESP.getFreeHeap() < NET_HEAP_RESERVE;
+    for (int i = 0; i < NET_CLIENT_COUNT; i++)
+    {
+        NetClient &c = clients[i];
+        if (c.resident || c.state != TLS_IDLE)
+            continue;
+        if (lowHeap || millis() - c.idleSince > NET_TLS_IDLE_CLOSE_MS)
+        {
+            closeClient(c);
+            if (lowHeap)
+                c.stats.evictions++;
+        }
+    }
+}
+
+uint8_t getOpenTlsContexts()
+{
+    uint8_t open = 0;
+    for (int i = 0; i < NET_CLIENT_COUNT; i++)
+    {
+        if (clients[i].state != TLS_CLOSED)
+            open++;
+    }
+    return open;
+}
+
+NetClientStats getNetClientStats(NetClientId id)
+{
+    return clients[id].stats;
+}
+
+void printNetClientPoolStats()
+{
+    Serial.print("TLS contexts open: ");
+    Serial.print(getOpenTlsContexts());
+    Serial.print(" (largest free block ");
+    Serial.print(ESP.getMaxAllocHeap());
+    Serial.println(" bytes)");
+    for (int i = 0; i < NET_CLIENT_COUNT; i++)
+    {
+        const NetClient &c = clients[i];
+        if (c.name == nullptr)
+            continue;
+        Serial.print("  ");
+        Serial.print(c.name);
+        Serial.print(c.state == TLS_CLOSED ? ": closed" : (c.state == TLS_IDLE ? ": idle" : ": active"));
+        Serial.print(", opened ");
+        Serial.print(c.stats.grants);
+        Serial.print(", denied ");
+        Serial.print(c.stats.denials);
+        Serial.print(", evicted ");
+        Serial.println(c.stats.evictions);
+    }
+}
@@ -0,0 +1,72 @@
+// ==================================================
+// File: src/NetClientPool.h
+// ==================================================
+//
+// Heap budget for TLS contexts. Every TLS connection costs roughly
+// TLS_CONTEXT_HEAP_COST bytes (mbedTLS record buffers, certificate chain,
+// handshake state). MQTT is "resident" and keeps its own context; the
+// short-lived HTTPS clients (Firebase REST, SMTP alerts) share a single
+// slot, so at most one of them holds a context at any time.
+//
+// A shared client takes the slot with acquireTls() for the duration of a
+// burst of requests and gives it back with releaseTls(). The connection stays
+// open after release (so back-to-back bursts reuse it) until another shared
+// client needs the slot, the heap runs low, or it has been idle for
+// NET_TLS_IDLE_CLOSE_MS - then its release callback closes it.
+
+#pragma once
+#include <Arduino.h>
+
+#define TLS_CONTEXT_HEAP_COST 40000 // per open TLS connection, measured on core 2.x
+#define NET_HEAP_RESERVE 24000      // kept free for everything that isn't TLS
+#define NET_MIN_CONTIGUOUS 17000    // mbedTLS allocates its 16 KB input buffer in one piece
+#define NET_TLS_IDLE_CLOSE_MS 15000
+
+enum NetClientId
+{
+    NET_CLIENT_MQTT,     // resident
+    NET_CLIENT_FIREBASE, // shared HTTPS slot
+    NET_CLIENT_SMTP,     // shared HTTPS slot
+    NET_CLIENT_COUNT
+};
+
+// Closes the client's TLS connection (frees its context)
+typedef void (*TlsCloseFn)();
+
+struct NetClientStats
+{
+    uint32_t grants;    // acquireTls() calls that succeeded with a new context
+    uint32_t denials;   // refused: slot busy or not enough heap
+    uint32_t evictions; // idle context closed for someone else / low heap
+};
+
+// Function declarations
+void registerNetClient(NetClientId id, const char *name, bool resident, TlsCloseFn close);
+bool acquireTls(NetClientId id);
+void releaseTls(NetClientId id);
+void tlsClosed(NetClientId id); // the client dropped its connection by itself
+void handleNetClientPool();
+uint8_t getOpenTlsContexts();
+NetClientStats getNetClientStats(NetClientId id);
+void printNetClientPoolStats();
+
+// Holds the client's TLS slot for one burst of requests:
+//   TlsLease lease(NET_CLIENT_FIREBASE);
+//   if (!lease) return;
+class TlsLease
+{
+public:
+    explicit TlsLease(NetClientId id) : id(id), held(acquireTls(id)) {}
+    ~TlsLease()
+    {
+        if (held)
+            releaseTls(id);
+    }
+    explicit operator bool() const { return held; }
+
+private:
+    TlsLease(const TlsLease &);
+    TlsLease &operator=(const TlsLease &);
+    NetClientId id;
+    bool held;
+};
@@ -0,0 +1,125 @@
+// ==================================================
+// File: src/PowerManager.cpp
+// ==================================================
+
+#include "PowerManager.h"
+#include <WiFi.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+#include <esp_pm.h>
+
+static int64_t statsStartUs = 0;
+static uint64_t idleUs = 0;
+static uint64_t asleepUs = 0;
+static uint32_t idlePeriods = 0;
+static bool lightSleepEnabled = false;
+static bool modemSleepEnabled = false;
+
+void initPowerManager()
+{
+    statsStartUs = esp_timer_get_time();
+    idleUs = 0;
+    asleepUs = 0;
+    idlePeriods = 0;
+
+    if (!POWER_SAVE_ENABLED)
+    {
+        Serial.println("⚡ Power save disabled - running at full speed");
+        return;
+    }
+
+    Serial.println("Initializing power management...");
+
+#if CONFIG_PM_ENABLE
+    // Dynamic frequency scaling between POWER_MIN_CPU_MHZ and POWER_MAX_CPU_MHZ;
+    // with tickless idle the core also enters light sleep whenever every task
+    // is blocked, waking on the next FreeRTOS timeout or on WiFi/RTC events
+    esp_pm_config_esp32_t pmConfig;
+    pmConfig.max_freq_mhz = POWER_MAX_CPU_MHZ;
+    pmConfig.min_freq_mhz = POWER_MIN_CPU_MHZ;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    pmConfig.light_sleep_enable = true;
+#else
+    pmConfig.light_sleep_enable = false;
+#endif
+    esp_err_t err = esp_pm_configure(&pmConfig);
+    if (err == ESP_OK)
+    {
+        lightSleepEnabled = pmConfig.light_sleep_enable;
+        Serial.print("✅ Power management configured, automatic light sleep: ");
+        Serial.println(lightSleepEnabled ? "ON" : "OFF (tickless idle not built in)");
+    }
+    else
+    {
+        Serial.print("⚠️  esp_pm_configure failed, staying at full clock: ");
+        Serial.println(esp_err_to_name(err));
+    }
+#else
+    // No power management in this core build. A fixed low clock would also
+    // slow the busy work (TLS handshakes), so stay at full speed and rely on
+    // modem sleep
+    Serial.println("⚡ Light sleep and frequency scaling not available in this build");
+#endif
+
+    applyWiFiPowerSave();
+}
+
+void applyWiFiPowerSave()
+{
+    if (!POWER_SAVE_ENABLED)
+        return;
+
+    // Minimum modem sleep: the radio wakes for every DTIM beacon, so the AP
+    // keeps buffered frames for us and the MQTT keepalive stays intact
+    modemSleepEnabled = (esp_wifi_set_ps(WIFI_PS_MIN_MODEM) == ESP_OK);
+    if (!modemSleepEnabled)
+    {
+        Serial.println("⚠️  WiFi modem sleep could not be enabled");
+    }
+}
+
+void powerIdle(unsigned long ms)
+{
+    int64_t start = esp_timer_get_time();
+    delay(ms); // blocks this task; the idle task may light-sleep until the timeout
+    uint64_t elapsedUs = esp_timer_get_time() - start;
+    idleUs += elapsedUs;
+    if (lightSleepEnabled)
+        asleepUs += elapsedUs; // without light sleep the CPU just runs the idle task
+    idlePeriods++;
+}
+
+PowerStats getPowerStats()
+{
+    PowerStats stats;
+    uint64_t totalUs = esp_timer_get_time() - statsStartUs;
+    stats.idleUs = idleUs;
+    stats.asleepUs = asleepUs;
+    stats.awakeUs = totalUs > asleepUs ? totalUs - asleepUs : 0;
+    stats.idlePeriods = idlePeriods;
+    stats.lightSleepEnabled = lightSleepEnabled;
+    stats.modemSleepEnabled = modemSleepEnabled;
+    return stats;
+}
+
+uint8_t getAwakePercent()
+{
+    PowerStats stats = getPowerStats();
+    uint64_t totalUs = stats.awakeUs + stats.asleepUs;
+    if (totalUs == 0)
+        return 100;
+    return (uint8_t)((stats.awakeUs * 100) / totalUs);
+}
+
+void printPowerStats()
+{
+    PowerStats stats = getPowerStats();
+    Serial.printf("⚡ Power: awake %lus, asleep %lus (%u%% awake), idle %lus in %lu periods, light sleep %s, modem sleep %s\n",
+                  (unsigned long)(stats.awakeUs / 1000000ULL),
+                  (unsigned long)(stats.asleepUs / 1000000ULL),
+                  getAwakePercent(),
+                  (unsigned long)(stats.idleUs / 1000000ULL),
+                  (unsigned long)stats.idlePeriods,
+                  stats.lightSleepEnabled ? "ON" : "OFF",
+                  stats.modemSleepEnabled ? "ON" : "OFF");
+}
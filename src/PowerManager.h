@@ -0,0 +1,35 @@
+// ==================================================
+// File: src/PowerManager.h
+// ==================================================
+//
+// Power-save mode: DTIM-based WiFi modem sleep plus automatic light sleep
+// (when the core was built with power management / tickless idle), so the
+// CPU sleeps between scheduler deadlines; without power management the CPU
+// stays at full clock. The scheduler idles through powerIdle(), which is
+// also where awake/asleep time is measured.
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+// Time accounting since initPowerManager(). "Idle" is time the scheduler
+// spent waiting for its next deadline; it counts as "asleep" only when
+// automatic light sleep is enabled, since otherwise the CPU keeps running.
+// Everything that is not asleep counts as awake.
+struct PowerStats
+{
+    uint64_t awakeUs;
+    uint64_t asleepUs;
+    uint64_t idleUs;
+    uint32_t idlePeriods;
+    bool lightSleepEnabled; // automatic light sleep configured successfully
+    bool modemSleepEnabled; // WiFi modem sleep active
+};
+
+// Function declarations
+void initPowerManager();
+void applyWiFiPowerSave(); // call again after (re)connecting WiFi
+void powerIdle(unsigned long ms);
+PowerStats getPowerStats();
+uint8_t getAwakePercent();
+void printPowerStats();
@@ -0,0 +1,85 @@
+// ==================================================
+// File: src/Presence.cpp
+// ==================================================
+
+#include "Presence.h"
+#include "FirebaseService.h"
+#include "MQTTManager.h"
+#include "NetClientPool.h"
+
+#define PRESENCE_PATH "system/device_status/"
+
+static bool written = false;     // since Firebase (re)connected
+static bool writtenMqtt = false; // "mqtt" as last written
+static bool pendingMqtt = false; // "mqtt" in the update being sent
+static unsigned long lastWriteMs = 0;
+static PresenceStats stats = {};
+
+static bool mqttLive()
+{
+    return getMQTTConnState() == MQTT_CONN_READY;
+}
+
+static unsigned long heartbeatMs()
+{
+    return mqttLive() ? PRESENCE_HEARTBEAT_SLOW_MS : PRESENCE_HEARTBEAT_FAST_MS;
+}
+
+void resetPresence()
+{
+    written = false;
+}
+
+void addPresenceFields(String &body)
+{
+    pendingMqtt = mqttLive();
+    addFirebaseUpdate(body, PRESENCE_PATH "status", "\"online\"");
+    addFirebaseUpdate(body, PRESENCE_PATH "last_seen", "{\".sv\":\"timestamp\"}");
+    addFirebaseUpdate(body, PRESENCE_PATH "heartbeat_s", String(heartbeatMs() / 1000));
+    addFirebaseUpdate(body, PRESENCE_PATH "mqtt", pendingMqtt ? "true" : "false");
+    addFirebaseUpdate(body, "system/status", "\"online\"");
+    addFirebaseUpdate(body, "system/last_update", "{\".sv\":\"timestamp\"}");
+}
+
+void presenceWritten(bool piggybacked)
+{
+    if (!written)
+        Serial.println("🟢 Firebase presence: online");
+    written = true;
+    writtenMqtt = pendingMqtt;
+    lastWriteMs = millis();
+    if (piggybacked)
+        stats.piggybacked++;
+    else
+        stats.heartbeats++;
+}
+
+void maintainPresence()
+{
+    // A change of the MQTT link changes what readers should rely on (and
+    // the promised heartbeat), so it is written straight away
+    bool due = !written || mqttLive() != writtenMqtt || millis() - lastWriteMs >= heartbeatMs();
+    if (!due)
+        return;
+
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
+
+    String body;
+    addPresenceFields(body);
+    if (sendFirebaseUpdate("/", body))
+    {
+        presenceWritten(false);
+    }
+    else
+    {
+        Serial.print("❌ Presence update failed: ");
+        Serial.println(fbData.errorReason());
+    }
+}
+
+const PresenceStats &getPresenceStats()
+{
+    return stats;
+}
@@ -0,0 +1,44 @@
+// ==================================================
+// File: src/Presence.h
+// ==================================================
+//
+// Device presence for Firebase readers without a "still alive" write every
+// sync cycle.
+//
+// The MQTT session is the long-lived connection: its retained LWT flips
+// esp32/system/status to "offline" as soon as the broker loses the device.
+// The RTDB REST API has no onDisconnect, and a second resident TLS stream
+// would not fit the heap budget (NetClientPool.h), so Firebase gets a record
+// at /system/device_status instead:
+//   status        "online"
+//   last_seen     server timestamp (ms since epoch, set by Firebase)
+//   heartbeat_s   the next last_seen is due within this; readers treat the
+//                 device as offline after about twice that
+//   mqtt          whether the MQTT LWT is live, i.e. esp32/system/status can
+//                 be trusted for real-time presence
+// /system/status and /system/last_update are kept up to date alongside.
+//
+// The heartbeat adapts: PRESENCE_HEARTBEAT_FAST_MS while MQTT is down and
+// Firebase is the only presence signal, PRESENCE_HEARTBEAT_SLOW_MS while it
+// is up. Sensor pushes carry the record in the same multi-path update, so a
+// heartbeat only costs a request of its own when nothing else was written
+// for a whole period.
+
+#pragma once
+#include <Arduino.h>
+
+#define PRESENCE_HEARTBEAT_FAST_MS 60000  // MQTT down
+#define PRESENCE_HEARTBEAT_SLOW_MS 600000 // MQTT up, its LWT covers drops
+
+struct PresenceStats
+{
+    uint32_t heartbeats;  // updates of their own
+    uint32_t piggybacked; // carried by another update
+};
+
+// Function declarations
+void resetPresence();                 // Firebase (re)connected: write the record on the next chance
+void addPresenceFields(String &body); // into a multi-path update of the root node
+void presenceWritten(bool piggybacked);
+void maintainPresence();              // from the Firebase sync job; writes only when due
+const PresenceStats &getPresenceStats();
@@ -0,0 +1,56 @@
+// ==================================================
+// File: src/Reporter.cpp
+// ==================================================
+
+#include "Reporter.h"
+
+// Sensors move slowly; MQTT drives the live dashboard, Firebase stores
+// whole degrees and costs an HTTPS request per write
+#define SENSOR_MQTT_POLICY {10, 5000, 300000}      // 0.1 °C, <= 1 per 5 s, heartbeat 5 min
+#define SENSOR_FIREBASE_POLICY {100, 60000, 900000} // 1.0 °C, <= 1 per min, heartbeat 15 min
+
+static const ReportPolicy policies[REPORT_CHANNEL_COUNT][REPORT_SINK_COUNT] = {
+    {SENSOR_MQTT_POLICY, SENSOR_FIREBASE_POLICY}, // red
+    {SENSOR_MQTT_POLICY, SENSOR_FIREBASE_POLICY}, // blue
+    {SENSOR_MQTT_POLICY, SENSOR_FIREBASE_POLICY}, // green
+    {SENSOR_MQTT_POLICY, SENSOR_FIREBASE_POLICY}, // average
+    {{10, 0, 300000}, {10, 0, 300000}},            // target: every change, resync every 5 min
+};
+
+struct ReportState
+{
+    Temp value;
+    unsigned long at;
+    bool reported;
+};
+
+static ReportState states[REPORT_CHANNEL_COUNT][REPORT_SINK_COUNT];
+
+bool reportDue(ReportChannel channel, ReportSink sink, Temp value)
+{
+    const ReportPolicy &policy = policies[channel][sink];
+    const ReportState &state = states[channel][sink];
+    if (!state.reported)
+        return true;
+
+    unsigned long since = millis() - state.at;
+    if (since >= policy.maxSilenceMs)
+        return true;
+    if (since < policy.minIntervalMs)
+        return false;
+    return value.changedFrom(state.value, policy.deadbandCenti);
+}
+
+void markReported(ReportChannel channel, ReportSink sink, Temp value)
+{
+    ReportState &state = states[channel][sink];
+    state.value = value;
+    state.at = millis();
+    state.reported = true;
+}
+
+Temp lastReported(ReportChannel channel, ReportSink sink)
+{
+    const ReportState &state = states[channel][sink];
+    return state.reported ? state.value : Temp::invalid();
+}
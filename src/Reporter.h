@@ -0,0 +1,46 @@
+// ==================================================
+// File: src/Reporter.h
+// ==================================================
+//
+// Shared change detection for telemetry. Each channel (sensor, target, ...)
+// keeps separate state per sink (MQTT, Firebase), so one sink reporting a
+// value never hides the change from the other. A value is due when:
+//   - it moved by more than the channel's deadband, or became valid/invalid,
+//   - and at least minIntervalMs passed since the last report (rate limit;
+//     the change stays due and goes out once the interval has elapsed),
+//   - or maxSilenceMs passed without a report (heartbeat).
+// Publishers call reportDue() and, after the value was actually sent,
+// markReported().
+
+#pragma once
+#include <Arduino.h>
+#include "Temp.h"
+
+enum ReportSink
+{
+    REPORT_SINK_MQTT,
+    REPORT_SINK_FIREBASE,
+    REPORT_SINK_COUNT
+};
+
+enum ReportChannel
+{
+    REPORT_TEMP_RED,
+    REPORT_TEMP_BLUE,
+    REPORT_TEMP_GREEN,
+    REPORT_TEMP_AVG,
+    REPORT_TARGET_TEMP,
+    REPORT_CHANNEL_COUNT
+};
+
+struct ReportPolicy
+{
+    int32_t deadbandCenti;
+    unsigned long minIntervalMs;
+    unsigned long maxSilenceMs;
+};
+
+// Function declarations
+bool reportDue(ReportChannel channel, ReportSink sink, Temp value);
+void markReported(ReportChannel channel, ReportSink sink, Temp value);
+Temp lastReported(ReportChannel channel, ReportSink sink);
@@ -0,0 +1,302 @@
+// ==================================================
+// File: src/Rollups.cpp
+// ==================================================
+
+#include "Rollups.h"
+#include "config.h"
+#include "TemperatureSensors.h"
+#include "TimeManager.h"
+
+extern SystemStatus systemStatus;
+
+// Open bucket being accumulated
+struct RollupAcc
+{
+    bool active;
+    uint32_t start;
+    int16_t min[ROLLUP_SENSOR_COUNT];
+    int16_t max[ROLLUP_SENSOR_COUNT];
+    int32_t sum[ROLLUP_SENSOR_COUNT];
+    uint16_t n[ROLLUP_SENSOR_COUNT];
+    uint32_t coveredS;
+    uint32_t heaterOnS;
+    uint32_t energyJ;
+};
+
+struct RollupRing
+{
+    uint32_t period;
+    RollupBucket *buckets;
+    uint8_t size;
+    uint8_t head; // oldest
+    uint8_t count;
+};
+
+static RollupBucket ring1min[60];  // last hour
+static RollupBucket ring15min[96]; // last day
+static RollupBucket ring1h[72];    // last three days
+
+static RollupRing rings[ROLLUP_LEVEL_COUNT] = {
+    {60, ring1min, 60, 0, 0},
+    {900, ring15min, 96, 0, 0},
+    {3600, ring1h, 72, 0, 0},
+};
+
+static RollupAcc acc[ROLLUP_LEVEL_COUNT];
+static uint32_t lastSampleT = 0;
+
+// === Accumulators ===
+
+static uint32_t bucketStart(uint32_t t, uint8_t level)
+{
+    return t - t % rings[level].period;
+}
+
+static void openAcc(RollupAcc &a, uint32_t start)
+{
+    memset(&a, 0, sizeof(a));
+    a.active = true;
+    a.start = start;
+    for (uint8_t i = 0; i < ROLLUP_SENSOR_COUNT; i++)
+    {
+        a.min[i] = INT16_MAX;
+        a.max[i] = INT16_MIN;
+    }
+}
+
+static void addTemp(RollupAcc &a, uint8_t sensor, Temp value)
+{
+    if (!value.isValid())
+        return;
+    if (value.centi < a.min[sensor])
+        a.min[sensor] = value.centi;
+    if (value.centi > a.max[sensor])
+        a.max[sensor] = value.centi;
+    a.sum[sensor] += value.centi;
+    a.n[sensor]++;
+}
+
+static void mergeAcc(RollupAcc &into, const RollupAcc &from)
+{
+    for (uint8_t i = 0; i < ROLLUP_SENSOR_COUNT; i++)
+    {
+        if (from.n[i] == 0)
+            continue;
+        if (from.min[i] < into.min[i])
+            into.min[i] = from.min[i];
+        if (from.max[i] > into.max[i])
+            into.max[i] = from.max[i];
+        into.sum[i] += from.sum[i];
+        into.n[i] += from.n[i];
+    }
+    into.coveredS += from.coveredS;
+    into.heaterOnS += from.heaterOnS;
+    into.energyJ += from.energyJ;
+}
+
+static void finishAcc(const RollupAcc &a, RollupBucket &out)
+{
+    out.t = a.start;
+    for (uint8_t i = 0; i < ROLLUP_SENSOR_COUNT; i++)
+    {
+        if (a.n[i] == 0)
+        {
+            out.min[i] = out.max[i] = out.mean[i] = Temp::invalid();
+            continue;
+        }
+        int32_t half = a.n[i] / 2;
+        out.min[i] = Temp::fromCenti(a.min[i]);
+        out.max[i] = Temp::fromCenti(a.max[i]);
+        out.mean[i] = Temp::fromCenti((a.sum[i] + (a.sum[i] >= 0 ? half : -half)) / (int32_t)a.n[i]);
+    }
+    out.coveredS = a.coveredS > UINT16_MAX ? UINT16_MAX : a.coveredS;
+    out.heaterOnS = a.heaterOnS > UINT16_MAX ? UINT16_MAX : a.heaterOnS;
+    out.energyJ = a.energyJ;
+}
+
+static void pushBucket(uint8_t level, const RollupBucket &b)
+{
+    RollupRing &r = rings[level];
+    if (r.count == r.size)
+    {
+        r.head = (r.head + 1) % r.size;
+        r.count--;
+    }
+    r.buckets[(r.head + r.count) % r.size] = b;
+    r.count++;
+}
+
+// Archives a level's bucket and folds it into the next level up
+static void closeLevel(uint8_t level)
+{
+    RollupAcc &a = acc[level];
+    RollupBucket b;
+    finishAcc(a, b);
+    pushBucket(level, b);
+
+    if (level + 1 < ROLLUP_LEVEL_COUNT)
+    {
+        RollupAcc &up = acc[level + 1];
+        uint32_t start = bucketStart(a.start, level + 1);
+        if (up.active && up.start != start)
+            closeLevel(level + 1); // a gap skipped past the end of it
+        if (!up.active)
+            openAcc(up, start);
+        mergeAcc(up, a);
+    }
+    a.active = false;
+}
+
+void recordRollupSample()
+{
+    uint32_t now = getEpochTime();
+    if (now == 0 || now < lastSampleT)
+        return; // no clock yet, or it was just stepped back
+
+    uint32_t dt = now - lastSampleT;
+    if (lastSampleT == 0 || dt > ROLLUP_MAX_STEP_S)
+        dt = 1;
+    lastSampleT = now;
+
+    for (uint8_t level = 0; level < ROLLUP_LEVEL_COUNT; level++)
+    {
+        if (acc[level].active && bucketStart(now, level) != acc[level].start)
+            closeLevel(level);
+    }
+
+    RollupAcc &a = acc[ROLLUP_1MIN];
+    if (!a.active)
+        openAcc(a, bucketStart(now, ROLLUP_1MIN));
+    for (uint8_t i = 0; i < ROLLUP_SENSOR_COUNT; i++)
+    {
+        addTemp(a, i, getLastTemperature(i));
+    }
+    a.coveredS += dt;
+    if (systemStatus.heater == HEATER_ON)
+    {
+        a.heaterOnS += dt;
+        a.energyJ += lroundf(getHeaterCurrent() * MAINS_VOLTAGE * dt);
+    }
+}
+
+// === Reading ===
+
+uint32_t getRollupPeriod(uint8_t level)
+{
+    return rings[level].period;
+}
+
+// The open bucket of a level, including what the lower levels have not
+// handed up yet
+static bool openBucket(uint8_t level, RollupBucket &out)
+{
+    RollupAcc tmp;
+    tmp.active = false;
+    for (int8_t k = level; k >= 0; k--)
+    {
+        if (!acc[k].active)
+            continue;
+        uint32_t start = bucketStart(acc[k].start, level);
+        if (!tmp.active)
+            openAcc(tmp, start);
+        if (start == tmp.start)
+            mergeAcc(tmp, acc[k]);
+    }
+    if (!tmp.active)
+        return false;
+    finishAcc(tmp, out);
+    return true;
+}
+
+// Where the RAM copy of a level starts; everything before comes from flash
+static uint32_t ramStart(uint8_t level)
+{
+    const RollupRing &r = rings[level];
+    if (r.count > 0)
+        return r.buckets[r.head].t;
+    for (uint8_t k = 0; k <= level; k++)
+    {
+        if (acc[k].active)
+            return bucketStart(acc[k].start, level);
+    }
+    return UINT32_MAX;
+}
+
+void beginRollupRead(RollupCursor &c, uint8_t level, uint32_t from, uint32_t to)
+{
+    c.level = level;
+    c.next = bucketStart(from, level);
+    c.to = to;
+    c.flashOpen = false;
+    c.havePending = false;
+}
+
+// Aggregates the one-a-minute flash records of the next non-empty bucket
+// before `limit`
+static bool nextFlashBucket(RollupCursor &c, uint32_t limit, RollupBucket &out)
+{
+    if (!c.flashOpen)
+    {
+        beginTimeSeriesRead(c.flash, c.next);
+        c.flashOpen = true;
+    }
+    if (!c.havePending)
+        c.havePending = nextTimeSeriesRecord(c.flash, c.pending);
+    if (!c.havePending || c.pending.t >= limit)
+        return false;
+
+    const uint32_t stepS = TSDB_SAMPLE_INTERVAL / 1000;
+    RollupAcc a;
+    openAcc(a, bucketStart(c.pending.t, c.level));
+    while (c.havePending && bucketStart(c.pending.t, c.level) == a.start)
+    {
+        const TsRecord &r = c.pending;
+        for (uint8_t i = 0; i < ROLLUP_SENSOR_COUNT; i++)
+        {
+            addTemp(a, i, Temp::fromCenti(r.values[TS_FIELD_TEMP_RED + i]));
+        }
+        a.coveredS += stepS;
+        if (r.values[TS_FIELD_HEATER])
+        {
+            a.heaterOnS += stepS;
+            a.energyJ += (uint32_t)r.values[TS_FIELD_CURRENT] * MAINS_VOLTAGE * stepS / 100;
+        }
+        c.havePending = nextTimeSeriesRecord(c.flash, c.pending);
+    }
+    finishAcc(a, out);
+    c.next = a.start + rings[c.level].period;
+    return true;
+}
+
+bool nextRollupBucket(RollupCursor &c, RollupBucket &out)
+{
+    const RollupRing &r = rings[c.level];
+    while (c.next < c.to)
+    {
+        uint32_t ram = ramStart(c.level);
+        if (c.next < ram)
+        {
+            if (nextFlashBucket(c, ram < c.to ? ram : c.to, out))
+                return true;
+            c.next = ram; // flash has nothing more before the RAM copy
+            continue;
+        }
+
+        for (uint8_t i = 0; i < r.count; i++)
+        {
+            const RollupBucket &b = r.buckets[(r.head + i) % r.size];
+            if (b.t < c.next)
+                continue;
+            if (b.t >= c.to)
+                break;
+            out = b;
+            c.next = b.t + r.period;
+            return true;
+        }
+
+        bool open = openBucket(c.level, out) && out.t >= c.next && out.t < c.to;
+        c.next = c.to;
+        return open;
+    }
+    return false;
+}
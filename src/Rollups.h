@@ -0,0 +1,59 @@
+// ==================================================
+// File: src/Rollups.h
+// ==================================================
+//
+// Downsampled history at three resolutions (1 min, 15 min, 1 h): min, max
+// and mean per temperature sensor, heater on-time and heater energy per
+// bucket. Maintained incrementally - each once-a-second reading goes into the
+// open 1-min accumulator, a closed 1-min bucket is merged into the open
+// 15-min accumulator, and so on - so nothing is ever recomputed.
+//
+// Closed buckets are kept in small RAM rings. Older ranges are rebuilt from
+// the one-a-minute records of the flash store (TimeSeriesStore.h), so a
+// query can reach back as far as the flash history goes.
+
+#pragma once
+#include <Arduino.h>
+#include "Temp.h"
+#include "TimeSeriesStore.h"
+
+#define ROLLUP_SENSOR_COUNT 3
+#define ROLLUP_MAX_STEP_S 5 // longer gaps between readings count as missing data
+
+enum RollupLevel
+{
+    ROLLUP_1MIN,
+    ROLLUP_15MIN,
+    ROLLUP_1H,
+    ROLLUP_LEVEL_COUNT
+};
+
+struct RollupBucket
+{
+    uint32_t t;        // bucket start, epoch seconds
+    Temp min[ROLLUP_SENSOR_COUNT];
+    Temp max[ROLLUP_SENSOR_COUNT];
+    Temp mean[ROLLUP_SENSOR_COUNT];
+    uint16_t coveredS; // seconds with readings
+    uint16_t heaterOnS;
+    uint32_t energyJ;  // heater energy, joules
+};
+
+// Walks one level oldest first: flash-derived buckets, then the RAM ring,
+// then the open (partial) bucket
+struct RollupCursor
+{
+    uint8_t level;
+    uint32_t next; // start of the next bucket to produce
+    uint32_t to;
+    TsCursor flash;
+    bool flashOpen;
+    bool havePending; // flash record read ahead of the current bucket
+    TsRecord pending;
+};
+
+// Function declarations
+void recordRollupSample(); // cached readings and heater state; no-op until the clock is set
+uint32_t getRollupPeriod(uint8_t level);
+void beginRollupRead(RollupCursor &c, uint8_t level, uint32_t from, uint32_t to);
+bool nextRollupBucket(RollupCursor &c, RollupBucket &out);
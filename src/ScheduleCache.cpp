@@ -0,0 +1,119 @@
+// ==================================================
+// File: src/ScheduleCache.cpp
+// ==================================================
+
+#include "ScheduleCache.h"
+#include "GetShedual.h"
+#include "HeaterControl.h"
+#include "ScheduleSync.h"
+#include <Preferences.h>
+#include <rom/crc.h>
+
+// NVS image; times are "HH:MM" plus terminator
+struct ScheduleBlob
+{
+    uint16_t version;
+    ScheduleFieldSync sync[SCHED_FIELD_COUNT];
+    int16_t amCenti;
+    int16_t pmCenti;
+    char amTime[6];
+    char pmTime[6];
+    uint8_t amEnabled;
+    uint8_t pmEnabled;
+    uint32_t crc; // over everything above
+};
+
+static uint32_t savedCrc = 0;
+
+static uint32_t blobCrc(const ScheduleBlob &blob)
+{
+    return crc32_le(0, (const uint8_t *)&blob, offsetof(ScheduleBlob, crc));
+}
+
+static bool scheduleComplete()
+{
+    return isValidTemperature(currentSchedule.amTemp) && isValidTemperature(currentSchedule.pmTemp) &&
+           isValidTime(currentSchedule.amTime) && isValidTime(currentSchedule.pmTime);
+}
+
+void initScheduleCache()
+{
+    ScheduleBlob blob;
+    bool loaded = false;
+    Preferences prefs;
+    if (prefs.begin("schedule", true))
+    {
+        if (prefs.getBytesLength("cache") == sizeof(blob))
+        {
+            prefs.getBytes("cache", &blob, sizeof(blob));
+            loaded = blob.version == SCHEDULE_NVS_VERSION && blob.crc == blobCrc(blob);
+        }
+        prefs.end();
+    }
+    if (!loaded)
+    {
+        Serial.println("⚠️  No cached schedule - waiting for Firebase or MQTT");
+        return;
+    }
+
+    blob.amTime[5] = '\0';
+    blob.pmTime[5] = '\0';
+    Temp amTemp = Temp::fromCenti(blob.amCenti);
+    Temp pmTemp = Temp::fromCenti(blob.pmCenti);
+    if (!isValidTemperature(amTemp) || !isValidTemperature(pmTemp) || !isValidTime(blob.amTime) ||
+        !isValidTime(blob.pmTime))
+    {
+        Serial.println("⚠️  Cached schedule out of range - ignored");
+        return;
+    }
+
+    currentSchedule.amTemp = amTemp;
+    currentSchedule.pmTemp = pmTemp;
+    currentSchedule.amTime = blob.amTime;
+    currentSchedule.pmTime = blob.pmTime;
+    currentSchedule.amEnabled = blob.amEnabled;
+    currentSchedule.pmEnabled = blob.pmEnabled;
+    restoreScheduleSync(blob.sync);
+    savedCrc = blob.crc;
+    refreshScheduleCache();
+
+    Serial.print("✅ Cached schedule: AM ");
+    Serial.print(blob.amTime);
+    Serial.print(" → ");
+    Serial.print(amTemp.toString(2));
+    Serial.print("°C, PM ");
+    Serial.print(blob.pmTime);
+    Serial.print(" → ");
+    Serial.print(pmTemp.toString(2));
+    Serial.println("°C");
+}
+
+void saveScheduleCache()
+{
+    if (!scheduleComplete())
+        return;
+
+    ScheduleBlob blob;
+    memset(&blob, 0, sizeof(blob));
+    blob.version = SCHEDULE_NVS_VERSION;
+    for (int i = 0; i < SCHED_FIELD_COUNT; i++)
+        memcpy(&blob.sync[i], &getScheduleFieldSync((ScheduleField)i), sizeof(blob.sync[i]));
+    blob.amCenti = currentSchedule.amTemp.centi;
+    blob.pmCenti = currentSchedule.pmTemp.centi;
+    strncpy(blob.amTime, currentSchedule.amTime.c_str(), sizeof(blob.amTime) - 1);
+    strncpy(blob.pmTime, currentSchedule.pmTime.c_str(), sizeof(blob.pmTime) - 1);
+    blob.amEnabled = currentSchedule.amEnabled;
+    blob.pmEnabled = currentSchedule.pmEnabled;
+    blob.crc = blobCrc(blob);
+    if (blob.crc == savedCrc)
+        return;
+
+    Preferences prefs;
+    if (prefs.begin("schedule", false))
+    {
+        prefs.putBytes("cache", &blob, sizeof(blob));
+        prefs.end();
+        savedCrc = blob.crc;
+        Serial.println("💾 Schedule cached to NVS");
+    }
+}
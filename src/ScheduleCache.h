@@ -0,0 +1,24 @@
+// ==================================================
+// File: src/ScheduleCache.h
+// ==================================================
+//
+// Last known-good schedule in NVS, so the heater has its AM/PM slots within
+// milliseconds of boot instead of after WiFi, Firebase sign-in and the
+// schedule fetch - and keeps them when the internet is down.
+//
+// The image is a fixed-size blob with a version and a CRC32; anything that
+// does not match is ignored. It carries each field's ScheduleSync state -
+// its revision and what Firebase last held - so merges after a reboot still
+// order correctly against older writes and recognise app edits. Only
+// a complete schedule (both temperatures and both times valid) is saved, and
+// a save whose CRC matches the stored image is skipped, so callers can save
+// after every update without wearing flash.
+
+#pragma once
+#include <Arduino.h>
+
+#define SCHEDULE_NVS_VERSION 3
+
+// Function declarations
+void initScheduleCache(); // loads the cached schedule into currentSchedule
+void saveScheduleCache(); // after the schedule changed; no-op if unchanged or incomplete
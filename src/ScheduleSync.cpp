@@ -0,0 +1,381 @@
+// ==================================================
+// File: src/ScheduleSync.cpp
+// ==================================================
+
+#include "ScheduleSync.h"
+#include "GetShedual.h"
+#include "HeaterControl.h"
+#include "ScheduleCache.h"
+#include "NetClientPool.h"
+#include "TimeManager.h"
+#include "FirebaseService.h"
+
+static const char *const fieldKeys[SCHED_FIELD_COUNT] = {
+    "amTemperature", "pmTemperature", "amScheduledTime", "pmScheduledTime", "amEnabled", "pmEnabled"};
+static const char *const sourceNames[] = {"MQTT", "LAN", "Firebase"};
+
+static ScheduleFieldSync fields[SCHED_FIELD_COUNT];
+static ScheduleRev clockRev = 0; // highest revision issued or seen
+static bool dirty = false;       // changed since the last commit
+static bool pulled = false;      // Firebase read once; no pushes before that
+static ScheduleSyncStats stats = {};
+
+// === Hybrid logical clock ===
+
+static ScheduleRev physicalRev()
+{
+    uint32_t epoch = getEpochTime();
+    return epoch ? ((ScheduleRev)epoch * 1000) << 16 : 0;
+}
+
+// A revision above everything issued or seen so far
+static ScheduleRev nextRev()
+{
+    ScheduleRev next = clockRev + 1;
+    ScheduleRev physical = physicalRev();
+    if (physical > next)
+        next = physical;
+    clockRev = next;
+    return next;
+}
+
+static void observeRev(ScheduleRev rev)
+{
+    if (rev > clockRev)
+        clockRev = rev;
+}
+
+static void formatRev(ScheduleRev rev, char *out)
+{
+    char digits[21];
+    int n = 0;
+    do
+    {
+        digits[n++] = '0' + rev % 10;
+        rev /= 10;
+    } while (rev);
+    while (n)
+        *out++ = digits[--n];
+    *out = '\0';
+}
+
+// === Field values ===
+
+// Validates and normalizes a value ("21.5" -> "21.50", "1" -> "true")
+static bool canonicalValue(ScheduleField field, const char *in, char *out)
+{
+    switch (field)
+    {
+    case SCHED_AM_TEMP:
+    case SCHED_PM_TEMP:
+    {
+        Temp t = Temp::parse(in);
+        if (!isValidTemperature(t))
+            return false;
+        snprintf(out, SCHEDULE_VALUE_MAX, "%d.%02d", t.centi / 100, t.centi % 100);
+        return true;
+    }
+    case SCHED_AM_TIME:
+    case SCHED_PM_TIME:
+        if (!isValidTime(String(in)))
+            return false;
+        strcpy(out, in);
+        return true;
+    default:
+        if (strcmp(in, "true") == 0 || strcmp(in, "1") == 0)
+            strcpy(out, "true");
+        else if (strcmp(in, "false") == 0 || strcmp(in, "0") == 0)
+            strcpy(out, "false");
+        else
+            return false;
+        return true;
+    }
+}
+
+// Current value in canonical form, "" if not set
+static void currentValue(ScheduleField field, char *out)
+{
+    out[0] = '\0';
+    switch (field)
+    {
+    case SCHED_AM_TEMP:
+    case SCHED_PM_TEMP:
+    {
+        Temp t = field == SCHED_AM_TEMP ? currentSchedule.amTemp : currentSchedule.pmTemp;
+        if (isValidTemperature(t))
+            snprintf(out, SCHEDULE_VALUE_MAX, "%d.%02d", t.centi / 100, t.centi % 100);
+        break;
+    }
+    case SCHED_AM_TIME:
+    case SCHED_PM_TIME:
+    {
+        const String &time = field == SCHED_AM_TIME ? currentSchedule.amTime : currentSchedule.pmTime;
+        if (isValidTime(time))
+            strcpy(out, time.c_str());
+        break;
+    }
+    case SCHED_AM_ENABLED:
+        strcpy(out, currentSchedule.amEnabled ? "true" : "false");
+        break;
+    default:
+        strcpy(out, currentSchedule.pmEnabled ? "true" : "false");
+        break;
+    }
+}
+
+// Through the validated GetShedual setters
+static void applyValue(ScheduleField field, const char *value)
+{
+    switch (field)
+    {
+    case SCHED_AM_TEMP:
+        setAMTemperature(Temp::parse(value));
+        break;
+    case SCHED_PM_TEMP:
+        setPMTemperature(Temp::parse(value));
+        break;
+    case SCHED_AM_TIME:
+        setAMTime(String(value));
+        break;
+    case SCHED_PM_TIME:
+        setPMTime(String(value));
+        break;
+    case SCHED_AM_ENABLED:
+        currentSchedule.amEnabled = strcmp(value, "true") == 0;
+        break;
+    default:
+        currentSchedule.pmEnabled = strcmp(value, "true") == 0;
+        break;
+    }
+    stats.applied++;
+    dirty = true;
+}
+
+// === Local writes ===
+
+bool isValidScheduleValue(ScheduleField field, const char *value)
+{
+    char v[SCHEDULE_VALUE_MAX];
+    return canonicalValue(field, value, v);
+}
+
+bool setScheduleField(ScheduleField field, const char *value, ScheduleSource source)
+{
+    char v[SCHEDULE_VALUE_MAX], cur[SCHEDULE_VALUE_MAX];
+    if (!canonicalValue(field, value, v))
+    {
+        Serial.print("❌ Invalid schedule value from ");
+        Serial.print(sourceNames[source]);
+        Serial.print(": ");
+        Serial.print(fieldKeys[field]);
+        Serial.print(" = ");
+        Serial.println(value);
+        return false;
+    }
+    currentValue(field, cur);
+    if (strcmp(v, cur) == 0)
+    {
+        stats.suppressed++;
+        return false;
+    }
+
+    applyValue(field, v);
+    fields[field].rev = nextRev();
+    Serial.print("🔄 Schedule ");
+    Serial.print(fieldKeys[field]);
+    Serial.print(" = ");
+    Serial.print(v);
+    Serial.print(" via ");
+    Serial.println(sourceNames[source]);
+    return true;
+}
+
+void commitScheduleChanges()
+{
+    if (!dirty)
+        return;
+    dirty = false;
+    refreshScheduleCache();
+    saveScheduleCache();
+}
+
+// === Firebase ===
+
+static void mergeFromFirebase(ScheduleField field, const char *value, ScheduleRev remoteRev)
+{
+    ScheduleFieldSync &f = fields[field];
+    char v[SCHEDULE_VALUE_MAX], cur[SCHEDULE_VALUE_MAX];
+    if (!canonicalValue(field, value, v))
+    {
+        f.cloudKnown = false; // rewritten by the next push
+        return;
+    }
+    if (f.cloudKnown && strcmp(v, f.cloudValue) == 0 && remoteRev == f.cloudRev)
+        return; // nothing new, including our own writes
+
+    // Changed under the same revision: an edit from outside (the app keeps
+    // no revisions), as of now. Without a known cloud state (no cache yet)
+    // the local revision stands in for it. A lower revision is an older
+    // write and loses.
+    currentValue(field, cur);
+    ScheduleRev rev = remoteRev;
+    if (f.cloudKnown ? remoteRev == f.cloudRev : remoteRev == f.rev && strcmp(v, cur) != 0)
+        rev = nextRev();
+    observeRev(remoteRev);
+    strncpy(f.cloudValue, v, sizeof(f.cloudValue));
+    f.cloudRev = remoteRev;
+    f.cloudKnown = true;
+
+    if (strcmp(v, cur) == 0)
+    {
+        if (rev > f.rev)
+            f.rev = rev;
+        return;
+    }
+    bool newer = rev > f.rev || (rev == f.rev && (cur[0] == '\0' || strcmp(v, cur) > 0));
+    if (!newer)
+    {
+        stats.stale++; // the local value is pushed back instead
+        return;
+    }
+    applyValue(field, v);
+    f.rev = rev;
+    Serial.print("🔄 Schedule ");
+    Serial.print(fieldKeys[field]);
+    Serial.print(" = ");
+    Serial.print(v);
+    Serial.println(" via Firebase");
+}
+
+bool pullScheduleFromFirebase()
+{
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return false;
+    if (!Firebase.RTDB.getJSON(&fbData, "/schedule"))
+    {
+        Serial.print("❌ Schedule read failed: ");
+        Serial.println(fbData.errorReason());
+        return false;
+    }
+
+    FirebaseJson &json = fbData.jsonObject();
+    FirebaseJsonData value, rev;
+    for (int i = 0; i < SCHED_FIELD_COUNT; i++)
+    {
+        if (!json.get(value, fieldKeys[i]) || !value.success)
+            continue;
+        ScheduleRev remoteRev = 0;
+        if (json.get(rev, String("rev/") + fieldKeys[i]) && rev.success)
+            remoteRev = strtoull(rev.stringValue.c_str(), nullptr, 10);
+        mergeFromFirebase((ScheduleField)i, value.stringValue.c_str(), remoteRev);
+    }
+    pulled = true;
+    commitScheduleChanges();
+    saveScheduleCache(); // the cloud state may have changed on its own
+    return true;
+}
+
+// A field needs a push when Firebase does not hold its value and revision
+static bool needsPush(int i, char *cur)
+{
+    currentValue((ScheduleField)i, cur);
+    if (cur[0] == '\0')
+        return false;
+    const ScheduleFieldSync &f = fields[i];
+    return !f.cloudKnown || f.rev != f.cloudRev || strcmp(cur, f.cloudValue) != 0;
+}
+
+bool schedulePushPending()
+{
+    char cur[SCHEDULE_VALUE_MAX];
+    for (int i = 0; i < SCHED_FIELD_COUNT; i++)
+    {
+        if (needsPush(i, cur))
+            return true;
+    }
+    return false;
+}
+
+// All pending fields and their revisions in one multi-path update
+void pushScheduleToFirebase()
+{
+    if (!pulled || !schedulePushPending())
+        return;
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
+
+    String body;
+    char values[SCHED_FIELD_COUNT][SCHEDULE_VALUE_MAX];
+    char rev[21];
+    bool pending[SCHED_FIELD_COUNT];
+    for (int i = 0; i < SCHED_FIELD_COUNT; i++)
+    {
+        pending[i] = needsPush(i, values[i]);
+        if (!pending[i])
+            continue;
+        formatRev(fields[i].rev, rev);
+        addFirebaseUpdate(body, fieldKeys[i], String("\"") + values[i] + "\"");
+        addFirebaseUpdate(body, String("rev/") + fieldKeys[i], String("\"") + rev + "\"");
+    }
+
+    if (!sendFirebaseUpdate("/schedule", body))
+    {
+        Serial.print("❌ Schedule push failed: ");
+        Serial.println(fbData.errorReason());
+        return;
+    }
+    for (int i = 0; i < SCHED_FIELD_COUNT; i++)
+    {
+        if (!pending[i])
+            continue;
+        strncpy(fields[i].cloudValue, values[i], sizeof(fields[i].cloudValue));
+        fields[i].cloudRev = fields[i].rev;
+        fields[i].cloudKnown = true;
+    }
+    stats.pushes++;
+    saveScheduleCache();
+    Serial.println("✅ Schedule pushed to Firebase");
+}
+
+// === State ===
+
+const ScheduleFieldSync &getScheduleFieldSync(ScheduleField field)
+{
+    return fields[field];
+}
+
+void restoreScheduleSync(const ScheduleFieldSync *state)
+{
+    for (int i = 0; i < SCHED_FIELD_COUNT; i++)
+    {
+        fields[i] = state[i];
+        fields[i].cloudValue[SCHEDULE_VALUE_MAX - 1] = '\0';
+        observeRev(fields[i].rev);
+        observeRev(fields[i].cloudRev);
+    }
+}
+
+const char *scheduleFieldKey(ScheduleField field)
+{
+    return fieldKeys[field];
+}
+
+const ScheduleSyncStats &getScheduleSyncStats()
+{
+    return stats;
+}
+
+void printScheduleSyncStats()
+{
+    Serial.print("Schedule sync: ");
+    Serial.print(stats.applied);
+    Serial.print(" applied, ");
+    Serial.print(stats.suppressed);
+    Serial.print(" duplicates suppressed, ");
+    Serial.print(stats.stale);
+    Serial.print(" stale Firebase values, ");
+    Serial.print(stats.pushes);
+    Serial.println(" Firebase pushes");
+}
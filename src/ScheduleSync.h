@@ -0,0 +1,80 @@
+// ==================================================
+// File: src/ScheduleSync.h
+// ==================================================
+//
+// Single write path for the six schedule fields, shared by MQTT, the LAN API
+// and Firebase, so concurrent updates converge instead of ping-ponging.
+//
+// Every field carries a revision from a hybrid logical clock: wall-clock
+// milliseconds (0 before NTP) shifted left 16 bits, plus a counter in the
+// low bits. Revisions only grow, across reboots too (they are cached in NVS
+// with the schedule), and the higher revision wins a merge; equal revisions
+// are broken by the value so every copy picks the same one.
+//
+//   - MQTT and LAN writes are stamped with a new revision on arrival.
+//   - The device writes /schedule/<field> and /schedule/rev/<field> together
+//     in one multi-path update, and remembers what it wrote.
+//   - A Firebase read that returns what the device last wrote or read is an
+//     echo and changes nothing. A value that changed under the same
+//     revision (an edit from the app, which does not keep revisions) is
+//     stamped when it is seen; one with a lower revision is an older write.
+//     What Firebase last held is cached in NVS too, so an app edit made
+//     while the device was off is still recognised after the reboot.
+//   - A write that does not change a value (retained MQTT messages on every
+//     reconnect, repeated app saves) is suppressed before it reaches the
+//     schedule, NVS or Firebase.
+
+#pragma once
+#include <Arduino.h>
+
+enum ScheduleField
+{
+    SCHED_AM_TEMP,
+    SCHED_PM_TEMP,
+    SCHED_AM_TIME,
+    SCHED_PM_TIME,
+    SCHED_AM_ENABLED,
+    SCHED_PM_ENABLED,
+    SCHED_FIELD_COUNT
+};
+
+enum ScheduleSource
+{
+    SCHED_SOURCE_MQTT,
+    SCHED_SOURCE_LAN,
+    SCHED_SOURCE_FIREBASE
+};
+
+typedef uint64_t ScheduleRev;
+
+#define SCHEDULE_VALUE_MAX 8 // "21.50", "07:30", "false"
+
+// Per-field merge state, persisted by ScheduleCache
+struct ScheduleFieldSync
+{
+    ScheduleRev rev;                     // of the local value
+    ScheduleRev cloudRev;                // last written to / read from Firebase
+    char cloudValue[SCHEDULE_VALUE_MAX]; // likewise
+    bool cloudKnown;
+};
+
+struct ScheduleSyncStats
+{
+    uint32_t applied;    // values changed; also a change counter for observers
+    uint32_t suppressed; // writes that matched the current value
+    uint32_t stale;      // Firebase values older than the local ones
+    uint32_t pushes;     // multi-path Firebase updates
+};
+
+// Function declarations
+bool isValidScheduleValue(ScheduleField field, const char *value);
+bool setScheduleField(ScheduleField field, const char *value, ScheduleSource source); // true if the value changed
+void commitScheduleChanges();       // after one or more sets: heater refresh + NVS cache
+bool pullScheduleFromFirebase();    // reads /schedule and merges it; false if the read failed
+void pushScheduleToFirebase();      // writes fields whose revision Firebase does not have yet
+bool schedulePushPending();
+const ScheduleFieldSync &getScheduleFieldSync(ScheduleField field);
+void restoreScheduleSync(const ScheduleFieldSync *state); // from the NVS cache, SCHED_FIELD_COUNT entries
+const char *scheduleFieldKey(ScheduleField field); // Firebase key under /schedule
+const ScheduleSyncStats &getScheduleSyncStats();
+void printScheduleSyncStats();
@@ -0,0 +1,312 @@
+// ==================================================
+// File: src/Scheduler.cpp
+// ==================================================
+
+#include "Scheduler.h"
+#include "PowerManager.h"
+
+#define SCHED_SLOT_MASK (SCHED_WHEEL_SLOTS - 1)
+#define SCHED_NO_LINK -1
+
+struct Job
+{
+    const char *name;
+    JobCallback fn;
+    unsigned long periodMs; // 0 = one-shot
+    unsigned long deadline; // millis() value of the next run
+    JobPriority priority;
+    bool active;
+    bool queued;  // currently linked into a wheel slot
+    int8_t next;  // next job in the same wheel slot
+    JobStats stats;
+};
+
+static Job jobs[SCHED_MAX_JOBS];
+static int8_t wheel[SCHED_WHEEL_SLOTS];
+static unsigned long wheelMs = 0; // millis() of the last wheel scan
+static int runningJob = SCHED_INVALID_JOB;
+
+static inline uint8_t slotFor(unsigned long ms)
+{
+    return (ms >> SCHED_TICK_SHIFT) & SCHED_SLOT_MASK;
+}
+
+static bool validJob(int jobId)
+{
+    return jobId >= 0 && jobId < SCHED_MAX_JOBS && jobs[jobId].active;
+}
+
+static void linkJob(int jobId)
+{
+    Job &job = jobs[jobId];
+    // A deadline that is already in the past goes into the current slot,
+    // which is always rescanned on the next pass
+    unsigned long when = ((long)(job.deadline - wheelMs) < 0) ? wheelMs : job.deadline;
+    uint8_t slot = slotFor(when);
+    job.next = wheel[slot];
+    wheel[slot] = jobId;
+    job.queued = true;
+}
+
+static void unlinkJob(int jobId)
+{
+    Job &job = jobs[jobId];
+    if (!job.queued)
+        return;
+    for (uint8_t slot = 0; slot < SCHED_WHEEL_SLOTS; slot++)
+    {
+        int8_t *link = &wheel[slot];
+        while (*link != SCHED_NO_LINK)
+        {
+            if (*link == jobId)
+            {
+                *link = job.next;
+                job.next = SCHED_NO_LINK;
+                job.queued = false;
+                return;
+            }
+            link = &jobs[*link].next;
+        }
+    }
+}
+
+static int addJob(const char *name, unsigned long periodMs, unsigned long delayMs,
+                  JobCallback fn, JobPriority priority)
+{
+    for (int i = 0; i < SCHED_MAX_JOBS; i++)
+    {
+        if (!jobs[i].active && i != runningJob)
+        {
+            Job &job = jobs[i];
+            job.name = name;
+            job.fn = fn;
+            job.periodMs = periodMs;
+            job.deadline = millis() + delayMs;
+            job.priority = priority;
+            job.active = true;
+            job.queued = false;
+            job.next = SCHED_NO_LINK;
+            memset(&job.stats, 0, sizeof(job.stats));
+            linkJob(i);
+            return i;
+        }
+    }
+    Serial.print("❌ Scheduler full, cannot add job: ");
+    Serial.println(name);
+    return SCHED_INVALID_JOB;
+}
+
+void initScheduler()
+{
+    for (int i = 0; i < SCHED_MAX_JOBS; i++)
+    {
+        jobs[i].active = false;
+        jobs[i].queued = false;
+        jobs[i].next = SCHED_NO_LINK;
+    }
+    for (int s = 0; s < SCHED_WHEEL_SLOTS; s++)
+    {
+        wheel[s] = SCHED_NO_LINK;
+    }
+    wheelMs = millis();
+    runningJob = SCHED_INVALID_JOB;
+}
+
+int scheduleEvery(const char *name, unsigned long periodMs, JobCallback fn,
+                  JobPriority priority, unsigned long firstDelayMs)
+{
+    if (periodMs == 0)
+        periodMs = 1;
+    return addJob(name, periodMs, firstDelayMs, fn, priority);
+}
+
+int scheduleOnce(const char *name, unsigned long delayMs, JobCallback fn, JobPriority priority)
+{
+    return addJob(name, 0, delayMs, fn, priority);
+}
+
+void cancelJob(int jobId)
+{
+    if (!validJob(jobId))
+        return;
+    unlinkJob(jobId);
+    jobs[jobId].active = false;
+}
+
+void rescheduleJob(int jobId, unsigned long delayMs)
+{
+    if (!validJob(jobId))
+        return;
+    unlinkJob(jobId);
+    jobs[jobId].deadline = millis() + delayMs;
+    // Linking a running job tells runScheduler() not to apply its period afterwards
+    linkJob(jobId);
+}
+
+void setJobPeriod(int jobId, unsigned long periodMs)
+{
+    if (!validJob(jobId) || jobs[jobId].periodMs == 0)
+        return;
+    jobs[jobId].periodMs = periodMs > 0 ? periodMs : 1;
+}
+
+bool isJobScheduled(int jobId)
+{
+    return validJob(jobId);
+}
+
+void runScheduler()
+{
+    unsigned long now = millis();
+
+    // === Collect due jobs from the slots that expired since the last scan ===
+    int8_t due[SCHED_MAX_JOBS];
+    int dueCount = 0;
+
+    unsigned long elapsedTicks = (now >> SCHED_TICK_SHIFT) - (wheelMs >> SCHED_TICK_SHIFT);
+    unsigned long slotsToScan = elapsedTicks >= SCHED_WHEEL_SLOTS ? SCHED_WHEEL_SLOTS : elapsedTicks + 1;
+    uint8_t slot = slotsToScan == SCHED_WHEEL_SLOTS ? 0 : slotFor(wheelMs);
+
+    for (unsigned long n = 0; n < slotsToScan; n++, slot = (slot + 1) & SCHED_SLOT_MASK)
+    {
+        int8_t *link = &wheel[slot];
+        while (*link != SCHED_NO_LINK)
+        {
+            Job &job = jobs[*link];
+            if ((long)(now - job.deadline) >= 0)
+            {
+                int8_t id = *link;
+                *link = job.next;
+                job.next = SCHED_NO_LINK;
+                job.queued = false;
+
+                // Insert sorted by priority, then deadline
+                int pos = dueCount++;
+                while (pos > 0)
+                {
+                    Job &prev = jobs[due[pos - 1]];
+                    if (prev.priority < job.priority ||
+                        (prev.priority == job.priority && (long)(prev.deadline - job.deadline) <= 0))
+                        break;
+                    due[pos] = due[pos - 1];
+                    pos--;
+                }
+                due[pos] = id;
+            }
+            else
+            {
+                link = &job.next;
+            }
+        }
+    }
+    wheelMs = now;
+
+    // === Run them ===
+    for (int i = 0; i < dueCount; i++)
+    {
+        int id = due[i];
+        Job &job = jobs[id];
+        if (!job.active)
+            continue;
+
+        unsigned long start = millis();
+        uint32_t late = start - job.deadline;
+        job.stats.runs++;
+        job.stats.lastLateMs = late;
+        job.stats.totalLateMs += late;
+        if (late > job.stats.maxLateMs)
+            job.stats.maxLateMs = late;
+
+        runningJob = id;
+        job.fn();
+        runningJob = SCHED_INVALID_JOB;
+
+        uint32_t ran = millis() - start;
+        if (ran > job.stats.maxRunMs)
+            job.stats.maxRunMs = ran;
+        job.stats.totalRunMs += ran;
+
+        if (!job.active || job.queued)
+            continue; // cancelled or rescheduled from inside the callback
+
+        if (job.periodMs == 0)
+        {
+            job.active = false; // one-shot done
+            continue;
+        }
+
+        // Keep the original phase; if we fell a whole period behind, drop the
+        // missed runs rather than firing them back to back
+        job.deadline += job.periodMs;
+        unsigned long after = millis();
+        if ((long)(after - job.deadline) >= 0)
+        {
+            job.stats.skipped += (after - job.deadline) / job.periodMs + 1;
+            job.deadline = after + job.periodMs;
+        }
+        linkJob(id);
+    }
+}
+
+unsigned long getMsUntilNextJob()
+{
+    unsigned long now = millis();
+    unsigned long best = SCHED_MAX_SLEEP_MS;
+    for (int i = 0; i < SCHED_MAX_JOBS; i++)
+    {
+        if (!jobs[i].active || !jobs[i].queued)
+            continue;
+        long remaining = (long)(jobs[i].deadline - now);
+        if (remaining <= 0)
+            return 0;
+        if ((unsigned long)remaining < best)
+            best = remaining;
+    }
+    return best;
+}
+
+void sleepUntilNextJob()
+{
+    unsigned long ms = getMsUntilNextJob();
+    if (ms > 0)
+    {
+        powerIdle(ms); // the idle task may light-sleep until the deadline
+    }
+    else
+    {
+        yield();
+    }
+}
+
+const JobStats *getJobStats(int jobId)
+{
+    if (!validJob(jobId))
+        return nullptr;
+    return &jobs[jobId].stats;
+}
+
+const char *getJobName(int jobId)
+{
+    if (!validJob(jobId))
+        return nullptr;
+    return jobs[jobId].name;
+}
+
+void printSchedulerStats()
+{
+    Serial.println("=== Scheduler Stats (late = start - deadline) ===");
+    for (int i = 0; i < SCHED_MAX_JOBS; i++)
+    {
+        const Job &job = jobs[i];
+        if (!job.active)
+            continue;
+        Serial.printf("  %-14s period %6lums runs %6lu skipped %4lu late avg/max %4lu/%5lums run max %5lums\n",
+                      job.name,
+                      job.periodMs,
+                      (unsigned long)job.stats.runs,
+                      (unsigned long)job.stats.skipped,
+                      (unsigned long)(job.stats.runs ? job.stats.totalLateMs / job.stats.runs : 0),
+                      (unsigned long)job.stats.maxLateMs,
+                      (unsigned long)job.stats.maxRunMs);
+    }
+}
@@ -0,0 +1,56 @@
+// ==================================================
+// File: src/Scheduler.h
+// ==================================================
+//
+// Cooperative job scheduler. Jobs are plain callbacks registered as periodic
+// or one-shot; deadlines live in a small hashed timer wheel so runScheduler()
+// only touches the slots that expired since the last call. The main loop
+// calls runScheduler() and then sleepUntilNextJob() instead of a fixed delay.
+
+#pragma once
+#include <Arduino.h>
+
+#define SCHED_MAX_JOBS 20
+#define SCHED_WHEEL_SLOTS 32 // must be a power of two
+#define SCHED_TICK_SHIFT 6   // 64 ms per wheel slot
+#define SCHED_MAX_SLEEP_MS 1000
+#define SCHED_INVALID_JOB -1
+
+typedef void (*JobCallback)();
+
+// Lower value runs first when several jobs are due in the same pass
+enum JobPriority
+{
+    JOB_PRIORITY_HIGH,
+    JOB_PRIORITY_NORMAL,
+    JOB_PRIORITY_LOW
+};
+
+// Per-job timing statistics ("late" = how far after its deadline a job started)
+struct JobStats
+{
+    uint32_t runs;
+    uint32_t skipped;     // periods dropped because the job fell a whole period behind
+    uint32_t lastLateMs;
+    uint32_t maxLateMs;
+    uint32_t totalLateMs; // for the average
+    uint32_t maxRunMs;
+    uint32_t totalRunMs;
+};
+
+// Function declarations
+void initScheduler();
+int scheduleEvery(const char *name, unsigned long periodMs, JobCallback fn,
+                  JobPriority priority = JOB_PRIORITY_NORMAL, unsigned long firstDelayMs = 0);
+int scheduleOnce(const char *name, unsigned long delayMs, JobCallback fn,
+                 JobPriority priority = JOB_PRIORITY_NORMAL);
+void cancelJob(int jobId);
+void rescheduleJob(int jobId, unsigned long delayMs); // move the next run, keep the period
+void setJobPeriod(int jobId, unsigned long periodMs);
+bool isJobScheduled(int jobId);
+void runScheduler();
+unsigned long getMsUntilNextJob();
+void sleepUntilNextJob();
+const JobStats *getJobStats(int jobId);
+const char *getJobName(int jobId); // nullptr for a free slot
+void printSchedulerStats();
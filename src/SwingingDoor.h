@@ -0,0 +1,155 @@
+// ==================================================
+// File: src/SwingingDoor.h
+// ==================================================
+//
+// Streaming swinging-door trending (SDT) compressor for one signal.
+//
+// From the last archived point (the pivot) every sample allows a range of
+// slopes - those whose line passes within +/- deviation of it. The "doors"
+// are the intersection of those ranges: the lower door can only rise and the
+// upper door only fall. When a sample would close them (no single line from
+// the pivot fits every sample any more), a point on the middle line at the
+// previous sample's time is archived and becomes the new pivot. Linear
+// interpolation between archived points is therefore within `deviation`
+// (plus 0.01 °C rounding) of every input sample.
+//
+// Integer-only: values are centi-degrees, times are seconds, slopes are kept
+// as fractions and compared by cross-multiplying in 64 bits.
+
+#pragma once
+#include <Arduino.h>
+#include "Temp.h"
+
+struct SdtPoint
+{
+    uint32_t t; // seconds
+    Temp value; // invalid = start of a gap
+};
+
+struct SwingingDoor
+{
+    int32_t deviation; // centi-degrees
+    uint32_t maxGapS;  // archive at least this often so long flat lines still show up
+
+    bool started;
+    uint32_t pivotT;
+    int32_t pivotV;
+    bool haveLast; // at least one sample since the pivot
+    uint32_t lastT;
+    int64_t lowNum; // lower door slope (lowNum / lowDen), centi per second
+    int64_t lowDen;
+    int64_t highNum; // upper door slope
+    int64_t highDen;
+
+    void reset()
+    {
+        started = false;
+        haveLast = false;
+    }
+
+    // Feeds one sample; writes up to two archived points to out and returns how many
+    uint8_t add(uint32_t t, Temp value, SdtPoint out[2])
+    {
+        uint8_t n = 0;
+        if (!value.isValid())
+        {
+            // Close the segment at the last good sample and mark the gap
+            if (started)
+            {
+                if (haveLast)
+                    out[n++] = archiveAtLast();
+                out[n++] = {t, Temp::invalid()};
+            }
+            reset();
+            return n;
+        }
+
+        int32_t v = value.centi;
+        if (!started)
+        {
+            startAt(t, v);
+            out[n++] = {t, value};
+            return n;
+        }
+        if (t <= (haveLast ? lastT : pivotT))
+            return 0; // same second (or clock stepped back) - keep the first sample
+
+        if (haveLast && t - pivotT > maxGapS)
+        {
+            // Long flat stretch: archive so it isn't one giant segment
+            out[n++] = archiveAtLast();
+        }
+        else if (haveLast && doorsCloseWith(t, v))
+        {
+            out[n++] = archiveAtLast();
+        }
+        narrowDoors(t, v);
+        return n;
+    }
+
+    // Archives the most recent sample's position (e.g. before an upload) so
+    // the stored curve reaches the present; returns 0 or 1
+    uint8_t flush(SdtPoint out[1])
+    {
+        if (!started || !haveLast)
+            return 0;
+        out[0] = archiveAtLast();
+        return 1;
+    }
+
+    // === Internals ===
+
+    void startAt(uint32_t t, int32_t v)
+    {
+        started = true;
+        haveLast = false;
+        pivotT = t;
+        pivotV = v;
+    }
+
+    // Slopes from the pivot to (t, v -/+ deviation)
+    void slopesTo(uint32_t t, int32_t v, int64_t &lo, int64_t &hi, int64_t &den) const
+    {
+        den = (int64_t)(t - pivotT);
+        lo = (int64_t)v - deviation - pivotV;
+        hi = (int64_t)v + deviation - pivotV;
+    }
+
+    bool doorsCloseWith(uint32_t t, int32_t v) const
+    {
+        int64_t lo, hi, den;
+        slopesTo(t, v, lo, hi, den);
+        // new lower bound above the upper door, or new upper bound below the lower door
+        return lo * highDen > highNum * den || hi * lowDen < lowNum * den;
+    }
+
+    void narrowDoors(uint32_t t, int32_t v)
+    {
+        int64_t lo, hi, den;
+        slopesTo(t, v, lo, hi, den);
+        if (!haveLast || lo * lowDen > lowNum * den)
+        {
+            lowNum = lo;
+            lowDen = den;
+        }
+        if (!haveLast || hi * highDen < highNum * den)
+        {
+            highNum = hi;
+            highDen = den;
+        }
+        haveLast = true;
+        lastT = t;
+    }
+
+    // Point on the middle line of the doors at lastT; becomes the new pivot
+    SdtPoint archiveAtLast()
+    {
+        int64_t dt = (int64_t)(lastT - pivotT);
+        int64_t num = dt * (lowNum * highDen + highNum * lowDen);
+        int64_t den = 2 * lowDen * highDen;
+        int64_t offset = (num >= 0 ? num + den / 2 : num - den / 2) / den; // rounded
+        int32_t v = pivotV + (int32_t)offset;
+        startAt(lastT, v);
+        return {lastT, Temp::fromCenti(v)};
+    }
+};
@@ -0,0 +1,102 @@
+// ==================================================
+// File: src/SystemState.cpp
+// ==================================================
+
+#include "SystemState.h"
+
+static SystemStateModel model;
+static uint8_t dirtyFields = STATE_ALL_FIELDS; // first publish sends everything
+static unsigned long lastHeartbeatAt = 0;
+
+void updateSystemState(const SystemStatus &status, long rssi, unsigned long uptimeS)
+{
+    uint8_t changed = 0;
+
+    if (status.heater != model.heater)
+    {
+        model.heater = status.heater;
+        changed |= STATE_FIELD_BIT(STATE_FIELD_HEATER);
+    }
+    if (status.wifi != model.wifi)
+    {
+        model.wifi = status.wifi;
+        changed |= STATE_FIELD_BIT(STATE_FIELD_WIFI);
+    }
+    if (status.mqtt != model.mqtt)
+    {
+        model.mqtt = status.mqtt;
+        changed |= STATE_FIELD_BIT(STATE_FIELD_MQTT);
+    }
+    if (status.firebase != model.firebase)
+    {
+        model.firebase = status.firebase;
+        changed |= STATE_FIELD_BIT(STATE_FIELD_FIREBASE);
+    }
+    // Dead band instead of fixed buckets: a signal hovering on a bucket
+    // edge would otherwise flap between two values
+    if (labs(rssi - model.rssi) >= STATE_RSSI_STEP_DB || (rssi == 0) != (model.rssi == 0))
+    {
+        model.rssi = rssi;
+        changed |= STATE_FIELD_BIT(STATE_FIELD_RSSI);
+    }
+    uint32_t uptimeBucket = uptimeS / STATE_UPTIME_BUCKET_S;
+    if (uptimeBucket != model.uptimeBucket)
+    {
+        model.uptimeBucket = uptimeBucket;
+        changed |= STATE_FIELD_BIT(STATE_FIELD_UPTIME);
+    }
+
+    dirtyFields |= changed;
+}
+
+uint8_t takeSystemStateChanges()
+{
+    if (millis() - lastHeartbeatAt >= STATE_HEARTBEAT_INTERVAL || lastHeartbeatAt == 0)
+    {
+        dirtyFields = STATE_ALL_FIELDS;
+    }
+    if (dirtyFields == STATE_ALL_FIELDS)
+    {
+        lastHeartbeatAt = millis(); // any full publish counts as the heartbeat
+    }
+    uint8_t fields = dirtyFields;
+    dirtyFields = 0;
+    return fields;
+}
+
+void markSystemStateDirty(uint8_t fields)
+{
+    dirtyFields |= fields;
+}
+
+const SystemStateModel &getSystemState()
+{
+    return model;
+}
+
+// === Names used in published payloads ===
+
+const char *wifiStateName(WiFiState state)
+{
+    return state == CONNECTED ? "connected" : (state == CONNECTING ? "connecting" : "error");
+}
+
+const char *firebaseStateName(FirebaseState state)
+{
+    return state == FB_CONNECTED ? "connected" : (state == FB_CONNECTING ? "connecting" : "error");
+}
+
+const char *mqttStateName(MQTTState state)
+{
+    switch (state)
+    {
+    case MQTT_STATE_CONNECTED:
+        return "connected";
+    case MQTT_STATE_CONNECTING:
+        return "connecting";
+    case MQTT_STATE_ERROR:
+        return "error";
+    default:
+        return "disconnected";
+    }
+}
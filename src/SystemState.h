@@ -0,0 +1,51 @@
+// ==================================================
+// File: src/SystemState.h
+// ==================================================
+//
+// Published view of the system status with per-field change tracking.
+// updateSystemState() folds the live values into the model and sets a dirty
+// bit for every field whose published value would change; the publisher
+// sends only those fields, plus the full state every
+// STATE_HEARTBEAT_INTERVAL so late subscribers and dashboards catch up.
+// RSSI and uptime are coarsened first so noise doesn't count as a change.
+
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+
+#define STATE_RSSI_STEP_DB 6           // RSSI is re-published after moving this far
+#define STATE_UPTIME_BUCKET_S 3600     // uptime is re-published once per bucket
+#define STATE_HEARTBEAT_INTERVAL 300000 // full state
+
+enum SystemStateField
+{
+    STATE_FIELD_HEATER,
+    STATE_FIELD_WIFI,
+    STATE_FIELD_MQTT,
+    STATE_FIELD_FIREBASE,
+    STATE_FIELD_RSSI,
+    STATE_FIELD_UPTIME,
+    STATE_FIELD_COUNT
+};
+
+#define STATE_FIELD_BIT(f) (1u << (f))
+#define STATE_ALL_FIELDS ((1u << STATE_FIELD_COUNT) - 1)
+
+struct SystemStateModel
+{
+    HeaterState heater;
+    WiFiState wifi;
+    MQTTState mqtt;
+    FirebaseState firebase;
+    long rssi;             // last published RSSI
+    uint32_t uptimeBucket; // uptime / STATE_UPTIME_BUCKET_S
+};
+
+// Function declarations
+void updateSystemState(const SystemStatus &status, long rssi, unsigned long uptimeS);
+uint8_t takeSystemStateChanges(); // dirty fields (all of them when a heartbeat is due), then clears
+void markSystemStateDirty(uint8_t fields = STATE_ALL_FIELDS);
+const SystemStateModel &getSystemState();
+const char *wifiStateName(WiFiState state);
+const char *firebaseStateName(FirebaseState state);
+const char *mqttStateName(MQTTState state);
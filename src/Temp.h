@@ -0,0 +1,160 @@
+// ==================================================
+// File: src/Temp.h
+// ==================================================
+//
+// Fixed-point temperature value shared by the sensors, the schedule and the
+// heater control. Stored as centi-degrees Celsius in an int16_t (range
+// -327.67 .. 327.67 °C) with one reserved raw value meaning "no reading".
+// Everything on the hot path is integer maths; float only appears at the
+// edges (Firebase float fields, debug prints).
+
+#pragma once
+#include <Arduino.h>
+
+struct Temp
+{
+    static const int16_t INVALID_RAW = INT16_MIN;
+
+    int16_t centi;
+
+    // === Construction ===
+    static Temp invalid()
+    {
+        Temp t;
+        t.centi = INVALID_RAW;
+        return t;
+    }
+
+    static Temp fromCenti(int32_t c)
+    {
+        if (c <= INVALID_RAW || c > INT16_MAX)
+            return invalid();
+        Temp t;
+        t.centi = (int16_t)c;
+        return t;
+    }
+
+    static Temp fromCelsius(float c)
+    {
+        if (isnan(c))
+            return invalid();
+        return fromCenti((int32_t)lroundf(c * 100.0f));
+    }
+
+    // DallasTemperature raw readings are 1/128 °C
+    static Temp fromDallasRaw(int32_t raw)
+    {
+        int32_t scaled = raw * 100;
+        return fromCenti((scaled + (scaled >= 0 ? 64 : -64)) / 128);
+    }
+
+    // Parses "21", "21.5", "-3.25" without going through float.
+    // Anything else (empty, trailing junk, "21.", more than two decimals) is
+    // invalid - a third decimal is rejected rather than truncated.
+    static Temp parse(const char *s)
+    {
+        if (s == nullptr)
+            return invalid();
+        while (*s == ' ')
+            s++;
+        bool negative = false;
+        if (*s == '-' || *s == '+')
+        {
+            negative = (*s == '-');
+            s++;
+        }
+        if (*s < '0' || *s > '9')
+            return invalid();
+
+        int32_t whole = 0;
+        while (*s >= '0' && *s <= '9')
+        {
+            whole = whole * 10 + (*s++ - '0');
+            if (whole > 327)
+                return invalid();
+        }
+
+        int32_t frac = 0;
+        if (*s == '.')
+        {
+            s++;
+            int digits = 0;
+            while (*s >= '0' && *s <= '9')
+            {
+                if (++digits > 2)
+                    return invalid();
+                frac = frac * 10 + (*s++ - '0');
+            }
+            if (digits == 0)
+                return invalid();
+            if (digits == 1)
+                frac *= 10;
+        }
+        while (*s == ' ' || *s == '\r' || *s == '\n')
+            s++;
+        if (*s != '\0')
+            return invalid();
+
+        int32_t c = whole * 100 + frac;
+        return fromCenti(negative ? -c : c);
+    }
+
+    static Temp parse(const String &s) { return parse(s.c_str()); }
+
+    // === Access ===
+    bool isValid() const { return centi != INVALID_RAW; }
+
+    float toCelsius() const { return isValid() ? centi / 100.0f : NAN; }
+
+    // Rounded to the nearest 0.1 °C / 1 °C (half away from zero)
+    int16_t tenths() const { return (centi + (centi >= 0 ? 5 : -5)) / 10; }
+    int16_t wholeDegrees() const { return (centi + (centi >= 0 ? 50 : -50)) / 100; }
+
+    // Absolute difference in centi-degrees; only meaningful when both are valid
+    int32_t absDiff(Temp other) const
+    {
+        int32_t d = (int32_t)centi - other.centi;
+        return d < 0 ? -d : d;
+    }
+
+    // True when validity differs or the values are more than `centiThreshold` apart
+    bool changedFrom(Temp previous, int32_t centiThreshold) const
+    {
+        if (isValid() != previous.isValid())
+            return true;
+        return isValid() && absDiff(previous) > centiThreshold;
+    }
+
+    // Writes e.g. "21.5" (decimals = 1) or "21.50" (decimals = 2); "ERROR" when invalid
+    void format(char *buf, size_t len, uint8_t decimals = 1) const
+    {
+        if (!isValid())
+        {
+            snprintf(buf, len, "ERROR");
+            return;
+        }
+        if (decimals == 0)
+        {
+            snprintf(buf, len, "%d", wholeDegrees());
+            return;
+        }
+        int32_t v = decimals == 1 ? tenths() : centi;
+        int32_t scale = decimals == 1 ? 10 : 100;
+        int32_t mag = v < 0 ? -v : v;
+        snprintf(buf, len, decimals == 1 ? "%s%ld.%01ld" : "%s%ld.%02ld",
+                 v < 0 ? "-" : "", (long)(mag / scale), (long)(mag % scale));
+    }
+
+    String toString(uint8_t decimals = 1) const
+    {
+        char buf[12];
+        format(buf, sizeof(buf), decimals);
+        return String(buf);
+    }
+
+    // === Comparison (invalid compares unequal to everything but itself) ===
+    bool operator==(Temp o) const { return centi == o.centi; }
+    bool operator!=(Temp o) const { return centi != o.centi; }
+    bool operator<(Temp o) const { return isValid() && o.isValid() && centi < o.centi; }
+    bool operator>(Temp o) const { return isValid() && o.isValid() && centi > o.centi; }
+};
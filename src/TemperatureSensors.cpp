@@ -12,6 +12,9 @@ DallasTemperature sensors(&oneWire);
 DeviceAddress red, blue, green;
 static int connectedSensors = 0;
 
+// Readings from the last readAllSensors(), for everything else on the tick
+static Temp lastReadings[3] = {Temp::invalid(), Temp::invalid(), Temp::invalid()};
+
 void initTemperatureSensors()
 {
     Serial.println("Initializing temperature sensors...");
@@ -58,7 +61,8 @@ void initTemperatureSensors()
      *************************************/
 }
 
-float getTemperature(int sensorIndex)
+// Reads the result of the last conversion (requestTemperatures())
+static Temp readSensor(int sensorIndex)
 {
     DeviceAddress *sensorAddress;
 
@@ -75,23 +79,35 @@ float getTemperature(int sensorIndex)
         sensorAddress = &green;
         break;
     default:
-        return NAN; // Invalid sensor index
+        return Temp::invalid(); // Invalid sensor index
     }
 
-    // Request temperature from specific sensor
-    sensors.requestTemperatures();
-    float temp = sensors.getTempC(*sensorAddress);
+    int32_t raw = sensors.getTemp(*sensorAddress);
 
     // Check if reading is valid
-    if (temp == DEVICE_DISCONNECTED_C)
+    if (raw == DEVICE_DISCONNECTED_RAW)
     {
         Serial.print("Sensor ");
         Serial.print(sensorIndex);
         Serial.println(" disconnected");
-        return NAN;
+        return Temp::invalid();
     }
 
-    return temp;
+    return Temp::fromDallasRaw(raw);
+}
+
+Temp getTemperature(int sensorIndex)
+{
+    // Request temperature from specific sensor
+    sensors.requestTemperatures();
+    return readSensor(sensorIndex);
+}
+
+Temp getLastTemperature(int sensorIndex)
+{
+    if (sensorIndex < 0 || sensorIndex >= 3)
+        return Temp::invalid();
+    return lastReadings[sensorIndex];
 }
 
 void readAllSensors()
@@ -103,15 +119,18 @@ void readAllSensors()
 
     Serial.println("Reading all temperature sensors:");
 
+    // One conversion for the whole bus (blocks ~750 ms)
+    sensors.requestTemperatures();
     for (int i = 0; i < 3; i++)
     {
-        float temp = getTemperature(i);
-        if (!isnan(temp))
+        Temp temp = readSensor(i);
+        lastReadings[i] = temp;
+        if (temp.isValid())
         {
             Serial.print("Sensor ");
             Serial.print(i);
             Serial.print(": ");
-            Serial.print(temp);
+            Serial.print(temp.toString(2));
             Serial.println("°C");
         }
     }
@@ -7,11 +7,13 @@
 #include <OneWire.h>
 #include <DallasTemperature.h>
 #include "config.h"
+#include "Temp.h"
 
 // Function declarations
 void initTemperatureSensors();
-float getTemperature(int sensorIndex);
-void readAllSensors();
+Temp getTemperature(int sensorIndex);   // blocks for a conversion (~750 ms)
+void readAllSensors();                  // one conversion for all three, cached
+Temp getLastTemperature(int sensorIndex); // cached by readAllSensors(), no bus I/O
 int getConnectedSensorCount();
 
 // External declarations for sensor objects
@@ -6,66 +6,196 @@
 #include "FirebaseService.h"
 #include "config.h"
 #include <WiFi.h>
+#include "WiFiManagerCustom.h"
+#include "TimeZone.h"
+#include "CalendarEvents.h"
+#include "NetClientPool.h"
 #include <Firebase_ESP_Client.h>
-
-// Create NTP client
-WiFiUDP ntpUDP;
-NTPClient timeClient(ntpUDP, NTP_SERVER, UTC_OFFSET_STANDARD, NTP_UPDATE_INTERVAL);
+#include <esp_timer.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
+#include <time.h>
 
 // Global time variables
 int currentDay = 1;
 int currentMonth = 1;
+int currentYear = 1970;
 int Hours = 0;
 int Minutes = 0;
-int nextDay = 2;
-bool asBeenSaved = false;
 
-void initTimeManager()
+// Clock reading: anchorEpochUs plus esp_timer time since anchorMonoUs,
+// corrected by driftPpb, plus the part of slewUs absorbed so far
+static int64_t anchorMonoUs = 0;
+static int64_t anchorEpochUs = 0;
+static int64_t slewUs = 0;
+static int32_t driftPpb = 0;
+static bool synced = false;
+
+static int64_t lastSampleMonoUs = 0;
+static bool lastSampleStepped = true;
+static int32_t lastOffsetMs = 0;
+static uint32_t sampleCount = 0;
+static uint32_t stepCount = 0;
+
+// Latest SNTP sample, handed over from the lwIP task
+static portMUX_TYPE sampleMux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t pendingEpochUs = 0;
+static int64_t pendingMonoUs = 0;
+static bool samplePending = false;
+
+static uint32_t calendarMinute = 0; // local epoch / 60 the calendar globals are for
+static bool dateStorePending = false;
+
+extern SystemStatus systemStatus;
+
+static int64_t clockUs(int64_t monoUs)
 {
-    Serial.println("Initializing Time Manager...");
+    int64_t elapsed = monoUs - anchorMonoUs;
+    int64_t t = anchorEpochUs + elapsed + elapsed * driftPpb / 1000000000;
+    int64_t maxSlew = elapsed * CLOCK_SLEW_MAX_PPM / 1000000;
+    if (slewUs >= 0)
+        t += slewUs < maxSlew ? slewUs : maxSlew;
+    else
+        t += -slewUs < maxSlew ? slewUs : -maxSlew;
+    return t;
+}
+
+// Called by the SNTP client (lwIP task) in place of its own settimeofday()
+extern "C" void sntp_sync_time(struct timeval *tv)
+{
+    int64_t mono = esp_timer_get_time();
+    portENTER_CRITICAL(&sampleMux);
+    pendingEpochUs = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+    pendingMonoUs = mono;
+    samplePending = true;
+    portEXIT_CRITICAL(&sampleMux);
+}
+
+static void applySample(int64_t epochUs, int64_t monoUs)
+{
+    int64_t local = clockUs(monoUs);
+    int64_t offset = epochUs - local;
+    int64_t interval = monoUs - lastSampleMonoUs;
+    bool stepped = !synced || llabs(offset) > CLOCK_STEP_THRESHOLD_MS * 1000LL;
+
+    if (stepped)
+    {
+        anchorEpochUs = epochUs;
+        slewUs = 0;
+        stepCount++;
+    }
+    else
+    {
+        // With the last slew fully absorbed, what is left after a long
+        // enough interval is rate error; take a quarter of it
+        bool slewDone = llabs(slewUs) <= interval * CLOCK_SLEW_MAX_PPM / 1000000;
+        if (!lastSampleStepped && slewDone && interval >= CLOCK_DRIFT_MIN_SAMPLE_S * 1000000LL)
+        {
+            int64_t drift = driftPpb + offset * 1000000000 / interval / 4;
+            int64_t limit = CLOCK_DRIFT_MAX_PPM * 1000LL;
+            driftPpb = (int32_t)(drift > limit ? limit : drift < -limit ? -limit : drift);
+        }
+        anchorEpochUs = local;
+        slewUs = offset;
+    }
+    anchorMonoUs = monoUs;
+    synced = true;
+    lastSampleMonoUs = monoUs;
+    lastSampleStepped = stepped;
+    lastOffsetMs = (int32_t)(offset / 1000);
+    sampleCount++;
+
+    // Keep time() and the TLS certificate checks on the same clock
+    int64_t now = clockUs(esp_timer_get_time());
+    struct timeval tv = {(time_t)(now / 1000000), (suseconds_t)(now % 1000000)};
+    settimeofday(&tv, nullptr);
+
+    Serial.print("🕐 NTP sample: offset ");
+    Serial.print(lastOffsetMs);
+    Serial.print(stepped ? " ms (stepped), drift " : " ms (slewing), drift ");
+    Serial.print(driftPpb / 1000.0f, 1);
+    Serial.println(" ppm");
+}
+
+// === Date storage ===
+
+// /system/date, /system/time and /system/timestamp in one update; retried
+// every minute until it succeeds
+void storeDateToFirebase()
+{
+    if (systemStatus.firebase != FB_CONNECTED)
+        return;
+    TlsLease lease(NET_CLIENT_FIREBASE);
+    if (!lease)
+        return;
+
+    char dateBuffer[20];
+    char timeBuffer[10];
+    sprintf(dateBuffer, "\"%d/%d/%d\"", currentDay, currentMonth, currentYear);
+    sprintf(timeBuffer, "\"%d:%02d\"", Hours, Minutes);
 
+    String body;
+    addFirebaseUpdate(body, "system/date/current", dateBuffer);
+    addFirebaseUpdate(body, "system/time/current", timeBuffer);
+    addFirebaseUpdate(body, "system/timestamp", String(getEpochTime()));
+    if (!sendFirebaseUpdate("/", body))
+    {
+        Serial.print("❌ Date update failed: ");
+        Serial.println(fbData.errorReason());
+        return;
+    }
+    dateStorePending = false;
+    Serial.print("📅 Date stored: ");
+    Serial.println(dateBuffer);
+}
+
+static void storeDateOnNewDay(const CivilTime &local)
+{
+    dateStorePending = true;
+    storeDateToFirebase();
+}
+
+static void retryDateStore(const CivilTime &local)
+{
+    if (dateStorePending)
+        storeDateToFirebase();
+}
+
+void initTimeManager()
+{
     // Wait for WiFi connection
-    if (WiFi.status() != WL_CONNECTED)
+    if (!isWiFiConnected())
     {
         Serial.println("WiFi not connected, cannot initialize time manager");
         return;
     }
+    if (sntp_enabled())
+        return;
 
-    // Initialize NTP client with GMT offset (0)
-    timeClient.begin();
-    timeClient.setTimeOffset(0); // Set to GMT (UTC+0)
-    timeClient.update();
-
-    // Get initial time
-    time_t epochTime = timeClient.getEpochTime();
-    currentDay = day(epochTime);
-    currentMonth = month(epochTime);
-    nextDay = currentDay + 1;
-
-    Serial.println("Time Manager initialized successfully (GMT)");
-    Serial.print("Current date: ");
-    Serial.print(currentDay);
-    Serial.print("/");
-    Serial.print(currentMonth);
-    Serial.print("/");
-    Serial.println(year(epochTime));
-
-    // Print current GMT time for verification
-    Serial.print("Current GMT time: ");
-    Serial.print(hour(epochTime));
-    Serial.print(":");
-    Serial.println(minute(epochTime));
+    Serial.println("Initializing Time Manager...");
+    setTimeZone(LOCAL_TIMEZONE);
+    onCalendarEvent(CAL_DAY, storeDateOnNewDay);
+    onCalendarEvent(CAL_MINUTE, retryDateStore);
+    sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    sntp_setservername(0, NTP_SERVER);
+    sntp_set_sync_interval(CLOCK_NTP_SYNC_MS);
+    sntp_init();
+    Serial.println("Time Manager started (SNTP " NTP_SERVER ", " LOCAL_TIMEZONE ")");
 }
 
+// Called by the "time" scheduler job every TIME_UPDATE_INTERVAL ms
 void handleTimeManager()
 {
-    // Update time periodically
-    static unsigned long lastTimeUpdate = 0;
-    if (millis() - lastTimeUpdate > 30000) // Update every 30 seconds
-    {
-        getTime();
-        lastTimeUpdate = millis();
-    }
+    portENTER_CRITICAL(&sampleMux);
+    bool pending = samplePending;
+    int64_t epochUs = pendingEpochUs;
+    int64_t monoUs = pendingMonoUs;
+    samplePending = false;
+    portEXIT_CRITICAL(&sampleMux);
+
+    if (pending)
+        applySample(epochUs, monoUs);
+    getTime();
 }
 
 /***************************************
@@ -74,103 +204,31 @@ void handleTimeManager()
  ***************************************/
 void getTime()
 {
-    timeClient.update();
-    time_t epochTime = timeClient.getEpochTime();
-
-    currentDay = day(epochTime);
-    currentMonth = month(epochTime);
-
-    int currentYear = year(epochTime);
-    Hours = hour(epochTime);
-    Minutes = minute(epochTime);
-    int currentSecond = second(epochTime);
-    String currentTime = getFormattedTime();
-
-    // For GMT, we always use offset 0 (no DST adjustment)
-    timeClient.setTimeOffset(0);
-
-    // Print the complete date and time for debugging
-    Serial.printf("GMT Date and Time: %02d-%02d-%04d %02d:%02d:%02d\n", currentDay, currentMonth, currentYear, Hours, Minutes, currentSecond);
-
-    if (currentDay == nextDay)
-    {
-        if (currentMonth == 2) // February
-        {
-            Serial.println("February");
-            // Check for leap year
-            if ((year() % 4 == 0 && year() % 100 != 0) || (year() % 400 == 0)) // Leap year
-            {
-                if (currentDay > 28)
-                {
-                    Serial.println("line 594");
-                    // publishTimeToMQTT();
-                    storeDateToFirebase();
-                    asBeenSaved = true;
-                    nextDay = 1; // Reset nextDay to 1 for the next month
-                }
-            }
-            else // Non-leap year
-            {
-                if (currentDay > 27)
-                {
-                    Serial.println("line 607");
-                    // publishTimeToMQTT();
-                    storeDateToFirebase();
-                    asBeenSaved = true;
-                    nextDay = 1; // Reset nextDay to 1 for the next month
-                    Serial.println("Non-leap year February");
-                }
-            }
-        }
-        else if (currentMonth == 4 || currentMonth == 6 || currentMonth == 9 || currentMonth == 11) // Months with 30 days
-        {
-            if (currentDay > 29)
-            {
-                Serial.println("April, June, September, November");
-                Serial.println("line 623");
-                // publishTimeToMQTT();
-                storeDateToFirebase();
-                asBeenSaved = true;
-                nextDay = 1; // Reset nextDay to 1 for the next month
-            }
-        }
-        else // Months with 31 days
-        {
-            if (currentDay > 30)
-            {
-                Serial.println("All other months have 31 days");
-                Serial.println("line 637");
-                // publishTimeToMQTT();
-                storeDateToFirebase();
-                asBeenSaved = true;
-                nextDay = 1; // Reset nextDay to 1 for the next month
-            }
-        }
+    uint32_t now = getEpochTime();
+    uint32_t localTime = toLocalTime(now);
+    if (now == 0 || localTime / 60 == calendarMinute)
+        return;
+    bool first = calendarMinute == 0;
+    calendarMinute = localTime / 60;
 
-        // Reset to January if the month exceeds December
-        if (currentMonth > 12)
-        {
-            Serial.println("Resetting month to January");
-            currentMonth = 1;
-        }
-        if (asBeenSaved == false)
-        {
-            // Store the date in Firebase
-            storeDateToFirebase();
-            // Publish the time to MQTT
-            Serial.println("line 658");
-            // publishTimeToMQTT();
-            asBeenSaved = true;
-            nextDay++; // Increment nextDay for the next day
-        }
-    }
+    CivilTime local;
+    civilFromEpoch(localTime, local);
+    currentDay = local.day;
+    currentMonth = local.month;
+    currentYear = local.year;
+    Hours = local.hour;
+    Minutes = local.minute;
+    if (first || Minutes == 0)
+        Serial.printf("Local Date and Time: %02d-%02d-%04d %02d:%02d %s\n", currentDay, currentMonth, currentYear,
+                      Hours, Minutes, timeZoneName(now));
+    emitCalendarRollover(local);
 }
 
+// Whether DST applies at that local standard time of the current year
 bool isDST(int day, int month, int hour)
 {
-    // For GMT time, we don't apply DST adjustments
-    // GMT stays constant year-round
-    return false;
+    int64_t local = (int64_t)daysFromCivil(currentYear, month, day) * 86400 + hour * 3600;
+    return isDstAt((uint32_t)(local - getStandardOffset()));
 }
 
 /***************************************
@@ -178,37 +236,6 @@ bool isDST(int day, int month, int hour)
  *           end                       *
  ***************************************/
 
-void storeDateToFirebase()
-{
-    Serial.println("Storing date to Firebase...");
-
-    // Get current timestamp
-    time_t epochTime = timeClient.getEpochTime();
-
-    // Store date components
-    String datePath = "/system/date/";
-
-    // Create date object with current values
-    char dateBuffer[20];
-    char timeBuffer[10];
-
-    sprintf(dateBuffer, "%d/%d/%d", currentDay, currentMonth, year(epochTime));
-    sprintf(timeBuffer, "%d:%02d", Hours, Minutes);
-
-    String dateStr = String(dateBuffer);
-    String timeStr = String(timeBuffer);
-
-    // Store in Firebase (using external Firebase functions)
-    setControlValue("/system/date/current", dateStr.c_str());
-    setControlValue("/system/time/current", timeStr.c_str());
-    setControlValue("/system/timestamp", (float)epochTime);
-
-    Serial.print("Date stored: ");
-    Serial.println(dateStr);
-    Serial.print("Time stored: ");
-    Serial.println(timeStr);
-}
-
 String getFormattedTime()
 {
     char timeBuffer[10];
@@ -218,8 +245,29 @@ String getFormattedTime()
 
 String getFormattedDate()
 {
-    time_t epochTime = timeClient.getEpochTime();
     char dateBuffer[20];
-    sprintf(dateBuffer, "%d/%d/%d", currentDay, currentMonth, year(epochTime));
+    sprintf(dateBuffer, "%d/%d/%d", currentDay, currentMonth, currentYear);
     return String(dateBuffer);
 }
+
+uint32_t getEpochTime()
+{
+    return synced ? (uint32_t)(clockUs(esp_timer_get_time()) / 1000000) : 0;
+}
+
+uint64_t getEpochMs()
+{
+    return synced ? (uint64_t)(clockUs(esp_timer_get_time()) / 1000) : 0;
+}
+
+ClockStats getClockStats()
+{
+    ClockStats stats;
+    stats.synced = synced;
+    stats.driftPpb = driftPpb;
+    stats.lastOffsetMs = lastOffsetMs;
+    stats.samples = sampleCount;
+    stats.steps = stepCount;
+    stats.lastSampleAgeS = synced ? (uint32_t)((esp_timer_get_time() - lastSampleMonoUs) / 1000000) : 0;
+    return stats;
+}
@@ -1,35 +1,67 @@
 // ==================================================
 // File: src/TimeManager.h
 // ==================================================
+//
+// Clock service. UTC is kept from esp_timer (microseconds since boot) and
+// disciplined against NTP, so reading the time is a timer read and a few
+// multiplies - no network I/O - and it keeps running when NTP is
+// unreachable.
+//
+// Samples come from the lwIP SNTP client (sntp_sync_time() is overridden)
+// every CLOCK_NTP_SYNC_MS and are applied by the "time" job:
+//   - the first sample, or one more than CLOCK_STEP_THRESHOLD_MS off, steps
+//     the clock;
+//   - smaller offsets are slewed out at up to CLOCK_SLEW_MAX_PPM, so the
+//     clock never jumps;
+//   - the offset left over after a full sync interval is oscillator drift,
+//     folded into a rate correction (driftPpb).
+// Every sample also sets the system time (settimeofday), for time() and TLS.
+//
+// The calendar globals below are local time (LOCAL_TIMEZONE), recomputed
+// only when the minute rolls over, by getTime() from the "time" job, which
+// then emits the rollover events (CalendarEvents.h).
 
 #ifndef TIMEMANAGER_H
 #define TIMEMANAGER_H
 
-#include <WiFiUdp.h>
-#include <NTPClient.h>
-#include <TimeLib.h>
+#include <Arduino.h>
 
 // Time configuration constants
-#define UTC_OFFSET_STANDARD 0 // UTC+0 (GMT - Greenwich Mean Time)
-#define UTC_OFFSET_DST 0      // UTC+0 (GMT - no DST adjustment for GMT)
+#define LOCAL_TIMEZONE "GMT0BST,M3.5.0/1,M10.5.0" // POSIX TZ (TimeZone.h): UK, GMT and BST
 #define NTP_SERVER "pool.ntp.org"
-#define NTP_UPDATE_INTERVAL 60000 // Update every 60 seconds
+#define CLOCK_NTP_SYNC_MS 900000      // SNTP poll interval
+#define CLOCK_STEP_THRESHOLD_MS 1000  // larger offsets are stepped, not slewed
+#define CLOCK_SLEW_MAX_PPM 500        // at most 0.5 ms per second
+#define CLOCK_DRIFT_MAX_PPM 200       // ESP32 crystals are within tens of ppm
+#define CLOCK_DRIFT_MIN_SAMPLE_S 600  // shorter intervals are too noisy for a rate
 
 // Global time variables
 extern int currentDay;
 extern int currentMonth;
+extern int currentYear;
 extern int Hours;
 extern int Minutes;
-extern int nextDay;
-extern bool asBeenSaved;
+
+struct ClockStats
+{
+    bool synced;
+    int32_t driftPpb;      // rate correction applied to esp_timer
+    int32_t lastOffsetMs;  // NTP minus clock at the last sample
+    uint32_t samples;      // NTP samples applied
+    uint32_t steps;        // of which stepped the clock
+    uint32_t lastSampleAgeS;
+};
 
 // Function declarations
 void initTimeManager();
-void getTime();
-bool isDST(int day, int month, int hour);
-void storeDateToFirebase();
+void getTime(); // refreshes the calendar globals and emits events on minute rollover
+bool isDST(int day, int month, int hour); // local standard time, current year
+void storeDateToFirebase(); // also on every new day, by a CAL_DAY handler
 void handleTimeManager();
 String getFormattedTime();
 String getFormattedDate();
+uint32_t getEpochTime(); // UTC seconds, 0 until NTP has synced
+uint64_t getEpochMs();   // UTC milliseconds, 0 until NTP has synced
+ClockStats getClockStats();
 
 #endif // TIMEMANAGER_H
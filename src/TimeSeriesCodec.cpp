@@ -0,0 +1,257 @@
+// ==================================================
+// File: src/TimeSeriesCodec.cpp
+// ==================================================
+
+#include "TimeSeriesCodec.h"
+#include <string.h>
+
+#define TS_BLOCK_BITS (TS_BLOCK_SIZE * 8)
+
+// Bucket widths (zigzag bits) for '10', '110' and '1110'
+static const uint8_t TIME_WIDTHS[3] = {7, 12, 20};
+static const uint8_t VALUE_WIDTHS[3] = {6, 12, 20};
+
+// === Bit stream (stored inverted, MSB first) ===
+
+static void putBits(uint8_t *block, uint32_t &pos, uint32_t value, uint8_t bits)
+{
+    while (bits > 0)
+    {
+        bits--;
+        if ((value >> bits) & 1)
+            block[pos >> 3] &= ~(0x80 >> (pos & 7));
+        pos++;
+    }
+}
+
+static bool getBits(const uint8_t *block, uint32_t &pos, uint8_t bits, uint32_t &value)
+{
+    if (pos + bits > TS_BLOCK_BITS)
+        return false;
+    value = 0;
+    while (bits > 0)
+    {
+        bits--;
+        uint32_t bit = (block[pos >> 3] & (0x80 >> (pos & 7))) ? 0 : 1;
+        value = (value << 1) | bit;
+        pos++;
+    }
+    return true;
+}
+
+static uint32_t zigzag(uint32_t v)
+{
+    return (v << 1) ^ (uint32_t)((int32_t)v >> 31);
+}
+
+static uint32_t unzigzag(uint32_t z)
+{
+    return (z >> 1) ^ (0U - (z & 1));
+}
+
+// Size in bits of one bucketed value (0 = '0')
+static uint8_t bucketBits(uint32_t v, const uint8_t *widths)
+{
+    if (v == 0)
+        return 1;
+    uint32_t z = zigzag(v);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        if (z < (1UL << widths[i]))
+            return i + 2 + widths[i];
+    }
+    return 4 + 32;
+}
+
+static void putBucket(uint8_t *block, uint32_t &pos, uint32_t v, const uint8_t *widths)
+{
+    if (v == 0)
+    {
+        putBits(block, pos, 0, 1);
+        return;
+    }
+    uint32_t z = zigzag(v);
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        if (z < (1UL << widths[i]))
+        {
+            // i+1 ones then a zero: '10', '110', '1110'
+            putBits(block, pos, ((1UL << (i + 1)) - 1) << 1, i + 2);
+            putBits(block, pos, z, widths[i]);
+            return;
+        }
+    }
+    putBits(block, pos, 0xF, 4);
+    putBits(block, pos, z, 32);
+}
+
+static bool getBucket(const uint8_t *block, uint32_t &pos, const uint8_t *widths, uint32_t &v)
+{
+    uint8_t ones = 0;
+    uint32_t bit;
+    while (ones < 4)
+    {
+        if (!getBits(block, pos, 1, bit))
+            return false;
+        if (bit == 0)
+            break;
+        ones++;
+    }
+    if (ones == 0)
+    {
+        v = 0;
+        return true;
+    }
+    uint32_t z;
+    if (!getBits(block, pos, ones == 4 ? 32 : widths[ones - 1], z))
+        return false;
+    v = unzigzag(z);
+    return true;
+}
+
+// === Header ===
+
+static void putWord(uint8_t *p, uint32_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static uint32_t getWord(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool tsReadHeader(const uint8_t *block, TsBlockHeader &out)
+{
+    out.magic = getWord(block);
+    out.seq = getWord(block + 4);
+    out.baseT = getWord(block + 8);
+    out.check = getWord(block + 12);
+    return out.magic == TS_BLOCK_MAGIC && out.check == ~(out.magic ^ out.seq ^ out.baseT);
+}
+
+static void resetState(TsCodecState &state, uint32_t baseT)
+{
+    state.t = baseT;
+    state.delta = 0;
+    for (uint8_t i = 0; i < TS_FIELD_COUNT; i++)
+    {
+        state.values[i] = 0;
+    }
+}
+
+// === Encoder ===
+
+void TsBlockEncoder::begin(uint8_t *buf, uint32_t seq, uint32_t baseT)
+{
+    block = buf;
+    memset(block, 0xFF, TS_BLOCK_SIZE);
+    putWord(block, TS_BLOCK_MAGIC);
+    putWord(block + 4, seq);
+    putWord(block + 8, baseT);
+    putWord(block + 12, ~(TS_BLOCK_MAGIC ^ seq ^ baseT));
+    bitPos = TS_HEADER_SIZE * 8;
+    count = 0;
+    resetState(state, baseT);
+}
+
+bool TsBlockEncoder::resume(uint8_t *buf)
+{
+    TsBlockDecoder dec;
+    if (!dec.begin(buf))
+        return false;
+    block = buf;
+    count = 0;
+    TsRecord r;
+    while (dec.next(r))
+    {
+        count++;
+    }
+    bitPos = dec.bitPos;
+    state = dec.state;
+    // A torn record leaves stray programmed bits after the last good one;
+    // they would corrupt whatever is appended next
+    for (uint32_t i = bitPos; i < TS_BLOCK_BITS; i++)
+    {
+        if (!(block[i >> 3] & (0x80 >> (i & 7))))
+        {
+            bitPos = TS_BLOCK_BITS; // treat the block as full
+            break;
+        }
+    }
+    return true;
+}
+
+bool TsBlockEncoder::append(const TsRecord &r)
+{
+    uint32_t delta = r.t - state.t;
+    uint32_t dod = delta - state.delta;
+    uint32_t diffs[TS_FIELD_COUNT];
+
+    uint32_t bits = 1 + bucketBits(dod, TIME_WIDTHS);
+    for (uint8_t i = 0; i < TS_FIELD_COUNT; i++)
+    {
+        diffs[i] = (uint32_t)r.values[i] - (uint32_t)state.values[i];
+        bits += bucketBits(diffs[i], VALUE_WIDTHS);
+    }
+    if (bitPos + bits > TS_BLOCK_BITS)
+        return false;
+
+    putBits(block, bitPos, 1, 1);
+    putBucket(block, bitPos, dod, TIME_WIDTHS);
+    for (uint8_t i = 0; i < TS_FIELD_COUNT; i++)
+    {
+        putBucket(block, bitPos, diffs[i], VALUE_WIDTHS);
+        state.values[i] = r.values[i];
+    }
+    state.t = r.t;
+    state.delta = delta;
+    count++;
+    return true;
+}
+
+// === Decoder ===
+
+bool TsBlockDecoder::begin(const uint8_t *buf)
+{
+    TsBlockHeader header;
+    block = buf;
+    if (!tsReadHeader(block, header))
+        return false;
+    bitPos = TS_HEADER_SIZE * 8;
+    resetState(state, header.baseT);
+    return true;
+}
+
+bool TsBlockDecoder::next(TsRecord &out)
+{
+    // Work on copies so a truncated record leaves the decoder where it was
+    uint32_t pos = bitPos;
+    TsCodecState s = state;
+    uint32_t marker, dod, diff;
+
+    if (!getBits(block, pos, 1, marker) || marker == 0)
+        return false;
+    if (!getBucket(block, pos, TIME_WIDTHS, dod))
+        return false;
+    s.delta += dod;
+    s.t += s.delta;
+    for (uint8_t i = 0; i < TS_FIELD_COUNT; i++)
+    {
+        if (!getBucket(block, pos, VALUE_WIDTHS, diff))
+            return false;
+        s.values[i] = (int32_t)((uint32_t)s.values[i] + diff);
+    }
+
+    bitPos = pos;
+    state = s;
+    out.t = s.t;
+    for (uint8_t i = 0; i < TS_FIELD_COUNT; i++)
+    {
+        out.values[i] = s.values[i];
+    }
+    return true;
+}
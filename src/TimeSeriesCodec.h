@@ -0,0 +1,93 @@
+// ==================================================
+// File: src/TimeSeriesCodec.h
+// ==================================================
+//
+// Gorilla-style compressed time-series blocks. A block is one 4 KB flash
+// sector: a 16-byte header followed by a bit stream of records, each record
+// being one timestamp and TS_FIELD_COUNT fixed-point values.
+//
+//   record    := '1' timestamp value*TS_FIELD_COUNT   ('0' = end of block)
+//   timestamp := delta-of-delta of the seconds, bucketed
+//   value     := delta from the previous value of the same field, bucketed
+//   bucket    := '0'                  -> 0
+//              | '10'   + w0 bits     -> zigzag value fits w0 bits
+//              | '110'  + w1 bits
+//              | '1110' + w2 bits
+//              | '1111' + 32 bits
+//
+// Gorilla XORs IEEE doubles; our values are already integers (centi-degrees,
+// centi-amps, on/off), so a plain delta is smaller and just as cheap. A
+// regular sampling interval costs one bit for the timestamp and an unchanged
+// value one bit, so a typical record is 4-6 bytes.
+//
+// The stream is stored inverted (a 1 bit is written as a programmed 0), so an
+// erased sector reads as "end of block" and a block can be appended to in
+// place - rewriting its last, partially used byte only ever clears bits,
+// which NOR flash allows without an erase.
+//
+// Plain C++ with no Arduino dependencies, so it also builds on the host.
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+#define TS_BLOCK_SIZE 4096 // one flash sector
+#define TS_BLOCK_MAGIC 0x31425354UL // "TSB1"
+#define TS_HEADER_SIZE 16
+#define TS_FIELD_COUNT 5
+
+enum TsField
+{
+    TS_FIELD_TEMP_RED,   // centi-degrees, Temp::INVALID_RAW when missing
+    TS_FIELD_TEMP_BLUE,
+    TS_FIELD_TEMP_GREEN,
+    TS_FIELD_CURRENT,    // centi-amps
+    TS_FIELD_HEATER      // 0 = off, 1 = on
+};
+
+struct TsRecord
+{
+    uint32_t t; // epoch seconds
+    int32_t values[TS_FIELD_COUNT];
+};
+
+struct TsBlockHeader
+{
+    uint32_t magic;
+    uint32_t seq;   // increases by one per block, orders the ring
+    uint32_t baseT; // timestamp of the first record
+    uint32_t check; // ~(magic ^ seq ^ baseT), catches torn header writes
+};
+
+// Running state shared by the encoder and decoder
+struct TsCodecState
+{
+    uint32_t t;
+    uint32_t delta; // previous timestamp delta
+    int32_t values[TS_FIELD_COUNT];
+};
+
+struct TsBlockEncoder
+{
+    uint8_t *block;
+    uint32_t bitPos; // from the start of the block
+    uint16_t count;
+    TsCodecState state;
+
+    void begin(uint8_t *block, uint32_t seq, uint32_t baseT); // erases `block` in RAM
+    bool resume(uint8_t *block);                             // continue after the last record
+    bool append(const TsRecord &r);                          // false = block full
+    uint32_t usedBytes() const { return (bitPos + 7) / 8; }
+};
+
+struct TsBlockDecoder
+{
+    const uint8_t *block;
+    uint32_t bitPos;
+    TsCodecState state;
+
+    bool begin(const uint8_t *block); // false = no valid header
+    bool next(TsRecord &out);         // false = end of block (or corrupt tail)
+};
+
+bool tsReadHeader(const uint8_t *block, TsBlockHeader &out);
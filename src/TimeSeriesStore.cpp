@@ -0,0 +1,322 @@
+// ==================================================
+// File: src/TimeSeriesStore.cpp
+// ==================================================
+
+#include "TimeSeriesStore.h"
+#include "config.h"
+#include "TemperatureSensors.h"
+#include "TimeManager.h"
+#include <esp_partition.h>
+
+extern SystemStatus systemStatus;
+
+static const esp_partition_t *partition = nullptr;
+static const uint8_t *mapped = nullptr; // whole partition, read-only
+static spi_flash_mmap_handle_t mapHandle;
+static uint16_t blockCount = 0;
+
+static uint8_t activeBuf[TS_BLOCK_SIZE]; // RAM copy of the block being filled
+static TsBlockEncoder encoder;
+static uint16_t activeBlock = 0;
+static uint32_t activeSeq = 0;
+static uint32_t flushedBits = 0; // prefix of activeBuf already on flash
+static bool ready = false;
+static bool haveRecords = false;
+static uint32_t lastFlushT = 0;
+
+static TimeSeriesStats stats;
+
+// === Flash helpers ===
+
+static const uint8_t *blockData(uint16_t index)
+{
+    // Unflushed records only exist in RAM
+    return index == activeBlock ? activeBuf : mapped + (uint32_t)index * TS_BLOCK_SIZE;
+}
+
+static bool blockHeader(uint16_t index, TsBlockHeader &header)
+{
+    return tsReadHeader(blockData(index), header);
+}
+
+static bool writeActive(uint32_t from, uint32_t to)
+{
+    if (to <= from)
+        return true;
+    esp_err_t err = esp_partition_write(partition, (uint32_t)activeBlock * TS_BLOCK_SIZE + from, activeBuf + from, to - from);
+    if (err != ESP_OK)
+    {
+        Serial.print("❌ History flash write failed: ");
+        Serial.println(esp_err_to_name(err));
+        return false;
+    }
+    stats.bytesWritten += to - from;
+    return true;
+}
+
+// Erases the next sector and starts a block there; the header goes to
+// flash right away so a reboot finds the block
+static bool openBlock(uint16_t index, uint32_t seq, uint32_t baseT)
+{
+    activeBlock = index;
+    activeSeq = seq;
+    encoder.begin(activeBuf, seq, baseT);
+    flushedBits = 0;
+
+    esp_err_t err = esp_partition_erase_range(partition, (uint32_t)index * TS_BLOCK_SIZE, TS_BLOCK_SIZE);
+    if (err != ESP_OK)
+    {
+        Serial.print("❌ History flash erase failed: ");
+        Serial.println(esp_err_to_name(err));
+        return false;
+    }
+    stats.erases++;
+    if (!writeActive(0, TS_HEADER_SIZE))
+        return false;
+    flushedBits = TS_HEADER_SIZE * 8;
+    return true;
+}
+
+// Finds the valid block with the highest sequence number
+static bool findNewestBlock(uint16_t &index, uint32_t &seq)
+{
+    bool found = false;
+    for (uint16_t i = 0; i < blockCount; i++)
+    {
+        TsBlockHeader header;
+        if (!tsReadHeader(mapped + (uint32_t)i * TS_BLOCK_SIZE, header))
+            continue;
+        if (!found || (int32_t)(header.seq - seq) > 0)
+        {
+            index = i;
+            seq = header.seq;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// Blocks from the oldest still in the ring up to the active one are
+// consecutive sequence numbers
+static uint16_t oldestBlock(uint16_t &used)
+{
+    used = 1;
+    uint16_t index = activeBlock;
+    while (used < blockCount)
+    {
+        uint16_t prev = (index + blockCount - 1) % blockCount;
+        TsBlockHeader header;
+        if (!blockHeader(prev, header) || header.seq != activeSeq - used)
+            break;
+        index = prev;
+        used++;
+    }
+    return index;
+}
+
+// === Public API ===
+
+bool initTimeSeriesStore()
+{
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)TSDB_PARTITION_SUBTYPE,
+                                         TSDB_PARTITION_LABEL);
+    if (partition == nullptr)
+    {
+        Serial.println("❌ No \"" TSDB_PARTITION_LABEL "\" partition - flash history disabled");
+        return false;
+    }
+    blockCount = partition->size / TS_BLOCK_SIZE;
+
+    const void *ptr;
+    if (esp_partition_mmap(partition, 0, (size_t)blockCount * TS_BLOCK_SIZE, SPI_FLASH_MMAP_DATA, &ptr, &mapHandle) != ESP_OK)
+    {
+        Serial.println("❌ Cannot map history partition - flash history disabled");
+        return false;
+    }
+    mapped = (const uint8_t *)ptr;
+    stats.blocks = blockCount;
+
+    uint16_t index;
+    uint32_t seq;
+    activeBlock = blockCount; // nothing in RAM yet, blockData() reads flash
+    if (findNewestBlock(index, seq))
+    {
+        memcpy(activeBuf, mapped + (uint32_t)index * TS_BLOCK_SIZE, TS_BLOCK_SIZE);
+        activeBlock = index;
+        activeSeq = seq;
+        encoder.resume(activeBuf);
+        flushedBits = encoder.bitPos;
+        haveRecords = true;
+        Serial.print("✅ Flash history resumed: block ");
+        Serial.print(index);
+        Serial.print(", ");
+        Serial.print(encoder.count);
+        Serial.println(" records in it");
+    }
+    else
+    {
+        // Empty partition: the first record opens block 0
+        activeBlock = blockCount - 1;
+        activeSeq = 0;
+        encoder.begin(activeBuf, 0, 0);
+        encoder.bitPos = TS_BLOCK_SIZE * 8; // full, so the first append moves on
+        flushedBits = encoder.bitPos;
+        Serial.print("✅ Flash history initialized: ");
+        Serial.print(blockCount);
+        Serial.println(" blocks");
+    }
+    ready = true;
+    return true;
+}
+
+bool appendTimeSeries(const TsRecord &r)
+{
+    if (!ready)
+        return false;
+    if (haveRecords && (int32_t)(r.t - encoder.state.t) <= 0)
+        return false; // the clock went backwards, keep the stream monotonic
+
+    if (!encoder.append(r))
+    {
+        // Block full: finish it on flash and move to the next sector
+        writeActive(flushedBits / 8, encoder.usedBytes());
+        uint16_t next = (activeBlock + 1) % blockCount;
+        if (!openBlock(next, activeSeq + 1, r.t) || !encoder.append(r))
+            return false;
+        lastFlushT = r.t;
+    }
+    haveRecords = true;
+    stats.records++;
+
+    if (r.t - lastFlushT >= TSDB_FLUSH_INTERVAL_S)
+        flushTimeSeries();
+    return true;
+}
+
+void flushTimeSeries()
+{
+    if (!ready || encoder.bitPos <= flushedBits)
+        return;
+    // The last byte may already be on flash half-filled; writing it again
+    // only programs more bits (see TimeSeriesCodec.h)
+    if (writeActive(flushedBits / 8, encoder.usedBytes()))
+    {
+        flushedBits = encoder.bitPos;
+        stats.flushes++;
+    }
+    lastFlushT = encoder.state.t;
+}
+
+void recordTimeSeriesSample()
+{
+    uint32_t now = getEpochTime();
+    if (now == 0)
+        return; // records need wall-clock timestamps
+
+    // The heater tick keeps the readings fresh; a conversion here would block
+    TsRecord r;
+    r.t = now;
+    r.values[TS_FIELD_TEMP_RED] = getLastTemperature(0).centi;
+    r.values[TS_FIELD_TEMP_BLUE] = getLastTemperature(1).centi;
+    r.values[TS_FIELD_TEMP_GREEN] = getLastTemperature(2).centi;
+    r.values[TS_FIELD_CURRENT] = systemStatus.heater == HEATER_ON ? lroundf(getHeaterCurrent() * 100.0f) : 0;
+    r.values[TS_FIELD_HEATER] = systemStatus.heater == HEATER_ON ? 1 : 0;
+    appendTimeSeries(r);
+}
+
+void beginTimeSeriesRead(TsCursor &c, uint32_t fromT)
+{
+    c.open = false;
+    c.fromT = fromT;
+    c.remaining = 0;
+    if (!ready || !haveRecords)
+        return;
+
+    uint16_t used;
+    c.block = oldestBlock(used);
+    c.remaining = used;
+    c.seq = activeSeq - used + 1;
+
+    // Skip whole blocks when the next one already starts before fromT
+    while (c.remaining > 1)
+    {
+        TsBlockHeader next;
+        if (!blockHeader((c.block + 1) % blockCount, next) || (int32_t)(next.baseT - fromT) > 0)
+            break;
+        c.block = (c.block + 1) % blockCount;
+        c.seq++;
+        c.remaining--;
+    }
+}
+
+bool nextTimeSeriesRecord(TsCursor &c, TsRecord &out)
+{
+    while (c.remaining > 0)
+    {
+        if (!c.open)
+        {
+            // The ring may have moved on since the cursor was created
+            TsBlockHeader header;
+            if (!blockHeader(c.block, header) || header.seq != c.seq || !c.dec.begin(blockData(c.block)))
+            {
+                c.remaining = 0;
+                return false;
+            }
+            c.open = true;
+        }
+        while (c.dec.next(out))
+        {
+            if ((int32_t)(out.t - c.fromT) >= 0)
+                return true;
+        }
+        c.open = false;
+        c.block = (c.block + 1) % blockCount;
+        c.seq++;
+        c.remaining--;
+    }
+    return false;
+}
+
+TimeSeriesStats getTimeSeriesStats()
+{
+    TimeSeriesStats s = stats;
+    s.usedBlocks = 0;
+    s.oldestT = 0;
+    s.newestT = 0;
+    if (ready && haveRecords)
+    {
+        uint16_t oldest = oldestBlock(s.usedBlocks);
+        TsBlockHeader header;
+        if (blockHeader(oldest, header))
+            s.oldestT = header.baseT;
+        s.newestT = encoder.state.t;
+    }
+    return s;
+}
+
+void printTimeSeriesStats()
+{
+    if (!ready)
+        return;
+    TimeSeriesStats s = getTimeSeriesStats();
+    Serial.print("Flash history: ");
+    Serial.print(s.usedBlocks);
+    Serial.print("/");
+    Serial.print(s.blocks);
+    Serial.print(" blocks");
+    if (s.newestT > s.oldestT)
+    {
+        Serial.print(" (");
+        Serial.print((s.newestT - s.oldestT) / 3600);
+        Serial.print(" h)");
+    }
+    Serial.print(", active ");
+    Serial.print(encoder.usedBytes());
+    Serial.print(" B / ");
+    Serial.print(encoder.count);
+    Serial.print(" records, ");
+    Serial.print(s.bytesWritten);
+    Serial.print(" B written, ");
+    Serial.print(s.erases);
+    Serial.println(" erases");
+}
@@ -0,0 +1,55 @@
+// ==================================================
+// File: src/TimeSeriesStore.h
+// ==================================================
+//
+// Long-term history on flash: a ring of TimeSeriesCodec blocks, one per 4 KB
+// sector of the "tsdb" data partition (partitions.csv). One record per
+// TSDB_SAMPLE_INTERVAL holds the three temperatures, the heater current and
+// the heater state - about 2-3 bytes each, so a block covers a day or more
+// at one sample a minute and the partition keeps over a year.
+//
+// The active block lives in RAM and is appended to flash in place every
+// TSDB_FLUSH_INTERVAL_S; a sector is erased only when the ring reaches it
+// again. After a reboot the newest block is decoded and appended to.
+// Older blocks are read through a memory mapping of the partition.
+
+#pragma once
+#include <Arduino.h>
+#include "TimeSeriesCodec.h"
+
+#define TSDB_PARTITION_LABEL "tsdb"
+#define TSDB_PARTITION_SUBTYPE 0x40 // custom data subtype
+#define TSDB_FLUSH_INTERVAL_S 600   // at most this much history is lost on power-off
+
+struct TimeSeriesStats
+{
+    uint16_t blocks;     // sectors in the partition
+    uint16_t usedBlocks; // holding data
+    uint32_t oldestT;    // epoch of the oldest record, 0 = empty
+    uint32_t newestT;
+    uint32_t records;    // appended since boot
+    uint32_t flushes;
+    uint32_t bytesWritten;
+    uint32_t erases;
+};
+
+// Reads records oldest first, across blocks
+struct TsCursor
+{
+    uint16_t block;     // current block index
+    uint16_t remaining; // blocks left, including the current one
+    uint32_t seq;       // expected sequence number of the current block
+    uint32_t fromT;
+    bool open;          // dec is positioned inside `block`
+    TsBlockDecoder dec;
+};
+
+// Function declarations
+bool initTimeSeriesStore();
+void recordTimeSeriesSample(); // reads sensors/heater; no-op until the clock is set
+bool appendTimeSeries(const TsRecord &r);
+void flushTimeSeries();
+void beginTimeSeriesRead(TsCursor &c, uint32_t fromT);
+bool nextTimeSeriesRecord(TsCursor &c, TsRecord &out);
+TimeSeriesStats getTimeSeriesStats();
+void printTimeSeriesStats();
@@ -0,0 +1,277 @@
+// ==================================================
+// File: src/TimeZone.cpp
+// ==================================================
+
+#include "TimeZone.h"
+
+enum TzRuleType
+{
+    TZ_RULE_MONTH_WEEK_DAY, // Mm.w.d
+    TZ_RULE_JULIAN,         // Jn, no February 29
+    TZ_RULE_DAY_OF_YEAR     // n, counting February 29
+};
+
+struct TzRule
+{
+    TzRuleType type;
+    int16_t month;
+    int16_t week;
+    int16_t day; // weekday, or day of the year
+    int32_t timeS;
+};
+
+static char stdName[TZ_NAME_MAX + 1] = "UTC";
+static char dstName[TZ_NAME_MAX + 1] = "";
+static int32_t stdOffsetS = 0; // east of UTC
+static int32_t dstOffsetS = 0;
+static bool hasDst = false;
+static TzRule startRule;
+static TzRule endRule;
+
+// Transitions of the year [yearStartUtc, yearEndUtc) (local standard time), as UTC
+static int64_t yearStartUtc = 0;
+static int64_t yearEndUtc = 0;
+static int64_t dstStartUtc = 0;
+static int64_t dstEndUtc = 0;
+
+// === Calendar ===
+
+bool isLeapYear(int year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+int daysInMonth(int year, int month)
+{
+    static const uint8_t days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return month == 2 && isLeapYear(year) ? 29 : days[month - 1];
+}
+
+// Proleptic Gregorian, after H. Hinnant's days_from_civil
+int32_t daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    int32_t era = (year >= 0 ? year : year - 399) / 400;
+    int32_t yoe = year - era * 400;
+    int32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void civilFromEpoch(uint32_t t, CivilTime &out)
+{
+    int32_t days = t / 86400;
+    uint32_t secs = t % 86400;
+    out.hour = secs / 3600;
+    out.minute = secs / 60 % 60;
+    out.second = secs % 60;
+    out.weekday = (days + 4) % 7; // 1970-01-01 was a Thursday
+
+    int32_t z = days + 719468;
+    int32_t era = z / 146097;
+    int32_t doe = z - era * 146097;
+    int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int32_t mp = (5 * doy + 2) / 153;
+    out.day = doy - (153 * mp + 2) / 5 + 1;
+    out.month = mp < 10 ? mp + 3 : mp - 9;
+    out.year = yoe + era * 400 + (out.month <= 2);
+}
+
+// === Parsing ===
+
+static bool parseName(const char *&p, char *name)
+{
+    uint8_t n = 0;
+    if (*p == '<')
+    {
+        p++;
+        while (*p && *p != '>')
+        {
+            if (n < TZ_NAME_MAX)
+                name[n++] = *p;
+            p++;
+        }
+        if (*p++ != '>')
+            return false;
+    }
+    else
+    {
+        while (isalpha((unsigned char)*p))
+        {
+            if (n < TZ_NAME_MAX)
+                name[n++] = *p;
+            p++;
+        }
+    }
+    name[n] = '\0';
+    return n >= 3;
+}
+
+// [+|-]hh[:mm[:ss]] in seconds
+static bool parseTime(const char *&p, int32_t &secs)
+{
+    int sign = 1;
+    if (*p == '+' || *p == '-')
+        sign = *p++ == '-' ? -1 : 1;
+    if (!isdigit((unsigned char)*p))
+        return false;
+    int32_t fields[3] = {0, 0, 0};
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        while (isdigit((unsigned char)*p))
+            fields[i] = fields[i] * 10 + (*p++ - '0');
+        if (i == 2 || *p != ':')
+            break;
+        p++;
+    }
+    secs = sign * (fields[0] * 3600 + fields[1] * 60 + fields[2]);
+    return fields[0] <= 167 && fields[1] < 60 && fields[2] < 60;
+}
+
+static bool parseNumber(const char *&p, int16_t &value)
+{
+    if (!isdigit((unsigned char)*p))
+        return false;
+    value = 0;
+    while (isdigit((unsigned char)*p))
+        value = value * 10 + (*p++ - '0');
+    return true;
+}
+
+static bool parseRule(const char *&p, TzRule &rule)
+{
+    if (*p == 'M')
+    {
+        p++;
+        rule.type = TZ_RULE_MONTH_WEEK_DAY;
+        if (!parseNumber(p, rule.month) || *p++ != '.' || !parseNumber(p, rule.week) || *p++ != '.' ||
+            !parseNumber(p, rule.day))
+            return false;
+        if (rule.month < 1 || rule.month > 12 || rule.week < 1 || rule.week > 5 || rule.day > 6)
+            return false;
+    }
+    else if (*p == 'J')
+    {
+        p++;
+        rule.type = TZ_RULE_JULIAN;
+        if (!parseNumber(p, rule.day) || rule.day < 1 || rule.day > 365)
+            return false;
+    }
+    else
+    {
+        rule.type = TZ_RULE_DAY_OF_YEAR;
+        if (!parseNumber(p, rule.day) || rule.day > 365)
+            return false;
+    }
+
+    rule.timeS = 2 * 3600;
+    if (*p == '/')
+    {
+        p++;
+        return parseTime(p, rule.timeS);
+    }
+    return true;
+}
+
+bool setTimeZone(const char *posixTz)
+{
+    const char *p = posixTz;
+    int32_t west;
+    bool ok = parseName(p, stdName) && parseTime(p, west);
+    stdOffsetS = -west;
+    hasDst = false;
+    if (ok && *p)
+    {
+        ok = parseName(p, dstName);
+        dstOffsetS = stdOffsetS + 3600;
+        if (ok && *p && *p != ',')
+        {
+            ok = parseTime(p, west);
+            dstOffsetS = -west;
+        }
+        // Without rules POSIX leaves the dates to the implementation; use the US ones
+        if (ok && *p == '\0')
+            p = ",M3.2.0,M11.1.0";
+        ok = ok && *p++ == ',' && parseRule(p, startRule) && *p++ == ',' && parseRule(p, endRule) && *p == '\0';
+        hasDst = ok;
+    }
+    // Forget the previous zone's year, so the next conversion recomputes it
+    yearStartUtc = 0;
+    yearEndUtc = 0;
+
+    if (!ok)
+    {
+        strcpy(stdName, "UTC");
+        stdOffsetS = 0;
+        hasDst = false;
+        Serial.print("❌ Invalid time zone, using UTC: ");
+        Serial.println(posixTz);
+        return false;
+    }
+    return true;
+}
+
+// === Transitions ===
+
+// Local date of a rule in the given year, as days since 1970-01-01
+static int32_t ruleDay(const TzRule &rule, int year)
+{
+    int32_t jan1 = daysFromCivil(year, 1, 1);
+    switch (rule.type)
+    {
+    case TZ_RULE_JULIAN:
+        return jan1 + rule.day - 1 + (isLeapYear(year) && rule.day >= 60);
+    case TZ_RULE_DAY_OF_YEAR:
+        return jan1 + rule.day;
+    default:
+    {
+        int32_t first = daysFromCivil(year, rule.month, 1);
+        int32_t day = first + (rule.day - (first + 4) % 7 + 7) % 7 + (rule.week - 1) * 7;
+        if (day >= first + daysInMonth(year, rule.month))
+            day -= 7; // week 5 = last
+        return day;
+    }
+    }
+}
+
+static void computeYear(int year)
+{
+    yearStartUtc = (int64_t)daysFromCivil(year, 1, 1) * 86400 - stdOffsetS;
+    yearEndUtc = (int64_t)daysFromCivil(year + 1, 1, 1) * 86400 - stdOffsetS;
+    if (!hasDst)
+        return;
+    // Each change happens at the local time in effect before it
+    dstStartUtc = (int64_t)ruleDay(startRule, year) * 86400 + startRule.timeS - stdOffsetS;
+    dstEndUtc = (int64_t)ruleDay(endRule, year) * 86400 + endRule.timeS - dstOffsetS;
+}
+
+bool isDstAt(uint32_t utc)
+{
+    if (!hasDst)
+        return false;
+    if (utc < yearStartUtc || utc >= yearEndUtc)
+    {
+        CivilTime c;
+        civilFromEpoch((uint32_t)((int64_t)utc + stdOffsetS), c);
+        computeYear(c.year);
+    }
+    if (dstStartUtc < dstEndUtc)
+        return utc >= dstStartUtc && utc < dstEndUtc;
+    return utc >= dstStartUtc || utc < dstEndUtc; // southern hemisphere
+}
+
+uint32_t toLocalTime(uint32_t utc)
+{
+    return (uint32_t)((int64_t)utc + (isDstAt(utc) ? dstOffsetS : stdOffsetS));
+}
+
+int32_t getStandardOffset()
+{
+    return stdOffsetS;
+}
+
+const char *timeZoneName(uint32_t utc)
+{
+    return isDstAt(utc) ? dstName : stdName;
+}
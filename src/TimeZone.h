@@ -0,0 +1,46 @@
+// ==================================================
+// File: src/TimeZone.h
+// ==================================================
+//
+// Local time from a POSIX TZ string, e.g. "GMT0BST,M3.5.0/1,M10.5.0" (UK):
+// standard name and offset (hours west of UTC, so "CET-1" is UTC+1), then
+// optionally the DST name, its offset (default one hour ahead of standard)
+// and when DST starts and ends:
+//   Mm.w.d   day d (0 = Sunday) of week w (5 = last) of month m
+//   Jn       day n of the year, 1..365, February 29 never counted
+//   n        day n of the year, 0..365, counting February 29
+// each optionally followed by /time, the local wall-clock time of the change
+// (default 02:00, may be negative or beyond 24 hours).
+//
+// The two transitions of a year are computed the first time a timestamp of
+// that year is converted, so a conversion is normally two comparisons and
+// an add. The calendar helpers are integer-only and valid for any epoch a
+// uint32_t can hold.
+
+#pragma once
+#include <Arduino.h>
+
+#define TZ_NAME_MAX 8
+
+struct CivilTime
+{
+    int16_t year;
+    int8_t month; // 1-12
+    int8_t day;   // 1-31
+    int8_t hour;
+    int8_t minute;
+    int8_t second;
+    int8_t weekday; // 0 = Sunday
+};
+
+// Function declarations
+bool setTimeZone(const char *posixTz); // false (and UTC) if the string does not parse
+uint32_t toLocalTime(uint32_t utc);
+bool isDstAt(uint32_t utc);
+int32_t getStandardOffset();        // seconds east of UTC
+const char *timeZoneName(uint32_t utc); // "GMT" or "BST"
+
+bool isLeapYear(int year);
+int daysInMonth(int year, int month);
+int32_t daysFromCivil(int year, int month, int day); // days since 1970-01-01
+void civilFromEpoch(uint32_t t, CivilTime &out);
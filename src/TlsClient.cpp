@@ -0,0 +1,575 @@
+// ==================================================
+// File: src/TlsClient.cpp
+// ==================================================
+
+#include "TlsClient.h"
+#include <Preferences.h>
+#include <mbedtls/sha256.h>
+#include <mbedtls/version.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+// mbedTLS 3 hides struct members behind MBEDTLS_PRIVATE()
+#if MBEDTLS_VERSION_MAJOR >= 3
+#define TLS_SESSION_MASTER(s) ((s).MBEDTLS_PRIVATE(master))
+#define TLS_SHA256(in, len, out) mbedtls_sha256(in, len, out, 0)
+#else
+#define TLS_SESSION_MASTER(s) ((s).master)
+#define TLS_SHA256(in, len, out) mbedtls_sha256_ret(in, len, out, 0)
+#endif
+
+TlsClient::TlsClient()
+    : caPem(nullptr), haveFingerprint(false), randomReady(false), caReady(false),
+      haveSession(false), sessionLoaded(false), haveStoredDigest(false), open(false), peeked(-1),
+      handshakeTimeoutMs(TLS_DEFAULT_HANDSHAKE_TIMEOUT_MS), nvsKey(nullptr)
+{
+    sessionHost[0] = '\0';
+    memset(&stats, 0, sizeof(stats));
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&conf);
+    mbedtls_net_init(&net);
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&drbg);
+    mbedtls_x509_crt_init(&ca);
+    mbedtls_ssl_session_init(&session);
+}
+
+TlsClient::~TlsClient()
+{
+    stop();
+    mbedtls_ssl_session_free(&session);
+    mbedtls_x509_crt_free(&ca);
+    mbedtls_ctr_drbg_free(&drbg);
+    mbedtls_entropy_free(&entropy);
+    mbedtls_ssl_config_free(&conf);
+}
+
+// === Configuration ===
+
+void TlsClient::setPinnedCA(const char *pem)
+{
+    caPem = pem;
+    caReady = false;
+}
+
+static int hexNibble(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+bool TlsClient::setPinnedFingerprint(const char *sha256Hex)
+{
+    uint8_t parsed[32];
+    size_t digits = 0;
+    for (const char *p = sha256Hex; *p; p++)
+    {
+        if (*p == ':' || *p == ' ')
+            continue;
+        int v = hexNibble(*p);
+        if (v < 0 || digits >= 64)
+            return false;
+        if (digits % 2 == 0)
+            parsed[digits / 2] = v << 4;
+        else
+            parsed[digits / 2] |= v;
+        digits++;
+    }
+    if (digits != 64)
+        return false;
+    memcpy(fingerprint, parsed, sizeof(fingerprint));
+    haveFingerprint = true;
+    return true;
+}
+
+void TlsClient::setHandshakeTimeout(unsigned long ms)
+{
+    handshakeTimeoutMs = ms;
+}
+
+void TlsClient::setSessionStore(const char *key)
+{
+    nvsKey = key;
+    sessionLoaded = false;
+}
+
+void TlsClient::clearSession()
+{
+    mbedtls_ssl_session_free(&session);
+    mbedtls_ssl_session_init(&session);
+    haveSession = false;
+    haveStoredDigest = false;
+    sessionHost[0] = '\0';
+    if (nvsKey)
+    {
+        Preferences prefs;
+        if (prefs.begin("tls", false))
+        {
+            prefs.remove(nvsKey);
+            prefs.end();
+        }
+    }
+}
+
+// === Setup helpers ===
+
+bool TlsClient::ensureRandom()
+{
+    if (randomReady)
+        return true;
+    int ret = mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, nullptr, 0);
+    if (ret != 0)
+    {
+        fail("DRBG seed", ret);
+        return false;
+    }
+    randomReady = true;
+    return true;
+}
+
+bool TlsClient::ensureCA()
+{
+    if (caReady || caPem == nullptr)
+        return true;
+    mbedtls_x509_crt_free(&ca);
+    mbedtls_x509_crt_init(&ca);
+    // PEM input must include the terminating NUL in its length
+    int ret = mbedtls_x509_crt_parse(&ca, (const unsigned char *)caPem, strlen(caPem) + 1);
+    if (ret != 0)
+    {
+        fail("CA parse", ret);
+        return false;
+    }
+    caReady = true;
+    return true;
+}
+
+// Blob layout in NVS: host (NUL-terminated) followed by mbedtls_ssl_session_save() output
+void TlsClient::loadStoredSession()
+{
+    sessionLoaded = true;
+    if (nvsKey == nullptr || haveSession)
+        return;
+
+    Preferences prefs;
+    if (!prefs.begin("tls", true))
+        return;
+    size_t len = prefs.getBytesLength(nvsKey);
+    if (len > 0 && len <= TLS_SESSION_BLOB_MAX)
+    {
+        uint8_t *blob = (uint8_t *)malloc(len);
+        if (blob && prefs.getBytes(nvsKey, blob, len) == len)
+        {
+            size_t hostLen = strnlen((const char *)blob, len);
+            if (hostLen < len && hostLen < TLS_MAX_HOST_LEN &&
+                mbedtls_ssl_session_load(&session, blob + hostLen + 1, len - hostLen - 1) == 0)
+            {
+                memcpy(sessionHost, blob, hostLen + 1);
+                haveSession = true;
+                haveStoredDigest = TLS_SHA256(blob, len, storedDigest) == 0;
+                Serial.println("🔐 Restored TLS session from flash");
+            }
+        }
+        free(blob);
+    }
+    prefs.end();
+}
+
+void TlsClient::storeSession()
+{
+    if (nvsKey == nullptr)
+        return;
+
+    size_t hostLen = strlen(sessionHost);
+    uint8_t *blob = (uint8_t *)malloc(TLS_SESSION_BLOB_MAX);
+    if (blob == nullptr)
+        return;
+    memcpy(blob, sessionHost, hostLen + 1);
+    size_t sessionLen = 0;
+    if (mbedtls_ssl_session_save(&session, blob + hostLen + 1, TLS_SESSION_BLOB_MAX - hostLen - 1, &sessionLen) == 0)
+    {
+        // A resumption that kept the same ticket serializes identically; skip the flash write
+        uint8_t digest[32];
+        size_t len = hostLen + 1 + sessionLen;
+        bool changed = TLS_SHA256(blob, len, digest) != 0 || !haveStoredDigest ||
+                       memcmp(digest, storedDigest, sizeof(digest)) != 0;
+        Preferences prefs;
+        if (changed && prefs.begin("tls", false))
+        {
+            if (prefs.putBytes(nvsKey, blob, len) == len)
+            {
+                memcpy(storedDigest, digest, sizeof(digest));
+                haveStoredDigest = true;
+            }
+            prefs.end();
+        }
+    }
+    free(blob);
+}
+
+bool TlsClient::verifyFingerprint()
+{
+    const mbedtls_x509_crt *peer = mbedtls_ssl_get_peer_cert(&ssl);
+    if (peer == nullptr)
+        return false;
+    uint8_t digest[32];
+    if (TLS_SHA256(peer->raw.p, peer->raw.len, digest) != 0)
+        return false;
+    return memcmp(digest, fingerprint, sizeof(digest)) == 0;
+}
+
+void TlsClient::fail(const char *stage, int err)
+{
+    stats.failures++;
+    stats.lastError = err;
+    Serial.print("❌ TLS ");
+    Serial.print(stage);
+    Serial.print(" failed: -0x");
+    Serial.println(-err, HEX);
+}
+
+// mbedtls_net_connect() blocks in connect() for as long as the stack keeps
+// retrying the SYN; this gives up after timeoutMs. Name resolution still
+// blocks, bounded by the lwIP DNS timeout.
+static int connectWithTimeout(mbedtls_net_context *ctx, const char *host, const char *port,
+                              unsigned long timeoutMs)
+{
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    struct addrinfo *list = nullptr;
+    if (getaddrinfo(host, port, &hints, &list) != 0 || list == nullptr)
+        return MBEDTLS_ERR_NET_UNKNOWN_HOST;
+
+    int ret = MBEDTLS_ERR_NET_CONNECT_FAILED;
+    unsigned long startedAt = millis();
+    for (struct addrinfo *cur = list; cur != nullptr; cur = cur->ai_next)
+    {
+        int fd = socket(cur->ai_family, cur->ai_socktype, cur->ai_protocol);
+        if (fd < 0)
+        {
+            ret = MBEDTLS_ERR_NET_SOCKET_FAILED;
+            continue;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int rc = ::connect(fd, cur->ai_addr, cur->ai_addrlen);
+        if (rc != 0 && errno == EINPROGRESS)
+        {
+            unsigned long elapsed = millis() - startedAt;
+            unsigned long left = elapsed < timeoutMs ? timeoutMs - elapsed : 0;
+            fd_set writable;
+            FD_ZERO(&writable);
+            FD_SET(fd, &writable);
+            struct timeval tv;
+            tv.tv_sec = left / 1000;
+            tv.tv_usec = (left % 1000) * 1000;
+            rc = select(fd + 1, nullptr, &writable, nullptr, &tv);
+            if (rc > 0)
+            {
+                int err = 0;
+                socklen_t len = sizeof(err);
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                rc = err == 0 ? 0 : -1;
+            }
+            else
+            {
+                if (rc == 0)
+                    ret = MBEDTLS_ERR_SSL_TIMEOUT;
+                rc = -1;
+            }
+        }
+        if (rc == 0)
+        {
+            // The handshake below reads with mbedtls_net_recv_timeout(), which expects a blocking socket
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+            ctx->fd = fd;
+            ret = 0;
+            break;
+        }
+        close(fd);
+        if (ret == MBEDTLS_ERR_SSL_TIMEOUT)
+            break; // the budget is spent, whatever addresses are left
+    }
+    freeaddrinfo(list);
+    return ret;
+}
+
+// === Client interface ===
+
+int TlsClient::connect(IPAddress ip, uint16_t port)
+{
+    String address = ip.toString();
+    return connectTo(address.c_str(), address.c_str(), port);
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port, const char *serverName)
+{
+    return connectTo(ip.toString().c_str(), serverName, port);
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port, int32_t timeout)
+{
+    return connect(ip, port);
+}
+
+int TlsClient::connect(const char *host, uint16_t port, int32_t timeout)
+{
+    if (timeout > 0)
+        handshakeTimeoutMs = timeout;
+    return connect(host, port);
+}
+
+int TlsClient::connect(const char *host, uint16_t port)
+{
+    return connectTo(host, host, port);
+}
+
+// address is what the socket connects to (a name or a dotted IP); serverName
+// goes into SNI, the certificate check and the session match
+int TlsClient::connectTo(const char *address, const char *serverName, uint16_t port)
+{
+    stop();
+    if (!ensureRandom() || !ensureCA())
+        return 0;
+    if (!sessionLoaded)
+        loadStoredSession();
+
+    unsigned long startedAt = millis();
+
+    // Rebuild the config each time so a changed CA/fingerprint takes effect
+    mbedtls_ssl_config_free(&conf);
+    mbedtls_ssl_config_init(&conf);
+    int ret = mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                          MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret != 0)
+    {
+        fail("config", ret);
+        return 0;
+    }
+    if (caPem)
+    {
+        mbedtls_ssl_conf_ca_chain(&conf, &ca, nullptr);
+        mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    }
+    else
+    {
+        // Fingerprint pinning checks the leaf ourselves after the handshake
+        mbedtls_ssl_conf_authmode(&conf, haveFingerprint ? MBEDTLS_SSL_VERIFY_OPTIONAL : MBEDTLS_SSL_VERIFY_NONE);
+    }
+    mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &drbg);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(&conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+    mbedtls_ssl_conf_read_timeout(&conf, handshakeTimeoutMs);
+
+    ret = mbedtls_ssl_setup(&ssl, &conf);
+    if (ret == 0)
+        ret = mbedtls_ssl_set_hostname(&ssl, serverName);
+    if (ret != 0)
+    {
+        fail("setup", ret);
+        stop();
+        return 0;
+    }
+
+    // Offer the previous session (ID or ticket) for an abbreviated handshake
+    bool offered = false;
+    if (haveSession && strcmp(sessionHost, serverName) == 0)
+    {
+        offered = mbedtls_ssl_set_session(&ssl, &session) == 0;
+    }
+
+    char portStr[6];
+    snprintf(portStr, sizeof(portStr), "%u", port);
+    unsigned long connectTimeoutMs =
+        handshakeTimeoutMs < TLS_CONNECT_TIMEOUT_MS ? handshakeTimeoutMs : TLS_CONNECT_TIMEOUT_MS;
+    ret = connectWithTimeout(&net, address, portStr, connectTimeoutMs);
+    if (ret != 0)
+    {
+        fail("TCP connect", ret);
+        stop();
+        return 0;
+    }
+    open = true;
+    mbedtls_ssl_set_bio(&ssl, &net, mbedtls_net_send, mbedtls_net_recv, mbedtls_net_recv_timeout);
+
+    while ((ret = mbedtls_ssl_handshake(&ssl)) != 0)
+    {
+        if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+        {
+            fail("handshake", ret);
+            stop();
+            return 0;
+        }
+        if (millis() - startedAt > handshakeTimeoutMs)
+        {
+            fail("handshake", MBEDTLS_ERR_SSL_TIMEOUT);
+            stop();
+            return 0;
+        }
+    }
+
+    // A resumed handshake reuses the offered master secret; a full one
+    // derives a fresh one
+    mbedtls_ssl_session negotiated;
+    mbedtls_ssl_session_init(&negotiated);
+    bool gotSession = mbedtls_ssl_get_session(&ssl, &negotiated) == 0;
+    bool resumed = offered && gotSession &&
+                   memcmp(TLS_SESSION_MASTER(negotiated), TLS_SESSION_MASTER(session),
+                          sizeof(TLS_SESSION_MASTER(session))) == 0;
+
+    // A resumed session proves the server held keys from an earlier, already
+    // verified handshake - only full handshakes need the pin check
+    if (!resumed && haveFingerprint && !verifyFingerprint())
+    {
+        mbedtls_ssl_session_free(&negotiated);
+        fail("certificate pin", 0);
+        clearSession();
+        stop();
+        return 0;
+    }
+
+    if (gotSession)
+    {
+        mbedtls_ssl_session_free(&session);
+        session = negotiated; // take ownership
+        haveSession = true;
+        strncpy(sessionHost, serverName, sizeof(sessionHost) - 1);
+        sessionHost[sizeof(sessionHost) - 1] = '\0';
+        // Servers may issue a new ticket on a resumed handshake too (RFC 5077
+        // section 3.3); storeSession() skips the write if nothing changed
+        storeSession();
+    }
+    else
+    {
+        mbedtls_ssl_session_free(&negotiated);
+    }
+
+    stats.lastType = resumed ? TLS_HANDSHAKE_RESUMED : TLS_HANDSHAKE_FULL;
+    stats.lastHandshakeMs = millis() - startedAt;
+    if (resumed)
+        stats.resumedHandshakes++;
+    else
+        stats.fullHandshakes++;
+
+    // From here on reads must not block the main loop
+    mbedtls_net_set_nonblock(&net);
+    mbedtls_ssl_set_bio(&ssl, &net, mbedtls_net_send, mbedtls_net_recv, nullptr);
+    return 1;
+}
+
+size_t TlsClient::write(uint8_t b)
+{
+    return write(&b, 1);
+}
+
+size_t TlsClient::write(const uint8_t *buf, size_t size)
+{
+    if (!open)
+        return 0;
+    size_t written = 0;
+    unsigned long startedAt = millis();
+    while (written < size)
+    {
+        int ret = mbedtls_ssl_write(&ssl, buf + written, size - written);
+        if (ret > 0)
+        {
+            written += ret;
+            continue;
+        }
+        if ((ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) ||
+            millis() - startedAt > TLS_WRITE_TIMEOUT_MS)
+        {
+            stop();
+            break;
+        }
+        delay(1);
+    }
+    return written;
+}
+
+int TlsClient::available()
+{
+    if (!open)
+        return 0;
+    if (peeked < 0)
+    {
+        unsigned char b;
+        int ret = mbedtls_ssl_read(&ssl, &b, 1);
+        if (ret == 1)
+        {
+            peeked = b;
+        }
+        else if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE)
+        {
+            stop(); // peer closed or fatal alert
+            return 0;
+        }
+    }
+    return (peeked >= 0 ? 1 : 0) + (int)mbedtls_ssl_get_bytes_avail(&ssl);
+}
+
+int TlsClient::read()
+{
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int TlsClient::read(uint8_t *buf, size_t size)
+{
+    if (size == 0 || available() == 0)
+        return -1;
+    size_t count = 0;
+    if (peeked >= 0)
+    {
+        buf[count++] = (uint8_t)peeked;
+        peeked = -1;
+    }
+    if (count < size && mbedtls_ssl_get_bytes_avail(&ssl) > 0)
+    {
+        int ret = mbedtls_ssl_read(&ssl, buf + count, size - count);
+        if (ret > 0)
+            count += ret;
+    }
+    return count;
+}
+
+int TlsClient::peek()
+{
+    return available() ? peeked : -1;
+}
+
+void TlsClient::flush()
+{
+}
+
+void TlsClient::stop()
+{
+    if (open)
+    {
+        mbedtls_ssl_close_notify(&ssl);
+        open = false;
+    }
+    peeked = -1;
+    mbedtls_net_free(&net);
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_init(&ssl);
+}
+
+uint8_t TlsClient::connected()
+{
+    if (!open)
+        return 0;
+    available(); // notices a peer close
+    return open;
+}
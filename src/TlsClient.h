@@ -0,0 +1,111 @@
+// ==================================================
+// File: src/TlsClient.h
+// ==================================================
+//
+// mbedTLS client with a pinned CA or certificate fingerprint and TLS session
+// resumption. After the first full handshake the negotiated session (session
+// ID and/or session ticket) is kept in RAM - and optionally in NVS - and
+// offered on the next connect, so reconnects do an abbreviated handshake
+// instead of a full certificate exchange and key agreement.
+//
+// Drop-in Arduino Client, e.g. for PubSubClient.
+
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/x509_crt.h>
+
+#define TLS_DEFAULT_HANDSHAKE_TIMEOUT_MS 15000
+#define TLS_CONNECT_TIMEOUT_MS 5000 // TCP connect, within the handshake timeout
+#define TLS_WRITE_TIMEOUT_MS 5000
+#define TLS_MAX_HOST_LEN 96
+#define TLS_SESSION_BLOB_MAX 2048 // NVS copy of a serialized session
+
+enum TlsHandshakeType
+{
+    TLS_HANDSHAKE_NONE,
+    TLS_HANDSHAKE_FULL,
+    TLS_HANDSHAKE_RESUMED
+};
+
+struct TlsHandshakeStats
+{
+    TlsHandshakeType lastType;
+    unsigned long lastHandshakeMs; // TCP connect + TLS handshake
+    uint32_t fullHandshakes;
+    uint32_t resumedHandshakes;
+    uint32_t failures;
+    int lastError; // mbedTLS error code of the last failure
+};
+
+class TlsClient : public Client
+{
+public:
+    TlsClient();
+    ~TlsClient();
+
+    // Trust configuration (pick one; neither = no verification)
+    void setPinnedCA(const char *pem);
+    bool setPinnedFingerprint(const char *sha256Hex); // 64 hex digits, ':' / ' ' ignored
+    void setHandshakeTimeout(unsigned long ms);
+
+    // Persist the session in NVS under this key (nullptr = RAM only)
+    void setSessionStore(const char *nvsKey);
+    void clearSession();
+
+    const TlsHandshakeStats &getStats() const { return stats; }
+
+    // Arduino Client interface
+    int connect(IPAddress ip, uint16_t port);
+    int connect(const char *host, uint16_t port);
+    int connect(IPAddress ip, uint16_t port, int32_t timeout);
+    int connect(const char *host, uint16_t port, int32_t timeout);
+    int connect(IPAddress ip, uint16_t port, const char *serverName); // name for SNI, certificate and session
+    size_t write(uint8_t b);
+    size_t write(const uint8_t *buf, size_t size);
+    int available();
+    int read();
+    int read(uint8_t *buf, size_t size);
+    int peek();
+    void flush();
+    void stop();
+    uint8_t connected();
+    operator bool() { return connected(); }
+
+private:
+    bool ensureRandom();
+    bool ensureCA();
+    void loadStoredSession();
+    void storeSession();
+    bool verifyFingerprint();
+    void fail(const char *stage, int err);
+    int connectTo(const char *address, const char *serverName, uint16_t port);
+
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config conf;
+    mbedtls_net_context net;
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_x509_crt ca;
+    mbedtls_ssl_session session; // last negotiated session
+
+    const char *caPem;
+    uint8_t fingerprint[32];
+    bool haveFingerprint;
+    bool randomReady;
+    bool caReady;
+    bool haveSession;
+    bool sessionLoaded;
+    bool haveStoredDigest;
+    bool open;
+    int peeked; // one byte pulled forward by available()/peek(), -1 if none
+    unsigned long handshakeTimeoutMs;
+    const char *nvsKey;
+    char sessionHost[TLS_MAX_HOST_LEN];
+    uint8_t storedDigest[32]; // SHA-256 of the blob in NVS, to skip rewriting it
+    TlsHandshakeStats stats;
+};
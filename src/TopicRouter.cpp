@@ -0,0 +1,201 @@
+// ==================================================
+// File: src/TopicRouter.cpp
+// ==================================================
+
+#include "TopicRouter.h"
+
+#define NO_NODE -1
+
+struct TopicNode
+{
+    char segment[TOPIC_SEGMENT_MAX_LEN]; // "+" / "#" for wildcards
+    int8_t firstChild;
+    int8_t nextSibling;
+    TopicHandler handler;
+};
+
+// Last message seen on one topic
+struct SeenMessage
+{
+    uint32_t topicHash;
+    uint32_t fingerprint; // topic + payload
+    unsigned long at;
+};
+
+// Node 0 is the root (empty segment)
+static TopicNode nodes[TOPIC_ROUTER_MAX_NODES] = {{"", NO_NODE, NO_NODE, nullptr}};
+static uint8_t nodeCount = 1;
+
+static SeenMessage seen[TOPIC_DEDUP_SLOTS];
+static uint8_t seenNext = 0;
+static uint32_t duplicateCount = 0;
+
+// === Trie construction ===
+
+static int8_t findOrAddChild(int8_t parent, const char *segment, size_t len)
+{
+    for (int8_t c = nodes[parent].firstChild; c != NO_NODE; c = nodes[c].nextSibling)
+    {
+        if (strlen(nodes[c].segment) == len && strncmp(nodes[c].segment, segment, len) == 0)
+            return c;
+    }
+    if (nodeCount >= TOPIC_ROUTER_MAX_NODES || len >= TOPIC_SEGMENT_MAX_LEN)
+        return NO_NODE;
+
+    int8_t n = nodeCount++;
+    memcpy(nodes[n].segment, segment, len);
+    nodes[n].segment[len] = '\0';
+    nodes[n].firstChild = NO_NODE;
+    nodes[n].handler = nullptr;
+    nodes[n].nextSibling = nodes[parent].firstChild;
+    nodes[parent].firstChild = n;
+    return n;
+}
+
+bool addTopicRoute(const char *pattern, TopicHandler handler)
+{
+    int8_t node = 0;
+    const char *segment = pattern;
+    while (true)
+    {
+        const char *end = strchr(segment, '/');
+        size_t len = end ? (size_t)(end - segment) : strlen(segment);
+        node = findOrAddChild(node, segment, len);
+        if (node == NO_NODE)
+        {
+            Serial.print("❌ Topic router full, cannot add route: ");
+            Serial.println(pattern);
+            return false;
+        }
+        if (!end)
+            break;
+        segment = end + 1;
+    }
+    nodes[node].handler = handler;
+    return true;
+}
+
+// === Matching ===
+
+// Matches `topic` (positioned at the start of a segment, or nullptr when all
+// segments are consumed) below `node`. Exact segments win over '+', which
+// wins over '#'.
+static TopicHandler matchFrom(int8_t node, const char *topic)
+{
+    if (topic == nullptr)
+    {
+        if (nodes[node].handler)
+            return nodes[node].handler;
+        // "a/#" also matches "a" itself
+        for (int8_t c = nodes[node].firstChild; c != NO_NODE; c = nodes[c].nextSibling)
+        {
+            if (strcmp(nodes[c].segment, "#") == 0)
+                return nodes[c].handler;
+        }
+        return nullptr;
+    }
+
+    const char *end = strchr(topic, '/');
+    size_t len = end ? (size_t)(end - topic) : strlen(topic);
+    const char *rest = end ? end + 1 : nullptr;
+
+    for (int pass = 0; pass < 3; pass++)
+    {
+        for (int8_t c = nodes[node].firstChild; c != NO_NODE; c = nodes[c].nextSibling)
+        {
+            const char *seg = nodes[c].segment;
+            TopicHandler found = nullptr;
+            if (pass == 0 && strlen(seg) == len && strncmp(seg, topic, len) == 0)
+                found = matchFrom(c, rest);
+            else if (pass == 1 && strcmp(seg, "+") == 0)
+                found = matchFrom(c, rest);
+            else if (pass == 2 && strcmp(seg, "#") == 0)
+                found = nodes[c].handler;
+            if (found)
+                return found;
+        }
+    }
+    return nullptr;
+}
+
+// === Duplicate suppression ===
+
+#define FNV_OFFSET 2166136261UL
+#define FNV_PRIME 16777619UL
+
+// FNV-1a over the topic bytes as they arrived (topics are case-sensitive)
+static uint32_t topicHashOf(const char *topic)
+{
+    uint32_t h = FNV_OFFSET;
+    for (const char *p = topic; *p; p++)
+    {
+        h = (h ^ (uint8_t)*p) * FNV_PRIME;
+    }
+    return h;
+}
+
+// Continues the topic hash over a separator and the payload
+static uint32_t fingerprint(uint32_t topicHash, const String &message)
+{
+    uint32_t h = (topicHash ^ 0xFF) * FNV_PRIME;
+    const char *payload = message.c_str();
+    for (unsigned int i = 0; i < message.length(); i++)
+    {
+        h = (h ^ (uint8_t)payload[i]) * FNV_PRIME;
+    }
+    return h;
+}
+
+// A duplicate repeats the last message on its topic within the window;
+// an A -> B -> A sequence is three changes and all of them get through
+static bool isDuplicate(const char *topic, const String &message)
+{
+    unsigned long now = millis();
+    uint32_t topicHash = topicHashOf(topic);
+    uint32_t fp = fingerprint(topicHash, message);
+
+    SeenMessage *slot = nullptr;
+    for (uint8_t i = 0; i < TOPIC_DEDUP_SLOTS; i++)
+    {
+        if (seen[i].at != 0 && seen[i].topicHash == topicHash)
+        {
+            slot = &seen[i];
+            break;
+        }
+    }
+    if (slot && slot->fingerprint == fp && now - slot->at < TOPIC_DEDUP_WINDOW_MS)
+        return true;
+
+    if (slot == nullptr)
+    {
+        slot = &seen[seenNext];
+        seenNext = (seenNext + 1) % TOPIC_DEDUP_SLOTS;
+    }
+    slot->topicHash = topicHash;
+    slot->fingerprint = fp;
+    slot->at = now ? now : 1;
+    return false;
+}
+
+RouteResult routeTopic(const char *topic, const String &message)
+{
+    TopicHandler handler = matchFrom(0, topic);
+    if (handler == nullptr)
+        return ROUTE_UNMATCHED;
+
+    // Overlapping subscriptions / QoS 1 redelivery can hand us the same
+    // message twice; only the first one reaches the handler
+    if (isDuplicate(topic, message))
+    {
+        duplicateCount++;
+        return ROUTE_DUPLICATE;
+    }
+
+    handler(topic, message);
+    return ROUTE_DISPATCHED;
+}
+
+uint32_t getDuplicateMessageCount()
+{
+    return duplicateCount;
+}
@@ -0,0 +1,32 @@
+// ==================================================
+// File: src/TopicRouter.h
+// ==================================================
+//
+// On-device MQTT topic router. Routes are registered once as patterns (MQTT
+// '+' and '#' wildcards allowed) and stored in a small static trie, so the
+// device can hold a single wildcard subscription and dispatch locally.
+// A message identical to the last one on its topic (same topic + payload
+// fingerprint) arriving again within TOPIC_DEDUP_WINDOW_MS is dropped before
+// it reaches a handler. TOPIC_DEDUP_SLOTS topics are tracked at a time.
+
+#pragma once
+#include <Arduino.h>
+
+#define TOPIC_ROUTER_MAX_NODES 32
+#define TOPIC_SEGMENT_MAX_LEN 24
+#define TOPIC_DEDUP_SLOTS 8 // topics remembered
+#define TOPIC_DEDUP_WINDOW_MS 2000
+
+typedef void (*TopicHandler)(const char *topic, const String &message);
+
+enum RouteResult
+{
+    ROUTE_DISPATCHED,
+    ROUTE_DUPLICATE,
+    ROUTE_UNMATCHED
+};
+
+// Function declarations
+bool addTopicRoute(const char *pattern, TopicHandler handler);
+RouteResult routeTopic(const char *topic, const String &message);
+uint32_t getDuplicateMessageCount();
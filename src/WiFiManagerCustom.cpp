@@ -1,46 +1,301 @@
 // ==================================================
 // File: src/WiFiManagerCustom.cpp
 // ==================================================
+//
+// Event-driven WiFi connection manager. The WiFi event task only records
+// what happened; handleWiFi() (the "wifi" scheduler job) runs the state
+// machine, applies exponential backoff with jitter and notifies listeners.
+// The last good BSSID/channel is kept in RTC memory and NVS so reconnects
+// skip the full channel scan.
 
 #include "WiFiManagerCustom.h"
+#include "Backoff.h"
 #include <WiFi.h>
+#include <Preferences.h>
+
+#define WIFI_CACHE_MAGIC 0x57494649 // "WIFI"
+#define WIFI_MAX_LISTENERS 4
+
+enum WiFiLinkState
+{
+    WIFI_LINK_IDLE,       // waiting for the backoff timer
+    WIFI_LINK_CONNECTING, // WiFi.begin() issued, waiting for GOT_IP
+    WIFI_LINK_UP
+};
+
+struct WiFiApCache
+{
+    uint32_t magic;
+    uint8_t bssid[6];
+    int32_t channel;
+};
+
+// Survives deep sleep only (reinitialised on software and watchdog resets);
+// the NVS copy covers every other restart
+RTC_DATA_ATTR static WiFiApCache apCache;
+
+static WiFiLinkState linkState = WIFI_LINK_IDLE;
+static volatile bool eventGotIP = false;
+static volatile bool eventDisconnected = false;
+static volatile uint8_t lastDisconnectReason = 0;
+
+static unsigned long attemptStartedAt = 0;
+static unsigned long nextAttemptAt = 0;
+static Backoff retryBackoff = {WIFI_BACKOFF_MIN_MS, WIFI_BACKOFF_MAX_MS, 0};
+static bool usedCacheForAttempt = false;
+static uint32_t reconnectCount = 0;
+
+static long cachedRSSI = 0;
+static unsigned long rssiReadAt = 0;
+
+static WiFiChangeCallback listeners[WIFI_MAX_LISTENERS];
+static uint8_t listenerCount = 0;
+
+// === AP cache ===
+
+static bool apCacheValid()
+{
+    return apCache.magic == WIFI_CACHE_MAGIC && apCache.channel > 0;
+}
+
+static void loadApCache()
+{
+    if (apCacheValid())
+        return; // RTC copy survived
+
+    Preferences prefs;
+    if (prefs.begin("wifi", true))
+    {
+        if (prefs.getBytesLength("ap") == sizeof(apCache))
+        {
+            prefs.getBytes("ap", &apCache, sizeof(apCache));
+        }
+        prefs.end();
+    }
+    if (!apCacheValid())
+    {
+        apCache.magic = 0;
+    }
+}
+
+static void saveApCache(const uint8_t *bssid, int32_t channel)
+{
+    if (bssid == nullptr || channel <= 0)
+        return;
+    if (apCacheValid() && apCache.channel == channel && memcmp(apCache.bssid, bssid, 6) == 0)
+        return; // unchanged - don't wear the flash
+
+    apCache.magic = WIFI_CACHE_MAGIC;
+    memcpy(apCache.bssid, bssid, 6);
+    apCache.channel = channel;
+
+    Preferences prefs;
+    if (prefs.begin("wifi", false))
+    {
+        prefs.putBytes("ap", &apCache, sizeof(apCache));
+        prefs.end();
+    }
+    Serial.print("💾 Cached AP channel ");
+    Serial.println(channel);
+}
+
+static void clearApCache()
+{
+    apCache.magic = 0;
+    Preferences prefs;
+    if (prefs.begin("wifi", false))
+    {
+        prefs.remove("ap");
+        prefs.end();
+    }
+}
+
+// === Event task side: record only ===
+
+static void onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info)
+{
+    switch (event)
+    {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+        eventGotIP = true;
+        break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+        lastDisconnectReason = info.wifi_sta_disconnected.reason;
+        eventDisconnected = true;
+        break;
+    case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+        eventDisconnected = true;
+        break;
+    default:
+        break;
+    }
+}
+
+// === State machine helpers ===
+
+static void notifyListeners(bool connected)
+{
+    for (uint8_t i = 0; i < listenerCount; i++)
+    {
+        listeners[i](connected);
+    }
+}
+
+static void startAttempt()
+{
+    // After a couple of failures on the cached AP (router moved channel,
+    // different mesh node, ...) fall back to a full scan
+    usedCacheForAttempt = apCacheValid() && retryBackoff.failures < WIFI_CACHED_AP_ATTEMPTS;
+    if (apCacheValid() && !usedCacheForAttempt)
+    {
+        Serial.println("⚠️  Cached AP not reachable - dropping cache and scanning");
+        clearApCache();
+    }
+
+    if (usedCacheForAttempt)
+    {
+        Serial.print("Connecting to WiFi (fast reconnect, channel ");
+        Serial.print(apCache.channel);
+        Serial.println(")...");
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD, apCache.channel, apCache.bssid, true);
+    }
+    else
+    {
+        Serial.println("Connecting to WiFi (full scan)...");
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    }
+    linkState = WIFI_LINK_CONNECTING;
+    attemptStartedAt = millis();
+}
+
+static void attemptFailed(SystemStatus &status)
+{
+    WiFi.disconnect();
+    eventGotIP = false;
+
+    unsigned long wait = retryBackoff.nextDelay();
+    nextAttemptAt = millis() + wait;
+    linkState = WIFI_LINK_IDLE;
+    status.wifi = (retryBackoff.failures >= WIFI_ERROR_AFTER_ATTEMPTS) ? ERROR : CONNECTING;
+
+    Serial.print("WiFi retry ");
+    Serial.print(retryBackoff.failures);
+    Serial.print(" in ");
+    Serial.print(wait);
+    Serial.println(" ms");
+}
+
+// === Public API ===
 
 void initWiFi(SystemStatus &status)
 {
-  status.wifi = CONNECTING;
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-  Serial.println("Connecting to WiFi...");
+    status.wifi = CONNECTING;
+    loadApCache();
+
+    WiFi.persistent(false);       // we keep our own credentials/AP cache
+    WiFi.setAutoReconnect(false); // reconnects are driven by handleWiFi()
+    WiFi.mode(WIFI_STA);
+    WiFi.onEvent(onWiFiEvent);
+
+    retryBackoff.reset();
+    startAttempt();
 }
 
 void handleWiFi(SystemStatus &status)
 {
-  wl_status_t s = WiFi.status();
-  if (s == WL_CONNECTED)
-  {
-    if (status.wifi != CONNECTED)
-    {
-      Serial.println("WiFi connected");
-      long rssi = WiFi.RSSI();
-      Serial.print("Signal strength (RSSI): ");
-      Serial.print(rssi);
-      Serial.println(" dBm");
-    }
-    status.wifi = CONNECTED;
-  }
-  else if (s == WL_IDLE_STATUS || s == WL_NO_SSID_AVAIL || s == WL_DISCONNECTED)
-  {
-    status.wifi = CONNECTING;
-    static unsigned long lastAttempt = 0;
-    if (millis() - lastAttempt > 5000)
-    {
-      lastAttempt = millis();
-      Serial.println("Reconnecting WiFi...");
-      WiFi.disconnect();
-      WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-    }
-  }
-  else
-  {
-    status.wifi = ERROR;
-  }
+    if (eventDisconnected)
+    {
+        eventDisconnected = false;
+        if (linkState == WIFI_LINK_UP)
+        {
+            eventGotIP = false;
+            Serial.print("WiFi connection lost, reason ");
+            Serial.println(lastDisconnectReason);
+            linkState = WIFI_LINK_IDLE;
+            status.wifi = CONNECTING;
+            retryBackoff.reset();
+            reconnectCount++;
+            notifyListeners(false);
+            nextAttemptAt = millis(); // first retry is immediate - cached AP, no scan
+            return;
+        }
+        // WiFi.begin() itself may report a disconnect of the previous
+        // association; only later ones mean this attempt failed
+        if (linkState == WIFI_LINK_CONNECTING && millis() - attemptStartedAt > WIFI_DISCONNECT_GRACE_MS)
+        {
+            Serial.print("WiFi connect attempt failed, reason ");
+            Serial.println(lastDisconnectReason);
+            attemptFailed(status);
+            return;
+        }
+    }
+
+    switch (linkState)
+    {
+    case WIFI_LINK_CONNECTING:
+        if (eventGotIP)
+        {
+            eventGotIP = false;
+            linkState = WIFI_LINK_UP;
+            status.wifi = CONNECTED;
+            retryBackoff.reset();
+            saveApCache(WiFi.BSSID(), WiFi.channel());
+            cachedRSSI = WiFi.RSSI();
+            rssiReadAt = millis();
+
+            Serial.print("WiFi connected in ");
+            Serial.print(millis() - attemptStartedAt);
+            Serial.print(" ms, signal strength (RSSI): ");
+            Serial.print(cachedRSSI);
+            Serial.println(" dBm");
+            notifyListeners(true);
+        }
+        else if (millis() - attemptStartedAt > WIFI_CONNECT_TIMEOUT_MS)
+        {
+            Serial.println("WiFi connect attempt timed out");
+            attemptFailed(status);
+        }
+        break;
+
+    case WIFI_LINK_IDLE:
+        if ((long)(millis() - nextAttemptAt) >= 0)
+        {
+            startAttempt();
+        }
+        break;
+
+    case WIFI_LINK_UP:
+        status.wifi = CONNECTED;
+        break;
+    }
+}
+
+bool isWiFiConnected()
+{
+    return linkState == WIFI_LINK_UP;
+}
+
+long getWiFiRSSI()
+{
+    if (linkState != WIFI_LINK_UP)
+        return 0;
+    if (millis() - rssiReadAt > WIFI_RSSI_REFRESH_INTERVAL)
+    {
+        cachedRSSI = WiFi.RSSI();
+        rssiReadAt = millis();
+    }
+    return cachedRSSI;
+}
+
+uint32_t getWiFiReconnectCount()
+{
+    return reconnectCount;
+}
+
+bool onWiFiConnectionChange(WiFiChangeCallback callback)
+{
+    if (listenerCount >= WIFI_MAX_LISTENERS)
+        return false;
+    listeners[listenerCount++] = callback;
+    return true;
 }
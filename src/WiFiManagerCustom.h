@@ -6,6 +6,16 @@
 #include <Arduino.h>
 #include "config.h"
 
+// Called from handleWiFi() (main task, not the WiFi event task) whenever the
+// link goes up or down
+typedef void (*WiFiChangeCallback)(bool connected);
+
 struct SystemStatus;
 void initWiFi(SystemStatus &status);
-void handleWiFi(SystemStatus &status);
\ No newline at end of file
+void handleWiFi(SystemStatus &status);
+
+// Cached link state for consumers - no driver calls
+bool isWiFiConnected();
+long getWiFiRSSI(); // refreshed at most every WIFI_RSSI_REFRESH_INTERVAL ms
+uint32_t getWiFiReconnectCount();
+bool onWiFiConnectionChange(WiFiChangeCallback callback);
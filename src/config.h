@@ -49,6 +49,13 @@ struct SystemStatus
 // #define WIFI_SSID "Gimp_EXT"
 #define WIFI_SSID "Gimp"
 #define WIFI_PASSWORD "FC7KUNPX"
+#define WIFI_CONNECT_TIMEOUT_MS 10000   // give up on one attempt after this
+#define WIFI_DISCONNECT_GRACE_MS 250    // ignore disconnect events right after WiFi.begin()
+#define WIFI_BACKOFF_MIN_MS 500
+#define WIFI_BACKOFF_MAX_MS 60000
+#define WIFI_CACHED_AP_ATTEMPTS 2       // fast-reconnect tries before a full scan
+#define WIFI_ERROR_AFTER_ATTEMPTS 5     // LED goes red after this many failures
+#define WIFI_RSSI_REFRESH_INTERVAL 10000
 // === Wi-Fi End ===
 
 // === Firebase Start ===
@@ -66,6 +73,10 @@ struct SystemStatus
 
 //  === MQTT (HiveMQ) End    ===
 
+// === LAN control API ===
+// Bearer token for the /api/* endpoints (LocalControl.h); empty disables them
+#define LAN_API_TOKEN ""
+
 /******************************
  *    Email Credentials       *
  *****************************/
@@ -93,6 +104,26 @@ struct SystemStatus
 #define SENSOR_READ_INTERVAL 1000   // ms
 #define FIREBASE_SYNC_INTERVAL 5000 // ms
 
+// === Scheduler job periods (ms) ===
+#define WIFI_CHECK_INTERVAL 500
+#define MQTT_LOOP_INTERVAL 100
+#define MQTT_PUBLISH_INTERVAL 5000
+#define LED_UPDATE_INTERVAL 250
+#define FIREBASE_HEALTH_INTERVAL 10000
+#define FIREBASE_INIT_RETRY_INTERVAL 30000
+#define FIREBASE_TARGET_CHECK_INTERVAL 30000
+#define TIME_UPDATE_INTERVAL 1000    // clock tick: NTP samples, minute rollover (no I/O)
+#define MEMORY_REPORT_INTERVAL 30000
+#define NET_POOL_CHECK_INTERVAL 5000 // close idle shared TLS connections
+#define TSDB_SAMPLE_INTERVAL 60000   // one flash history record per minute
+#define HTTP_POLL_INTERVAL 50        // LAN HTTP server (/metrics, /status, /api)
+#define LAN_LIVE_INTERVAL 1000       // live readings to open /api/events streams
+
+// === Power Save ===
+#define POWER_SAVE_ENABLED true // modem sleep + automatic light sleep between jobs
+#define POWER_MAX_CPU_MHZ 240
+#define POWER_MIN_CPU_MHZ 80 // lowest clock WiFi tolerates
+
 //=================================================
 // Hardware for Current Monitoring Configuration
 //=================================================
@@ -100,6 +131,7 @@ struct SystemStatus
 // Calibration Constants
 #define CALIBRATION_CONSTANT 68.3
 #define BASELINE_OFFSET 1.75
+#define MAINS_VOLTAGE 230 // V, for heater energy from the measured current
 
 // Detection Thresholds
 #define NOISE_THRESHOLD 0.1
@@ -112,8 +144,8 @@ struct SystemStatus
 #define READING_DELAY_MS 300
 
 // Logging Configuration
-#define LOG_FILE_NAME "/current_log.csv"
 #define ENABLE_DEBUG_OUTPUT true
 
 // Function prototypes
-bool voltageSensor(); // Returns true if heater is drawing current, false if not
\ No newline at end of file
+bool voltageSensor(); // Returns true if heater is drawing current, false if not
+float getHeaterCurrent(); // Amps measured by the last voltageSensor() call
\ No newline at end of file
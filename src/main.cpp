@@ -10,10 +10,34 @@
 #include "MQTTManager.h"
 #include "GetShedual.h"
 #include "HeaterControl.h"
+#include "Scheduler.h"
+#include "PowerManager.h"
+#include "NetClientPool.h"
+#include "MQTTOutbox.h"
+#include "History.h"
+#include "TimeSeriesStore.h"
+#include "Rollups.h"
+#include "EnergyMeter.h"
+#include "HttpServer.h"
+#include "Metrics.h"
+#include "LocalControl.h"
+#include "ScheduleCache.h"
+#include "ScheduleSync.h"
+#include "Presence.h"
 
 // put function declarations here:
 int myFunction(int, int);
 void updateHeaterControl();
+void wifiJob();
+void onNetworkChange(bool connected);
+void firebaseHealthJob();
+void mqttJob();
+void heaterJob();
+void ledJob();
+void firebaseSyncJob();
+void mqttPublishJob();
+void memoryJob();
+void timeSeriesJob();
 bool AmFlag;
 bool firstRun = true;
 // Global system status
@@ -49,147 +73,193 @@ void setup()
   initTemperatureSensors();
   Serial.println("✅ Temperature sensors initialized");
 
+  // Last known schedule from NVS, so heating does not wait for the network
+  initScheduleCache();
+  initHeaterControl(); // AM/PM slot switches on the clock's minute events
+
+  // Heater energy counters from NVS
+  initEnergyMeter();
+
+  // LAN endpoints; the server starts listening once WiFi is up
+  initMetrics();
+  initLocalControl();
+
+  // Long-term history in the "tsdb" flash partition
+  initTimeSeriesStore();
+
   // // Initialize schedule manager
   // initScheduleManager();
   // Serial.println("✅ Schedule manager initialized");
 
   // Initialize WiFi
+  onWiFiConnectionChange(onNetworkChange);
   initWiFi(systemStatus);
   Serial.println("✅ WiFi initialization started");
 
+  // Modem sleep and automatic light sleep between scheduler deadlines
+  initPowerManager();
+
   Serial.print("Free heap after setup: ");
   Serial.print(ESP.getFreeHeap());
   Serial.println(" bytes");
 
-  // Initialize MQTT, Time Manager (after WiFi)
-  // Will be called in loop when WiFi is connected
+  // Register periodic jobs; loop() only runs the scheduler
+  initScheduler();
+  scheduleEvery("wifi", WIFI_CHECK_INTERVAL, wifiJob, JOB_PRIORITY_HIGH);
+  scheduleEvery("heater", SENSOR_READ_INTERVAL, heaterJob, JOB_PRIORITY_HIGH);
+  scheduleEvery("leds", LED_UPDATE_INTERVAL, ledJob, JOB_PRIORITY_NORMAL);
+  scheduleEvery("fb-sync", FIREBASE_SYNC_INTERVAL, firebaseSyncJob, JOB_PRIORITY_NORMAL, FIREBASE_SYNC_INTERVAL);
+  scheduleEvery("mqtt-pub", MQTT_PUBLISH_INTERVAL, mqttPublishJob, JOB_PRIORITY_NORMAL, MQTT_PUBLISH_INTERVAL);
+  scheduleEvery("tsdb", TSDB_SAMPLE_INTERVAL, timeSeriesJob, JOB_PRIORITY_LOW, TSDB_SAMPLE_INTERVAL);
+  scheduleEvery("net-pool", NET_POOL_CHECK_INTERVAL, handleNetClientPool, JOB_PRIORITY_LOW, NET_POOL_CHECK_INTERVAL);
+  scheduleEvery("memory", MEMORY_REPORT_INTERVAL, memoryJob, JOB_PRIORITY_LOW, MEMORY_REPORT_INTERVAL);
+
+  // Note: Firebase, MQTT and TimeManager are initialized by wifiJob() once WiFi connects,
+  // which then registers their own jobs
+}
+
+// === Scheduler jobs ===
 
-  // Note: Firebase, MQTT and TimeManager will be initialized automatically when WiFi connects
-  // via handleFirebase(), handleMQTT() and handleTimeManager() in the main loop
+// WiFi state machine; link changes arrive through onNetworkChange()
+void wifiJob()
+{
+  handleWiFi(systemStatus);
 }
 
-void loop()
+// Bring up the network services the first time WiFi is ready
+void onNetworkChange(bool connected)
 {
-  long rssi = WiFi.RSSI();
-  Serial.print("********===========********Signal strength (RSSI): ");
-  Serial.print(rssi);
-  Serial.println(" dBm");
+  if (!connected)
+    return;
 
-  // Handle WiFi connection status
-  handleWiFi(systemStatus);
+  // Modem sleep settings do not survive a new association on every core version
+  applyWiFiPowerSave();
 
-  // Handle Firebase connection status (will initialize when WiFi is ready)
-  static bool firebaseInitialized = false;
-  if (systemStatus.wifi == CONNECTED && !firebaseInitialized)
+  // Firebase, time and MQTT are initialized once, the first time WiFi is ready
+  static bool networkServicesStarted = false;
+  if (!networkServicesStarted)
   {
     // Initialize Firebase immediately after WiFi connection
     Serial.println("🔥 WiFi connected! Initializing Firebase...");
     initFirebase(systemStatus);
-    firebaseInitialized = true;
-  }
-
-  if (firebaseInitialized)
-  {
-    handleFirebase(systemStatus);
-  }
+    scheduleEvery("fb-health", FIREBASE_HEALTH_INTERVAL, firebaseHealthJob, JOB_PRIORITY_NORMAL, FIREBASE_HEALTH_INTERVAL);
+    scheduleEvery("fb-target", FIREBASE_TARGET_CHECK_INTERVAL, checkFirebaseTargetTemperatureChanges, JOB_PRIORITY_LOW);
 
-  // Handle time management (will initialize when WiFi is ready)
-  static bool timeManagerInitialized = false;
-  if (systemStatus.wifi == CONNECTED && !timeManagerInitialized)
-  {
     initTimeManager();
-    timeManagerInitialized = true;
-  }
-  if (timeManagerInitialized)
-  {
-    handleTimeManager();
-  }
+    scheduleEvery("time", TIME_UPDATE_INTERVAL, handleTimeManager, JOB_PRIORITY_LOW);
 
-  // Handle MQTT connection (will initialize when WiFi is ready)
-  static bool mqttInitialized = false;
-  if (systemStatus.wifi == CONNECTED && !mqttInitialized)
-  {
     initMQTT();
-    mqttInitialized = true;
-  }
-  if (mqttInitialized)
-  {
-    handleMQTT(); // This calls mqttClient.loop() internally
-    systemStatus.mqtt = getMQTTStatus();
-  }
+    scheduleEvery("mqtt", MQTT_LOOP_INTERVAL, mqttJob, JOB_PRIORITY_HIGH);
 
-  // Update heater control
-  updateHeaterControl();
-  // Update LED status indicators
-  updateLEDs(systemStatus);
-
-  // If Firebase is connected, check for changes and push data when needed
-  static unsigned long lastFirebaseCheck = 0;
+    initHttpServer();
+    scheduleEvery("http", HTTP_POLL_INTERVAL, handleHttpServer, JOB_PRIORITY_NORMAL);
+    scheduleEvery("lan-live", LAN_LIVE_INTERVAL, localControlJob, JOB_PRIORITY_LOW);
 
-  if (systemStatus.firebase == FB_CONNECTED && millis() - lastFirebaseCheck > 5000) // Check every 5 seconds
-  {
-    // Read all temperature sensors first
-    readAllSensors();
-
-    // Only push sensor data to Firebase if there are changes
-    if (checkTemperatureChanges())
-    {
-      Serial.println("\n=== Firebase Push (Sensor Change Detected) ===");
+    networkServicesStarted = true;
+  }
+}
 
-      // Push sensor data to Firebase (no fetching needed)
-      pushSensorValuesToFirebase();
+void firebaseHealthJob()
+{
+  handleFirebase(systemStatus);
+}
 
-      Serial.println("=== End Firebase Push ===\n");
-    }
+void mqttJob()
+{
+  handleMQTT(); // This calls mqttClient.loop() internally
+  systemStatus.mqtt = getMQTTStatus();
+}
 
-    // Always check and push target temperature changes (independent of sensor changes)
-    checkAndPushTargetTemperature();
+void heaterJob()
+{
+  // Update heater control, then meter what the relay and current sensor did
+  updateHeaterControl();
+  updateEnergyMeter();
 
-    // Check for external target temperature changes (from React app)
-    checkFirebaseTargetTemperatureChanges();
+  // Feed the history compressors and rollups with the readings
+  // updateHeaterControl() just cached (getLastTemperature())
+  recordHistorySamples();
+  recordRollupSample();
+}
 
-    // NOTE: Schedule data is only fetched once at startup via Firebase initialization
-    // Future schedule updates will come via MQTT
-    // No need to fetch sensor data back from Firebase
+// One record of temperatures, heater current and heater state to flash
+void timeSeriesJob()
+{
+  recordTimeSeriesSample();
+}
 
-    // Update heater control based on temperature and local schedule settings
+void ledJob()
+{
+  // Update LED status indicators
+  updateLEDs(systemStatus);
+}
 
-    lastFirebaseCheck = millis();
-  }
+// If Firebase is connected, push whatever its reporter says is due
+void firebaseSyncJob()
+{
+  if (systemStatus.firebase != FB_CONNECTED)
+    return;
+
+  // Read all temperature sensors first
+  readAllSensors();
+
+  // Sensor channels and the target temperature each have their own
+  // deadband / rate limit / resync state for the Firebase sink (Reporter.h)
+  pushSensorValuesToFirebase(); // carries the presence record when it writes
+  maintainPresence();
+  checkAndPushTargetTemperature();
+  uploadHistoryToFirebase();
+  pushEnergyToFirebase();
+  pushScheduleToFirebase();
+
+  // Schedule changes from MQTT and the LAN API go out with pushScheduleToFirebase();
+  // external /schedule and target temperature edits are merged by the "fb-target" job
+}
 
-  // If MQTT is connected, check for temperature changes and publish when needed
-  static unsigned long lastMQTTCheck = 0;
-  if (systemStatus.mqtt == MQTT_STATE_CONNECTED && millis() - lastMQTTCheck > 5000) // Check every 5 seconds
-  {
-    // Read all temperature sensors first
-    readAllSensors();
+// If MQTT is connected, publish the temperature channels that are due
+void mqttPublishJob()
+{
+  if (systemStatus.mqtt != MQTT_STATE_CONNECTED)
+    return;
 
-    // Check if any temperature values have changed
-    if (checkTemperatureChanges())
-    {
-      Serial.println("\n=== MQTT Publish (Temperature Change Detected) ===");
+  // Read all temperature sensors first
+  readAllSensors();
 
-      // Publish sensor data (includes time and system data)
-      publishSensorData();
+  // Publishes only changed channels (plus heartbeats), with time and system data
+  publishSensorData();
+  publishEnergyData();
+}
 
-      Serial.println("=== End MQTT Publish ===\n");
-    }
+// Periodic memory, signal and scheduling report
+void memoryJob()
+{
+  Serial.print("Free heap: ");
+  Serial.print(ESP.getFreeHeap());
+  Serial.println(" bytes");
 
-    lastMQTTCheck = millis();
+  if (isWiFiConnected())
+  {
+    Serial.print("Signal strength (RSSI): ");
+    Serial.print(getWiFiRSSI());
+    Serial.print(" dBm, WiFi reconnects: ");
+    Serial.println(getWiFiReconnectCount());
   }
 
-  // Small delay to prevent watchdog resets and excessive CPU usage
-  delay(50);
+  printSchedulerStats();
+  printPowerStats();
+  printNetClientPoolStats();
+  printOutboxStats();
+  printHistoryStats();
+  printTimeSeriesStats();
+  printEnergyStats();
+  printScheduleSyncStats();
+}
 
-  // Periodic memory monitoring (every 30 seconds)
-  static unsigned long lastMemoryCheck = 0;
-  if (millis() - lastMemoryCheck > 30000)
-  {
-    Serial.print("Free heap: ");
-    Serial.print(ESP.getFreeHeap());
-    Serial.println(" bytes");
-    lastMemoryCheck = millis();
-  }
+void loop()
+{
+  // Run whatever is due, then sleep until the next deadline
+  runScheduler();
+  sleepUntilNextJob();
 }
 
 // put function definitions here:
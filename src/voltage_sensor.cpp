@@ -10,6 +10,7 @@
 #include "config.h"
 
 EnergyMonitor emon1;
+static double lastIrms = 0.0; // last corrected reading, for the history
 
 // Check if heater is actually drawing current (for safety verification)
 bool voltageSensor()
@@ -40,6 +41,7 @@ bool voltageSensor()
     {
         Irms = 0.0;
     }
+    lastIrms = Irms;
 
     // Check if heater is drawing current (simplified for safety check)
     bool currentDetected = (Irms > HEATER_ON_THRESHOLD); // Current > 0.45A indicates heater is on
@@ -55,3 +57,9 @@ bool voltageSensor()
 
     return currentDetected; // Return true if heater is drawing current, false if not
 }
+
+// Current measured by the last voltageSensor() call, in amps
+float getHeaterCurrent()
+{
+    return lastIrms;
+}
@@ -0,0 +1,324 @@
+// ==================================================
+// File: test/native/Arduino.h
+// ==================================================
+//
+// Host stand-in for the parts of the Arduino core the hardware-free modules
+// use, so they build unchanged in the [env:native] test environment.
+// Header-only: String, Print, a silent Serial and a test clock.
+//
+// The clock starts at 0 and only moves with delay() or nativeAdvanceMs(),
+// so tests step through hours of simulated time instantly.
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+#include <algorithm>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HEX 16
+#define DEC 10
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+using std::isnan;
+using std::max;
+using std::min;
+
+template <class T>
+T constrain(T x, T lo, T hi)
+{
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+// === Test clock ===
+
+inline uint64_t nativeNowUs = 0;
+
+inline void nativeAdvanceMs(unsigned long ms)
+{
+    nativeNowUs += (uint64_t)ms * 1000;
+}
+
+inline unsigned long millis()
+{
+    return (unsigned long)(nativeNowUs / 1000);
+}
+
+inline unsigned long micros()
+{
+    return (unsigned long)nativeNowUs;
+}
+
+inline void delay(unsigned long ms)
+{
+    nativeAdvanceMs(ms);
+}
+
+inline void yield()
+{
+}
+
+inline long random(long lo, long hi)
+{
+    return hi > lo ? lo + rand() % (hi - lo) : lo;
+}
+
+inline long random(long hi)
+{
+    return random(0, hi);
+}
+
+// === String ===
+
+class String
+{
+public:
+    String() {}
+    String(const char *c) : s(c ? c : "") {}
+    String(const std::string &x) : s(x) {}
+    String(char c) : s(1, c) {}
+    String(int v, unsigned char base = DEC) { fromInt((long long)v, base); }
+    String(unsigned v, unsigned char base = DEC) { fromUnsigned(v, base); }
+    String(long v, unsigned char base = DEC) { fromInt(v, base); }
+    String(unsigned long v, unsigned char base = DEC) { fromUnsigned(v, base); }
+    String(long long v, unsigned char base = DEC) { fromInt(v, base); }
+    String(unsigned long long v, unsigned char base = DEC) { fromUnsigned(v, base); }
+    String(float v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+    String(double v, unsigned char decimals = 2) { fromDouble(v, decimals); }
+
+    const char *c_str() const { return s.c_str(); }
+    unsigned length() const { return s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    bool reserve(unsigned n)
+    {
+        s.reserve(n);
+        return true;
+    }
+    char charAt(unsigned i) const { return i < s.size() ? s[i] : 0; }
+    char operator[](unsigned i) const { return charAt(i); }
+    void setCharAt(unsigned i, char c)
+    {
+        if (i < s.size())
+            s[i] = c;
+    }
+
+    String substring(unsigned from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+    String substring(unsigned from, unsigned to) const
+    {
+        if (from > to)
+            std::swap(from, to);
+        if (from >= s.size())
+            return String();
+        return String(s.substr(from, to - from));
+    }
+    int indexOf(char c, unsigned from = 0) const { return found(s.find(c, from)); }
+    int indexOf(const char *str, unsigned from = 0) const { return found(s.find(str, from)); }
+    int indexOf(const String &str, unsigned from = 0) const { return found(s.find(str.s, from)); }
+    int lastIndexOf(char c) const { return found(s.rfind(c)); }
+    int lastIndexOf(const char *str) const { return found(s.rfind(str)); }
+
+    bool startsWith(const String &p) const { return s.compare(0, p.s.size(), p.s) == 0; }
+    bool endsWith(const String &p) const
+    {
+        return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0;
+    }
+    bool equals(const String &o) const { return s == o.s; }
+    bool equalsIgnoreCase(const String &o) const { return strcasecmp(s.c_str(), o.s.c_str()) == 0; }
+    int compareTo(const String &o) const { return strcmp(s.c_str(), o.s.c_str()); }
+
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return (float)atof(s.c_str()); }
+    double toDouble() const { return atof(s.c_str()); }
+
+    void trim()
+    {
+        size_t a = s.find_first_not_of(" \t\r\n");
+        size_t b = s.find_last_not_of(" \t\r\n");
+        s = a == std::string::npos ? std::string() : s.substr(a, b - a + 1);
+    }
+    void toLowerCase()
+    {
+        for (char &c : s)
+            c = tolower((unsigned char)c);
+    }
+    void toUpperCase()
+    {
+        for (char &c : s)
+            c = toupper((unsigned char)c);
+    }
+    void replace(const String &from, const String &to)
+    {
+        if (from.s.empty())
+            return;
+        for (size_t i = s.find(from.s); i != std::string::npos; i = s.find(from.s, i + to.s.size()))
+            s.replace(i, from.s.size(), to.s);
+    }
+    void remove(unsigned index) { remove(index, s.size()); }
+    void remove(unsigned index, unsigned count)
+    {
+        if (index < s.size())
+            s.erase(index, count);
+    }
+    void getBytes(unsigned char *buf, unsigned size) const { toCharArray((char *)buf, size); }
+    void toCharArray(char *buf, unsigned size) const
+    {
+        if (size == 0)
+            return;
+        size_t n = std::min<size_t>(size - 1, s.size());
+        memcpy(buf, s.data(), n);
+        buf[n] = '\0';
+    }
+
+    bool concat(const String &o)
+    {
+        s += o.s;
+        return true;
+    }
+    String &operator+=(const String &o)
+    {
+        s += o.s;
+        return *this;
+    }
+    String &operator+=(const char *o)
+    {
+        s += o ? o : "";
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        s += c;
+        return *this;
+    }
+    String &operator+=(int v) { return *this += String(v); }
+    String &operator+=(unsigned v) { return *this += String(v); }
+    String &operator+=(long v) { return *this += String(v); }
+    String &operator+=(unsigned long v) { return *this += String(v); }
+
+    bool operator==(const String &o) const { return s == o.s; }
+    bool operator==(const char *o) const { return s == (o ? o : ""); }
+    bool operator!=(const String &o) const { return s != o.s; }
+    bool operator!=(const char *o) const { return !(*this == o); }
+    bool operator<(const String &o) const { return s < o.s; }
+    explicit operator bool() const { return true; }
+
+    friend String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+    friend String operator+(const String &a, const char *b) { return String(a.s + (b ? b : "")); }
+    friend String operator+(const char *a, const String &b) { return String(std::string(a ? a : "") + b.s); }
+    friend String operator+(const String &a, char b) { return String(a.s + b); }
+
+private:
+    std::string s;
+
+    static int found(size_t i) { return i == std::string::npos ? -1 : (int)i; }
+    void fromUnsigned(unsigned long long v, unsigned char base)
+    {
+        char buf[72];
+        char *p = buf + sizeof(buf) - 1;
+        *p = '\0';
+        do
+        {
+            unsigned d = v % base;
+            *--p = d < 10 ? '0' + d : 'a' + d - 10;
+            v /= base;
+        } while (v);
+        s = p;
+    }
+    void fromInt(long long v, unsigned char base)
+    {
+        if (base == DEC && v < 0)
+        {
+            fromUnsigned(0ULL - (unsigned long long)v, base);
+            s.insert(s.begin(), '-');
+        }
+        else
+        {
+            fromUnsigned((unsigned long long)v, base);
+        }
+    }
+    void fromDouble(double v, unsigned char decimals)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        s = buf;
+    }
+};
+
+// === Print ===
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t *buf, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+            n += write(*buf++);
+        return n;
+    }
+    size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+
+    size_t print(const char *str) { return write(str); }
+    size_t print(const String &str) { return write(str.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned v, int base = DEC) { return print(String(v, base)); }
+    size_t print(long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(long long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(unsigned long long v, int base = DEC) { return print(String(v, base)); }
+    size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+
+    size_t println() { return write("\r\n"); }
+    template <class T>
+    size_t println(const T &v)
+    {
+        return print(v) + println();
+    }
+    template <class T>
+    size_t println(const T &v, int format)
+    {
+        return print(v, format) + println();
+    }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[512];
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (n < 0)
+            return 0;
+        return write((const uint8_t *)buf, std::min<size_t>(n, sizeof(buf) - 1));
+    }
+
+    virtual void flush() {}
+};
+
+// Log output is discarded, so the test report stays readable
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long) {}
+    int available() { return 0; }
+    int read() { return -1; }
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t *, size_t size) override { return size; }
+    using Print::write;
+};
+
+inline HardwareSerial Serial;
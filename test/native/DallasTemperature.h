@@ -0,0 +1,17 @@
+// ==================================================
+// File: test/native/DallasTemperature.h
+// ==================================================
+//
+// Host stand-in: the types only, for headers that declare the sensor objects.
+
+#pragma once
+#include <Arduino.h>
+#include "OneWire.h"
+
+typedef uint8_t DeviceAddress[8];
+
+class DallasTemperature
+{
+public:
+    explicit DallasTemperature(OneWire *bus = nullptr) {}
+};
@@ -0,0 +1,8 @@
+// ==================================================
+// File: test/native/FastLED.h
+// ==================================================
+//
+// Host stand-in: config.h includes FastLED, the tested modules use none of it.
+
+#pragma once
+#include <Arduino.h>
@@ -0,0 +1,190 @@
+// ==================================================
+// File: test/native/Firebase_ESP_Client.h
+// ==================================================
+//
+// Host stand-in for the Firebase client: an in-memory Realtime Database.
+// The database is flat - "/schedule/rev/amTemperature" -> raw JSON text of
+// the leaf - which is all multi-path updates and one-level reads need.
+//
+//   Firebase.RTDB.db["/schedule/amTemperature"] = "\"18.00\""; // an app edit
+//   Firebase.RTDB.online = false;                              // requests fail
+
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <string>
+
+typedef std::map<std::string, std::string> NativeJsonLeaves; // path -> raw JSON
+
+class FirebaseJsonData
+{
+public:
+    bool success = false;
+    String stringValue; // string contents without quotes, or the number/literal as text
+};
+
+class FirebaseJson
+{
+public:
+    NativeJsonLeaves leaves; // relative paths
+
+    bool get(FirebaseJsonData &out, const String &path)
+    {
+        auto it = leaves.find(path.c_str());
+        out.success = it != leaves.end();
+        out.stringValue = "";
+        if (out.success)
+        {
+            const std::string &raw = it->second;
+            bool quoted = raw.size() >= 2 && raw.front() == '"' && raw.back() == '"';
+            out.stringValue = quoted ? String(raw.substr(1, raw.size() - 2)) : String(raw);
+        }
+        return out.success;
+    }
+
+    void clear() { leaves.clear(); }
+
+    // A flat object {"a/b":"x","c":1,...}; nested object values are kept raw
+    bool setJsonData(const String &json)
+    {
+        leaves.clear();
+        const char *p = json.c_str();
+        skipSpace(p);
+        if (*p++ != '{')
+            return false;
+        while (true)
+        {
+            skipSpace(p);
+            if (*p == '}')
+                return true;
+            std::string key, value;
+            if (!readString(p, key))
+                return false;
+            skipSpace(p);
+            if (*p++ != ':')
+                return false;
+            skipSpace(p);
+            if (!readValue(p, value))
+                return false;
+            leaves[key.substr(1, key.size() - 2)] = value;
+            skipSpace(p);
+            if (*p == ',')
+                p++;
+            else if (*p != '}')
+                return false;
+        }
+    }
+
+private:
+    static void skipSpace(const char *&p)
+    {
+        while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+            p++;
+    }
+    static bool readString(const char *&p, std::string &out)
+    {
+        const char *start = p;
+        if (*p++ != '"')
+            return false;
+        while (*p && *p != '"')
+            p += *p == '\\' && p[1] ? 2 : 1;
+        if (*p++ != '"')
+            return false;
+        out.assign(start, p - start);
+        return true;
+    }
+    static bool readValue(const char *&p, std::string &out)
+    {
+        if (*p == '"')
+            return readString(p, out);
+        const char *start = p;
+        int depth = 0;
+        while (*p && (depth > 0 || (*p != ',' && *p != '}')))
+        {
+            if (*p == '{')
+                depth++;
+            else if (*p == '}')
+                depth--;
+            else if (*p == '"')
+            {
+                std::string skipped;
+                if (!readString(p, skipped))
+                    return false;
+                continue;
+            }
+            p++;
+        }
+        out.assign(start, p - start);
+        while (!out.empty() && out.back() == ' ')
+            out.pop_back();
+        return !out.empty();
+    }
+};
+
+class FirebaseData
+{
+public:
+    FirebaseJson &jsonObject() { return json; }
+    String errorReason() { return error; }
+
+    FirebaseJson json;
+    String error;
+};
+
+class NativeRtdb
+{
+public:
+    NativeJsonLeaves db; // absolute paths
+    bool online = true;
+    uint32_t reads = 0;
+    uint32_t updates = 0;
+
+    // Every leaf under path, relative to it
+    bool getJSON(FirebaseData *data, const char *path)
+    {
+        if (!reachable(data))
+            return false;
+        reads++;
+        std::string prefix = std::string(path) + "/";
+        data->json.clear();
+        for (const auto &leaf : db)
+        {
+            if (leaf.first.compare(0, prefix.size(), prefix) == 0)
+                data->json.leaves[leaf.first.substr(prefix.size())] = leaf.second;
+        }
+        return true;
+    }
+
+    // Each key of the update is a path below node; a nested object value
+    // would replace the whole subtree, so it is stored as one leaf
+    bool updateNodeSilent(FirebaseData *data, const char *node, FirebaseJson *json)
+    {
+        if (!reachable(data))
+            return false;
+        updates++;
+        std::string base = strcmp(node, "/") == 0 ? "" : node;
+        for (const auto &leaf : json->leaves)
+        {
+            std::string path = base + "/" + leaf.first;
+            for (auto it = db.begin(); it != db.end();)
+                it = it->first.compare(0, path.size() + 1, path + "/") == 0 ? db.erase(it) : std::next(it);
+            db[path] = leaf.second;
+        }
+        return true;
+    }
+
+private:
+    bool reachable(FirebaseData *data)
+    {
+        data->error = online ? "" : "connection refused";
+        return online;
+    }
+};
+
+class NativeFirebase
+{
+public:
+    NativeRtdb RTDB;
+};
+
+inline NativeFirebase Firebase;
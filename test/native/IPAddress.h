@@ -0,0 +1,37 @@
+// ==================================================
+// File: test/native/IPAddress.h
+// ==================================================
+//
+// Host stand-in for the Arduino IPAddress (IPv4 only).
+
+#pragma once
+#include <Arduino.h>
+
+class IPAddress
+{
+public:
+    IPAddress() : addr{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : addr{a, b, c, d} {}
+
+    bool fromString(const char *s)
+    {
+        unsigned a, b, c, d;
+        char tail;
+        if (sscanf(s, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 || a > 255 || b > 255 || c > 255 || d > 255)
+            return false;
+        *this = IPAddress(a, b, c, d);
+        return true;
+    }
+    String toString() const
+    {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", addr[0], addr[1], addr[2], addr[3]);
+        return String(buf);
+    }
+    uint8_t operator[](int i) const { return addr[i]; }
+    bool operator==(const IPAddress &o) const { return memcmp(addr, o.addr, 4) == 0; }
+    bool operator!=(const IPAddress &o) const { return !(*this == o); }
+
+private:
+    uint8_t addr[4];
+};
@@ -0,0 +1,14 @@
+// ==================================================
+// File: test/native/OneWire.h
+// ==================================================
+//
+// Host stand-in: the type only, for headers that declare the bus object.
+
+#pragma once
+#include <Arduino.h>
+
+class OneWire
+{
+public:
+    explicit OneWire(uint8_t pin = 0) {}
+};
@@ -0,0 +1,87 @@
+// ==================================================
+// File: test/native/Preferences.h
+// ==================================================
+//
+// Host stand-in for the ESP32 Preferences (NVS) library: an in-memory store
+// that outlives the Preferences objects, like flash outlives a reboot.
+// nativeNvs() exposes it so tests can inspect or wipe it.
+
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef std::map<std::string, std::vector<uint8_t>> NativeNvsStore; // "namespace/key" -> bytes
+
+inline NativeNvsStore &nativeNvs()
+{
+    static NativeNvsStore store;
+    return store;
+}
+
+class Preferences
+{
+public:
+    bool begin(const char *name, bool readOnly = false)
+    {
+        ns = name;
+        ro = readOnly;
+        open = true;
+        return true;
+    }
+    void end() { open = false; }
+
+    size_t putBytes(const char *key, const void *value, size_t len)
+    {
+        if (!open || ro)
+            return 0;
+        const uint8_t *p = (const uint8_t *)value;
+        nativeNvs()[path(key)] = std::vector<uint8_t>(p, p + len);
+        return len;
+    }
+    size_t getBytesLength(const char *key)
+    {
+        auto it = nativeNvs().find(path(key));
+        return open && it != nativeNvs().end() ? it->second.size() : 0;
+    }
+    size_t getBytes(const char *key, void *buf, size_t maxLen)
+    {
+        auto it = nativeNvs().find(path(key));
+        if (!open || it == nativeNvs().end() || it->second.size() > maxLen)
+            return 0;
+        memcpy(buf, it->second.data(), it->second.size());
+        return it->second.size();
+    }
+    bool isKey(const char *key) { return open && nativeNvs().count(path(key)) > 0; }
+    bool remove(const char *key) { return open && !ro && nativeNvs().erase(path(key)) > 0; }
+    bool clear()
+    {
+        if (!open || ro)
+            return false;
+        std::string prefix = ns + "/";
+        for (auto it = nativeNvs().begin(); it != nativeNvs().end();)
+            it = it->first.compare(0, prefix.size(), prefix) == 0 ? nativeNvs().erase(it) : std::next(it);
+        return true;
+    }
+
+    size_t putUChar(const char *key, uint8_t v) { return putBytes(key, &v, sizeof(v)); }
+    size_t putUInt(const char *key, uint32_t v) { return putBytes(key, &v, sizeof(v)); }
+    size_t putULong64(const char *key, uint64_t v) { return putBytes(key, &v, sizeof(v)); }
+    uint8_t getUChar(const char *key, uint8_t def = 0) { return get(key, def); }
+    uint32_t getUInt(const char *key, uint32_t def = 0) { return get(key, def); }
+    uint64_t getULong64(const char *key, uint64_t def = 0) { return get(key, def); }
+
+private:
+    std::string ns;
+    bool ro = false;
+    bool open = false;
+
+    std::string path(const char *key) const { return ns + "/" + key; }
+    template <class T>
+    T get(const char *key, T def)
+    {
+        T v;
+        return getBytesLength(key) == sizeof(T) && getBytes(key, &v, sizeof(T)) == sizeof(T) ? v : def;
+    }
+};
@@ -0,0 +1,320 @@
+// ==================================================
+// File: test/native/PubSubClient.h
+// ==================================================
+//
+// Host stand-in for PubSubClient, talking to NativeBroker: an in-memory
+// broker that behaves like a local Mosquitto for one or more clients -
+// credentials, '+'/'#' subscriptions, retained messages, last will, and
+// in-order delivery (so the sync-topic barriers work as on a real broker).
+//
+//   NativeBroker mosquitto;
+//   mosquitto.listen(IPAddress(192, 168, 1, 50), 1883);
+//   mosquitto.inject("esp32/control/schedule/am/time", "06:30"); // another client
+//   mosquitto.shutdown();                                         // connections drop
+//
+// Messages are handed to the callback from loop(), one queue per client.
+
+#pragma once
+#include <Arduino.h>
+#include "Client.h"
+#include "WiFiClient.h"
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+
+typedef std::function<void(char *, uint8_t *, unsigned int)> NativeMqttCallback;
+
+class PubSubClient;
+typedef std::pair<std::string, std::string> NativeMessage; // topic, payload
+
+class NativeBroker
+{
+public:
+    const char *user = nullptr; // nullptr = anonymous clients accepted
+    const char *password = nullptr;
+    bool ignoreSubscribe = false;           // SUBSCRIBE is taken but never applied
+    std::vector<NativeMessage> log;         // every PUBLISH the broker accepted
+    std::map<std::string, std::string> retained;
+    uint32_t connects = 0;
+
+    ~NativeBroker()
+    {
+        while (!sessions.empty())
+            drop(sessions.front(), false);
+    }
+
+    void listen(IPAddress ip, uint16_t port)
+    {
+        endpoint = NativeNetwork::endpoint(ip.toString(), port);
+        nativeNetwork().listeners[endpoint] = this;
+    }
+
+    // Stops listening; every connection drops and its will is published
+    void shutdown();
+
+    // A PUBLISH from some other client
+    void inject(const char *topic, const char *payload, bool retain = false) { publish(topic, payload, retain); }
+
+    uint32_t published(const std::string &topic) const
+    {
+        uint32_t n = 0;
+        for (const auto &m : log)
+            n += m.first == topic;
+        return n;
+    }
+
+    static bool matches(const std::string &filter, const std::string &topic)
+    {
+        std::vector<std::string> f = split(filter), t = split(topic);
+        for (size_t i = 0; i < f.size(); i++)
+        {
+            if (f[i] == "#")
+                return true; // "a/#" also matches "a"
+            if (i >= t.size() || (f[i] != "+" && f[i] != t[i]))
+                return false;
+        }
+        return f.size() == t.size();
+    }
+
+private:
+    friend class PubSubClient;
+    std::string endpoint;
+    std::vector<PubSubClient *> sessions;
+
+    static std::vector<std::string> split(const std::string &topic)
+    {
+        std::vector<std::string> segments(1);
+        for (char c : topic)
+        {
+            if (c == '/')
+                segments.emplace_back();
+            else
+                segments.back() += c;
+        }
+        return segments;
+    }
+
+    void publish(const std::string &topic, const std::string &payload, bool retain);
+    bool accept(PubSubClient *client, const char *user, const char *password);
+    void subscribe(PubSubClient *client, const std::string &filter);
+    void drop(PubSubClient *client, bool sendWill);
+};
+
+class PubSubClient
+{
+public:
+    PubSubClient() {}
+    ~PubSubClient() { disconnect(); }
+
+    PubSubClient &setClient(Client &c)
+    {
+        client = &c;
+        return *this;
+    }
+    PubSubClient &setServer(const char *host, uint16_t p)
+    {
+        domain = host;
+        port = p;
+        return *this;
+    }
+    PubSubClient &setServer(IPAddress ip, uint16_t p)
+    {
+        domain = ip.toString();
+        port = p;
+        return *this;
+    }
+    PubSubClient &setCallback(NativeMqttCallback cb)
+    {
+        onMessage = cb;
+        return *this;
+    }
+    bool setBufferSize(uint16_t size)
+    {
+        bufferSize = size;
+        return true;
+    }
+    PubSubClient &setKeepAlive(uint16_t) { return *this; }
+    PubSubClient &setSocketTimeout(uint16_t) { return *this; }
+
+    bool connect(const char *id, const char *user, const char *pass, const char *willTopic, uint8_t willQos,
+                 bool willRetain, const char *willMessage)
+    {
+        if (connected())
+            return true;
+        // Like the library: opens the transport itself unless it is already up
+        if (!client->connected() && !client->connect(domain.c_str(), port))
+        {
+            rc = MQTT_CONNECT_FAILED;
+            return false;
+        }
+        WiFiClient *tcp = dynamic_cast<WiFiClient *>(client);
+        NativeBroker *target = tcp ? (NativeBroker *)tcp->server() : nullptr;
+        if (!target)
+        {
+            rc = MQTT_CONNECT_FAILED;
+            return false;
+        }
+        will = willTopic ? NativeMessage(willTopic, willMessage) : NativeMessage();
+        this->willRetain = willRetain;
+        clientId = id;
+        if (!target->accept(this, user, pass))
+        {
+            rc = MQTT_CONNECT_BAD_CREDENTIALS;
+            client->stop();
+            return false;
+        }
+        rc = MQTT_CONNECTED;
+        return true;
+    }
+    bool connect(const char *id) { return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr); }
+
+    void disconnect()
+    {
+        if (broker)
+            broker->drop(this, false);
+        rc = MQTT_DISCONNECTED;
+        if (client)
+            client->stop();
+    }
+
+    bool connected()
+    {
+        if (broker && client->connected())
+            return true;
+        if (broker)
+        {
+            broker->drop(this, true);
+            rc = MQTT_CONNECTION_LOST;
+        }
+        return false;
+    }
+
+    bool loop()
+    {
+        if (!connected())
+            return false;
+        while (!inbox.empty())
+        {
+            NativeMessage m = inbox.front();
+            inbox.pop_front();
+            if (!onMessage)
+                continue;
+            std::vector<char> topic(m.first.begin(), m.first.end());
+            topic.push_back('\0');
+            onMessage(topic.data(), (uint8_t *)m.second.data(), m.second.size());
+            if (!connected()) // the callback may have closed the session
+                return false;
+        }
+        return true;
+    }
+
+    bool publish(const char *topic, const char *payload, bool retained = false)
+    {
+        if (!connected() || strlen(topic) + strlen(payload) + 7 > bufferSize)
+            return false;
+        broker->publish(topic, payload, retained);
+        return true;
+    }
+    bool subscribe(const char *topic, uint8_t qos = 0)
+    {
+        if (!connected())
+            return false;
+        broker->subscribe(this, topic);
+        return true;
+    }
+    int state() { return rc; }
+
+    std::vector<std::string> subscriptions; // as applied by the broker
+    std::string clientId;
+
+private:
+    friend class NativeBroker;
+    Client *client = nullptr;
+    NativeBroker *broker = nullptr;
+    String domain;
+    uint16_t port = 0;
+    uint16_t bufferSize = 256;
+    int rc = MQTT_DISCONNECTED;
+    NativeMessage will;
+    bool willRetain = false;
+    std::deque<NativeMessage> inbox;
+    NativeMqttCallback onMessage;
+};
+
+// === NativeBroker ===
+
+inline void NativeBroker::shutdown()
+{
+    nativeNetwork().listeners.erase(endpoint);
+    while (!sessions.empty())
+        drop(sessions.front(), true);
+}
+
+inline void NativeBroker::publish(const std::string &topic, const std::string &payload, bool retain)
+{
+    log.push_back(NativeMessage(topic, payload));
+    if (retain)
+        retained[topic] = payload;
+    for (PubSubClient *s : sessions)
+    {
+        for (const std::string &filter : s->subscriptions)
+        {
+            if (matches(filter, topic))
+            {
+                s->inbox.push_back(NativeMessage(topic, payload));
+                break;
+            }
+        }
+    }
+}
+
+inline bool NativeBroker::accept(PubSubClient *client, const char *u, const char *p)
+{
+    if (user && (!u || strcmp(u, user) != 0 || !p || strcmp(p, password) != 0))
+        return false;
+    connects++;
+    client->broker = this;
+    client->subscriptions.clear();
+    client->inbox.clear();
+    sessions.push_back(client);
+    return true;
+}
+
+inline void NativeBroker::subscribe(PubSubClient *client, const std::string &filter)
+{
+    if (ignoreSubscribe)
+        return;
+    client->subscriptions.push_back(filter);
+    for (const auto &r : retained)
+    {
+        if (matches(filter, r.first))
+            client->inbox.push_back(r);
+    }
+}
+
+inline void NativeBroker::drop(PubSubClient *client, bool sendWill)
+{
+    for (auto it = sessions.begin(); it != sessions.end(); ++it)
+    {
+        if (*it == client)
+        {
+            sessions.erase(it);
+            break;
+        }
+    }
+    client->broker = nullptr;
+    client->subscriptions.clear();
+    client->inbox.clear();
+    if (sendWill && !client->will.first.empty())
+        publish(client->will.first, client->will.second, client->willRetain);
+}
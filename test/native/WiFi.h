@@ -0,0 +1,23 @@
+// ==================================================
+// File: test/native/WiFi.h
+// ==================================================
+//
+// Host stand-in for the ESP32 WiFi object: DNS through nativeNetwork()
+// (WiFiClient.h) and a fixed MAC address.
+
+#pragma once
+#include <Arduino.h>
+#include "IPAddress.h"
+#include "WiFiClient.h"
+#include "WiFiServer.h"
+
+class WiFiClass
+{
+public:
+    String macAddress() { return "24:6F:28:00:00:01"; }
+
+    // 1 on success, like the core
+    int hostByName(const char *host, IPAddress &ip) { return nativeNetwork().resolve(host, ip) ? 1 : 0; }
+};
+
+inline WiFiClass WiFi;
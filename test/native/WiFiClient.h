@@ -0,0 +1,154 @@
+// ==================================================
+// File: test/native/WiFiClient.h
+// ==================================================
+//
+// Host stand-in for the ESP32 WiFiClient on a simulated network: a table of
+// DNS names and a table of listening endpoints. Nothing is sent anywhere;
+// a connection only records where it was dialled and stays up while the
+// listener (e.g. a NativeBroker from PubSubClient.h) does.
+//
+//   nativeNetwork().hosts["broker.example"] = IPAddress(10, 0, 0, 2);
+//   nativeNetwork().dialled  // "10.0.0.2:1883", in order
+//
+// Clients a WiFiServer (WiFiServer.h) accepts do carry bytes: both ends share
+// a NativeConnection, and like the core's socket handle it closes once every
+// copy of the client was stopped or destroyed.
+
+#pragma once
+#include <Arduino.h>
+#include "Client.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct NativeNetwork
+{
+    std::map<std::string, IPAddress> hosts;  // DNS
+    std::map<std::string, void *> listeners; // "ip:port" -> server
+    std::vector<std::string> dialled;        // every connect(), as given
+    uint32_t lookups = 0;                    // DNS queries (IP literals need none)
+
+    static std::string endpoint(const String &address, uint16_t port)
+    {
+        return std::string(address.c_str()) + ":" + std::to_string(port);
+    }
+
+    // Literal or DNS; false if the name is unknown
+    bool resolve(const char *host, IPAddress &ip)
+    {
+        if (ip.fromString(host))
+            return true;
+        lookups++;
+        auto it = hosts.find(host);
+        if (it == hosts.end())
+            return false;
+        ip = it->second;
+        return true;
+    }
+};
+
+inline NativeNetwork &nativeNetwork()
+{
+    static NativeNetwork network;
+    return network;
+}
+
+// An accepted connection; the test plays the remote end
+struct NativeConnection
+{
+    std::string received;    // sent by the remote end, not read yet
+    std::string sent;        // written by the device
+    bool peerClosed = false; // the remote end hung up
+    bool closed = false;     // the device closed it
+};
+
+struct NativeSocket
+{
+    std::shared_ptr<NativeConnection> connection;
+    ~NativeSocket() { connection->closed = true; }
+};
+
+class WiFiClient : public Client
+{
+public:
+    WiFiClient() {}
+    explicit WiFiClient(std::shared_ptr<NativeSocket> accepted) : socket(accepted) {}
+
+    int connect(IPAddress ip, uint16_t port) override
+    {
+        nativeNetwork().dialled.push_back(NativeNetwork::endpoint(ip.toString(), port));
+        return open(ip, port);
+    }
+    int connect(const char *host, uint16_t port) override
+    {
+        nativeNetwork().dialled.push_back(NativeNetwork::endpoint(host, port));
+        IPAddress ip;
+        return nativeNetwork().resolve(host, ip) && open(ip, port);
+    }
+    int connect(const char *host, uint16_t port, int32_t) { return connect(host, port); }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t *buf, size_t size) override
+    {
+        if (!socket)
+            return connected() ? size : 0;
+        if (socket->connection->peerClosed)
+            return 0;
+        socket->connection->sent.append((const char *)buf, size);
+        return size;
+    }
+    int available() override { return socket ? (int)socket->connection->received.size() : 0; }
+    int read() override
+    {
+        uint8_t b;
+        return read(&b, 1) == 1 ? b : -1;
+    }
+    int read(uint8_t *buf, size_t size) override
+    {
+        if (!available())
+            return -1;
+        std::string &in = socket->connection->received;
+        size_t n = size < in.size() ? size : in.size();
+        memcpy(buf, in.data(), n);
+        in.erase(0, n);
+        return (int)n;
+    }
+    int peek() override { return available() ? (uint8_t)socket->connection->received[0] : -1; }
+    void flush() override {}
+    void stop() override
+    {
+        remote.clear();
+        socket.reset();
+    }
+    uint8_t connected() override
+    {
+        if (socket)
+            return !socket->connection->peerClosed || available() > 0;
+        return server() != nullptr;
+    }
+    operator bool() override { return connected(); }
+    using Print::write;
+
+    // The listener this connection reached, nullptr once it is gone
+    void *server() const
+    {
+        if (remote.empty())
+            return nullptr;
+        auto it = nativeNetwork().listeners.find(remote);
+        return it == nativeNetwork().listeners.end() ? nullptr : it->second;
+    }
+
+private:
+    std::string remote;
+    std::shared_ptr<NativeSocket> socket; // shared by copies, as in the core
+
+    int open(IPAddress ip, uint16_t port)
+    {
+        remote = NativeNetwork::endpoint(ip.toString(), port);
+        if (nativeNetwork().listeners.count(remote))
+            return 1;
+        remote.clear();
+        return 0;
+    }
+};
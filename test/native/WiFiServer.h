@@ -0,0 +1,51 @@
+// ==================================================
+// File: test/native/WiFiServer.h
+// ==================================================
+//
+// Host stand-in for the ESP32 WiFiServer. The test plays a LAN client with
+// dial(): the connection is queued until available() accepts it, and the
+// test reads the reply from the returned NativeConnection.
+//
+//   auto c = server.dial("GET /status HTTP/1.1\r\n\r\n");
+//   handleHttpServer();
+//   c->sent;    // "HTTP/1.1 200 OK\r\n..."
+//   c->closed;  // true once the device is done with it
+
+#pragma once
+#include <Arduino.h>
+#include "WiFiClient.h"
+#include <deque>
+
+class WiFiServer
+{
+public:
+    explicit WiFiServer(uint16_t port) : port(port) {}
+
+    void begin() { listening = true; }
+    void setNoDelay(bool) {}
+
+    // The next pending connection, or a client that is false
+    WiFiClient available()
+    {
+        if (!listening || pending.empty())
+            return WiFiClient();
+        std::shared_ptr<NativeSocket> socket = pending.front();
+        pending.pop_front();
+        return WiFiClient(socket);
+    }
+
+    std::shared_ptr<NativeConnection> dial(const std::string &request = "")
+    {
+        std::shared_ptr<NativeSocket> socket = std::make_shared<NativeSocket>();
+        socket->connection = std::make_shared<NativeConnection>();
+        socket->connection->received = request;
+        pending.push_back(socket);
+        return socket->connection;
+    }
+
+    uint16_t port;
+    bool listening = false;
+
+private:
+    std::deque<std::shared_ptr<NativeSocket>> pending; // connected, not accepted yet
+};
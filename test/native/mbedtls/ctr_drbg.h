@@ -0,0 +1,14 @@
+// ==================================================
+// File: test/native/mbedtls/ctr_drbg.h
+// ==================================================
+//
+// See ssl.h.
+
+#pragma once
+#include "ssl.h"
+
+void mbedtls_ctr_drbg_init(mbedtls_ctr_drbg_context *ctx);
+void mbedtls_ctr_drbg_free(mbedtls_ctr_drbg_context *ctx);
+int mbedtls_ctr_drbg_seed(mbedtls_ctr_drbg_context *ctx, int (*entropy)(void *, unsigned char *, size_t),
+                          void *entropyCtx, const unsigned char *custom, size_t len);
+int mbedtls_ctr_drbg_random(void *ctx, unsigned char *output, size_t len);
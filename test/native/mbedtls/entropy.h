@@ -0,0 +1,12 @@
+// ==================================================
+// File: test/native/mbedtls/entropy.h
+// ==================================================
+//
+// See ssl.h.
+
+#pragma once
+#include "ssl.h"
+
+void mbedtls_entropy_init(mbedtls_entropy_context *ctx);
+void mbedtls_entropy_free(mbedtls_entropy_context *ctx);
+int mbedtls_entropy_func(void *data, unsigned char *output, size_t len);
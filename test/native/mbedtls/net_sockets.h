@@ -0,0 +1,19 @@
+// ==================================================
+// File: test/native/mbedtls/net_sockets.h
+// ==================================================
+//
+// See ssl.h.
+
+#pragma once
+#include "ssl.h"
+
+#define MBEDTLS_ERR_NET_SOCKET_FAILED -0x0042
+#define MBEDTLS_ERR_NET_CONNECT_FAILED -0x0044
+#define MBEDTLS_ERR_NET_UNKNOWN_HOST -0x0052
+
+void mbedtls_net_init(mbedtls_net_context *ctx);
+void mbedtls_net_free(mbedtls_net_context *ctx);
+int mbedtls_net_set_nonblock(mbedtls_net_context *ctx);
+int mbedtls_net_send(void *ctx, const unsigned char *buf, size_t len);
+int mbedtls_net_recv(void *ctx, unsigned char *buf, size_t len);
+int mbedtls_net_recv_timeout(void *ctx, unsigned char *buf, size_t len, uint32_t timeout);
@@ -0,0 +1,10 @@
+// ==================================================
+// File: test/native/mbedtls/sha256.h
+// ==================================================
+//
+// See ssl.h.
+
+#pragma once
+#include "ssl.h"
+
+int mbedtls_sha256_ret(const unsigned char *input, size_t len, unsigned char output[32], int is224);
@@ -0,0 +1,113 @@
+// ==================================================
+// File: test/native/mbedtls/ssl.h
+// ==================================================
+//
+// Host stand-in for the slice of the mbedTLS 2.x API that TlsClient uses:
+// the types (with just the members TlsClient touches), constants and
+// declarations. Nothing here is implemented - suites that never open a TLS
+// connection define the TlsClient members they link against, and
+// test_tls_client defines these functions as a fake server with a session
+// cache and a certificate it can swap.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBEDTLS_SSL_SESSION_TICKETS
+
+#define MBEDTLS_ERR_SSL_TIMEOUT -0x6800
+#define MBEDTLS_ERR_SSL_WANT_READ -0x6900
+#define MBEDTLS_ERR_SSL_WANT_WRITE -0x6880
+#define MBEDTLS_ERR_SSL_HANDSHAKE_FAILURE -0x7780
+#define MBEDTLS_ERR_SSL_BAD_INPUT_DATA -0x7100
+
+#define MBEDTLS_SSL_IS_CLIENT 0
+#define MBEDTLS_SSL_TRANSPORT_STREAM 0
+#define MBEDTLS_SSL_PRESET_DEFAULT 0
+#define MBEDTLS_SSL_VERIFY_NONE 0
+#define MBEDTLS_SSL_VERIFY_OPTIONAL 1
+#define MBEDTLS_SSL_VERIFY_REQUIRED 2
+#define MBEDTLS_SSL_SESSION_TICKETS_ENABLED 1
+
+typedef struct
+{
+    int fd;
+} mbedtls_net_context;
+
+typedef struct
+{
+    int unused;
+} mbedtls_entropy_context;
+
+typedef struct
+{
+    int seeded;
+} mbedtls_ctr_drbg_context;
+
+typedef struct
+{
+    const unsigned char *p;
+    size_t len;
+} mbedtls_x509_buf;
+
+typedef struct
+{
+    mbedtls_x509_buf raw; // DER
+} mbedtls_x509_crt;
+
+typedef struct
+{
+    unsigned char id[32];
+    size_t id_len;
+    unsigned char master[48];
+} mbedtls_ssl_session;
+
+typedef struct
+{
+    int authmode;
+    uint32_t read_timeout;
+} mbedtls_ssl_config;
+
+typedef int mbedtls_ssl_send_t(void *ctx, const unsigned char *buf, size_t len);
+typedef int mbedtls_ssl_recv_t(void *ctx, unsigned char *buf, size_t len);
+typedef int mbedtls_ssl_recv_timeout_t(void *ctx, unsigned char *buf, size_t len, uint32_t timeout);
+
+typedef struct
+{
+    const mbedtls_ssl_config *conf;
+    char hostname[256];
+    mbedtls_ssl_session offered;
+    int haveOffered;
+    mbedtls_ssl_session negotiated;
+    const mbedtls_x509_crt *peer;
+    int done; // handshake finished
+} mbedtls_ssl_context;
+
+void mbedtls_ssl_init(mbedtls_ssl_context *ssl);
+void mbedtls_ssl_free(mbedtls_ssl_context *ssl);
+int mbedtls_ssl_setup(mbedtls_ssl_context *ssl, const mbedtls_ssl_config *conf);
+int mbedtls_ssl_set_hostname(mbedtls_ssl_context *ssl, const char *hostname);
+int mbedtls_ssl_set_session(mbedtls_ssl_context *ssl, const mbedtls_ssl_session *session);
+int mbedtls_ssl_get_session(const mbedtls_ssl_context *ssl, mbedtls_ssl_session *session);
+void mbedtls_ssl_set_bio(mbedtls_ssl_context *ssl, void *bio, mbedtls_ssl_send_t *send, mbedtls_ssl_recv_t *recv,
+                         mbedtls_ssl_recv_timeout_t *recvTimeout);
+int mbedtls_ssl_handshake(mbedtls_ssl_context *ssl);
+const mbedtls_x509_crt *mbedtls_ssl_get_peer_cert(const mbedtls_ssl_context *ssl);
+int mbedtls_ssl_read(mbedtls_ssl_context *ssl, unsigned char *buf, size_t len);
+int mbedtls_ssl_write(mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len);
+size_t mbedtls_ssl_get_bytes_avail(const mbedtls_ssl_context *ssl);
+int mbedtls_ssl_close_notify(mbedtls_ssl_context *ssl);
+
+void mbedtls_ssl_config_init(mbedtls_ssl_config *conf);
+void mbedtls_ssl_config_free(mbedtls_ssl_config *conf);
+int mbedtls_ssl_config_defaults(mbedtls_ssl_config *conf, int endpoint, int transport, int preset);
+void mbedtls_ssl_conf_ca_chain(mbedtls_ssl_config *conf, mbedtls_x509_crt *ca, void *crl);
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config *conf, int authmode);
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config *conf, int (*rng)(void *, unsigned char *, size_t), void *p);
+void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config *conf, int useTickets);
+void mbedtls_ssl_conf_read_timeout(mbedtls_ssl_config *conf, uint32_t timeout);
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session *session);
+void mbedtls_ssl_session_free(mbedtls_ssl_session *session);
+int mbedtls_ssl_session_save(const mbedtls_ssl_session *session, unsigned char *buf, size_t len, size_t *olen);
+int mbedtls_ssl_session_load(mbedtls_ssl_session *session, const unsigned char *buf, size_t len);
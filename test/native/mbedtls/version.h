@@ -0,0 +1,10 @@
+// ==================================================
+// File: test/native/mbedtls/version.h
+// ==================================================
+//
+// See ssl.h.
+
+#pragma once
+
+#define MBEDTLS_VERSION_MAJOR 2
+#define MBEDTLS_VERSION_NUMBER 0x021C0300 // 2.28.3, as in ESP32 Arduino 2.x
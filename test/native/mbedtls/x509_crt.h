@@ -0,0 +1,12 @@
+// ==================================================
+// File: test/native/mbedtls/x509_crt.h
+// ==================================================
+//
+// See ssl.h.
+
+#pragma once
+#include "ssl.h"
+
+void mbedtls_x509_crt_init(mbedtls_x509_crt *crt);
+void mbedtls_x509_crt_free(mbedtls_x509_crt *crt);
+int mbedtls_x509_crt_parse(mbedtls_x509_crt *chain, const unsigned char *buf, size_t len);
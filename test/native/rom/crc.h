@@ -0,0 +1,21 @@
+// ==================================================
+// File: test/native/rom/crc.h
+// ==================================================
+//
+// Host stand-in for the ESP32 ROM CRC routines.
+
+#pragma once
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3, reflected), as the ROM's crc32_le()
+inline uint32_t crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *buf++;
+        for (int i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
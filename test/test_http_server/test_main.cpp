@@ -0,0 +1,300 @@
+// ==================================================
+// File: test/test_http_server/test_main.cpp
+// ==================================================
+//
+// HttpServer on the host, with the test playing LAN clients through the
+// WiFiServer stand-in: request parsing (query, form body, headers, bodies
+// arriving in pieces), response formatting, the error statuses, timeouts,
+// slot exhaustion and event streams.
+
+#include <unity.h>
+#include "HttpServer.cpp"
+
+typedef std::shared_ptr<NativeConnection> Connection;
+
+// === Routes ===
+
+static char seenHeader[64];
+
+static void handleHello(const HttpRequest &req, HttpResponse &res)
+{
+    res.print("hello");
+}
+
+static void handleEcho(const HttpRequest &req, HttpResponse &res)
+{
+    char name[32] = "";
+    char x[8] = "";
+    getHttpQueryParam(req, "name", name, sizeof(name));
+    getHttpQueryParam(req, "x", x, sizeof(x));
+    res.contentType = "application/json";
+    res.printf("{\"path\":\"%s\",\"name\":\"%s\",\"x\":\"%s\"}", req.path, name, x);
+}
+
+static void handleForm(const HttpRequest &req, HttpResponse &res)
+{
+    char temp[16];
+    if (!getHttpFormParam(req, "temp", temp, sizeof(temp)))
+    {
+        res.status = 400;
+        res.print("missing temp");
+        return;
+    }
+    const char *auth = getHttpHeader(req, "authorization");
+    snprintf(seenHeader, sizeof(seenHeader), "%s", auth ? auth : "");
+    res.printf("temp=%s len=%u", temp, (unsigned)req.bodyLen);
+}
+
+static void handleHuge(const HttpRequest &req, HttpResponse &res)
+{
+    for (int i = 0; i < HTTP_RESPONSE_MAX / 8 + 1; i++)
+        res.print("12345678");
+}
+
+static void handleEvents(const HttpRequest &req, HttpResponse &res)
+{
+    res.stream = true;
+    res.print("event: hello\ndata: {}\n\n");
+}
+
+// === Helpers ===
+
+// Accepts and serves: a few polls, as the scheduler job would run
+static void poll(int times = 3)
+{
+    for (int i = 0; i < times; i++)
+        handleHttpServer();
+}
+
+static Connection request(const std::string &raw)
+{
+    Connection c = server.dial(raw);
+    poll();
+    return c;
+}
+
+static std::string bodyOf(const Connection &c)
+{
+    size_t at = c->sent.find("\r\n\r\n");
+    return at == std::string::npos ? "" : c->sent.substr(at + 4);
+}
+
+static bool hasLine(const Connection &c, const char *line)
+{
+    return c->sent.find(std::string("\r\n") + line + "\r\n") != std::string::npos;
+}
+
+static void assertStatus(const char *statusLine, const Connection &c)
+{
+    std::string first = c->sent.substr(0, c->sent.find("\r\n"));
+    TEST_ASSERT_EQUAL_STRING(statusLine, first.c_str());
+}
+
+void setUp(void)
+{
+    for (uint8_t i = 0; i < HTTP_MAX_CLIENTS; i++)
+        closeSlot(slots[i]);
+    for (uint8_t i = 0; i < HTTP_MAX_STREAMS; i++)
+        streams[i] = WiFiClient();
+    seenHeader[0] = '\0';
+}
+
+void tearDown(void)
+{
+}
+
+// === Tests ===
+
+void test_get_response_format(void)
+{
+    uint32_t before = getHttpRequestCount();
+    Connection c = request("GET /hello HTTP/1.1\r\nHost: heater.local\r\n\r\n");
+    TEST_ASSERT_EQUAL_STRING("HTTP/1.1 200 OK\r\n"
+                             "Content-Type: text/plain\r\n"
+                             "Content-Length: 5\r\n"
+                             "Cache-Control: no-store\r\n"
+                             "Access-Control-Allow-Origin: *\r\n"
+                             "Connection: close\r\n"
+                             "\r\n"
+                             "hello",
+                             c->sent.c_str());
+    TEST_ASSERT_TRUE(c->closed);
+    TEST_ASSERT_EQUAL(before + 1, getHttpRequestCount());
+}
+
+void test_query_is_split_and_decoded(void)
+{
+    Connection c = request("GET /echo?name=a%20b+c%2Fd&x=1 HTTP/1.1\r\n\r\n");
+    assertStatus("HTTP/1.1 200 OK", c);
+    TEST_ASSERT_TRUE(hasLine(c, "Content-Type: application/json"));
+    TEST_ASSERT_EQUAL_STRING("{\"path\":\"/echo\",\"name\":\"a b c/d\",\"x\":\"1\"}", bodyOf(c).c_str());
+}
+
+// Headers match case-insensitively, and the body waits for Content-Length
+void test_form_body_arrives_in_pieces(void)
+{
+    Connection c = server.dial("POST /form HTTP/1.1\r\nAUTHORIZATION: Bearer abc\r\n"
+                               "Content-Type: application/x-www-form-urlencoded\r\n"
+                               "Content-Length: 14\r\n\r\ntemp=2");
+    poll();
+    TEST_ASSERT_EQUAL(0, c->sent.size());
+    TEST_ASSERT_FALSE(c->closed);
+
+    c->received += "1.5&on=1";
+    poll();
+    assertStatus("HTTP/1.1 200 OK", c);
+    TEST_ASSERT_EQUAL_STRING("temp=21.5 len=14", bodyOf(c).c_str());
+    TEST_ASSERT_EQUAL_STRING("Bearer abc", seenHeader);
+}
+
+void test_head_split_across_reads(void)
+{
+    Connection c = server.dial("GET /hel");
+    poll();
+    c->received += "lo HTTP/1.1\r\nHost: x\r\n";
+    poll();
+    TEST_ASSERT_EQUAL(0, c->sent.size());
+    c->received += "\r\n";
+    poll();
+    TEST_ASSERT_EQUAL_STRING("hello", bodyOf(c).c_str());
+}
+
+void test_handler_status_is_used(void)
+{
+    Connection c = request("POST /form HTTP/1.1\r\nContent-Length: 3\r\n\r\nx=1");
+    assertStatus("HTTP/1.1 400 Bad Request", c);
+    TEST_ASSERT_EQUAL_STRING("missing temp", bodyOf(c).c_str());
+}
+
+void test_unknown_path_and_wrong_method(void)
+{
+    Connection missing = request("GET /nope HTTP/1.1\r\n\r\n");
+    assertStatus("HTTP/1.1 404 Not Found", missing);
+    TEST_ASSERT_EQUAL_STRING("404 Not Found\n", bodyOf(missing).c_str());
+    TEST_ASSERT_TRUE(hasLine(missing, "Content-Length: 14"));
+
+    Connection wrong = request("POST /hello HTTP/1.1\r\nContent-Length: 0\r\n\r\n");
+    assertStatus("HTTP/1.1 405 Method Not Allowed", wrong);
+}
+
+void test_preflight(void)
+{
+    Connection c = request("OPTIONS /form HTTP/1.1\r\nOrigin: http://dash.local\r\n\r\n");
+    assertStatus("HTTP/1.1 204 No Content", c);
+    TEST_ASSERT_TRUE(hasLine(c, "Access-Control-Allow-Methods: GET, POST, OPTIONS"));
+    TEST_ASSERT_TRUE(hasLine(c, "Access-Control-Allow-Headers: Authorization, Content-Type"));
+    TEST_ASSERT_EQUAL_STRING("", bodyOf(c).c_str());
+
+    Connection missing = request("OPTIONS /nope HTTP/1.1\r\n\r\n");
+    assertStatus("HTTP/1.1 404 Not Found", missing);
+}
+
+void test_malformed_requests(void)
+{
+    assertStatus("HTTP/1.1 400 Bad Request", request("GET hello HTTP/1.1\r\n\r\n"));
+    assertStatus("HTTP/1.1 400 Bad Request", request("GET\r\n\r\n"));
+    assertStatus("HTTP/1.1 400 Bad Request", request("POST /form HTTP/1.1\r\nContent-Length: -5\r\n\r\n"));
+}
+
+void test_too_large(void)
+{
+    Connection head = request("GET /hello HTTP/1.1\r\nX-Pad: " + std::string(HTTP_REQUEST_MAX, 'a') + "\r\n\r\n");
+    assertStatus("HTTP/1.1 413 Payload Too Large", head);
+    TEST_ASSERT_TRUE(head->closed);
+
+    Connection body = request("POST /form HTTP/1.1\r\nContent-Length: 5000\r\n\r\n");
+    assertStatus("HTTP/1.1 413 Payload Too Large", body);
+}
+
+void test_response_overflow_is_500(void)
+{
+    Connection c = request("GET /huge HTTP/1.1\r\n\r\n");
+    assertStatus("HTTP/1.1 500 Internal Server Error", c);
+}
+
+// A client that never finishes its request loses the slot, without a reply
+void test_incomplete_request_times_out(void)
+{
+    Connection c = server.dial("GET /hello HTTP/1.1\r\n");
+    poll();
+    nativeAdvanceMs(HTTP_CLIENT_TIMEOUT_MS + 1);
+    poll();
+    TEST_ASSERT_TRUE(c->closed);
+    TEST_ASSERT_EQUAL(0, c->sent.size());
+
+    Connection next = request("GET /hello HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_STRING("hello", bodyOf(next).c_str());
+}
+
+void test_busy_slots_answer_503(void)
+{
+    Connection a = server.dial("GET /hel");
+    Connection b = server.dial("GET /hel");
+    poll(2);
+    Connection c = request("GET /hello HTTP/1.1\r\n\r\n");
+    assertStatus("HTTP/1.1 503 Service Unavailable", c);
+    TEST_ASSERT_TRUE(c->closed);
+
+    a->received += "lo HTTP/1.1\r\n\r\n";
+    b->peerClosed = true; // hung up half-way
+    poll();
+    TEST_ASSERT_EQUAL_STRING("hello", bodyOf(a).c_str());
+    TEST_ASSERT_TRUE(b->closed);
+}
+
+void test_event_stream(void)
+{
+    Connection c = request("GET /events HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL_STRING("HTTP/1.1 200 OK\r\n"
+                             "Content-Type: text/event-stream\r\n"
+                             "Cache-Control: no-store\r\n"
+                             "Access-Control-Allow-Origin: *\r\n"
+                             "Connection: keep-alive\r\n"
+                             "\r\n"
+                             "event: hello\ndata: {}\n\n",
+                             c->sent.c_str());
+    TEST_ASSERT_FALSE(c->closed);
+    TEST_ASSERT_EQUAL(1, getHttpStreamCount());
+
+    c->sent.clear();
+    TEST_ASSERT_EQUAL(1, writeHttpStreams("data: 1\n\n", 9));
+    TEST_ASSERT_EQUAL_STRING("data: 1\n\n", c->sent.c_str());
+
+    // More streams than slots: the extra one is refused
+    Connection second = request("GET /events HTTP/1.1\r\n\r\n");
+    Connection third = request("GET /events HTTP/1.1\r\n\r\n");
+    TEST_ASSERT_EQUAL(2, getHttpStreamCount());
+    assertStatus("HTTP/1.1 503 Service Unavailable", third);
+
+    c->peerClosed = true;
+    TEST_ASSERT_EQUAL(1, writeHttpStreams("data: 2\n\n", 9));
+    TEST_ASSERT_TRUE(c->closed);
+    TEST_ASSERT_EQUAL(1, getHttpStreamCount());
+    TEST_ASSERT_TRUE(second->sent.find("data: 2\n\n") != std::string::npos);
+}
+
+int main(int argc, char **argv)
+{
+    addHttpRoute("GET", "/hello", handleHello);
+    addHttpRoute("GET", "/echo", handleEcho);
+    addHttpRoute("POST", "/form", handleForm);
+    addHttpRoute("GET", "/huge", handleHuge);
+    addHttpRoute("GET", "/events", handleEvents);
+    initHttpServer();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_get_response_format);
+    RUN_TEST(test_query_is_split_and_decoded);
+    RUN_TEST(test_form_body_arrives_in_pieces);
+    RUN_TEST(test_head_split_across_reads);
+    RUN_TEST(test_handler_status_is_used);
+    RUN_TEST(test_unknown_path_and_wrong_method);
+    RUN_TEST(test_preflight);
+    RUN_TEST(test_malformed_requests);
+    RUN_TEST(test_too_large);
+    RUN_TEST(test_response_overflow_is_500);
+    RUN_TEST(test_incomplete_request_times_out);
+    RUN_TEST(test_busy_slots_answer_503);
+    RUN_TEST(test_event_stream);
+    return UNITY_END();
+}
@@ -0,0 +1,354 @@
+// ==================================================
+// File: test/test_mqtt_manager/test_main.cpp
+// ==================================================
+//
+// The MQTT connection state machine against Mosquitto stand-ins
+// (NativeBroker, test/native/PubSubClient.h): a LAN broker by IP and a
+// "cloud" broker by name, plain MQTT (MQTT_USE_TLS false) as with a local
+// Mosquitto. Covers the stage order, DNS once per attempt and TCP to the
+// resolved address, the subscription barrier, backoff, failover and the
+// switch back, the last will, and that no stage waits with delay().
+
+#include <unity.h>
+#define MQTT_USE_TLS false
+#define MQTT_LAN_ENABLED true
+#include "MQTTManager.cpp"
+#include "MQTTOutbox.cpp"
+#include "Reporter.cpp"
+#include "SystemState.cpp"
+#include "TopicRouter.cpp"
+
+// === Collaborators ===
+
+SystemStatus systemStatus = {};
+const char ROOT_CA_ISRG_X1[] = "";
+static bool wifiUp = true;
+static std::vector<std::string> scheduleMessages;
+
+bool isWiFiConnected()
+{
+    return wifiUp;
+}
+
+long getWiFiRSSI()
+{
+    return -60;
+}
+
+void handleScheduleUpdate(const char *topic, const String &message)
+{
+    scheduleMessages.push_back(std::string(topic) + "=" + message.c_str());
+}
+
+void handleHistoryQuery(const char *, const String &)
+{
+}
+
+Temp getLastTemperature(int)
+{
+    return Temp::fromCenti(2150);
+}
+
+float getHeaterCurrent()
+{
+    return 0;
+}
+
+String getFormattedTime()
+{
+    return "12:00:00";
+}
+
+String getFormattedDate()
+{
+    return "2024-06-01";
+}
+
+const EnergyTotals &getEnergyTotals()
+{
+    static EnergyTotals totals = {};
+    return totals;
+}
+
+uint32_t getEnergyWh(const EnergyPeriod &)
+{
+    return 0;
+}
+
+uint16_t getDutyPermille(const EnergyPeriod &)
+{
+    return 0;
+}
+
+void registerNetClient(NetClientId, const char *, bool, TlsCloseFn)
+{
+}
+
+bool acquireTls(NetClientId)
+{
+    return true;
+}
+
+void releaseTls(NetClientId)
+{
+}
+
+void tlsClosed(NetClientId)
+{
+}
+
+// Plain MQTT only; the TLS client is never connected here
+TlsClient::TlsClient() {}
+TlsClient::~TlsClient() {}
+void TlsClient::setPinnedCA(const char *) {}
+void TlsClient::setSessionStore(const char *) {}
+int TlsClient::connect(IPAddress, uint16_t) { return 0; }
+int TlsClient::connect(const char *, uint16_t) { return 0; }
+int TlsClient::connect(IPAddress, uint16_t, const char *) { return 0; }
+size_t TlsClient::write(uint8_t) { return 0; }
+size_t TlsClient::write(const uint8_t *, size_t) { return 0; }
+int TlsClient::available() { return 0; }
+int TlsClient::read() { return -1; }
+int TlsClient::read(uint8_t *, size_t) { return -1; }
+int TlsClient::peek() { return -1; }
+void TlsClient::flush() {}
+void TlsClient::stop() {}
+uint8_t TlsClient::connected() { return 0; }
+
+// === Brokers ===
+
+static const IPAddress LAN_IP(192, 168, 1, 50);
+static const IPAddress CLOUD_IP(52, 28, 14, 9);
+static NativeBroker lan;
+static NativeBroker cloud;
+
+static std::string lanEndpoint()
+{
+    return NativeNetwork::endpoint(MQTT_LAN_SERVER, MQTT_LAN_PORT);
+}
+
+static std::string cloudEndpoint()
+{
+    return NativeNetwork::endpoint(CLOUD_IP.toString(), MQTT_PORT);
+}
+
+// One scheduler tick of the "mqtt" job; the stage itself must not move the clock
+static void tick()
+{
+    uint64_t before = nativeNowUs;
+    handleMQTT();
+    TEST_ASSERT_EQUAL_UINT64(before, nativeNowUs);
+    nativeAdvanceMs(MQTT_LOOP_INTERVAL);
+}
+
+// Ticks until READY; the number of ticks, or -1
+static int runUntilReady(int maxTicks)
+{
+    for (int i = 1; i <= maxTicks; i++)
+    {
+        tick();
+        if (getMQTTConnState() == MQTT_CONN_READY)
+            return i;
+    }
+    return -1;
+}
+
+void setUp(void)
+{
+    closeTransport();
+    lan.shutdown();
+    cloud.shutdown();
+    lan = NativeBroker();
+    cloud = NativeBroker();
+    cloud.user = MQTT_USER;
+    cloud.password = MQTT_PASSWORD;
+    nativeNetwork() = NativeNetwork();
+    nativeNetwork().hosts[MQTT_SERVER] = CLOUD_IP;
+    lan.listen(LAN_IP, MQTT_LAN_PORT);
+    cloud.listen(CLOUD_IP, MQTT_PORT);
+    scheduleMessages.clear();
+    wifiUp = true;
+
+    activeBroker = MQTT_BROKER_LAN;
+    lanFailures = 0;
+    initMQTT();
+}
+
+void tearDown(void)
+{
+}
+
+// === Tests ===
+
+void test_stages_in_order(void)
+{
+    const MQTTConnState expected[] = {MQTT_CONN_RESOLVE, MQTT_CONN_TLS, MQTT_CONN_CONNECT,
+                                      MQTT_CONN_SUBSCRIBE, MQTT_CONN_WAIT_SUBACK, MQTT_CONN_READY};
+    TEST_ASSERT_EQUAL(MQTT_CONN_RESOLVE, getMQTTConnState()); // WiFi already up
+    for (MQTTConnState stage : expected)
+    {
+        TEST_ASSERT_EQUAL(stage, getMQTTConnState());
+        tick();
+    }
+    TEST_ASSERT_EQUAL(MQTT_CONN_READY, getMQTTConnState());
+    TEST_ASSERT_EQUAL(MQTT_STATE_CONNECTED, getMQTTStatus());
+    TEST_ASSERT_EQUAL(1, lan.connects);
+}
+
+void test_lan_broker_by_address(void)
+{
+    TEST_ASSERT_TRUE(runUntilReady(10) > 0);
+    TEST_ASSERT_EQUAL(MQTT_BROKER_LAN, getMQTTBroker());
+    TEST_ASSERT_EQUAL(1, lan.connects);
+    TEST_ASSERT_EQUAL(0, nativeNetwork().lookups); // an IP literal needs no DNS
+    TEST_ASSERT_EQUAL(1, nativeNetwork().dialled.size());
+    TEST_ASSERT_EQUAL_STRING(lanEndpoint().c_str(), nativeNetwork().dialled[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("online", lan.retained[TOPIC_STATUS].c_str());
+}
+
+// The subscription is only trusted once the barrier comes back through it
+void test_subscription_barrier(void)
+{
+    TEST_ASSERT_TRUE(runUntilReady(10) > 0);
+    TEST_ASSERT_EQUAL(1, mqttClient.subscriptions.size());
+    TEST_ASSERT_EQUAL_STRING(TOPIC_CONTROL_ALL, mqttClient.subscriptions[0].c_str());
+    TEST_ASSERT_EQUAL(1, lan.published(syncTopic.c_str()));
+    TEST_ASSERT_TRUE(subscriptionsConfirmed);
+}
+
+void test_suback_timeout_backs_off(void)
+{
+    lan.ignoreSubscribe = true;
+    for (int i = 0; i < 5; i++)
+        tick();
+    TEST_ASSERT_EQUAL(MQTT_CONN_WAIT_SUBACK, getMQTTConnState());
+    nativeAdvanceMs(MQTT_SUBACK_TIMEOUT_MS);
+    tick();
+    TEST_ASSERT_EQUAL(MQTT_CONN_IDLE, getMQTTConnState());
+    TEST_ASSERT_EQUAL(MQTT_STATE_ERROR, getMQTTStatus());
+    TEST_ASSERT_EQUAL(1, connBackoff.failures);
+
+    // The next attempt waits out the backoff, then succeeds
+    lan.ignoreSubscribe = false;
+    unsigned long failedAt = millis();
+    int ticks = runUntilReady(1000);
+    TEST_ASSERT_TRUE(ticks > 0);
+    TEST_ASSERT_TRUE(millis() - failedAt >= MQTT_BACKOFF_MIN_MS / 2);
+    TEST_ASSERT_EQUAL(0, connBackoff.failures);
+}
+
+void test_control_messages_are_routed(void)
+{
+    TEST_ASSERT_TRUE(runUntilReady(10) > 0);
+    lan.inject(TOPIC_CONTROL_AM_TIME, "06:30");
+    lan.inject("esp32/Control/schedule/am/time", "07:00"); // another topic entirely
+    lan.inject("esp32/sensors/temperature/red", "21.5");   // not subscribed
+    tick();
+    TEST_ASSERT_EQUAL(1, scheduleMessages.size());
+    TEST_ASSERT_EQUAL_STRING(TOPIC_CONTROL_AM_TIME "=06:30", scheduleMessages[0].c_str());
+}
+
+void test_outbox_delivers_after_connect(void)
+{
+    publishSingleValue(TOPIC_TEMP_RED, "21.5"); // queued while disconnected
+    TEST_ASSERT_TRUE(runUntilReady(10) > 0);
+    for (int i = 0; i < 5; i++)
+        tick();
+    TEST_ASSERT_EQUAL(1, lan.published(TOPIC_TEMP_RED));
+    TEST_ASSERT_EQUAL(0, getOutboxDepth());
+}
+
+void test_lost_session_publishes_will_and_reconnects(void)
+{
+    TEST_ASSERT_TRUE(runUntilReady(10) > 0);
+    uint32_t connects = getMQTTConnectCount();
+    lan.shutdown();
+    tick();
+    TEST_ASSERT_EQUAL(MQTT_CONN_IDLE, getMQTTConnState());
+    TEST_ASSERT_EQUAL_STRING("offline", lan.retained[TOPIC_STATUS].c_str());
+
+    lan.listen(LAN_IP, MQTT_LAN_PORT);
+    TEST_ASSERT_TRUE(runUntilReady(1000) > 0);
+    TEST_ASSERT_EQUAL(connects + 1, getMQTTConnectCount());
+    TEST_ASSERT_EQUAL_STRING("online", lan.retained[TOPIC_STATUS].c_str());
+}
+
+// The cloud broker is found by name once per attempt, and the TCP connect
+// goes to that address instead of resolving the name again
+void test_failover_to_cloud_uses_resolved_address(void)
+{
+    lan.shutdown();
+    TEST_ASSERT_TRUE(runUntilReady(1000) > 0);
+    TEST_ASSERT_EQUAL(MQTT_BROKER_CLOUD, getMQTTBroker());
+    TEST_ASSERT_EQUAL(MQTT_LAN_FAILOVER_ATTEMPTS, nativeNetwork().dialled.size() - 1);
+    TEST_ASSERT_EQUAL_STRING(cloudEndpoint().c_str(), nativeNetwork().dialled.back().c_str());
+    TEST_ASSERT_EQUAL(1, nativeNetwork().lookups);
+    TEST_ASSERT_EQUAL(1, cloud.connects);
+    TEST_ASSERT_EQUAL_STRING(MQTT_USER, cloud.user);
+}
+
+void test_dns_failure_backs_off(void)
+{
+    activeBroker = MQTT_BROKER_CLOUD;
+    useBroker(MQTT_BROKER_CLOUD);
+    nativeNetwork().hosts.clear();
+    tick();
+    TEST_ASSERT_EQUAL(MQTT_CONN_IDLE, getMQTTConnState());
+    TEST_ASSERT_EQUAL(0, nativeNetwork().dialled.size());
+    TEST_ASSERT_EQUAL(1, connBackoff.failures);
+}
+
+void test_bad_credentials_fail_connect(void)
+{
+    lan.user = "someone";
+    lan.password = "secret";
+    for (int i = 0; i < 3; i++)
+        tick();
+    TEST_ASSERT_EQUAL(MQTT_CONN_IDLE, getMQTTConnState());
+    TEST_ASSERT_EQUAL(1, connBackoff.failures);
+    TEST_ASSERT_EQUAL(0, lan.connects);
+}
+
+void test_switches_back_to_lan(void)
+{
+    lan.shutdown();
+    TEST_ASSERT_TRUE(runUntilReady(1000) > 0);
+    TEST_ASSERT_EQUAL(MQTT_BROKER_CLOUD, getMQTTBroker());
+
+    lan.listen(LAN_IP, MQTT_LAN_PORT);
+    nativeAdvanceMs(MQTT_LAN_PROBE_INTERVAL);
+    tick();
+    TEST_ASSERT_EQUAL(MQTT_BROKER_LAN, getMQTTBroker());
+    TEST_ASSERT_TRUE(runUntilReady(10) > 0);
+    TEST_ASSERT_EQUAL(1, lan.connects);
+}
+
+void test_wifi_loss_resets(void)
+{
+    TEST_ASSERT_TRUE(runUntilReady(10) > 0);
+    wifiUp = false;
+    tick();
+    TEST_ASSERT_EQUAL(MQTT_CONN_IDLE, getMQTTConnState());
+    TEST_ASSERT_EQUAL(MQTT_STATE_DISCONNECTED, getMQTTStatus());
+
+    wifiUp = true;
+    TEST_ASSERT_EQUAL(6, runUntilReady(10)); // no backoff after a WiFi drop
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_stages_in_order);
+    RUN_TEST(test_lan_broker_by_address);
+    RUN_TEST(test_subscription_barrier);
+    RUN_TEST(test_suback_timeout_backs_off);
+    RUN_TEST(test_control_messages_are_routed);
+    RUN_TEST(test_outbox_delivers_after_connect);
+    RUN_TEST(test_lost_session_publishes_will_and_reconnects);
+    RUN_TEST(test_failover_to_cloud_uses_resolved_address);
+    RUN_TEST(test_dns_failure_backs_off);
+    RUN_TEST(test_bad_credentials_fail_connect);
+    RUN_TEST(test_switches_back_to_lan);
+    RUN_TEST(test_wifi_loss_resets);
+    return UNITY_END();
+}
@@ -0,0 +1,231 @@
+// ==================================================
+// File: test/test_reporter/test_main.cpp
+// ==================================================
+//
+// Reporter on the host: a simulated day of readings polled the way
+// mqttPublishJob() and firebaseSyncJob() poll it, counting what each sink
+// publishes - heartbeats only while nothing changes, one publish per real
+// change, rate-limited changes delivered late rather than lost.
+
+#include <unity.h>
+#include <stdio.h>
+#include "Reporter.cpp"
+#include "config.h"
+
+#define DAY_S 86400UL
+#define MQTT_HEARTBEATS_PER_DAY (DAY_S * 1000 / 300000)     // SENSOR_MQTT_POLICY
+#define FIREBASE_HEARTBEATS_PER_DAY (DAY_S * 1000 / 900000) // SENSOR_FIREBASE_POLICY
+
+typedef Temp (*Signal)(uint32_t s);
+
+struct DayCount
+{
+    uint32_t polls;
+    uint32_t published[REPORT_SINK_COUNT];
+    int32_t worstLag[REPORT_SINK_COUNT]; // centi-degrees behind the signal once the rate limit allowed a report
+};
+
+// What the publish jobs do for one channel: ask, send, mark
+static bool poll(ReportChannel channel, ReportSink sink, Temp value)
+{
+    if (!reportDue(channel, sink, value))
+        return false;
+    markReported(channel, sink, value);
+    return true;
+}
+
+// Both sinks poll every 5 s (MQTT_PUBLISH_INTERVAL, FIREBASE_SYNC_INTERVAL)
+static DayCount simulateDay(ReportChannel channel, Signal signal)
+{
+    static_assert(MQTT_PUBLISH_INTERVAL == FIREBASE_SYNC_INTERVAL, "one poll loop for both sinks");
+    static const unsigned long minInterval[REPORT_SINK_COUNT] = {5000, 60000};
+    static const int32_t deadband[REPORT_SINK_COUNT] = {10, 100};
+
+    DayCount day = {};
+    unsigned long start = millis();
+    unsigned long lastAt[REPORT_SINK_COUNT] = {};
+    for (uint32_t s = 0; s < DAY_S; s += MQTT_PUBLISH_INTERVAL / 1000)
+    {
+        nativeNowUs = (uint64_t)(start + s * 1000UL) * 1000;
+        Temp value = signal(s);
+        day.polls++;
+        for (uint8_t k = 0; k < REPORT_SINK_COUNT; k++)
+        {
+            ReportSink sink = (ReportSink)k;
+            if (poll(channel, sink, value))
+            {
+                day.published[k]++;
+                lastAt[k] = millis();
+            }
+            Temp shown = lastReported(channel, sink);
+            if (millis() - lastAt[k] >= minInterval[k] && value.isValid() && shown.isValid())
+            {
+                int32_t lag = value.absDiff(shown) - deadband[k];
+                if (lag > day.worstLag[k])
+                    day.worstLag[k] = lag;
+            }
+        }
+    }
+    nativeNowUs = (uint64_t)(start + DAY_S * 1000UL) * 1000;
+    return day;
+}
+
+static void printDay(const char *name, const DayCount &day)
+{
+    char line[128];
+    snprintf(line, sizeof(line), "%-16s %5u polls -> MQTT %4u, Firebase %3u publishes", name, (unsigned)day.polls,
+             (unsigned)day.published[REPORT_SINK_MQTT], (unsigned)day.published[REPORT_SINK_FIREBASE]);
+    TEST_MESSAGE(line);
+}
+
+// === Signals (s = seconds since the start of the day) ===
+
+static Temp steady(uint32_t)
+{
+    return Temp::fromCenti(2100);
+}
+
+// A reading on the edge between two DS18B20 steps (0.0625 °C)
+static Temp flicker(uint32_t s)
+{
+    return Temp::fromCenti((s / 5) % 2 ? 2106 : 2100);
+}
+
+// Window opened at 06:00:50 - off the heartbeat grid
+static Temp oneStep(uint32_t s)
+{
+    return Temp::fromCenti(s < 21650 ? 2000 : 2300);
+}
+
+// Heater cycling 20-22 °C at 1/16 °C resolution
+static Temp heaterCycle(uint32_t s)
+{
+    uint32_t phase = s % 5400; // 30 min warm-up, 60 min cool-down
+    int32_t centi = phase < 1800 ? 2000 + (int32_t)(phase * 200 / 1800) : 2200 - (int32_t)((phase - 1800) * 200 / 3600);
+    return Temp::fromCenti((centi * 16 + 50) / 100 * 100 / 16);
+}
+
+// Sensor unplugged from 10:00:20 to 10:10:20
+static Temp dropout(uint32_t s)
+{
+    return s >= 36020 && s < 36620 ? Temp::invalid() : Temp::fromCenti(2100);
+}
+
+void setUp(void)
+{
+    memset(states, 0, sizeof(states));
+}
+
+void tearDown(void)
+{
+}
+
+// === Tests ===
+
+void test_steady_day_is_heartbeats_only(void)
+{
+    DayCount day = simulateDay(REPORT_TEMP_RED, steady);
+    printDay("steady", day);
+    TEST_ASSERT_EQUAL(MQTT_HEARTBEATS_PER_DAY, day.published[REPORT_SINK_MQTT]);
+    TEST_ASSERT_EQUAL(FIREBASE_HEARTBEATS_PER_DAY, day.published[REPORT_SINK_FIREBASE]);
+}
+
+void test_flicker_inside_deadband_is_not_published(void)
+{
+    DayCount day = simulateDay(REPORT_TEMP_RED, flicker);
+    printDay("flicker", day);
+    TEST_ASSERT_EQUAL(MQTT_HEARTBEATS_PER_DAY, day.published[REPORT_SINK_MQTT]);
+    TEST_ASSERT_EQUAL(FIREBASE_HEARTBEATS_PER_DAY, day.published[REPORT_SINK_FIREBASE]);
+}
+
+// One change costs one publish per sink; Firebase sends it when its
+// 60 s rate limit ends (06:01:00) and the heartbeat restarts from there
+void test_step_publishes_once_per_sink(void)
+{
+    DayCount day = simulateDay(REPORT_TEMP_RED, oneStep);
+    printDay("one step", day);
+    TEST_ASSERT_EQUAL(MQTT_HEARTBEATS_PER_DAY + 1, day.published[REPORT_SINK_MQTT]);
+    TEST_ASSERT_EQUAL(FIREBASE_HEARTBEATS_PER_DAY + 1, day.published[REPORT_SINK_FIREBASE]);
+    TEST_ASSERT_EQUAL(2300, lastReported(REPORT_TEMP_RED, REPORT_SINK_FIREBASE).centi);
+    TEST_ASSERT_EQUAL(0, day.worstLag[REPORT_SINK_MQTT]);
+    TEST_ASSERT_EQUAL(0, day.worstLag[REPORT_SINK_FIREBASE]);
+}
+
+// Moving all day: change-only publishing stays well under one per poll, and
+// whenever the rate limit allows a report the shown value is within the deadband
+void test_heater_cycles_track_within_deadband(void)
+{
+    DayCount day = simulateDay(REPORT_TEMP_RED, heaterCycle);
+    printDay("heater cycles", day);
+    TEST_ASSERT_EQUAL(0, day.worstLag[REPORT_SINK_MQTT]);
+    TEST_ASSERT_EQUAL(0, day.worstLag[REPORT_SINK_FIREBASE]);
+    TEST_ASSERT_TRUE(day.published[REPORT_SINK_MQTT] <= day.polls / 10);
+    TEST_ASSERT_TRUE(day.published[REPORT_SINK_FIREBASE] <= day.polls / 60);
+    TEST_ASSERT_TRUE(day.published[REPORT_SINK_MQTT] > MQTT_HEARTBEATS_PER_DAY);
+}
+
+// Going invalid and coming back are both changes, each sent as soon as the
+// sink's rate limit allows
+void test_dropout_is_reported_both_ways(void)
+{
+    DayCount day = simulateDay(REPORT_TEMP_RED, dropout);
+    printDay("dropout", day);
+    TEST_ASSERT_TRUE(day.published[REPORT_SINK_MQTT] > MQTT_HEARTBEATS_PER_DAY);
+    TEST_ASSERT_TRUE(day.published[REPORT_SINK_FIREBASE] > FIREBASE_HEARTBEATS_PER_DAY);
+
+    Temp good = Temp::fromCenti(2100);
+    TEST_ASSERT_TRUE(poll(REPORT_TEMP_GREEN, REPORT_SINK_MQTT, good));
+    TEST_ASSERT_TRUE(poll(REPORT_TEMP_GREEN, REPORT_SINK_FIREBASE, good));
+    nativeAdvanceMs(5000);
+    TEST_ASSERT_TRUE(poll(REPORT_TEMP_GREEN, REPORT_SINK_MQTT, Temp::invalid()));
+    TEST_ASSERT_FALSE(poll(REPORT_TEMP_GREEN, REPORT_SINK_FIREBASE, Temp::invalid()));
+    nativeAdvanceMs(55000);
+    TEST_ASSERT_TRUE(poll(REPORT_TEMP_GREEN, REPORT_SINK_FIREBASE, Temp::invalid()));
+    TEST_ASSERT_FALSE(lastReported(REPORT_TEMP_GREEN, REPORT_SINK_FIREBASE).isValid());
+    nativeAdvanceMs(60000);
+    TEST_ASSERT_TRUE(poll(REPORT_TEMP_GREEN, REPORT_SINK_MQTT, good));
+    TEST_ASSERT_TRUE(poll(REPORT_TEMP_GREEN, REPORT_SINK_FIREBASE, good));
+}
+
+// A sink that was offline is due the moment it polls again, whatever the other did
+void test_sinks_are_independent(void)
+{
+    Temp v = Temp::fromCenti(2100);
+    TEST_ASSERT_TRUE(poll(REPORT_TEMP_BLUE, REPORT_SINK_MQTT, v));
+    TEST_ASSERT_TRUE(poll(REPORT_TEMP_BLUE, REPORT_SINK_FIREBASE, v));
+
+    Temp warmer = Temp::fromCenti(2400);
+    uint32_t mqtt = 0;
+    for (int i = 0; i < 720; i++) // an hour with Firebase offline
+    {
+        nativeAdvanceMs(5000);
+        mqtt += poll(REPORT_TEMP_BLUE, REPORT_SINK_MQTT, warmer);
+    }
+    TEST_ASSERT_EQUAL(1 + 11, mqtt); // the change, then a heartbeat every 5 min
+    TEST_ASSERT_EQUAL(2100, lastReported(REPORT_TEMP_BLUE, REPORT_SINK_FIREBASE).centi);
+    TEST_ASSERT_TRUE(poll(REPORT_TEMP_BLUE, REPORT_SINK_FIREBASE, warmer));
+    TEST_ASSERT_FALSE(poll(REPORT_TEMP_BLUE, REPORT_SINK_FIREBASE, warmer));
+}
+
+// The target has no rate limit: a schedule switch goes out on the next poll
+void test_target_change_is_not_delayed(void)
+{
+    TEST_ASSERT_TRUE(poll(REPORT_TARGET_TEMP, REPORT_SINK_FIREBASE, Temp::fromCenti(1950)));
+    nativeAdvanceMs(5000);
+    TEST_ASSERT_FALSE(poll(REPORT_TARGET_TEMP, REPORT_SINK_FIREBASE, Temp::fromCenti(1950)));
+    TEST_ASSERT_TRUE(poll(REPORT_TARGET_TEMP, REPORT_SINK_FIREBASE, Temp::fromCenti(2200)));
+    TEST_ASSERT_EQUAL(2200, lastReported(REPORT_TARGET_TEMP, REPORT_SINK_FIREBASE).centi);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_steady_day_is_heartbeats_only);
+    RUN_TEST(test_flicker_inside_deadband_is_not_published);
+    RUN_TEST(test_step_publishes_once_per_sink);
+    RUN_TEST(test_heater_cycles_track_within_deadband);
+    RUN_TEST(test_dropout_is_reported_both_ways);
+    RUN_TEST(test_sinks_are_independent);
+    RUN_TEST(test_target_change_is_not_delayed);
+    return UNITY_END();
+}
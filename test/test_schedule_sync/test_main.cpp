@@ -0,0 +1,284 @@
+// ==================================================
+// File: test/test_schedule_sync/test_main.cpp
+// ==================================================
+//
+// ScheduleSync against an in-memory Realtime Database (test/native), with
+// the NVS cache in between so reboots can be simulated: echoes, app edits,
+// older writes, duplicates, and app edits made while the device was off.
+
+#include <unity.h>
+#include "GetShedual.cpp"
+#include "ScheduleCache.cpp"
+#include "ScheduleSync.cpp"
+
+// === Collaborators ===
+
+FirebaseData fbData;
+bool AmFlag = true;
+static uint32_t epochNow = 0;
+
+uint32_t getEpochTime()
+{
+    return epochNow;
+}
+
+void refreshScheduleCache()
+{
+}
+
+bool acquireTls(NetClientId)
+{
+    return true;
+}
+
+void releaseTls(NetClientId)
+{
+}
+
+// As in FirebaseService.cpp
+void addFirebaseUpdate(String &body, const String &path, const String &value)
+{
+    body += body.length() ? ",\"" : "\"";
+    body += path;
+    body += "\":";
+    body += value;
+}
+
+bool sendFirebaseUpdate(const char *node, const String &body)
+{
+    FirebaseJson json;
+    json.setJsonData("{" + body + "}");
+    return Firebase.RTDB.updateNodeSilent(&fbData, node, &json);
+}
+
+// === Helpers ===
+
+#define APP_EPOCH 1717236000UL // 2024-06-01 10:00 UTC
+
+static std::string &cloud(const char *path)
+{
+    return Firebase.RTDB.db[std::string("/schedule/") + path];
+}
+
+static void clearSchedule()
+{
+    currentSchedule = {Temp::invalid(), Temp::invalid(), "", "", false, false};
+}
+
+// RAM is lost, NVS and Firebase are not; the clock is not set yet
+static void reboot()
+{
+    memset(fields, 0, sizeof(fields));
+    clockRev = 0;
+    dirty = false;
+    pulled = false;
+    savedCrc = 0;
+    epochNow = 0;
+    clearSchedule();
+    initScheduleCache();
+}
+
+static void setAll(const char *am, const char *pm)
+{
+    setScheduleField(SCHED_AM_TEMP, am, SCHED_SOURCE_MQTT);
+    setScheduleField(SCHED_PM_TEMP, pm, SCHED_SOURCE_MQTT);
+    setScheduleField(SCHED_AM_TIME, "06:30", SCHED_SOURCE_MQTT);
+    setScheduleField(SCHED_PM_TIME, "17:00", SCHED_SOURCE_MQTT);
+    setScheduleField(SCHED_AM_ENABLED, "true", SCHED_SOURCE_MQTT);
+    setScheduleField(SCHED_PM_ENABLED, "true", SCHED_SOURCE_MQTT);
+    commitScheduleChanges();
+}
+
+// A synced device: schedule set over MQTT, read and written back once
+static void syncedDevice()
+{
+    setAll("22.00", "19.50");
+    TEST_ASSERT_TRUE(pullScheduleFromFirebase());
+    pushScheduleToFirebase();
+    TEST_ASSERT_FALSE(schedulePushPending());
+}
+
+void setUp(void)
+{
+    nativeNvs().clear();
+    Firebase.RTDB.db.clear();
+    Firebase.RTDB.online = true;
+    Firebase.RTDB.updates = 0;
+    reboot();
+    epochNow = APP_EPOCH;
+    stats = {};
+}
+
+void tearDown(void)
+{
+}
+
+// === Tests ===
+
+void test_push_writes_value_and_revision(void)
+{
+    syncedDevice();
+    TEST_ASSERT_EQUAL(1, Firebase.RTDB.updates);
+    TEST_ASSERT_EQUAL_STRING("\"22.00\"", cloud("amTemperature").c_str());
+    TEST_ASSERT_EQUAL_STRING("\"true\"", cloud("pmEnabled").c_str());
+
+    char rev[21];
+    formatRev(getScheduleFieldSync(SCHED_AM_TEMP).rev, rev);
+    std::string quoted = std::string("\"") + rev + "\"";
+    TEST_ASSERT_EQUAL_STRING(quoted.c_str(), cloud("rev/amTemperature").c_str());
+    TEST_ASSERT_TRUE(getScheduleFieldSync(SCHED_AM_TEMP).rev >= (ScheduleRev)APP_EPOCH * 1000 << 16);
+}
+
+void test_echo_changes_nothing(void)
+{
+    syncedDevice();
+    uint32_t applied = stats.applied;
+    TEST_ASSERT_TRUE(pullScheduleFromFirebase());
+    pushScheduleToFirebase();
+    TEST_ASSERT_EQUAL(applied, stats.applied);
+    TEST_ASSERT_EQUAL(1, Firebase.RTDB.updates);
+}
+
+void test_duplicate_write_is_suppressed(void)
+{
+    syncedDevice();
+    ScheduleRev rev = getScheduleFieldSync(SCHED_AM_TEMP).rev;
+    TEST_ASSERT_FALSE(setScheduleField(SCHED_AM_TEMP, "22", SCHED_SOURCE_LAN));
+    TEST_ASSERT_EQUAL(1, stats.suppressed);
+    TEST_ASSERT_EQUAL(rev, getScheduleFieldSync(SCHED_AM_TEMP).rev);
+    TEST_ASSERT_FALSE(schedulePushPending());
+}
+
+void test_app_edit_is_adopted(void)
+{
+    syncedDevice();
+    cloud("amTemperature") = "\"18.00\""; // the app writes no revision
+    TEST_ASSERT_TRUE(pullScheduleFromFirebase());
+    TEST_ASSERT_EQUAL(1800, currentSchedule.amTemp.centi);
+
+    // Stamped above the old revision, and pushed so the revision follows
+    TEST_ASSERT_TRUE(schedulePushPending());
+    pushScheduleToFirebase();
+    TEST_ASSERT_EQUAL_STRING("\"18.00\"", cloud("amTemperature").c_str());
+    TEST_ASSERT_EQUAL(1800, currentSchedule.amTemp.centi);
+}
+
+// The review case: "18.00" sorts below the cached "22.00", so a tie-break
+// on the value alone pushed the cached value back over the user's edit
+void test_app_edit_while_offline_survives_reboot(void)
+{
+    syncedDevice();
+    reboot();
+    TEST_ASSERT_EQUAL(2200, currentSchedule.amTemp.centi);
+    TEST_ASSERT_TRUE(getScheduleFieldSync(SCHED_AM_TEMP).cloudKnown);
+
+    cloud("amTemperature") = "\"18.00\"";
+    TEST_ASSERT_TRUE(pullScheduleFromFirebase());
+    TEST_ASSERT_EQUAL(1800, currentSchedule.amTemp.centi);
+    TEST_ASSERT_EQUAL(0, stats.stale);
+    pushScheduleToFirebase();
+    TEST_ASSERT_EQUAL_STRING("\"18.00\"", cloud("amTemperature").c_str());
+
+    // And the adopted value is what the next boot starts with
+    reboot();
+    TEST_ASSERT_EQUAL(1800, currentSchedule.amTemp.centi);
+    TEST_ASSERT_TRUE(pullScheduleFromFirebase());
+    TEST_ASSERT_FALSE(schedulePushPending());
+}
+
+// Without a cached cloud state (first boot after an upgrade), a value that
+// differs under the local revision is still an outside edit
+void test_app_edit_without_cloud_state(void)
+{
+    syncedDevice();
+    for (int i = 0; i < SCHED_FIELD_COUNT; i++)
+        fields[i].cloudKnown = false;
+    cloud("amTemperature") = "\"18.00\"";
+    TEST_ASSERT_TRUE(pullScheduleFromFirebase());
+    TEST_ASSERT_EQUAL(1800, currentSchedule.amTemp.centi);
+    TEST_ASSERT_EQUAL(0, stats.stale);
+}
+
+void test_older_write_loses(void)
+{
+    syncedDevice();
+    char rev[21];
+    formatRev(getScheduleFieldSync(SCHED_AM_TEMP).rev - 1, rev);
+    epochNow += 60;
+    TEST_ASSERT_TRUE(setScheduleField(SCHED_AM_TEMP, "23.00", SCHED_SOURCE_MQTT));
+    commitScheduleChanges();
+
+    // A delayed write from another device, older than what Firebase held
+    cloud("amTemperature") = "\"24.00\"";
+    cloud("rev/amTemperature") = std::string("\"") + rev + "\"";
+    TEST_ASSERT_TRUE(pullScheduleFromFirebase());
+    TEST_ASSERT_EQUAL(2300, currentSchedule.amTemp.centi);
+    TEST_ASSERT_EQUAL(1, stats.stale);
+    pushScheduleToFirebase();
+    TEST_ASSERT_EQUAL_STRING("\"23.00\"", cloud("amTemperature").c_str());
+}
+
+void test_newer_write_wins(void)
+{
+    syncedDevice();
+    char rev[21];
+    formatRev(getScheduleFieldSync(SCHED_PM_TEMP).rev + 1, rev);
+    cloud("pmTemperature") = "\"17.00\"";
+    cloud("rev/pmTemperature") = std::string("\"") + rev + "\"";
+    TEST_ASSERT_TRUE(pullScheduleFromFirebase());
+    TEST_ASSERT_EQUAL(1700, currentSchedule.pmTemp.centi);
+    TEST_ASSERT_FALSE(schedulePushPending()); // Firebase already holds it
+}
+
+void test_local_write_offline_is_pushed_later(void)
+{
+    syncedDevice();
+    Firebase.RTDB.online = false;
+    epochNow += 60;
+    TEST_ASSERT_TRUE(setScheduleField(SCHED_PM_TIME, "18:15", SCHED_SOURCE_LAN));
+    commitScheduleChanges();
+    pushScheduleToFirebase();
+    TEST_ASSERT_TRUE(schedulePushPending());
+
+    reboot();
+    Firebase.RTDB.online = true;
+    TEST_ASSERT_EQUAL_STRING("18:15", currentSchedule.pmTime.c_str());
+    TEST_ASSERT_TRUE(pullScheduleFromFirebase());
+    pushScheduleToFirebase();
+    TEST_ASSERT_EQUAL_STRING("\"18:15\"", cloud("pmScheduledTime").c_str());
+    TEST_ASSERT_FALSE(schedulePushPending());
+}
+
+void test_invalid_cloud_value_is_rewritten(void)
+{
+    syncedDevice();
+    cloud("amScheduledTime") = "\"25:99\"";
+    TEST_ASSERT_TRUE(pullScheduleFromFirebase());
+    TEST_ASSERT_EQUAL_STRING("06:30", currentSchedule.amTime.c_str());
+    pushScheduleToFirebase();
+    TEST_ASSERT_EQUAL_STRING("\"06:30\"", cloud("amScheduledTime").c_str());
+}
+
+void test_no_push_before_first_read(void)
+{
+    setAll("22.00", "19.50");
+    pushScheduleToFirebase();
+    TEST_ASSERT_EQUAL(0, Firebase.RTDB.updates);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_push_writes_value_and_revision);
+    RUN_TEST(test_echo_changes_nothing);
+    RUN_TEST(test_duplicate_write_is_suppressed);
+    RUN_TEST(test_app_edit_is_adopted);
+    RUN_TEST(test_app_edit_while_offline_survives_reboot);
+    RUN_TEST(test_app_edit_without_cloud_state);
+    RUN_TEST(test_older_write_loses);
+    RUN_TEST(test_newer_write_wins);
+    RUN_TEST(test_local_write_offline_is_pushed_later);
+    RUN_TEST(test_invalid_cloud_value_is_rewritten);
+    RUN_TEST(test_no_push_before_first_read);
+    return UNITY_END();
+}
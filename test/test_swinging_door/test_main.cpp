@@ -0,0 +1,270 @@
+// ==================================================
+// File: test/test_swinging_door/test_main.cpp
+// ==================================================
+//
+// SwingingDoor on the host, fed a simulated day of 1 Hz readings per trace
+// (the heater job's rate): the piecewise-linear curve through the archived
+// points must stay within deviation + 0.01 °C of every sample, and the
+// compression ratio and per-sample CPU time are reported as a benchmark.
+//
+//   pio test -e native -f test_swinging_door -v   # shows the INFO lines
+
+#include <unity.h>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include "History.h" // the deviation and max gap History uses
+
+#define DAY_S 86400
+#define T0 1717200000U
+#define ERROR_SLACK_CENTI 1 // archived points are rounded to 0.01 °C
+
+struct Sample
+{
+    uint32_t t;
+    Temp value;
+};
+
+// === Traces ===
+
+static uint32_t rng = 1;
+
+static uint32_t nextRandom()
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// DS18B20 at 12 bits: readings come in 1/16 °C steps
+static Temp sensor(float celsius)
+{
+    return Temp::fromCenti((int32_t)lroundf(roundf(celsius * 16.0f) / 16.0f * 100.0f));
+}
+
+// Room temperature following the sun, plus a little sensor noise
+static std::vector<Sample> dailySine()
+{
+    std::vector<Sample> s;
+    for (uint32_t i = 0; i < DAY_S; i++)
+    {
+        float noise = ((int32_t)(nextRandom() % 5) - 2) * 0.01f;
+        s.push_back({T0 + i, sensor(19.0f + 2.5f * sinf(i * 2.0f * (float)M_PI / DAY_S) + noise)});
+    }
+    return s;
+}
+
+// Heater cycling between thresholds: exponential warm-up and cool-down
+static std::vector<Sample> heaterCycles()
+{
+    std::vector<Sample> s;
+    float temp = 18.0f;
+    bool on = true;
+    for (uint32_t i = 0; i < DAY_S; i++)
+    {
+        temp += on ? (35.0f - temp) / 3600.0f : (12.0f - temp) / 7200.0f;
+        if (on && temp >= 22.0f)
+            on = false;
+        else if (!on && temp <= 20.0f)
+            on = true;
+        s.push_back({T0 + i, sensor(temp)});
+    }
+    return s;
+}
+
+// A reading sitting on the edge between two sensor steps
+static std::vector<Sample> flickering()
+{
+    std::vector<Sample> s;
+    for (uint32_t i = 0; i < DAY_S; i++)
+        s.push_back({T0 + i, Temp::fromCenti(nextRandom() % 2 ? 2100 : 2106)});
+    return s;
+}
+
+// Worst case: large random jumps every sample
+static std::vector<Sample> randomWalk()
+{
+    std::vector<Sample> s;
+    int32_t v = 2000;
+    for (uint32_t i = 0; i < DAY_S; i++)
+    {
+        v += (int32_t)(nextRandom() % 61) - 30;
+        s.push_back({T0 + i, Temp::fromCenti(v)});
+    }
+    return s;
+}
+
+// Steps (a window opened) and a sensor dropping out for a few minutes
+static std::vector<Sample> stepsAndGaps()
+{
+    std::vector<Sample> s;
+    for (uint32_t i = 0; i < DAY_S; i++)
+    {
+        if (i % 14400 >= 7000 && i % 14400 < 7300)
+            s.push_back({T0 + i, Temp::invalid()});
+        else
+            s.push_back({T0 + i, sensor((i / 3600) % 2 ? 17.5f : 21.0f)});
+    }
+    return s;
+}
+
+// === Harness ===
+
+struct Result
+{
+    std::vector<SdtPoint> points;
+    double nsPerSample;
+};
+
+static Result compress(const std::vector<Sample> &samples, int32_t deviation, uint32_t maxGapS)
+{
+    Result r;
+    SwingingDoor door = {deviation, maxGapS};
+    door.reset();
+    r.points.reserve(samples.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for (const Sample &s : samples)
+    {
+        SdtPoint out[2];
+        uint8_t n = door.add(s.t, s.value, out);
+        for (uint8_t k = 0; k < n; k++)
+            r.points.push_back(out[k]);
+    }
+    SdtPoint last[1];
+    if (door.flush(last))
+        r.points.push_back(last[0]);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    r.nsPerSample = std::chrono::duration<double, std::nano>(elapsed).count() / samples.size();
+    return r;
+}
+
+// Largest distance between a valid sample and the line through the archived
+// points around it; fails if a valid sample has no segment covering it
+static int32_t worstError(const std::vector<Sample> &samples, const std::vector<SdtPoint> &points)
+{
+    int32_t worst = 0;
+    size_t seg = 0;
+    for (const Sample &s : samples)
+    {
+        if (!s.value.isValid())
+            continue;
+        while (seg + 1 < points.size() && points[seg + 1].t <= s.t)
+            seg++;
+
+        const SdtPoint &a = points[seg];
+        int64_t expected;
+        if (a.t == s.t && a.value.isValid())
+        {
+            expected = a.value.centi;
+        }
+        else
+        {
+            TEST_ASSERT_TRUE_MESSAGE(seg + 1 < points.size(), "sample after the last archived point");
+            const SdtPoint &b = points[seg + 1];
+            TEST_ASSERT_TRUE_MESSAGE(a.value.isValid() && b.value.isValid() && a.t <= s.t && s.t <= b.t,
+                                     "valid sample outside every segment");
+            int64_t num = (int64_t)(b.value.centi - a.value.centi) * (s.t - a.t);
+            int64_t den = b.t - a.t;
+            expected = a.value.centi + (num >= 0 ? num + den / 2 : num - den / 2) / den;
+        }
+        int32_t error = (int32_t)llabs(expected - s.value.centi);
+        if (error > worst)
+            worst = error;
+    }
+    return worst;
+}
+
+static double runTrace(const char *name, const std::vector<Sample> &samples, int32_t deviation)
+{
+    Result r = compress(samples, deviation, HISTORY_MAX_GAP_S);
+    int32_t worst = worstError(samples, r.points);
+
+    char line[160];
+    double ratio = (double)samples.size() / r.points.size();
+    snprintf(line, sizeof(line), "%-14s dev %2d: %6u samples -> %5u points (%6.1fx), worst error %2d, %5.0f ns/sample",
+             name, (int)deviation, (unsigned)samples.size(), (unsigned)r.points.size(), ratio, (int)worst,
+             r.nsPerSample);
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_TRUE_MESSAGE(worst <= deviation + ERROR_SLACK_CENTI, "reconstruction error above deviation + 0.01");
+    return ratio;
+}
+
+void setUp(void)
+{
+    rng = 1;
+}
+
+void tearDown(void)
+{
+}
+
+// === Tests ===
+
+void test_daily_sine(void)
+{
+    std::vector<Sample> s = dailySine();
+    TEST_ASSERT_TRUE(runTrace("daily sine", s, HISTORY_DEVIATION_CENTI) >= 100.0);
+    runTrace("daily sine", s, 5);
+    runTrace("daily sine", s, 25);
+}
+
+void test_heater_cycles(void)
+{
+    std::vector<Sample> s = heaterCycles();
+    TEST_ASSERT_TRUE(runTrace("heater cycles", s, HISTORY_DEVIATION_CENTI) >= 50.0);
+    runTrace("heater cycles", s, 5);
+    runTrace("heater cycles", s, 25);
+}
+
+// Flicker inside the deviation costs nothing beyond the max-gap points
+void test_flickering_reading(void)
+{
+    std::vector<Sample> s = flickering();
+    TEST_ASSERT_TRUE(runTrace("flickering", s, HISTORY_DEVIATION_CENTI) >= (double)HISTORY_MAX_GAP_S / 2);
+}
+
+// Nothing to gain, but the bound must still hold
+void test_random_walk(void)
+{
+    std::vector<Sample> s = randomWalk();
+    runTrace("random walk", s, HISTORY_DEVIATION_CENTI);
+    runTrace("random walk", s, 100);
+}
+
+void test_steps_and_gaps(void)
+{
+    std::vector<Sample> s = stepsAndGaps();
+    runTrace("steps, gaps", s, HISTORY_DEVIATION_CENTI);
+
+    // Every dropout is marked
+    Result r = compress(s, HISTORY_DEVIATION_CENTI, HISTORY_MAX_GAP_S);
+    uint32_t gaps = 0;
+    for (const SdtPoint &p : r.points)
+        gaps += !p.value.isValid();
+    TEST_ASSERT_EQUAL(6, gaps);
+}
+
+// Extreme slopes and values must not overflow the 64-bit cross products
+void test_extreme_values(void)
+{
+    std::vector<Sample> s;
+    for (uint32_t i = 0; i < 2000; i++)
+        s.push_back({T0 + i * 1800, Temp::fromCenti(i % 2 ? INT16_MAX : Temp::INVALID_RAW + 1)});
+    runTrace("extremes", s, HISTORY_DEVIATION_CENTI);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_daily_sine);
+    RUN_TEST(test_heater_cycles);
+    RUN_TEST(test_flickering_reading);
+    RUN_TEST(test_random_walk);
+    RUN_TEST(test_steps_and_gaps);
+    RUN_TEST(test_extreme_values);
+    return UNITY_END();
+}
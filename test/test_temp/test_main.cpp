@@ -0,0 +1,146 @@
+// ==================================================
+// File: test/test_temp/test_main.cpp
+// ==================================================
+//
+// Temp on the host: strict parsing (no truncated third decimal, no bare
+// trailing '.'), the conversions from float and DallasTemperature raw
+// readings, rounding and formatting.
+
+#include <unity.h>
+#include "Temp.h"
+
+static void assertParses(int32_t centi, const char *s)
+{
+    Temp t = Temp::parse(s);
+    TEST_ASSERT_TRUE_MESSAGE(t.isValid(), s);
+    TEST_ASSERT_EQUAL_MESSAGE(centi, t.centi, s);
+}
+
+static void assertRejected(const char *s)
+{
+    TEST_ASSERT_FALSE_MESSAGE(Temp::parse(s).isValid(), s);
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// === Tests ===
+
+void test_parse_accepts(void)
+{
+    assertParses(2100, "21");
+    assertParses(2150, "21.5");
+    assertParses(2155, "21.55");
+    assertParses(2105, "21.05");
+    assertParses(-325, "-3.25");
+    assertParses(1800, "+18");
+    assertParses(0, "0.00");
+    assertParses(2200, "  22.00\r\n");
+    assertParses(32767, "327.67");
+    assertParses(-32767, "-327.67");
+}
+
+// The review case: "21.555" used to become 21.55 and "21." 21.00
+void test_parse_rejects(void)
+{
+    assertRejected("21.555");
+    assertRejected("21.550");
+    assertRejected("21.");
+    assertRejected("-3.");
+    assertRejected(".5");
+    assertRejected("");
+    assertRejected("-");
+    assertRejected("abc");
+    assertRejected("21x");
+    assertRejected("21.5 C");
+    assertRejected("21,5");
+    assertRejected("2 1");
+    assertRejected("327.68");
+    assertRejected("328");
+    assertRejected("-327.68"); // the "no reading" raw value
+    assertRejected("99999999999");
+    TEST_ASSERT_FALSE(Temp::parse((const char *)nullptr).isValid());
+}
+
+void test_parse_string(void)
+{
+    TEST_ASSERT_EQUAL(1950, Temp::parse(String("19.5")).centi);
+    TEST_ASSERT_FALSE(Temp::parse(String("19.")).isValid());
+}
+
+void test_from_celsius(void)
+{
+    TEST_ASSERT_EQUAL(2156, Temp::fromCelsius(21.556f).centi);
+    TEST_ASSERT_EQUAL(-1, Temp::fromCelsius(-0.006f).centi);
+    TEST_ASSERT_FALSE(Temp::fromCelsius(NAN).isValid());
+    TEST_ASSERT_FALSE(Temp::fromCelsius(400.0f).isValid());
+}
+
+// 1/128 °C steps, rounded half away from zero
+void test_from_dallas_raw(void)
+{
+    TEST_ASSERT_EQUAL(2100, Temp::fromDallasRaw(21 * 128).centi);
+    TEST_ASSERT_EQUAL(6, Temp::fromDallasRaw(8).centi);    // 0.0625
+    TEST_ASSERT_EQUAL(-6, Temp::fromDallasRaw(-8).centi);
+    TEST_ASSERT_EQUAL(1, Temp::fromDallasRaw(1).centi);    // 0.78
+    TEST_ASSERT_EQUAL(-5500, Temp::fromDallasRaw(-55 * 128).centi);
+}
+
+void test_rounding(void)
+{
+    TEST_ASSERT_EQUAL(216, Temp::fromCenti(2155).tenths());
+    TEST_ASSERT_EQUAL(-216, Temp::fromCenti(-2155).tenths());
+    TEST_ASSERT_EQUAL(22, Temp::fromCenti(2150).wholeDegrees());
+    TEST_ASSERT_EQUAL(21, Temp::fromCenti(2149).wholeDegrees());
+    TEST_ASSERT_EQUAL(-22, Temp::fromCenti(-2150).wholeDegrees());
+}
+
+void test_format(void)
+{
+    char buf[12];
+    Temp::fromCenti(2155).format(buf, sizeof(buf), 2);
+    TEST_ASSERT_EQUAL_STRING("21.55", buf);
+    Temp::fromCenti(2155).format(buf, sizeof(buf), 1);
+    TEST_ASSERT_EQUAL_STRING("21.6", buf);
+    Temp::fromCenti(-5).format(buf, sizeof(buf), 2);
+    TEST_ASSERT_EQUAL_STRING("-0.05", buf);
+    Temp::fromCenti(2150).format(buf, sizeof(buf), 0);
+    TEST_ASSERT_EQUAL_STRING("22", buf);
+    Temp::invalid().format(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("ERROR", buf);
+
+    // What parse() accepts, format() writes back unchanged at two decimals
+    Temp::parse("-3.25").format(buf, sizeof(buf), 2);
+    TEST_ASSERT_EQUAL_STRING("-3.25", buf);
+}
+
+void test_changed_from(void)
+{
+    Temp a = Temp::fromCenti(2100);
+    TEST_ASSERT_FALSE(Temp::fromCenti(2110).changedFrom(a, 10));
+    TEST_ASSERT_TRUE(Temp::fromCenti(2111).changedFrom(a, 10));
+    TEST_ASSERT_TRUE(Temp::invalid().changedFrom(a, 10));
+    TEST_ASSERT_TRUE(a.changedFrom(Temp::invalid(), 10));
+    TEST_ASSERT_FALSE(Temp::invalid().changedFrom(Temp::invalid(), 10));
+    TEST_ASSERT_FALSE(Temp::invalid() < a);
+    TEST_ASSERT_FALSE(Temp::invalid() > a);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_accepts);
+    RUN_TEST(test_parse_rejects);
+    RUN_TEST(test_parse_string);
+    RUN_TEST(test_from_celsius);
+    RUN_TEST(test_from_dallas_raw);
+    RUN_TEST(test_rounding);
+    RUN_TEST(test_format);
+    RUN_TEST(test_changed_from);
+    return UNITY_END();
+}
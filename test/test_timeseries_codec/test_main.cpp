@@ -0,0 +1,331 @@
+// ==================================================
+// File: test/test_timeseries_codec/test_main.cpp
+// ==================================================
+//
+// TimeSeriesCodec on the host: round trips (including every bucket edge and
+// full blocks), appending after resume() the way flash is appended in
+// place, and decoding corrupt or torn blocks.
+
+#include <unity.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "TimeSeriesCodec.cpp"
+
+#define T0 1717236000UL // 2024-06-01 10:00 UTC
+#define MISSING INT16_MIN // Temp::INVALID_RAW
+
+static uint8_t block[TS_BLOCK_SIZE];
+
+void setUp(void)
+{
+    srand(1);
+}
+
+void tearDown(void)
+{
+}
+
+// A day-like trace: 60 s samples with jitter and gaps, drifting
+// temperatures, a sensor dropping out, heater cycles
+static std::vector<TsRecord> trace(size_t n, uint32_t start = T0)
+{
+    std::vector<TsRecord> out;
+    TsRecord r = {start, {2150, 2230, 1980, 0, 0}};
+    for (size_t i = 0; i < n; i++)
+    {
+        r.t += i % 97 == 96 ? 3600 : 60 + rand() % 3 - 1;
+        for (int f = 0; f < 3; f++)
+            r.values[f] += rand() % 5 - 2;
+        r.values[TS_FIELD_TEMP_GREEN] = i % 50 < 5 ? MISSING : 1980 + (int32_t)(i % 7);
+        r.values[TS_FIELD_HEATER] = (i / 20) % 2;
+        r.values[TS_FIELD_CURRENT] = r.values[TS_FIELD_HEATER] ? 850 + rand() % 20 : 0;
+        out.push_back(r);
+    }
+    return out;
+}
+
+static void assertRecordEqual(const TsRecord &expected, const TsRecord &actual)
+{
+    TEST_ASSERT_EQUAL_UINT32(expected.t, actual.t);
+    for (int f = 0; f < TS_FIELD_COUNT; f++)
+        TEST_ASSERT_EQUAL_INT32(expected.values[f], actual.values[f]);
+}
+
+// Appends until the block is full; how many fit
+static size_t encode(const std::vector<TsRecord> &records, uint32_t seq = 1)
+{
+    TsBlockEncoder enc;
+    enc.begin(block, seq, records[0].t);
+    size_t n = 0;
+    while (n < records.size() && enc.append(records[n]))
+        n++;
+    TEST_ASSERT_EQUAL(n, enc.count);
+    TEST_ASSERT_TRUE(enc.usedBytes() <= TS_BLOCK_SIZE);
+    return n;
+}
+
+static size_t decodeAll(const uint8_t *buf, std::vector<TsRecord> &out)
+{
+    TsBlockDecoder dec;
+    out.clear();
+    if (!dec.begin(buf))
+        return 0;
+    TsRecord r;
+    while (dec.next(r))
+        out.push_back(r);
+    TEST_ASSERT_TRUE(dec.bitPos <= TS_BLOCK_SIZE * 8);
+    return out.size();
+}
+
+// === Round trip ===
+
+void test_round_trip(void)
+{
+    std::vector<TsRecord> in = trace(200), out;
+    TEST_ASSERT_EQUAL(200, encode(in));
+    TEST_ASSERT_EQUAL(200, decodeAll(block, out));
+    for (size_t i = 0; i < in.size(); i++)
+        assertRecordEqual(in[i], out[i]);
+
+    TsBlockHeader header;
+    TEST_ASSERT_TRUE(tsReadHeader(block, header));
+    TEST_ASSERT_EQUAL_UINT32(1, header.seq);
+    TEST_ASSERT_EQUAL_UINT32(in[0].t, header.baseT);
+}
+
+// Regular samples of unchanged values cost a bit each
+void test_steady_samples_are_small(void)
+{
+    TsBlockEncoder enc;
+    enc.begin(block, 1, T0);
+    TsRecord r = {T0, {2150, 2230, 1980, 0, 0}};
+    TEST_ASSERT_TRUE(enc.append(r));
+    uint32_t first = enc.bitPos;
+    for (int i = 1; i <= 100; i++)
+    {
+        r.t = T0 + 60 * i;
+        TEST_ASSERT_TRUE(enc.append(r));
+    }
+    // The second record pays for the first delta, the rest are 1+1+5 bits
+    TEST_ASSERT_TRUE(enc.bitPos - first <= 99 * 7 + 64);
+}
+
+// Deltas on both sides of every bucket width, and the 32-bit extremes
+void test_bucket_edges(void)
+{
+    const int32_t diffs[] = {0,     1,     -1,     31,         32,        -32,       -33,
+                             2047,  2048,  -2048,  -2049,      524287,    524288,    -524288,
+                             -524289, INT32_MAX, INT32_MIN, 1, -1};
+    std::vector<TsRecord> in;
+    TsRecord r = {T0, {0, 0, 0, 0, 0}};
+    uint32_t step = 0;
+    for (int32_t d : diffs)
+    {
+        step = step * 2 + 1; // delta-of-delta grows through the time buckets
+        r.t += step % 1000000;
+        for (int f = 0; f < TS_FIELD_COUNT; f++)
+            r.values[f] = (int32_t)((uint32_t)r.values[f] + (f % 2 ? 0U - (uint32_t)d : (uint32_t)d));
+        in.push_back(r);
+    }
+    in.push_back(r); // a repeated timestamp
+    r.t = UINT32_MAX; // and the end of time
+    in.push_back(r);
+
+    std::vector<TsRecord> out;
+    TEST_ASSERT_EQUAL(in.size(), encode(in));
+    TEST_ASSERT_EQUAL(in.size(), decodeAll(block, out));
+    for (size_t i = 0; i < in.size(); i++)
+        assertRecordEqual(in[i], out[i]);
+}
+
+void test_full_block(void)
+{
+    std::vector<TsRecord> in = trace(5000), out;
+    size_t n = encode(in);
+    TEST_ASSERT_TRUE(n > 500 && n < in.size());
+    TEST_ASSERT_EQUAL(n, decodeAll(block, out));
+    assertRecordEqual(in[n - 1], out.back());
+}
+
+// === Resume ===
+
+// Flash can only clear bits: appending may rewrite the last partial byte
+// but must never set a bit that is already programmed
+static void assertOnlyClears(const uint8_t *before, const uint8_t *after)
+{
+    for (size_t i = 0; i < TS_BLOCK_SIZE; i++)
+    {
+        if ((after[i] & ~before[i]) != 0)
+            TEST_FAIL_MESSAGE("append set a programmed bit");
+    }
+}
+
+void test_append_after_resume(void)
+{
+    std::vector<TsRecord> in = trace(300), out;
+    std::vector<TsRecord> first(in.begin(), in.begin() + 120);
+    TEST_ASSERT_EQUAL(120, encode(first));
+
+    // A reboot: only the flash image is left
+    static uint8_t flash[TS_BLOCK_SIZE];
+    memcpy(flash, block, sizeof(flash));
+    TsBlockEncoder enc;
+    TEST_ASSERT_TRUE(enc.resume(block));
+    TEST_ASSERT_EQUAL(120, enc.count);
+    for (size_t i = 120; i < in.size(); i++)
+        TEST_ASSERT_TRUE(enc.append(in[i]));
+    assertOnlyClears(flash, block);
+
+    TEST_ASSERT_EQUAL(in.size(), decodeAll(block, out));
+    for (size_t i = 0; i < in.size(); i++)
+        assertRecordEqual(in[i], out[i]);
+}
+
+// Resuming after every single record gives the same bytes as one pass
+void test_resume_every_record_matches_one_pass(void)
+{
+    std::vector<TsRecord> in = trace(150);
+    encode(in);
+    static uint8_t reference[TS_BLOCK_SIZE];
+    memcpy(reference, block, sizeof(reference));
+
+    TsBlockEncoder enc;
+    enc.begin(block, 1, in[0].t);
+    for (const TsRecord &r : in)
+    {
+        TsBlockEncoder resumed;
+        TEST_ASSERT_TRUE(resumed.resume(block));
+        TEST_ASSERT_TRUE(resumed.append(r));
+    }
+    TEST_ASSERT_EQUAL_MEMORY(reference, block, TS_BLOCK_SIZE);
+}
+
+void test_resume_full_block_stays_full(void)
+{
+    std::vector<TsRecord> in = trace(5000);
+    size_t n = encode(in);
+    TsBlockEncoder enc;
+    TEST_ASSERT_TRUE(enc.resume(block));
+    TEST_ASSERT_EQUAL(n, enc.count);
+    TEST_ASSERT_FALSE(enc.append(in[n]));
+}
+
+void test_resume_needs_a_header(void)
+{
+    TsBlockEncoder enc;
+    memset(block, 0xFF, sizeof(block)); // erased sector
+    TEST_ASSERT_FALSE(enc.resume(block));
+}
+
+// === Corruption ===
+
+void test_corrupt_header_is_rejected(void)
+{
+    std::vector<TsRecord> in = trace(10), out;
+    encode(in, 7);
+    TsBlockDecoder dec;
+
+    block[0] ^= 0x01; // magic
+    TEST_ASSERT_FALSE(dec.begin(block));
+    block[0] ^= 0x01;
+    TEST_ASSERT_TRUE(dec.begin(block));
+
+    block[9] &= 0x7F; // baseT, as a torn header write would leave it
+    TEST_ASSERT_FALSE(dec.begin(block));
+    TEST_ASSERT_EQUAL(0, decodeAll(block, out));
+}
+
+// A record cut short by a power loss, with only its later bits programmed
+// (a page write does not land in order): the good records before it decode,
+// and resume() refuses to append after the stray bits
+void test_torn_record(void)
+{
+    std::vector<TsRecord> in = trace(40), out;
+    std::vector<TsRecord> first(in.begin(), in.begin() + 39);
+    encode(first);
+    static uint8_t before[TS_BLOCK_SIZE];
+    memcpy(before, block, sizeof(before));
+    TsBlockEncoder enc;
+    TEST_ASSERT_TRUE(enc.resume(block));
+    uint32_t start = enc.bitPos;
+    TEST_ASSERT_TRUE(enc.append(in[39]));
+    uint32_t end = enc.bitPos;
+
+    // Lose the marker and the first half of the record's bits
+    uint32_t lost = start + (end - start) / 2;
+    for (uint32_t bit = start; bit < lost; bit++)
+    {
+        uint8_t mask = 0x80 >> (bit & 7);
+        block[bit >> 3] = (block[bit >> 3] & ~mask) | (before[bit >> 3] & mask);
+    }
+
+    TEST_ASSERT_EQUAL(39, decodeAll(block, out));
+    for (size_t i = 0; i < 39; i++)
+        assertRecordEqual(in[i], out[i]);
+
+    TsBlockEncoder resumed;
+    TEST_ASSERT_TRUE(resumed.resume(block));
+    TEST_ASSERT_FALSE(resumed.append(in[39]));
+}
+
+// A record running past the end of the block is not returned, and the
+// decoder stays where it was
+void test_truncated_tail(void)
+{
+    TsBlockEncoder enc;
+    enc.begin(block, 1, T0);
+
+    // Program every bit after the header: each record claims 32-bit buckets
+    memset(block + TS_HEADER_SIZE, 0x00, TS_BLOCK_SIZE - TS_HEADER_SIZE);
+    TsBlockDecoder dec;
+    TEST_ASSERT_TRUE(dec.begin(block));
+    TsRecord r;
+    uint32_t n = 0, lastPos = dec.bitPos;
+    while (dec.next(r))
+    {
+        TEST_ASSERT_TRUE(dec.bitPos > lastPos);
+        lastPos = dec.bitPos;
+        n++;
+    }
+    TEST_ASSERT_EQUAL(lastPos, dec.bitPos);
+    TEST_ASSERT_TRUE(n < TS_BLOCK_SIZE * 8 / (1 + 6 * 36) + 1);
+}
+
+// Garbage after a valid header: decoding terminates inside the block
+void test_random_garbage(void)
+{
+    for (int round = 0; round < 200; round++)
+    {
+        TsBlockEncoder enc;
+        enc.begin(block, round, T0);
+        size_t len = rand() % (TS_BLOCK_SIZE - TS_HEADER_SIZE);
+        for (size_t i = 0; i < len; i++)
+            block[TS_HEADER_SIZE + i] = rand();
+        std::vector<TsRecord> out;
+        decodeAll(block, out);
+        TEST_ASSERT_TRUE(out.size() <= (TS_BLOCK_SIZE - TS_HEADER_SIZE) * 8 / 7);
+
+        TsBlockEncoder resumed;
+        TEST_ASSERT_TRUE(resumed.resume(block));
+        TEST_ASSERT_TRUE(resumed.bitPos <= TS_BLOCK_SIZE * 8);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_steady_samples_are_small);
+    RUN_TEST(test_bucket_edges);
+    RUN_TEST(test_full_block);
+    RUN_TEST(test_append_after_resume);
+    RUN_TEST(test_resume_every_record_matches_one_pass);
+    RUN_TEST(test_resume_full_block_stays_full);
+    RUN_TEST(test_resume_needs_a_header);
+    RUN_TEST(test_corrupt_header_is_rejected);
+    RUN_TEST(test_torn_record);
+    RUN_TEST(test_truncated_tail);
+    RUN_TEST(test_random_garbage);
+    return UNITY_END();
+}
@@ -0,0 +1,238 @@
+// ==================================================
+// File: test/test_timezone/test_main.cpp
+// ==================================================
+//
+// TimeZone on the host: calendar helpers, leap years, DST transitions, and
+// every zone checked against glibc's localtime_r() for the same TZ string.
+
+#include <unity.h>
+#include <stdlib.h>
+#include <time.h>
+#include "TimeZone.cpp"
+
+#define UK_TZ "GMT0BST,M3.5.0/1,M10.5.0"
+
+// 2024-03-31 01:00 UTC (BST starts) and 2024-10-27 01:00 UTC (BST ends)
+#define UK_2024_DST_START 1711846800UL
+#define UK_2024_DST_END 1729990800UL
+
+void setUp(void)
+{
+    setTimeZone(UK_TZ);
+}
+
+void tearDown(void)
+{
+}
+
+static int32_t offsetAt(uint32_t utc)
+{
+    return (int32_t)((int64_t)toLocalTime(utc) - utc);
+}
+
+// === Calendar ===
+
+void test_leap_years(void)
+{
+    TEST_ASSERT_TRUE(isLeapYear(2000));
+    TEST_ASSERT_TRUE(isLeapYear(2024));
+    TEST_ASSERT_FALSE(isLeapYear(1900));
+    TEST_ASSERT_FALSE(isLeapYear(2023));
+    TEST_ASSERT_FALSE(isLeapYear(2100));
+    TEST_ASSERT_EQUAL(29, daysInMonth(2024, 2));
+    TEST_ASSERT_EQUAL(28, daysInMonth(2023, 2));
+    TEST_ASSERT_EQUAL(28, daysInMonth(2100, 2));
+    TEST_ASSERT_EQUAL(29, daysInMonth(2000, 2));
+    TEST_ASSERT_EQUAL(31, daysInMonth(2023, 12));
+    TEST_ASSERT_EQUAL(30, daysInMonth(2023, 4));
+}
+
+void test_civil_dates(void)
+{
+    TEST_ASSERT_EQUAL(0, daysFromCivil(1970, 1, 1));
+    TEST_ASSERT_EQUAL(19782, daysFromCivil(2024, 2, 29));
+    TEST_ASSERT_EQUAL(19783, daysFromCivil(2024, 3, 1));
+
+    CivilTime c;
+    civilFromEpoch(1709208000UL, c); // 2024-02-29 12:00:00, a Thursday
+    TEST_ASSERT_EQUAL(2024, c.year);
+    TEST_ASSERT_EQUAL(2, c.month);
+    TEST_ASSERT_EQUAL(29, c.day);
+    TEST_ASSERT_EQUAL(12, c.hour);
+    TEST_ASSERT_EQUAL(4, c.weekday);
+
+    civilFromEpoch(UINT32_MAX, c); // 2106-02-07 06:28:15
+    TEST_ASSERT_EQUAL(2106, c.year);
+    TEST_ASSERT_EQUAL(2, c.month);
+    TEST_ASSERT_EQUAL(7, c.day);
+    TEST_ASSERT_EQUAL(6, c.hour);
+    TEST_ASSERT_EQUAL(28, c.minute);
+    TEST_ASSERT_EQUAL(15, c.second);
+}
+
+// Every day a uint32_t can hold, against gmtime_r()
+void test_civil_matches_gmtime(void)
+{
+    for (uint64_t t = 0; t <= UINT32_MAX; t += 86400 - 1)
+    {
+        CivilTime c;
+        civilFromEpoch((uint32_t)t, c);
+        time_t tt = (time_t)t;
+        struct tm tm;
+        gmtime_r(&tt, &tm);
+        TEST_ASSERT_EQUAL(tm.tm_year + 1900, c.year);
+        TEST_ASSERT_EQUAL(tm.tm_mon + 1, c.month);
+        TEST_ASSERT_EQUAL(tm.tm_mday, c.day);
+        TEST_ASSERT_EQUAL(tm.tm_hour, c.hour);
+        TEST_ASSERT_EQUAL(tm.tm_min, c.minute);
+        TEST_ASSERT_EQUAL(tm.tm_sec, c.second);
+        TEST_ASSERT_EQUAL(tm.tm_wday, c.weekday);
+        TEST_ASSERT_EQUAL((int32_t)(t / 86400), daysFromCivil(c.year, c.month, c.day));
+    }
+}
+
+// === Transitions ===
+
+void test_uk_transitions(void)
+{
+    TEST_ASSERT_EQUAL(0, offsetAt(UK_2024_DST_START - 1));
+    TEST_ASSERT_EQUAL(3600, offsetAt(UK_2024_DST_START));
+    TEST_ASSERT_EQUAL(3600, offsetAt(UK_2024_DST_END - 1));
+    TEST_ASSERT_EQUAL(0, offsetAt(UK_2024_DST_END));
+    TEST_ASSERT_FALSE(isDstAt(UK_2024_DST_START - 1));
+    TEST_ASSERT_TRUE(isDstAt(UK_2024_DST_START));
+    TEST_ASSERT_EQUAL_STRING("GMT", timeZoneName(UK_2024_DST_START - 1));
+    TEST_ASSERT_EQUAL_STRING("BST", timeZoneName(UK_2024_DST_START));
+    TEST_ASSERT_EQUAL(0, getStandardOffset());
+}
+
+void test_southern_hemisphere(void)
+{
+    TEST_ASSERT_TRUE(setTimeZone("AEST-10AEDT,M10.1.0,M4.1.0/3"));
+    TEST_ASSERT_EQUAL(11 * 3600, offsetAt(1704067200UL)); // 2024-01-01, summer
+    TEST_ASSERT_EQUAL(10 * 3600, offsetAt(1719792000UL)); // 2024-07-01, winter
+    TEST_ASSERT_EQUAL(10 * 3600, getStandardOffset());
+}
+
+void test_zone_change_recomputes_transitions(void)
+{
+    TEST_ASSERT_EQUAL(0, offsetAt(1710936000UL)); // 2024-03-20 12:00 UTC, GMT
+    TEST_ASSERT_TRUE(setTimeZone("EST5EDT,M3.2.0,M11.1.0"));
+    TEST_ASSERT_EQUAL(-14400, offsetAt(1710936000UL)); // EDT since March 10
+    TEST_ASSERT_TRUE(setTimeZone("CET-1"));
+    TEST_ASSERT_EQUAL(3600, offsetAt(1710936000UL));
+    TEST_ASSERT_TRUE(setTimeZone(UK_TZ));
+    TEST_ASSERT_EQUAL(0, offsetAt(1710936000UL));
+}
+
+void test_invalid_zone_falls_back_to_utc(void)
+{
+    TEST_ASSERT_FALSE(setTimeZone("EST5EDT,M3.2.0"));
+    TEST_ASSERT_EQUAL(0, offsetAt(1719792000UL));
+    TEST_ASSERT_FALSE(isDstAt(1719792000UL));
+    TEST_ASSERT_EQUAL_STRING("UTC", timeZoneName(1719792000UL));
+    TEST_ASSERT_FALSE(setTimeZone("X1"));
+    TEST_ASSERT_FALSE(setTimeZone("EST5EDT,M13.1.0,M11.1.0"));
+}
+
+// === Against glibc ===
+
+static int32_t glibcOffset(time_t t, bool &dst)
+{
+    struct tm tm;
+    localtime_r(&t, &tm);
+    dst = tm.tm_isdst > 0;
+    return (int32_t)tm.tm_gmtoff;
+}
+
+static void checkAgainstGlibc(const char *posixTz)
+{
+    TEST_ASSERT_TRUE_MESSAGE(setTimeZone(posixTz), posixTz);
+    setenv("TZ", posixTz, 1);
+    tzset();
+
+    // Every 3601 s from 1970 to 2106, and every transition to the second
+    const uint32_t step = 3601;
+    bool prevDst;
+    int32_t prev = glibcOffset(0, prevDst);
+    for (uint64_t t = 0; t <= UINT32_MAX; t += step)
+    {
+        bool dst;
+        int32_t expected = glibcOffset((time_t)t, dst);
+        TEST_ASSERT_EQUAL_INT32_MESSAGE(expected, offsetAt((uint32_t)t), posixTz);
+        TEST_ASSERT_EQUAL_MESSAGE(dst, isDstAt((uint32_t)t), posixTz);
+
+        if (expected != prev && t >= step)
+        {
+            // Bisect glibc's change to the second; ours must flip there too
+            uint64_t lo = t - step, hi = t;
+            while (hi - lo > 1)
+            {
+                uint64_t mid = (lo + hi) / 2;
+                (glibcOffset((time_t)mid, dst) == prev ? lo : hi) = mid;
+            }
+            TEST_ASSERT_EQUAL_INT32_MESSAGE(prev, offsetAt((uint32_t)lo), posixTz);
+            TEST_ASSERT_EQUAL_INT32_MESSAGE(expected, offsetAt((uint32_t)hi), posixTz);
+        }
+        prev = expected;
+    }
+}
+
+void test_matches_glibc_uk(void)
+{
+    checkAgainstGlibc(UK_TZ);
+}
+
+void test_matches_glibc_central_europe(void)
+{
+    checkAgainstGlibc("CET-1CEST,M3.5.0,M10.5.0/3");
+}
+
+void test_matches_glibc_us_eastern(void)
+{
+    checkAgainstGlibc("EST5EDT,M3.2.0,M11.1.0");
+}
+
+void test_matches_glibc_southern(void)
+{
+    checkAgainstGlibc("AEST-10AEDT,M10.1.0,M4.1.0/3");
+    checkAgainstGlibc("NZST-12NZDT,M9.5.0,M4.1.0/3");
+}
+
+void test_matches_glibc_other_rules(void)
+{
+    checkAgainstGlibc("<+0530>-5:30");                    // no DST, half-hour offset
+    checkAgainstGlibc("<-03>3<-02>,M3.5.0/-2,M10.5.0/-1"); // negative transition times
+    checkAgainstGlibc("EST5EDT,J60/2,J300/2");            // Julian, no February 29
+    checkAgainstGlibc("EST5EDT,59/2,299/2");              // day of year, counting February 29
+}
+
+// POSIX leaves DST without rules to the implementation (glibc reads the
+// posixrules file); ours uses the current US rules
+void test_default_rules(void)
+{
+    TEST_ASSERT_TRUE(setTimeZone("EST5EDT"));
+    TEST_ASSERT_EQUAL(-18000, offsetAt(1710053999UL)); // 2024-03-10 01:59:59 EST
+    TEST_ASSERT_EQUAL(-14400, offsetAt(1710054000UL));
+    TEST_ASSERT_EQUAL(-14400, offsetAt(1730613599UL)); // 2024-11-03 01:59:59 EDT
+    TEST_ASSERT_EQUAL(-18000, offsetAt(1730613600UL));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_leap_years);
+    RUN_TEST(test_civil_dates);
+    RUN_TEST(test_civil_matches_gmtime);
+    RUN_TEST(test_uk_transitions);
+    RUN_TEST(test_southern_hemisphere);
+    RUN_TEST(test_zone_change_recomputes_transitions);
+    RUN_TEST(test_invalid_zone_falls_back_to_utc);
+    RUN_TEST(test_matches_glibc_uk);
+    RUN_TEST(test_matches_glibc_central_europe);
+    RUN_TEST(test_matches_glibc_us_eastern);
+    RUN_TEST(test_matches_glibc_southern);
+    RUN_TEST(test_matches_glibc_other_rules);
+    RUN_TEST(test_default_rules);
+    return UNITY_END();
+}
@@ -0,0 +1,511 @@
+// ==================================================
+// File: test/test_tls_client/test_main.cpp
+// ==================================================
+//
+// TlsClient on the host against a fake mbedTLS (test/native/mbedtls): the
+// TCP connect is real, to a loopback listener, and the handshake is played
+// by a fake server with a session cache and a certificate that can be
+// swapped. Covers full vs resumed handshakes, sessions kept in NVS across a
+// reboot, and a pin mismatch clearing the stored session.
+
+#include <unity.h>
+#include <arpa/inet.h>
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+#include "TlsClient.cpp"
+
+// === Fake server ===
+
+struct FakeServer
+{
+    std::string der; // the certificate it presents
+    std::map<std::string, std::array<unsigned char, 48>> cache; // session id -> master secret
+    uint32_t issued = 0;
+    uint32_t offers = 0; // handshakes where the client offered a session
+    std::string lastSni;
+    mbedtls_x509_crt crt;
+
+    const mbedtls_x509_crt *certificate()
+    {
+        crt.raw.p = (const unsigned char *)der.data();
+        crt.raw.len = der.size();
+        return &crt;
+    }
+};
+
+static FakeServer server;
+
+static std::string sessionId(const mbedtls_ssl_session &s)
+{
+    return std::string((const char *)s.id, s.id_len);
+}
+
+int mbedtls_ssl_handshake(mbedtls_ssl_context *ssl)
+{
+    server.lastSni = ssl->hostname;
+    if (ssl->haveOffered)
+    {
+        server.offers++;
+        auto it = server.cache.find(sessionId(ssl->offered));
+        if (it != server.cache.end() && memcmp(it->second.data(), ssl->offered.master, 48) == 0)
+        {
+            ssl->negotiated = ssl->offered; // abbreviated: same master secret
+            ssl->peer = nullptr;            // no certificate on a resumed handshake
+            ssl->done = 1;
+            return 0;
+        }
+    }
+
+    // Full handshake: new session ID and master secret, certificate sent
+    uint32_t n = ++server.issued;
+    mbedtls_ssl_session s;
+    mbedtls_ssl_session_init(&s);
+    s.id_len = snprintf((char *)s.id, sizeof(s.id), "session-%u", (unsigned)n);
+    for (size_t i = 0; i < sizeof(s.master); i++)
+        s.master[i] = (unsigned char)(n * 31 + i);
+    std::array<unsigned char, 48> master;
+    memcpy(master.data(), s.master, 48);
+    server.cache[sessionId(s)] = master;
+    ssl->negotiated = s;
+    ssl->peer = server.certificate();
+    ssl->done = 1;
+    return 0;
+}
+
+// === Fake mbedTLS ===
+
+void mbedtls_ssl_init(mbedtls_ssl_context *ssl)
+{
+    memset(ssl, 0, sizeof(*ssl));
+}
+
+void mbedtls_ssl_free(mbedtls_ssl_context *ssl)
+{
+    memset(ssl, 0, sizeof(*ssl));
+}
+
+int mbedtls_ssl_setup(mbedtls_ssl_context *ssl, const mbedtls_ssl_config *conf)
+{
+    ssl->conf = conf;
+    return 0;
+}
+
+int mbedtls_ssl_set_hostname(mbedtls_ssl_context *ssl, const char *hostname)
+{
+    snprintf(ssl->hostname, sizeof(ssl->hostname), "%s", hostname);
+    return 0;
+}
+
+int mbedtls_ssl_set_session(mbedtls_ssl_context *ssl, const mbedtls_ssl_session *session)
+{
+    ssl->offered = *session;
+    ssl->haveOffered = 1;
+    return 0;
+}
+
+int mbedtls_ssl_get_session(const mbedtls_ssl_context *ssl, mbedtls_ssl_session *session)
+{
+    if (!ssl->done)
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    *session = ssl->negotiated;
+    return 0;
+}
+
+void mbedtls_ssl_set_bio(mbedtls_ssl_context *, void *, mbedtls_ssl_send_t *, mbedtls_ssl_recv_t *,
+                         mbedtls_ssl_recv_timeout_t *)
+{
+}
+
+const mbedtls_x509_crt *mbedtls_ssl_get_peer_cert(const mbedtls_ssl_context *ssl)
+{
+    return ssl->peer;
+}
+
+int mbedtls_ssl_read(mbedtls_ssl_context *, unsigned char *, size_t)
+{
+    return MBEDTLS_ERR_SSL_WANT_READ; // the server never says anything
+}
+
+int mbedtls_ssl_write(mbedtls_ssl_context *, const unsigned char *, size_t len)
+{
+    return (int)len;
+}
+
+size_t mbedtls_ssl_get_bytes_avail(const mbedtls_ssl_context *)
+{
+    return 0;
+}
+
+int mbedtls_ssl_close_notify(mbedtls_ssl_context *)
+{
+    return 0;
+}
+
+void mbedtls_ssl_config_init(mbedtls_ssl_config *conf)
+{
+    memset(conf, 0, sizeof(*conf));
+}
+
+void mbedtls_ssl_config_free(mbedtls_ssl_config *)
+{
+}
+
+int mbedtls_ssl_config_defaults(mbedtls_ssl_config *, int, int, int)
+{
+    return 0;
+}
+
+void mbedtls_ssl_conf_ca_chain(mbedtls_ssl_config *, mbedtls_x509_crt *, void *)
+{
+}
+
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config *conf, int authmode)
+{
+    conf->authmode = authmode;
+}
+
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config *, int (*)(void *, unsigned char *, size_t), void *)
+{
+}
+
+void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config *, int)
+{
+}
+
+void mbedtls_ssl_conf_read_timeout(mbedtls_ssl_config *conf, uint32_t timeout)
+{
+    conf->read_timeout = timeout;
+}
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session *session)
+{
+    memset(session, 0, sizeof(*session));
+}
+
+void mbedtls_ssl_session_free(mbedtls_ssl_session *session)
+{
+    memset(session, 0, sizeof(*session));
+}
+
+// Serialized as id_len, id, master
+int mbedtls_ssl_session_save(const mbedtls_ssl_session *session, unsigned char *buf, size_t len, size_t *olen)
+{
+    *olen = 1 + session->id_len + sizeof(session->master);
+    if (len < *olen)
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    buf[0] = (unsigned char)session->id_len;
+    memcpy(buf + 1, session->id, session->id_len);
+    memcpy(buf + 1 + session->id_len, session->master, sizeof(session->master));
+    return 0;
+}
+
+int mbedtls_ssl_session_load(mbedtls_ssl_session *session, const unsigned char *buf, size_t len)
+{
+    if (len < 1 || buf[0] > sizeof(session->id) || len != 1 + buf[0] + sizeof(session->master))
+        return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+    session->id_len = buf[0];
+    memcpy(session->id, buf + 1, session->id_len);
+    memcpy(session->master, buf + 1 + session->id_len, sizeof(session->master));
+    return 0;
+}
+
+void mbedtls_net_init(mbedtls_net_context *ctx)
+{
+    ctx->fd = -1;
+}
+
+void mbedtls_net_free(mbedtls_net_context *ctx)
+{
+    if (ctx->fd >= 0)
+        close(ctx->fd);
+    ctx->fd = -1;
+}
+
+int mbedtls_net_set_nonblock(mbedtls_net_context *)
+{
+    return 0;
+}
+
+int mbedtls_net_send(void *, const unsigned char *, size_t len)
+{
+    return (int)len;
+}
+
+int mbedtls_net_recv(void *, unsigned char *, size_t)
+{
+    return MBEDTLS_ERR_SSL_WANT_READ;
+}
+
+int mbedtls_net_recv_timeout(void *, unsigned char *, size_t, uint32_t)
+{
+    return MBEDTLS_ERR_SSL_WANT_READ;
+}
+
+void mbedtls_entropy_init(mbedtls_entropy_context *)
+{
+}
+
+void mbedtls_entropy_free(mbedtls_entropy_context *)
+{
+}
+
+int mbedtls_entropy_func(void *, unsigned char *output, size_t len)
+{
+    memset(output, 0x5A, len);
+    return 0;
+}
+
+void mbedtls_ctr_drbg_init(mbedtls_ctr_drbg_context *ctx)
+{
+    ctx->seeded = 0;
+}
+
+void mbedtls_ctr_drbg_free(mbedtls_ctr_drbg_context *)
+{
+}
+
+int mbedtls_ctr_drbg_seed(mbedtls_ctr_drbg_context *ctx, int (*)(void *, unsigned char *, size_t), void *,
+                          const unsigned char *, size_t)
+{
+    ctx->seeded = 1;
+    return 0;
+}
+
+int mbedtls_ctr_drbg_random(void *, unsigned char *output, size_t len)
+{
+    memset(output, 0xA5, len);
+    return 0;
+}
+
+void mbedtls_x509_crt_init(mbedtls_x509_crt *crt)
+{
+    memset(crt, 0, sizeof(*crt));
+}
+
+void mbedtls_x509_crt_free(mbedtls_x509_crt *crt)
+{
+    memset(crt, 0, sizeof(*crt));
+}
+
+int mbedtls_x509_crt_parse(mbedtls_x509_crt *, const unsigned char *, size_t)
+{
+    return 0;
+}
+
+// Not SHA-256, but a stable 32-byte digest is all the pin check needs
+int mbedtls_sha256_ret(const unsigned char *input, size_t len, unsigned char output[32], int)
+{
+    for (int lane = 0; lane < 4; lane++)
+    {
+        uint64_t h = 14695981039346656037ULL ^ (uint64_t)lane;
+        for (size_t i = 0; i < len; i++)
+            h = (h ^ input[i]) * 1099511628211ULL;
+        memcpy(output + lane * 8, &h, 8);
+    }
+    return 0;
+}
+
+// === Helpers ===
+
+#define SERVER_NAME "broker.example.com"
+
+static int listener = -1;
+static uint16_t listenPort = 0;
+
+// Connections are left in the backlog; the fake handshake never reads them
+static void openListener()
+{
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL(0, bind(listener, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, listen(listener, 64));
+    socklen_t len = sizeof(addr);
+    getsockname(listener, (struct sockaddr *)&addr, &len);
+    listenPort = ntohs(addr.sin_port);
+}
+
+static int connectTo(TlsClient &tls, const char *serverName = SERVER_NAME)
+{
+    return tls.connect(IPAddress(127, 0, 0, 1), listenPort, serverName);
+}
+
+static std::string pinFor(const std::string &der)
+{
+    unsigned char digest[32];
+    mbedtls_sha256_ret((const unsigned char *)der.data(), der.size(), digest, 0);
+    char hex[3 * 32];
+    for (int i = 0; i < 32; i++)
+        snprintf(hex + i * 3, 4, i < 31 ? "%02X:" : "%02X", digest[i]);
+    return hex;
+}
+
+static bool sessionStored()
+{
+    Preferences prefs;
+    prefs.begin("tls", true);
+    bool stored = prefs.getBytesLength("mqtt") > 0;
+    prefs.end();
+    return stored;
+}
+
+void setUp(void)
+{
+    nativeNvs().clear();
+    server.der = "certificate A";
+    server.cache.clear();
+    server.offers = 0;
+    if (listener < 0)
+        openListener();
+}
+
+void tearDown(void)
+{
+}
+
+// === Tests ===
+
+void test_full_then_resumed(void)
+{
+    TlsClient tls;
+    TEST_ASSERT_EQUAL(1, connectTo(tls));
+    TEST_ASSERT_EQUAL(TLS_HANDSHAKE_FULL, tls.getStats().lastType);
+    TEST_ASSERT_EQUAL_STRING(SERVER_NAME, server.lastSni.c_str());
+    tls.stop();
+
+    TEST_ASSERT_EQUAL(1, connectTo(tls));
+    TEST_ASSERT_EQUAL(TLS_HANDSHAKE_RESUMED, tls.getStats().lastType);
+    TEST_ASSERT_EQUAL(1, tls.getStats().fullHandshakes);
+    TEST_ASSERT_EQUAL(1, tls.getStats().resumedHandshakes);
+    TEST_ASSERT_EQUAL(1, server.offers);
+    TEST_ASSERT_TRUE(tls.connected());
+}
+
+// The session is matched on the server name, not the address dialled
+void test_session_is_per_server_name(void)
+{
+    TlsClient tls;
+    TEST_ASSERT_EQUAL(1, connectTo(tls));
+    TEST_ASSERT_EQUAL(1, connectTo(tls, "other.example.com"));
+    TEST_ASSERT_EQUAL(TLS_HANDSHAKE_FULL, tls.getStats().lastType);
+    TEST_ASSERT_EQUAL(0, server.offers);
+}
+
+void test_session_survives_reboot(void)
+{
+    {
+        TlsClient tls;
+        tls.setSessionStore("mqtt");
+        TEST_ASSERT_EQUAL(1, connectTo(tls));
+    }
+    TEST_ASSERT_TRUE(sessionStored());
+
+    TlsClient rebooted;
+    rebooted.setSessionStore("mqtt");
+    TEST_ASSERT_EQUAL(1, connectTo(rebooted));
+    TEST_ASSERT_EQUAL(TLS_HANDSHAKE_RESUMED, rebooted.getStats().lastType);
+    TEST_ASSERT_EQUAL(0, rebooted.getStats().fullHandshakes);
+}
+
+// A server that dropped the session does a full handshake; its new session is kept
+void test_forgotten_session_falls_back_to_full(void)
+{
+    TlsClient tls;
+    TEST_ASSERT_EQUAL(1, connectTo(tls));
+    server.cache.clear();
+    TEST_ASSERT_EQUAL(1, connectTo(tls));
+    TEST_ASSERT_EQUAL(TLS_HANDSHAKE_FULL, tls.getStats().lastType);
+    TEST_ASSERT_EQUAL(1, server.offers);
+    TEST_ASSERT_EQUAL(1, connectTo(tls));
+    TEST_ASSERT_EQUAL(TLS_HANDSHAKE_RESUMED, tls.getStats().lastType);
+}
+
+void test_pin_checked_on_full_handshake(void)
+{
+    TlsClient tls;
+    TEST_ASSERT_TRUE(tls.setPinnedFingerprint(pinFor("certificate B").c_str()));
+    TEST_ASSERT_EQUAL(0, connectTo(tls));
+    TEST_ASSERT_EQUAL(1, tls.getStats().failures);
+    TEST_ASSERT_FALSE(tls.connected());
+
+    TEST_ASSERT_TRUE(tls.setPinnedFingerprint(pinFor("certificate A").c_str()));
+    TEST_ASSERT_EQUAL(1, connectTo(tls));
+    TEST_ASSERT_EQUAL(TLS_HANDSHAKE_FULL, tls.getStats().lastType);
+}
+
+// The server's certificate changes: resuming the old session still works
+// (no certificate is sent), but the next full handshake fails the pin and
+// the stored session is dropped, from RAM and NVS, so it is never offered again
+void test_pin_mismatch_clears_stored_session(void)
+{
+    TlsClient tls;
+    tls.setSessionStore("mqtt");
+    TEST_ASSERT_TRUE(tls.setPinnedFingerprint(pinFor("certificate A").c_str()));
+    TEST_ASSERT_EQUAL(1, connectTo(tls));
+    TEST_ASSERT_TRUE(sessionStored());
+
+    server.der = "certificate B";
+    TEST_ASSERT_EQUAL(1, connectTo(tls));
+    TEST_ASSERT_EQUAL(TLS_HANDSHAKE_RESUMED, tls.getStats().lastType);
+
+    server.cache.clear();
+    TEST_ASSERT_EQUAL(0, connectTo(tls));
+    TEST_ASSERT_EQUAL(1, tls.getStats().failures);
+    TEST_ASSERT_FALSE(sessionStored());
+
+    server.der = "certificate A";
+    uint32_t offers = server.offers;
+    TEST_ASSERT_EQUAL(1, connectTo(tls));
+    TEST_ASSERT_EQUAL(TLS_HANDSHAKE_FULL, tls.getStats().lastType);
+    TEST_ASSERT_EQUAL(offers, server.offers);
+
+    TlsClient rebooted;
+    rebooted.setSessionStore("mqtt");
+    TEST_ASSERT_EQUAL(1, connectTo(rebooted));
+    TEST_ASSERT_EQUAL(TLS_HANDSHAKE_RESUMED, rebooted.getStats().lastType); // the new, verified session
+}
+
+void test_fingerprint_format(void)
+{
+    TlsClient tls;
+    std::string pin = pinFor("certificate A");
+    TEST_ASSERT_TRUE(tls.setPinnedFingerprint(pin.c_str()));
+    std::string bare;
+    for (char c : pin)
+    {
+        if (c != ':')
+            bare += (char)tolower(c);
+    }
+    TEST_ASSERT_TRUE(tls.setPinnedFingerprint(bare.c_str()));
+    TEST_ASSERT_FALSE(tls.setPinnedFingerprint(bare.substr(2).c_str()));
+    TEST_ASSERT_FALSE(tls.setPinnedFingerprint((bare + "00").c_str()));
+    TEST_ASSERT_FALSE(tls.setPinnedFingerprint(("zz" + bare.substr(2)).c_str()));
+}
+
+void test_connect_refused(void)
+{
+    TlsClient tls;
+    TEST_ASSERT_EQUAL(0, tls.connect(IPAddress(127, 0, 0, 1), 1, SERVER_NAME));
+    TEST_ASSERT_EQUAL(1, tls.getStats().failures);
+    TEST_ASSERT_EQUAL(0, server.offers);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_full_then_resumed);
+    RUN_TEST(test_session_is_per_server_name);
+    RUN_TEST(test_session_survives_reboot);
+    RUN_TEST(test_forgotten_session_falls_back_to_full);
+    RUN_TEST(test_pin_checked_on_full_handshake);
+    RUN_TEST(test_pin_mismatch_clears_stored_session);
+    RUN_TEST(test_fingerprint_format);
+    RUN_TEST(test_connect_refused);
+    int failures = UNITY_END();
+    close(listener);
+    return failures;
+}
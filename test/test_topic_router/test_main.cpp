@@ -0,0 +1,125 @@
+// ==================================================
+// File: test/test_topic_router/test_main.cpp
+// ==================================================
+//
+// TopicRouter on the host: wildcard precedence, case-sensitive segments and
+// per-topic duplicate suppression on the test clock.
+
+#include <unity.h>
+#include "TopicRouter.cpp"
+
+static int calls[4];
+static String lastMessage;
+
+static void onExact(const char *, const String &message)
+{
+    calls[0]++;
+    lastMessage = message;
+}
+
+static void onPlus(const char *, const String &message)
+{
+    calls[1]++;
+    lastMessage = message;
+}
+
+static void onHash(const char *, const String &message)
+{
+    calls[2]++;
+    lastMessage = message;
+}
+
+static void onOther(const char *, const String &message)
+{
+    calls[3]++;
+    lastMessage = message;
+}
+
+void setUp(void)
+{
+    memset(calls, 0, sizeof(calls));
+    memset(seen, 0, sizeof(seen));
+    seenNext = 0;
+    nativeAdvanceMs(TOPIC_DEDUP_WINDOW_MS); // nothing carries over between tests
+}
+
+void tearDown(void)
+{
+}
+
+void test_wildcard_precedence(void)
+{
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/schedule/am/time", "06:30"));
+    TEST_ASSERT_EQUAL(1, calls[0]);
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/schedule/pm/time", "17:00"));
+    TEST_ASSERT_EQUAL(1, calls[1]);
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/cmd/restart", "1"));
+    TEST_ASSERT_EQUAL(1, calls[2]);
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/cmd", "1")); // "a/#" matches "a"
+    TEST_ASSERT_EQUAL(2, calls[2]);
+    TEST_ASSERT_EQUAL(ROUTE_UNMATCHED, routeTopic("other/topic", "1"));
+}
+
+void test_segments_are_case_sensitive(void)
+{
+    TEST_ASSERT_EQUAL(ROUTE_UNMATCHED, routeTopic("Heater/schedule/am/time", "06:30"));
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/schedule/AM/time", "06:30"));
+    TEST_ASSERT_EQUAL(0, calls[0]);
+    TEST_ASSERT_EQUAL(1, calls[1]);
+}
+
+void test_repeat_is_dropped_within_window(void)
+{
+    uint32_t before = getDuplicateMessageCount();
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/setpoint", "20"));
+    nativeAdvanceMs(TOPIC_DEDUP_WINDOW_MS - 1);
+    TEST_ASSERT_EQUAL(ROUTE_DUPLICATE, routeTopic("heater/setpoint", "20"));
+    TEST_ASSERT_EQUAL(before + 1, getDuplicateMessageCount());
+    nativeAdvanceMs(1);
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/setpoint", "20"));
+    TEST_ASSERT_EQUAL(2, calls[3]);
+}
+
+// 20 -> 21 -> 20 is two changes, not a repeat
+void test_change_and_back_gets_through(void)
+{
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/setpoint", "20"));
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/setpoint", "21"));
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/setpoint", "20"));
+    TEST_ASSERT_EQUAL(3, calls[3]);
+    TEST_ASSERT_EQUAL_STRING("20", lastMessage.c_str());
+}
+
+void test_topics_are_tracked_separately(void)
+{
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/schedule/am/temperature", "21"));
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/schedule/pm/temperature", "21"));
+    TEST_ASSERT_EQUAL(ROUTE_DUPLICATE, routeTopic("heater/schedule/am/temperature", "21"));
+    TEST_ASSERT_EQUAL(2, calls[1]);
+}
+
+// Topic bytes are hashed as they arrive, so case variants are not repeats
+void test_fingerprint_keeps_case(void)
+{
+    TEST_ASSERT_TRUE(topicHashOf("heater/schedule/am/x") != topicHashOf("heater/schedule/AM/x"));
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/schedule/am/x", "1"));
+    TEST_ASSERT_EQUAL(ROUTE_DISPATCHED, routeTopic("heater/schedule/AM/x", "1"));
+    TEST_ASSERT_EQUAL(2, calls[1]);
+}
+
+int main(int argc, char **argv)
+{
+    addTopicRoute("heater/schedule/am/time", onExact);
+    addTopicRoute("heater/schedule/+/+", onPlus);
+    addTopicRoute("heater/cmd/#", onHash);
+    addTopicRoute("heater/setpoint", onOther);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_wildcard_precedence);
+    RUN_TEST(test_segments_are_case_sensitive);
+    RUN_TEST(test_repeat_is_dropped_within_window);
+    RUN_TEST(test_change_and_back_gets_through);
+    RUN_TEST(test_topics_are_tracked_separately);
+    RUN_TEST(test_fingerprint_keeps_case);
+    return UNITY_END();
+}